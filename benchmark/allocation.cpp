@@ -0,0 +1,79 @@
+#include "allocation.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(__GLIBC__)
+    #include <malloc.h>
+#elif defined(__APPLE__)
+    #include <malloc/malloc.h>
+#elif defined(_WIN32)
+    #include <malloc.h>
+#endif
+
+//Allocation statistics, sizes of blocks are queried from the allocator, so pointers are returned unchanged
+namespace
+{
+    std::atomic<unsigned long long> allocations(0);
+    std::atomic<unsigned long long> current_bytes(0);
+    std::atomic<unsigned long long> peak_bytes(0);
+
+    std::size_t block_size(void *pointer)
+    {
+        #if defined(__GLIBC__)
+            return malloc_usable_size(pointer);
+        #elif defined(__APPLE__)
+            return malloc_size(pointer);
+        #elif defined(_WIN32)
+            return _msize(pointer);
+        #else
+            (void)pointer;
+            return 0;
+        #endif
+    }
+
+    void *allocate(std::size_t size)
+    {
+        void *pointer = malloc(size);
+        if (pointer == nullptr) return nullptr;
+        allocations++;
+        const unsigned long long bytes = (current_bytes += block_size(pointer));
+        unsigned long long peak = peak_bytes;
+        while (bytes > peak && !peak_bytes.compare_exchange_weak(peak, bytes)) {}
+        return pointer;
+    }
+
+    void deallocate(void *pointer)
+    {
+        if (pointer == nullptr) return;
+        current_bytes -= block_size(pointer);
+        free(pointer);
+    }
+}
+
+unsigned long long allocation_count()
+{
+    return allocations;
+}
+
+unsigned long long peak_heap_bytes()
+{
+    return peak_bytes;
+}
+
+unsigned long long reset_peak_heap_bytes()
+{
+    const unsigned long long bytes = current_bytes;
+    peak_bytes = bytes;
+    return bytes;
+}
+
+void *operator new(std::size_t size) { void *pointer = allocate(size); if (pointer == nullptr) throw std::bad_alloc(); return pointer; }
+void *operator new[](std::size_t size) { void *pointer = allocate(size); if (pointer == nullptr) throw std::bad_alloc(); return pointer; }
+void *operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void *operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void *pointer) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer) noexcept { deallocate(pointer); }
+void operator delete(void *pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { deallocate(pointer); }
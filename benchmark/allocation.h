@@ -0,0 +1,13 @@
+#pragma once
+
+/*
+    Allocation statistics of the benchmark, global operators new and delete are replaced in allocation.cpp
+    The operators live in their own translation unit, so they are never inlined into code that allocates
+*/
+
+//Number of allocations since the start of the process
+unsigned long long allocation_count();
+//Highest number of heap bytes allocated since the last reset
+unsigned long long peak_heap_bytes();
+//Resets the highest number of heap bytes to the current number and returns it
+unsigned long long reset_peak_heap_bytes();
@@ -0,0 +1,340 @@
+#include "../include/grid_generator/point_grid.hxx"
+#include "../include/grid_generator/cell_grid.hxx"
+#include "allocation.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <math.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+/*
+    Benchmark of point and cellular grids
+    Every sweep varies one dimension (number of elements, grid type, boundary figures, threshold area, boundary class) around a base case,
+    the domain is always the unit circle (possibly with holes), so the number of elements is controlled by the element size
+    Every case reports time per element, number of allocations, peak heap size and peak resident set size,
+    cases run in their own processes where fork() is available, so peak resident set size belongs to one case
+
+    Usage: grid_generator_bench [--max-elements N] [--threads N] [--scanline] [--indexed] [--json FILE]
+*/
+
+//Peak resident set size of the process in bytes, zero if unknown
+unsigned long long peak_rss_bytes()
+{
+    #if defined(__APPLE__)
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (unsigned long long)usage.ru_maxrss;
+    #elif defined(__unix__)
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (unsigned long long)usage.ru_maxrss * 1024;
+    #else
+        return 0;
+    #endif
+}
+
+//Boundary figure
+enum class FigureType
+{
+    line,   //Unit circle approximated by lines (vertices are shifted so they do not lie on grid rows)
+    circle, //Unit circle with circular holes
+    arc     //Unit circle divided into arcs
+};
+
+//Boundaries of the unit circle made of given number of figures
+template <class B> std::vector<B> domain(FigureType figure, unsigned int count);
+
+template <> std::vector<gg::Boundary> domain<gg::Boundary>(FigureType figure, unsigned int count)
+{
+    std::vector<gg::Boundary> boundaries;
+    if (figure == FigureType::line)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const double a0 = 2 * M_PI * (i + 0.5) / count, a1 = 2 * M_PI * (i + 1.5) / count;
+            boundaries.push_back(new gg::Line(gg::Vector(cos(a1), sin(a1)), gg::Vector(cos(a0), sin(a0)), false));
+        }
+    }
+    else if (figure == FigureType::circle)
+    {
+        //Holes lie on a sunflower spiral between radii 0.2 and 0.85, origin stays inside of the domain
+        boundaries.push_back(new gg::Circle(gg::Vector(0.0, 0.0), 1.0, true));
+        const unsigned int holes = count - 1;
+        const double radius = 0.25 * sqrt(M_PI * (0.85 * 0.85 - 0.2 * 0.2) / (holes > 0 ? holes : 1));
+        for (unsigned int i = 0; i < holes; i++)
+        {
+            const double r = sqrt(0.2 * 0.2 + (0.85 * 0.85 - 0.2 * 0.2) * (i + 0.5) / holes), a = 2.39996322972865332 * i;
+            boundaries.push_back(new gg::Circle(gg::Vector(r * cos(a), r * sin(a)), radius, false));
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < count; i++) boundaries.push_back(new gg::Arc(gg::Vector(0.0, 0.0), 1.0, true, -M_PI + 2 * M_PI * (i + 0.5) / count, 2 * M_PI / count));
+    }
+    return boundaries;
+}
+
+template <> std::vector<gg::StaticBoundary> domain<gg::StaticBoundary>(FigureType figure, unsigned int count)
+{
+    std::vector<gg::StaticBoundary> boundaries;
+    const std::vector<gg::Boundary> dynamic_boundaries = domain<gg::Boundary>(figure, count);
+    for (std::vector<gg::Boundary>::const_iterator boundary = dynamic_boundaries.begin(); boundary != dynamic_boundaries.end(); boundary++)
+    {
+        if (const gg::Line *line = dynamic_cast<const gg::Line*>(boundary->figure())) boundaries.push_back(*line);
+        else if (const gg::Circle *circle = dynamic_cast<const gg::Circle*>(boundary->figure())) boundaries.push_back(*circle);
+        else boundaries.push_back(*dynamic_cast<const gg::Arc*>(boundary->figure()));
+    }
+    return boundaries;
+}
+
+//Benchmark case
+struct Case
+{
+    std::string sweep;
+    bool cell_grid = false;
+    gg::GridType type = gg::GridType::square;
+    FigureType figure = FigureType::line;
+    unsigned int figures = 64;
+    bool static_boundary = false;
+    double threshold_area = 0.5;
+    double elements = 1e5;  //Requested number of elements
+};
+
+//Benchmark result
+struct Result
+{
+    unsigned long long elements = 0;
+    unsigned int repetitions = 0;
+    double seconds = 0.0;   //Minimal time of one repetition
+    unsigned long long allocations = 0;
+    unsigned long long peak_heap_bytes = 0;
+    unsigned long long peak_rss_bytes = 0;
+};
+
+//Options that apply to all cases
+struct Options
+{
+    double max_elements = 1e7;
+    unsigned int threads = 1;
+    gg::Generation generation = gg::Generation::flood_fill;
+    gg::Storage storage = gg::Storage::objects;
+    std::string json;
+};
+
+const char *type_name(gg::GridType type)
+{
+    switch (type)
+    {
+        case gg::GridType::triangular: return "triangular";
+        case gg::GridType::hexagonal: return "hexagonal";
+        default: return "square";
+    }
+}
+
+const char *figure_name(FigureType figure)
+{
+    switch (figure)
+    {
+        case FigureType::circle: return "circle";
+        case FigureType::arc: return "arc";
+        default: return "line";
+    }
+}
+
+template <class B> Result run(const Case &c, const Options &options)
+{
+    const std::vector<B> boundaries = domain<B>(c.figure, c.figures);
+    gg::CellGridParameters parameters;
+    parameters.typ = c.type;
+    parameters.generation = options.generation;
+    parameters.storage = options.storage;
+    parameters.threads = options.threads;
+    parameters.threshold_area = c.threshold_area;
+    const double unit_area = gg::get_area(parameters);  //Area of element of size 1x1
+    const double size = sqrt(M_PI / (c.elements * unit_area));
+    parameters.size = gg::Vector(size, size);
+    gg::PointGridParameters point_parameters;
+    static_cast<gg::Parameters&>(point_parameters) = parameters;
+
+    //Repeat small cases to reduce noise
+    Result result;
+    double total = 0.0;
+    while (result.repetitions == 0 || (total < 0.5 && result.repetitions < 10))
+    {
+        const unsigned long long allocations_before = allocation_count();
+        const unsigned long long heap_before = reset_peak_heap_bytes();
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        if (c.cell_grid)
+        {
+            gg::CellGrid<B> grid(parameters, boundaries);
+            result.elements = (options.storage == gg::Storage::indexed) ? grid.indexed().cell_centers.size() : grid.cells().size();
+        }
+        else
+        {
+            gg::PointGrid<B> grid(point_parameters, boundaries);
+            result.elements = (options.storage == gg::Storage::indexed) ? grid.indexed().coords.size() : grid.points().size();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (result.repetitions == 0 || seconds < result.seconds) result.seconds = seconds;
+        result.allocations = allocation_count() - allocations_before;
+        result.peak_heap_bytes = peak_heap_bytes() - heap_before;
+        total += seconds;
+        result.repetitions++;
+    }
+    return result;
+}
+
+//Runs the case in a child process, peak resident set size is measured in the child
+Result run_process(const Case &c, const Options &options)
+{
+    #if defined(__unix__) || defined(__APPLE__)
+        int pipe_ends[2];
+        if (pipe(pipe_ends) != 0) throw std::runtime_error("pipe() failed");
+        const pid_t pid = fork();
+        if (pid < 0) throw std::runtime_error("fork() failed");
+        if (pid == 0)
+        {
+            close(pipe_ends[0]);
+            Result result = c.static_boundary ? run<gg::StaticBoundary>(c, options) : run<gg::Boundary>(c, options);
+            result.peak_rss_bytes = peak_rss_bytes();
+            const bool written = write(pipe_ends[1], &result, sizeof(result)) == (ssize_t)sizeof(result);
+            close(pipe_ends[1]);
+            _exit(written ? 0 : 1);
+        }
+        close(pipe_ends[1]);
+        Result result;
+        std::size_t received = 0;
+        while (received < sizeof(result))
+        {
+            const ssize_t count = read(pipe_ends[0], (char*)&result + received, sizeof(result) - received);
+            if (count <= 0) break;
+            received += (std::size_t)count;
+        }
+        close(pipe_ends[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (received != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) throw std::runtime_error("Benchmark process failed");
+        return result;
+    #else
+        return c.static_boundary ? run<gg::StaticBoundary>(c, options) : run<gg::Boundary>(c, options);
+    #endif
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--max-elements" && i + 1 < argc) options.max_elements = atof(argv[++i]);
+        else if (argument == "--threads" && i + 1 < argc) options.threads = (unsigned int)atoi(argv[++i]);
+        else if (argument == "--scanline") options.generation = gg::Generation::scanline;
+        else if (argument == "--indexed") options.storage = gg::Storage::indexed;
+        else if (argument == "--json" && i + 1 < argc) options.json = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--max-elements N] [--threads N] [--scanline] [--indexed] [--json FILE]\n";
+            return 1;
+        }
+    }
+
+    //Sweeps around the base case (square grid, 64 lines, threshold area 0.5, 10^5 elements or less)
+    //The boundary sweep checks that time per element stays flat as the number of lines or arcs grows
+    std::vector<Case> cases;
+    const double base_elements = (options.max_elements < 1e5) ? options.max_elements : 1e5;
+    const gg::GridType types[3] = { gg::GridType::triangular, gg::GridType::square, gg::GridType::hexagonal };
+    const FigureType figures[3] = { FigureType::line, FigureType::circle, FigureType::arc };
+    for (unsigned int grid = 0; grid < 2; grid++)
+    {
+        Case c;
+        c.cell_grid = (grid == 1);
+        c.elements = base_elements;
+        for (unsigned int t = 0; t < 3; t++)
+        {
+            for (double elements = 1e3; elements <= options.max_elements * 1.001; elements *= 10)
+            {
+                Case size = c;
+                size.sweep = "size";
+                size.type = types[t];
+                size.elements = elements;
+                cases.push_back(size);
+            }
+        }
+        for (unsigned int f = 0; f < 3; f++)
+        {
+            for (unsigned int count = 4; count <= 4096; count *= 8)
+            {
+                Case figure = c;
+                figure.sweep = "figures";
+                figure.figure = figures[f];
+                figure.figures = count;
+                cases.push_back(figure);
+            }
+        }
+        for (unsigned int f = 0; f < 3; f += 2)
+        {
+            for (unsigned int count = 16; count <= 16384; count *= 16)
+            {
+                for (unsigned int s = 0; s < 2; s++)
+                {
+                    Case boundary = c;
+                    boundary.sweep = "boundary";
+                    boundary.figure = figures[f];
+                    boundary.figures = count;
+                    boundary.static_boundary = (s == 1);
+                    cases.push_back(boundary);
+                }
+            }
+        }
+        if (c.cell_grid) for (unsigned int t = 0; t <= 4; t++)
+        {
+            Case threshold = c;
+            threshold.sweep = "threshold_area";
+            threshold.threshold_area = 0.25 * t;
+            cases.push_back(threshold);
+        }
+    }
+
+    //Run
+    std::ostringstream json;
+    json << "{\n  \"threads\": " << options.threads
+        << ",\n  \"generation\": \"" << ((options.generation == gg::Generation::scanline) ? "scanline" : "flood_fill")
+        << "\",\n  \"storage\": \"" << ((options.storage == gg::Storage::indexed) ? "indexed" : "objects")
+        << "\",\n  \"results\": [";
+    bool first = true;
+    std::cout << "sweep\tgrid\ttype\tfigure\tfigures\tboundary\tthreshold\telements\tns_per_element\tallocations\tpeak_heap_MB\tpeak_rss_MB\n";
+    for (std::vector<Case>::const_iterator c = cases.begin(); c != cases.end(); c++)
+    {
+        if (c->elements > options.max_elements * 1.001) continue;
+        const Result result = run_process(*c, options);
+        const double ns_per_element = (result.elements == 0) ? 0.0 : (result.seconds * 1e9 / result.elements);
+        std::cout << c->sweep << '\t' << (c->cell_grid ? "cell" : "point") << '\t' << type_name(c->type) << '\t' << figure_name(c->figure) << '\t'
+            << c->figures << '\t' << (c->static_boundary ? "static" : "virtual") << '\t' << c->threshold_area << '\t' << result.elements << '\t'
+            << ns_per_element << '\t' << result.allocations << '\t' << result.peak_heap_bytes / 1048576.0 << '\t' << result.peak_rss_bytes / 1048576.0 << std::endl;
+        json << (first ? "\n" : ",\n") << "    {\"sweep\": \"" << c->sweep << "\", \"grid\": \"" << (c->cell_grid ? "cell" : "point")
+            << "\", \"type\": \"" << type_name(c->type) << "\", \"figure\": \"" << figure_name(c->figure) << "\", \"figures\": " << c->figures
+            << ", \"boundary\": \"" << (c->static_boundary ? "static" : "virtual") << "\", \"threshold_area\": " << c->threshold_area
+            << ", \"elements\": " << result.elements << ", \"repetitions\": " << result.repetitions << ", \"seconds\": " << result.seconds
+            << ", \"ns_per_element\": " << ns_per_element << ", \"allocations\": " << result.allocations
+            << ", \"peak_heap_bytes\": " << result.peak_heap_bytes << ", \"peak_rss_bytes\": " << result.peak_rss_bytes << "}";
+        first = false;
+    }
+    json << "\n  ]\n}\n";
+
+    if (!options.json.empty())
+    {
+        std::ofstream file(options.json);
+        if (!file) { std::cerr << "Cannot open " << options.json << '\n'; return 1; }
+        file << json.str();
+    }
+    return 0;
+}
@@ -1,6 +1,17 @@
 #include "../include/grid_generator/point_grid.hxx"
 #include "../include/grid_generator/cell_grid.hxx"
+#include "../include/grid_generator/lattice_view.hxx"
+#include "../include/grid_generator/figure_batch.h"
+#include "../include/grid_generator/binary_grid.h"
+#include "../include/grid_generator/export.h"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
 
 TEST (GridTest, PointGridTest)
 {
@@ -37,6 +48,1368 @@ TEST (GridTest, CellGridTest)
     EXPECT_NO_THROW(delete cell_grid);
 }
 
+TEST (GridTest, ScanlineTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, 0.5), gg::Vector(0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, -0.5), gg::Vector(-0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, -0.5), gg::Vector(-0.5, 0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, 0.5), gg::Vector(0.5, 0.5), false));
+    gg::PointGridParameters point_parameters;
+    point_parameters.size = gg::Vector(0.3, 0.3);
+    point_parameters.generation = gg::Generation::scanline;
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.3, 0.3);
+    cell_parameters.threshold_area = 0.0;
+    cell_parameters.generation = gg::Generation::scanline;
+
+    gg::PointGrid<> *point_grid;
+    EXPECT_NO_THROW(point_grid = new gg::PointGrid<>(point_parameters, boundaries));
+    EXPECT_EQ(point_grid->points().size(), 9);
+    EXPECT_NO_THROW(delete point_grid);
+
+    gg::CellGrid<> *cell_grid;
+    EXPECT_NO_THROW(cell_grid = new gg::CellGrid<>(cell_parameters, boundaries));
+    EXPECT_EQ(cell_grid->points().size(), 32);
+    EXPECT_EQ(cell_grid->faces().size(), 56);
+    EXPECT_EQ(cell_grid->cells().size(), 25);
+    EXPECT_NO_THROW(delete cell_grid);
+}
+
+TEST (GridTest, StaticBoundaryTest)
+{
+    std::vector<gg::StaticBoundary> boundaries;
+    boundaries.push_back(gg::Line(gg::Vector(0.5, 0.5), gg::Vector(0.5, -0.5), false));
+    boundaries.push_back(gg::Line(gg::Vector(0.5, -0.5), gg::Vector(-0.5, -0.5), false));
+    boundaries.push_back(gg::Line(gg::Vector(-0.5, -0.5), gg::Vector(-0.5, 0.5), false));
+    boundaries.push_back(gg::Line(gg::Vector(-0.5, 0.5), gg::Vector(0.5, 0.5), false));
+    gg::PointGridParameters point_parameters;
+    point_parameters.size = gg::Vector(0.3, 0.3);
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.3, 0.3);
+    cell_parameters.threshold_area = 0.0;
+
+    gg::PointGrid<gg::StaticBoundary> *point_grid;
+    EXPECT_NO_THROW(point_grid = new gg::PointGrid<gg::StaticBoundary>(point_parameters, boundaries));
+    EXPECT_EQ(point_grid->points().size(), 9);
+    EXPECT_NO_THROW(delete point_grid);
+
+    gg::CellGrid<gg::StaticBoundary> *cell_grid;
+    EXPECT_NO_THROW(cell_grid = new gg::CellGrid<gg::StaticBoundary>(cell_parameters, boundaries));
+    EXPECT_EQ(cell_grid->points().size(), 32);
+    EXPECT_EQ(cell_grid->faces().size(), 56);
+    EXPECT_EQ(cell_grid->cells().size(), 25);
+    EXPECT_NO_THROW(delete cell_grid);
+}
+
+///Boundary that provides only figure(), other functions come from gg::BoundaryTraits
+struct FigureOnlyBoundary
+{
+    std::shared_ptr<const gg::Figure> shared_figure;
+    FigureOnlyBoundary(const gg::Figure *figure) : shared_figure(figure) {}
+    const gg::Figure *figure() const { return shared_figure.get(); }
+};
+
+TEST (GridTest, FigureOnlyBoundaryTest)
+{
+    std::vector<FigureOnlyBoundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, 0.5), gg::Vector(0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, -0.5), gg::Vector(-0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, -0.5), gg::Vector(-0.5, 0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, 0.5), gg::Vector(0.5, 0.5), false));
+    gg::PointGridParameters point_parameters;
+    point_parameters.size = gg::Vector(0.3, 0.3);
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.3, 0.3);
+    cell_parameters.threshold_area = 0.0;
+
+    gg::PointGrid<FigureOnlyBoundary> *point_grid;
+    EXPECT_NO_THROW(point_grid = new gg::PointGrid<FigureOnlyBoundary>(point_parameters, boundaries));
+    EXPECT_EQ(point_grid->points().size(), 9);
+    EXPECT_NO_THROW(delete point_grid);
+
+    for (gg::Generation generation : { gg::Generation::flood_fill, gg::Generation::scanline })
+    {
+        cell_parameters.generation = generation;
+        gg::CellGrid<FigureOnlyBoundary> *cell_grid;
+        EXPECT_NO_THROW(cell_grid = new gg::CellGrid<FigureOnlyBoundary>(cell_parameters, boundaries));
+        EXPECT_EQ(cell_grid->points().size(), 32);
+        EXPECT_EQ(cell_grid->faces().size(), 56);
+        EXPECT_EQ(cell_grid->cells().size(), 25);
+        EXPECT_NO_THROW(delete cell_grid);
+    }
+}
+
+TEST (GridTest, IndexedStorageTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, 0.5), gg::Vector(0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, -0.5), gg::Vector(-0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, -0.5), gg::Vector(-0.5, 0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, 0.5), gg::Vector(0.5, 0.5), false));
+    gg::PointGridParameters point_parameters;
+    point_parameters.size = gg::Vector(0.3, 0.3);
+    point_parameters.storage = gg::Storage::indexed;
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.3, 0.3);
+    cell_parameters.threshold_area = 0.0;
+    cell_parameters.storage = gg::Storage::indexed;
+
+    gg::PointGrid<> point_grid(point_parameters, boundaries);
+    EXPECT_EQ(point_grid.points().size(), 0);
+    EXPECT_EQ(point_grid.indexed().coords.size(), 9);
+    EXPECT_EQ(point_grid.indexed().neighbor_offsets.size(), 10);
+
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+    const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+    EXPECT_EQ(cell_grid.cells().size(), 0);
+    EXPECT_EQ(indexed.point_coords.size(), 32);
+    EXPECT_EQ(indexed.face_points.size(), 56);
+    EXPECT_EQ(indexed.cell_centers.size(), 25);
+    ASSERT_EQ(indexed.side_offsets.size(), 26);
+    EXPECT_EQ(indexed.side_offsets.back(), indexed.sides.size());
+    for (unsigned int i = 0; i < indexed.sides.size(); i++)
+    {
+        EXPECT_LT(indexed.sides[i].point, indexed.point_coords.size());
+        EXPECT_LT(indexed.sides[i].face, indexed.face_points.size());
+        EXPECT_TRUE(indexed.sides[i].cell == gg::no_index || indexed.sides[i].cell < indexed.cell_centers.size());
+    }
+
+    //Objects are created directly and have the same connectivity and sides
+    cell_parameters.storage = gg::Storage::objects;
+    gg::CellGrid<> object_grid(cell_parameters, boundaries);
+    EXPECT_EQ(object_grid.indexed().sides.size(), 0);
+    EXPECT_EQ(object_grid.connectivity().cell_faces, cell_grid.connectivity().cell_faces);
+    EXPECT_EQ(object_grid.connectivity().cell_face_inwards, cell_grid.connectivity().cell_face_inwards);
+    EXPECT_EQ(object_grid.connectivity().cell_points, cell_grid.connectivity().cell_points);
+    EXPECT_EQ(object_grid.connectivity().point_cells, cell_grid.connectivity().point_cells);
+    ASSERT_EQ(object_grid.cells().size(), indexed.cell_centers.size());
+    std::vector<gg::Cell<>*> cells(object_grid.cells().begin(), object_grid.cells().end()); //Ordered by address, cells were created in order of indexes
+    for (unsigned int cell = 0; cell < cells.size(); cell++)
+    {
+        EXPECT_EQ(cells[cell]->center().x, indexed.cell_centers[cell].x);
+        EXPECT_EQ(cells[cell]->center().y, indexed.cell_centers[cell].y);
+        ASSERT_EQ(cells[cell]->sides().size(), indexed.side_offsets[cell + 1] - indexed.side_offsets[cell]);
+        for (unsigned int s = 0; s < cells[cell]->sides().size(); s++)
+        {
+            const gg::IndexedSide &side = indexed.sides[indexed.side_offsets[cell] + s];
+            EXPECT_EQ(cells[cell]->sides()[s].point->coord().x, indexed.point_coords[side.point].x);
+            EXPECT_EQ(cells[cell]->sides()[s].point->coord().y, indexed.point_coords[side.point].y);
+            EXPECT_EQ(cells[cell]->sides()[s].inwards, side.inwards);
+            EXPECT_EQ(cells[cell]->sides()[s].cell == nullptr, side.cell == gg::no_index);
+        }
+    }
+}
+
+TEST (GridTest, BinaryGridTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, 0.5), gg::Vector(0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, -0.5), gg::Vector(-0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, -0.5), gg::Vector(-0.5, 0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, 0.5), gg::Vector(0.5, 0.5), false));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.1, 0.1), 0.2, false));
+    gg::PointGridParameters point_parameters;
+    point_parameters.size = gg::Vector(0.05, 0.05);
+    point_parameters.storage = gg::Storage::indexed;
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.01, 0.01); //Sides are written in several chunks
+    cell_parameters.storage = gg::Storage::indexed;
+
+    gg::PointGrid<> point_grid(point_parameters, boundaries);
+    gg::write_grid("grid_generator_point_grid.bin", point_grid.indexed());
+    {
+        const gg::MappedGrid mapped("grid_generator_point_grid.bin");
+        ASSERT_FALSE(mapped.cellular());
+        EXPECT_THROW(mapped.cell_grid(), std::runtime_error);
+        const gg::MappedPointGrid &grid = mapped.point_grid();
+        EXPECT_TRUE(std::equal(grid.boundaries.begin(), grid.boundaries.end(), point_grid.indexed().boundaries.begin()));
+        EXPECT_TRUE(std::equal(grid.neighbors.begin(), grid.neighbors.end(), point_grid.indexed().neighbors.begin()));
+        ASSERT_EQ(grid.coords.size(), point_grid.indexed().coords.size());
+        for (unsigned int i = 0; i < grid.coords.size(); i++) EXPECT_EQ(grid.coords[i].x, point_grid.indexed().coords[i].x);
+    }
+    std::remove("grid_generator_point_grid.bin");
+
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+    const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+    gg::write_grid("grid_generator_cell_grid.bin", indexed);
+    {
+        const gg::MappedGrid mapped("grid_generator_cell_grid.bin");
+        ASSERT_TRUE(mapped.cellular());
+        const gg::MappedCellGrid &grid = mapped.cell_grid();
+        ASSERT_EQ(grid.cell_areas.size(), indexed.cell_areas.size());
+        ASSERT_EQ(grid.sides.size(), indexed.sides.size());
+        EXPECT_TRUE(std::equal(grid.cell_areas.begin(), grid.cell_areas.end(), indexed.cell_areas.begin()));
+        EXPECT_TRUE(std::equal(grid.face_lengths.begin(), grid.face_lengths.end(), indexed.face_lengths.begin()));
+        EXPECT_TRUE(std::equal(grid.face_points.begin(), grid.face_points.end(), indexed.face_points.begin()));
+        EXPECT_TRUE(std::equal(grid.side_offsets.begin(), grid.side_offsets.end(), indexed.side_offsets.begin()));
+        for (unsigned int i = 0; i < grid.sides.size(); i++)
+        {
+            EXPECT_EQ(grid.sides[i].point, indexed.sides[i].point);
+            EXPECT_EQ(grid.sides[i].face, indexed.sides[i].face);
+            EXPECT_EQ(grid.sides[i].cell, indexed.sides[i].cell);
+            EXPECT_EQ(grid.sides[i].inwards, indexed.sides[i].inwards);
+        }
+    }
+    std::remove("grid_generator_cell_grid.bin");
+    EXPECT_THROW(gg::MappedGrid("grid_generator_missing_grid.bin"), std::runtime_error);
+}
+
+TEST (GridTest, ExportTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, 0.5), gg::Vector(0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, -0.5), gg::Vector(-0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, -0.5), gg::Vector(-0.5, 0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, 0.5), gg::Vector(0.5, 0.5), false));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.1, 0.1), 0.2, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.05);
+    cell_parameters.storage = gg::Storage::indexed;
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+    const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+    const auto read = [](const char *path) -> std::string
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+
+    gg::write_vtu("grid_generator_cell_grid.vtu", indexed, { gg::area_field(indexed), gg::boundary_field(indexed) });
+    const std::string vtu = read("grid_generator_cell_grid.vtu");
+    std::remove("grid_generator_cell_grid.vtu");
+    EXPECT_NE(vtu.find("NumberOfCells=\"" + std::to_string(indexed.cell_centers.size()) + "\""), std::string::npos);
+    EXPECT_NE(vtu.find("Name=\"boundary\""), std::string::npos);
+    const std::size_t data = vtu.find("<AppendedData encoding=\"raw\">\n   _") + 34;
+    unsigned long long size;
+    std::memcpy(&size, &vtu[data], sizeof(size));
+    ASSERT_EQ(size, indexed.point_coords.size() * 3 * sizeof(double));
+    double coord[3];
+    std::memcpy(coord, &vtu[data + sizeof(size) + 3 * sizeof(double)], sizeof(coord));
+    EXPECT_EQ(coord[0], indexed.point_coords[1].x);
+    EXPECT_EQ(coord[1], indexed.point_coords[1].y);
+    EXPECT_EQ(coord[2], 0.0);
+    EXPECT_EQ(vtu.substr(vtu.size() - 11), "</VTKFile>\n");
+
+    gg::write_msh("grid_generator_cell_grid.msh", indexed, { gg::area_field(indexed) });
+    const std::string msh = read("grid_generator_cell_grid.msh");
+    std::remove("grid_generator_cell_grid.msh");
+    EXPECT_EQ(msh.substr(0, 20), "$MeshFormat\n4.1 1 8\n");
+    EXPECT_NE(msh.find("$EndElements\n$ElementData\n1\n\"area\""), std::string::npos);
+    EXPECT_THROW(gg::write_msh("grid_generator_cell_grid.msh", indexed, { { "wrong", { 1.0 } } }), std::runtime_error);
+}
+
+TEST (GridTest, ConnectivityTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Circle(gg::Vector(0.0, 0.0), 0.5, true));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.1, 0.1);
+
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+    const gg::CellConnectivity &connectivity = cell_grid.connectivity();
+    ASSERT_EQ(connectivity.cell_offsets.size(), cell_grid.cells().size() + 1);
+    ASSERT_EQ(connectivity.face_cells.size(), cell_grid.faces().size());
+    ASSERT_EQ(connectivity.point_offsets.size(), cell_grid.points().size() + 1);
+    EXPECT_EQ(connectivity.point_cells.size(), connectivity.cell_points.size());
+    unsigned int boundary_faces = 0;
+    for (unsigned int face = 0; face < connectivity.face_cells.size(); face++)
+    {
+        EXPECT_NE(connectivity.face_cells[face][0], gg::no_index);
+        if (connectivity.face_cells[face][1] == gg::no_index) boundary_faces++;
+    }
+    EXPECT_GT(boundary_faces, 0);
+    for (unsigned int cell = 0; cell + 1 < connectivity.cell_offsets.size(); cell++)
+    {
+        for (unsigned int i = connectivity.cell_offsets[cell]; i < connectivity.cell_offsets[cell + 1]; i++)
+        {
+            const std::array<unsigned int, 2> &face_cells = connectivity.face_cells[connectivity.cell_faces[i]];
+            if (face_cells[1] == gg::no_index) continue;
+            EXPECT_EQ(connectivity.cell_face_inwards[i], (face_cells[1] == cell) ? 1 : 0);
+        }
+    }
+}
+
+TEST (GridTest, ThreadsTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Circle(gg::Vector(0.01, 0.02), 0.5, true));
+    const gg::Generation generations[2] = { gg::Generation::flood_fill, gg::Generation::scanline };
+    for (unsigned int g = 0; g < 2; g++)
+    {
+        gg::PointGridParameters point_parameters;
+        point_parameters.size = gg::Vector(0.03, 0.02);
+        point_parameters.generation = generations[g];
+        point_parameters.storage = gg::Storage::indexed;
+        gg::CellGridParameters cell_parameters;
+        cell_parameters.size = gg::Vector(0.03, 0.02);
+        cell_parameters.generation = generations[g];
+        cell_parameters.storage = gg::Storage::indexed;
+
+        gg::PointGrid<> serial_point_grid(point_parameters, boundaries);
+        gg::CellGrid<> serial_cell_grid(cell_parameters, boundaries);
+        point_parameters.threads = cell_parameters.threads = 4;
+        gg::PointGrid<> parallel_point_grid(point_parameters, boundaries);
+        gg::CellGrid<> parallel_cell_grid(cell_parameters, boundaries);
+
+        const gg::IndexedPointGrid &serial_points = serial_point_grid.indexed(), &parallel_points = parallel_point_grid.indexed();
+        ASSERT_EQ(serial_points.coords.size(), parallel_points.coords.size());
+        for (unsigned int i = 0; i < serial_points.coords.size(); i++)
+        {
+            EXPECT_EQ(serial_points.coords[i].x, parallel_points.coords[i].x);
+            EXPECT_EQ(serial_points.coords[i].y, parallel_points.coords[i].y);
+            EXPECT_EQ(serial_points.boundaries[i], parallel_points.boundaries[i]);
+        }
+        EXPECT_EQ(serial_points.neighbors, parallel_points.neighbors);
+
+        const gg::IndexedCellGrid &serial_cells = serial_cell_grid.indexed(), &parallel_cells = parallel_cell_grid.indexed();
+        ASSERT_EQ(serial_cells.point_coords.size(), parallel_cells.point_coords.size());
+        for (unsigned int i = 0; i < serial_cells.point_coords.size(); i++)
+        {
+            EXPECT_EQ(serial_cells.point_coords[i].x, parallel_cells.point_coords[i].x);
+            EXPECT_EQ(serial_cells.point_coords[i].y, parallel_cells.point_coords[i].y);
+        }
+        EXPECT_EQ(serial_cells.face_points, parallel_cells.face_points);
+        EXPECT_EQ(serial_cells.face_lengths, parallel_cells.face_lengths);
+        EXPECT_EQ(serial_cells.cell_areas, parallel_cells.cell_areas);
+        EXPECT_EQ(serial_cells.side_offsets, parallel_cells.side_offsets);
+        ASSERT_EQ(serial_cells.sides.size(), parallel_cells.sides.size());
+        for (unsigned int i = 0; i < serial_cells.sides.size(); i++)
+        {
+            EXPECT_EQ(serial_cells.sides[i].point, parallel_cells.sides[i].point);
+            EXPECT_EQ(serial_cells.sides[i].face, parallel_cells.sides[i].face);
+            EXPECT_EQ(serial_cells.sides[i].cell, parallel_cells.sides[i].cell);
+            EXPECT_EQ(serial_cells.sides[i].inwards, parallel_cells.sides[i].inwards);
+        }
+        EXPECT_EQ(serial_cell_grid.connectivity().face_cells, parallel_cell_grid.connectivity().face_cells);
+    }
+
+    //Pool is reused by consecutive and nested loops, exceptions are rethrown
+    gg::ThreadPool pool(4);
+    std::vector<unsigned int> counts(1000, 0);
+    for (unsigned int repeat = 0; repeat < 100; repeat++) gg::parallel_for(pool, (unsigned int)counts.size(), [&](unsigned int i) { counts[i]++; });
+    EXPECT_EQ(std::count(counts.begin(), counts.end(), 100u), (std::ptrdiff_t)counts.size());
+    std::atomic<unsigned int> nested(0);
+    gg::parallel_for(pool, 8, [&](unsigned int) { gg::parallel_for(pool, 10, [&](unsigned int) { nested++; }); });
+    EXPECT_EQ(nested.load(), 80u);
+    EXPECT_THROW(gg::parallel_for(pool, 100, [](unsigned int i) { if (i == 50) throw std::runtime_error("test"); }), std::runtime_error);
+}
+
+TEST (GridTest, StatisticsTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, 0.5), gg::Vector(0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(0.5, -0.5), gg::Vector(-0.5, -0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, -0.5), gg::Vector(-0.5, 0.5), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-0.5, 0.5), gg::Vector(0.5, 0.5), false));
+    gg::PointGridParameters point_parameters;
+    point_parameters.size = gg::Vector(0.3, 0.3);
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.3, 0.3);
+    cell_parameters.threshold_area = 0.0;
+
+    gg::GridStatistics point_statistics;
+    gg::PointGrid<> point_grid(point_parameters, boundaries, point_statistics);
+    EXPECT_EQ(point_grid.points().size(), 9);
+    EXPECT_FALSE(point_statistics.stages().empty());
+    EXPECT_GT(point_statistics.waves(), 0);
+    EXPECT_GT(point_statistics.hits(), 0);
+    EXPECT_GE(point_statistics.probes(), point_statistics.hits());
+    EXPECT_GE(point_statistics.tests(), point_statistics.hits());
+    EXPECT_GT(point_statistics.lookups(), 0);
+
+    gg::GridStatistics cell_statistics;
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries, cell_statistics);
+    EXPECT_EQ(cell_grid.points().size(), 32);
+    EXPECT_EQ(cell_grid.faces().size(), 56);
+    EXPECT_EQ(cell_grid.cells().size(), 25);
+    EXPECT_FALSE(cell_statistics.stages().empty());
+    EXPECT_GT(cell_statistics.waves(), 0);
+    EXPECT_GT(cell_statistics.hits(), 0);
+    EXPECT_GE(cell_statistics.probes(), cell_statistics.hits());
+    EXPECT_GT(cell_statistics.allocations(), 0);
+    EXPECT_GT(cell_statistics.peak_memory(), 0);
+}
+
+//Checks that cell, face and point connectivity of the grid agree with each other and with sides
+static void check_connectivity(const gg::CellGrid<> &cell_grid)
+{
+    const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+    const gg::CellConnectivity &connectivity = cell_grid.connectivity();
+    ASSERT_EQ(connectivity.cell_offsets, indexed.side_offsets);
+    ASSERT_EQ(connectivity.face_cells.size(), indexed.face_points.size());
+    ASSERT_EQ(connectivity.point_offsets.size(), indexed.point_coords.size() + 1);
+    EXPECT_EQ(connectivity.point_cells.size(), connectivity.cell_points.size());
+    for (unsigned int cell = 0; cell + 1 < connectivity.cell_offsets.size(); cell++)
+    {
+        for (unsigned int s = connectivity.cell_offsets[cell]; s < connectivity.cell_offsets[cell + 1]; s++)
+        {
+            const unsigned int face = connectivity.cell_faces[s], point = connectivity.cell_points[s];
+            const std::array<unsigned int, 2> cells = connectivity.face_cells[face];
+            ASSERT_TRUE(cells[0] == cell || cells[1] == cell);
+            EXPECT_EQ(indexed.sides[s].face, face);
+            EXPECT_EQ(indexed.sides[s].point, point);
+            EXPECT_EQ(indexed.sides[s].cell, (cells[0] == cell) ? cells[1] : cells[0]);
+            EXPECT_EQ(indexed.sides[s].inwards, connectivity.cell_face_inwards[s] != 0);
+            const unsigned int *begin = &connectivity.point_cells[0] + connectivity.point_offsets[point], *end = &connectivity.point_cells[0] + connectivity.point_offsets[point + 1];
+            EXPECT_TRUE(std::is_sorted(begin, end));
+            EXPECT_NE(std::find(begin, end, cell), end);
+        }
+    }
+    for (unsigned int face = 0; face < connectivity.face_cells.size(); face++)
+    {
+        const std::array<unsigned int, 2> cells = connectivity.face_cells[face];
+        ASSERT_NE(cells[0], gg::no_index);
+        const gg::Vector outwards = indexed.face_centers[face] - indexed.cell_centers[cells[0]];
+        if (cells[1] != gg::no_index) { EXPECT_GT(indexed.face_normals[face].dot(outwards), 0.0); }
+    }
+}
+
+//Checks that cells of the grid are the cells of other grid, up to their numbering
+static void check_same_cells(const gg::CellGrid<> &cell_grid, const gg::CellGrid<> &other_grid)
+{
+    const gg::IndexedCellGrid &indexed = cell_grid.indexed(), &other = other_grid.indexed();
+    ASSERT_EQ(indexed.cell_areas.size(), other.cell_areas.size());
+    ASSERT_EQ(indexed.face_points.size(), other.face_points.size());
+    ASSERT_EQ(indexed.point_coords.size(), other.point_coords.size());
+    for (unsigned int cell = 0; cell < indexed.cell_areas.size(); cell++)
+    {
+        const unsigned int found = other_grid.locator().locate(indexed.cell_centers[cell]);
+        ASSERT_NE(found, gg::no_index);
+        EXPECT_NEAR(indexed.cell_areas[cell], other.cell_areas[found], 1e-12);
+        EXPECT_NEAR(indexed.cell_centers[cell].x, other.cell_centers[found].x, 1e-12);
+        EXPECT_NEAR(indexed.cell_centers[cell].y, other.cell_centers[found].y, 1e-12);
+        EXPECT_EQ(indexed.side_offsets[cell + 1] - indexed.side_offsets[cell], other.side_offsets[found + 1] - other.side_offsets[found]);
+        EXPECT_EQ(cell_grid.locator().locate(indexed.cell_centers[cell]), cell);
+        const gg::CellGeometry &geometry = cell_grid.geometry(), &other_geometry = other_grid.geometry();
+        if (geometry.cell_records.empty()) continue;
+        const unsigned int record = geometry.cell_records[cell], other_record = other_geometry.cell_records[found];
+        EXPECT_NEAR(geometry.inverse_areas[record], other_geometry.inverse_areas[other_record], 1e-6);
+        for (unsigned int i = 0; i < 3; i++) { EXPECT_NEAR(geometry.gradient_matrices[record][i], other_geometry.gradient_matrices[other_record][i], 1e-6); }
+        std::vector<double> distances, other_distances;
+        for (unsigned int s = indexed.side_offsets[cell]; s < indexed.side_offsets[cell + 1]; s++) distances.push_back(geometry.distances[geometry.face_records[indexed.sides[s].face]]);
+        for (unsigned int s = other.side_offsets[found]; s < other.side_offsets[found + 1]; s++) other_distances.push_back(other_geometry.distances[other_geometry.face_records[other.sides[s].face]]);
+        std::sort(distances.begin(), distances.end());
+        std::sort(other_distances.begin(), other_distances.end());
+        ASSERT_EQ(distances.size(), other_distances.size());
+        for (unsigned int i = 0; i < distances.size(); i++) { EXPECT_NEAR(distances[i], other_distances[i], 1e-12); }
+    }
+}
+
+TEST (GridTest, UpdateTest)
+{
+    std::vector<gg::Boundary> moved_boundaries;
+    moved_boundaries.push_back(new gg::Line(gg::Vector(1.0, 1.0), gg::Vector(1.0, -1.0), false));
+    moved_boundaries.push_back(new gg::Line(gg::Vector(1.0, -1.0), gg::Vector(-1.0, -1.0), false));
+    moved_boundaries.push_back(new gg::Line(gg::Vector(-1.0, -1.0), gg::Vector(-1.0, 1.0), false));
+    moved_boundaries.push_back(new gg::Line(gg::Vector(-1.0, 1.0), gg::Vector(1.0, 1.0), false));
+    moved_boundaries.push_back(new gg::Circle(gg::Vector(0.33, 0.12), 0.2, false));
+    const gg::Vector centers[2] = { gg::Vector(0.3, 0.1), gg::Vector(0.33, 0.12) };
+    const auto outside = [&](gg::Vector coord) -> bool
+    {
+        return (coord - centers[0]).norm() > 0.4 && (coord - centers[1]).norm() > 0.4;
+    };
+    const gg::Generation generations[2] = { gg::Generation::flood_fill, gg::Generation::scanline };
+    for (unsigned int g = 0; g < 2; g++)
+    {
+        std::vector<gg::Boundary> boundaries;
+        boundaries.push_back(new gg::Line(gg::Vector(1.0, 1.0), gg::Vector(1.0, -1.0), false));
+        boundaries.push_back(new gg::Line(gg::Vector(1.0, -1.0), gg::Vector(-1.0, -1.0), false));
+        boundaries.push_back(new gg::Line(gg::Vector(-1.0, -1.0), gg::Vector(-1.0, 1.0), false));
+        boundaries.push_back(new gg::Line(gg::Vector(-1.0, 1.0), gg::Vector(1.0, 1.0), false));
+        boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.2, false));
+        gg::CellGridParameters cell_parameters;
+        cell_parameters.size = gg::Vector(0.05, 0.05);
+        cell_parameters.origin = gg::Vector(0.013, 0.017);
+        cell_parameters.threshold_area = 0.0;
+        cell_parameters.generation = generations[g];
+        cell_parameters.storage = gg::Storage::indexed;
+        cell_parameters.incremental = true;
+        cell_parameters.locator = true;
+        cell_parameters.geometry = true;
+
+        //Updated grid has the cells of the grid generated around the moved boundary
+        gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+        const gg::IndexedCellGrid old_indexed = cell_grid.indexed();
+        boundaries[4] = gg::Boundary(new gg::Circle(gg::Vector(0.33, 0.12), 0.2, false));
+        const gg::CellGridChanges changes = cell_grid.update(boundaries, { 4 });
+        cell_parameters.incremental = false;
+        gg::CellGrid<> moved_cell_grid(cell_parameters, moved_boundaries);
+        check_connectivity(cell_grid);
+        check_same_cells(cell_grid, moved_cell_grid);
+
+        //Changes translate old indexes, only cells around the boundary are modified
+        const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+        ASSERT_EQ(changes.cell_map.size(), old_indexed.cell_areas.size());
+        ASSERT_EQ(changes.face_map.size(), old_indexed.face_points.size());
+        ASSERT_EQ(changes.point_map.size(), old_indexed.point_coords.size());
+        EXPECT_GT(changes.modified_cells.size(), 0);
+        EXPECT_LT(changes.modified_cells.size() + changes.added_cells.size(), indexed.cell_areas.size() / 10);
+        EXPECT_EQ(old_indexed.cell_areas.size() - changes.removed_cells.size() + changes.added_cells.size(), indexed.cell_areas.size());
+        std::vector<bool> modified(indexed.cell_areas.size(), false);
+        for (unsigned int i = 0; i < changes.modified_cells.size(); i++) modified[changes.modified_cells[i]] = true;
+        for (unsigned int cell = 0; cell < changes.cell_map.size(); cell++)
+        {
+            if (changes.cell_map[cell] != gg::no_index && !modified[changes.cell_map[cell]]) { EXPECT_EQ(old_indexed.cell_areas[cell], indexed.cell_areas[changes.cell_map[cell]]); }
+        }
+
+        //Cells, faces and points outside of the region keep their indexes, except for the last ones that fill holes of removed elements
+        unsigned int moved_cells = 0;
+        for (unsigned int cell = 0; cell < changes.cell_map.size(); cell++)
+        {
+            if (!outside(old_indexed.cell_centers[cell])) continue;
+            const unsigned int new_cell = changes.cell_map[cell];
+            ASSERT_NE(new_cell, gg::no_index);
+            if (new_cell != cell) moved_cells++;
+            ASSERT_EQ(old_indexed.side_offsets[cell + 1] - old_indexed.side_offsets[cell], indexed.side_offsets[new_cell + 1] - indexed.side_offsets[new_cell]);
+            for (unsigned int s = 0; s < old_indexed.side_offsets[cell + 1] - old_indexed.side_offsets[cell]; s++)
+            {
+                const gg::IndexedSide &old_side = old_indexed.sides[old_indexed.side_offsets[cell] + s], &side = indexed.sides[indexed.side_offsets[new_cell] + s];
+                EXPECT_EQ(changes.point_map[old_side.point], side.point);
+                EXPECT_EQ(changes.face_map[old_side.face], side.face);
+                if (old_side.cell != gg::no_index && outside(old_indexed.cell_centers[old_side.cell])) { EXPECT_EQ(changes.cell_map[old_side.cell], side.cell); }
+                EXPECT_EQ(old_indexed.point_coords[old_side.point].x, indexed.point_coords[side.point].x);
+                EXPECT_EQ(old_indexed.point_coords[old_side.point].y, indexed.point_coords[side.point].y);
+            }
+        }
+        EXPECT_LE(moved_cells, changes.removed_cells.size());
+        unsigned int moved_points = 0, moved_faces = 0, removed_points = 0, removed_faces = 0;
+        for (unsigned int point = 0; point < changes.point_map.size(); point++)
+        {
+            if (changes.point_map[point] == gg::no_index) removed_points++;
+            else if (changes.point_map[point] != point) moved_points++;
+        }
+        for (unsigned int face = 0; face < changes.face_map.size(); face++)
+        {
+            if (changes.face_map[face] == gg::no_index) removed_faces++;
+            else if (changes.face_map[face] != face) moved_faces++;
+        }
+        EXPECT_LE(moved_points, removed_points);
+        EXPECT_LE(moved_faces, removed_faces);
+
+        //Moving the boundary back gives the original cells
+        cell_parameters.incremental = true;
+        gg::CellGrid<> original_grid(cell_parameters, boundaries);
+        boundaries[4] = gg::Boundary(new gg::Circle(gg::Vector(0.3, 0.1), 0.2, false));
+        original_grid.update(boundaries, { 4 });
+        cell_grid.update(boundaries, { 4 });
+        check_connectivity(cell_grid);
+        check_same_cells(cell_grid, original_grid);
+    }
+
+    //Objects outside of the region keep their pointers, sides of neighbors lead to each other
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, 1.0), gg::Vector(1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, -1.0), gg::Vector(-1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, -1.0), gg::Vector(-1.0, 1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, 1.0), gg::Vector(1.0, 1.0), false));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.2, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.05);
+    cell_parameters.origin = gg::Vector(0.013, 0.017);
+    cell_parameters.threshold_area = 0.0;
+    cell_parameters.storage = gg::Storage::objects;
+    cell_parameters.incremental = true;
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+    std::vector<gg::Cell<>*> kept_cells;
+    std::vector<std::vector<gg::Cell<>::Side>> kept_sides;
+    for (std::set<gg::Cell<>*>::const_iterator cell = cell_grid.cells().begin(); cell != cell_grid.cells().end(); cell++)
+    {
+        if (!outside((*cell)->center())) continue;
+        kept_cells.push_back(*cell);
+        kept_sides.push_back((*cell)->sides());
+    }
+    boundaries[4] = gg::Boundary(new gg::Circle(gg::Vector(0.33, 0.12), 0.2, false));
+    cell_grid.update(boundaries, { 4 });
+    cell_parameters.incremental = false;
+    gg::CellGrid<> moved_cell_grid(cell_parameters, moved_boundaries);
+    EXPECT_EQ(cell_grid.cells().size(), moved_cell_grid.cells().size());
+    EXPECT_EQ(cell_grid.faces().size(), moved_cell_grid.faces().size());
+    EXPECT_EQ(cell_grid.points().size(), moved_cell_grid.points().size());
+    for (unsigned int i = 0; i < kept_cells.size(); i++)
+    {
+        ASSERT_NE(cell_grid.cells().find(kept_cells[i]), cell_grid.cells().end());
+        const std::vector<gg::Cell<>::Side> &sides = kept_cells[i]->sides();
+        ASSERT_EQ(sides.size(), kept_sides[i].size());
+        for (unsigned int s = 0; s < sides.size(); s++)
+        {
+            EXPECT_EQ(sides[s].point, kept_sides[i][s].point);
+            EXPECT_EQ(sides[s].face, kept_sides[i][s].face);
+            if (kept_sides[i][s].cell != nullptr && outside(kept_sides[i][s].cell->center())) { EXPECT_EQ(sides[s].cell, kept_sides[i][s].cell); }
+        }
+    }
+    double area = 0.0, moved_area = 0.0;
+    for (std::set<gg::Cell<>*>::const_iterator cell = cell_grid.cells().begin(); cell != cell_grid.cells().end(); cell++)
+    {
+        area += (*cell)->area();
+        for (unsigned int s = 0; s < (*cell)->sides().size(); s++)
+        {
+            const gg::Cell<>::Side &side = (*cell)->sides()[s];
+            EXPECT_NE(cell_grid.faces().find(side.face), cell_grid.faces().end());
+            EXPECT_NE(cell_grid.points().find(side.point), cell_grid.points().end());
+            if (side.cell == nullptr) continue;
+            ASSERT_NE(cell_grid.cells().find(side.cell), cell_grid.cells().end());
+            bool back = false;
+            for (unsigned int t = 0; t < side.cell->sides().size(); t++) back = back || (side.cell->sides()[t].face == side.face && side.cell->sides()[t].cell == *cell);
+            EXPECT_TRUE(back);
+        }
+    }
+    for (std::set<gg::Cell<>*>::const_iterator cell = moved_cell_grid.cells().begin(); cell != moved_cell_grid.cells().end(); cell++) moved_area += (*cell)->area();
+    EXPECT_NEAR(area, moved_area, 1e-9);
+}
+
+TEST (GridTest, StreamTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, 1.0), gg::Vector(1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, -1.0), gg::Vector(-1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, -1.0), gg::Vector(-1.0, 1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, 1.0), gg::Vector(1.0, 1.0), false));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.4, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.05);
+    cell_parameters.origin = gg::Vector(-0.513, -0.517);
+    cell_parameters.inclination = 0.2;
+    cell_parameters.storage = gg::Storage::indexed;
+    const gg::GridType types[3] = { gg::GridType::square, gg::GridType::triangular, gg::GridType::hexagonal };
+    const gg::Generation generations[2] = { gg::Generation::flood_fill, gg::Generation::scanline };
+    for (unsigned int t = 0; t < 3; t++)
+    {
+        for (unsigned int g = 0; g < 2; g++)
+        {
+            cell_parameters.typ = types[t];
+            cell_parameters.generation = generations[g];
+            gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+            const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+            gg::IndexedCellSink sink;
+            gg::CellGrid<>::stream(cell_parameters, boundaries, sink);
+            const gg::IndexedCellGrid &streamed = sink.grid();
+            ASSERT_EQ(streamed.point_coords.size(), indexed.point_coords.size());
+            ASSERT_EQ(streamed.face_points.size(), indexed.face_points.size());
+            ASSERT_EQ(streamed.cell_centers.size(), indexed.cell_centers.size());
+            EXPECT_EQ(streamed.face_points, indexed.face_points);
+            EXPECT_EQ(streamed.face_lengths, indexed.face_lengths);
+            EXPECT_EQ(streamed.cell_areas, indexed.cell_areas);
+            EXPECT_EQ(streamed.cell_boundaries, indexed.cell_boundaries);
+            EXPECT_EQ(streamed.side_offsets, indexed.side_offsets);
+            for (unsigned int point = 0; point < indexed.point_coords.size(); point++)
+            {
+                EXPECT_EQ(streamed.point_coords[point].x, indexed.point_coords[point].x);
+                EXPECT_EQ(streamed.point_coords[point].y, indexed.point_coords[point].y);
+            }
+            for (unsigned int s = 0; s < indexed.sides.size(); s++)
+            {
+                EXPECT_EQ(streamed.sides[s].point, indexed.sides[s].point);
+                EXPECT_EQ(streamed.sides[s].face, indexed.sides[s].face);
+                EXPECT_EQ(streamed.sides[s].cell, indexed.sides[s].cell);
+                EXPECT_EQ(streamed.sides[s].inwards, indexed.sides[s].inwards);
+            }
+        }
+    }
+
+    //Scanline search is interleaved with emission, so temporary memory is proportional to one column and not to the whole grid
+    cell_parameters.typ = gg::GridType::square;
+    cell_parameters.generation = gg::Generation::scanline;
+    cell_parameters.size = gg::Vector(0.02, 0.02);
+    gg::GridStatistics generated, streamed;
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries, generated);
+    gg::IndexedCellSink sink;
+    gg::CellGrid<>::stream(cell_parameters, boundaries, sink, streamed);
+    EXPECT_EQ(sink.grid().cell_areas, cell_grid.indexed().cell_areas);
+    EXPECT_GT(streamed.peak_memory(), 0u);
+    EXPECT_LT(10 * streamed.peak_memory(), generated.peak_memory());
+}
+
+TEST (GridTest, LatticeTest)
+{
+    gg::Parameters parameters;
+    parameters.size = gg::Vector(0.3, 0.2);
+    parameters.origin = gg::Vector(0.1, -0.2);
+    parameters.inclination = 0.4;
+    const gg::GridType types[3] = { gg::GridType::triangular, gg::GridType::square, gg::GridType::hexagonal };
+    for (unsigned int t = 0; t < 3; t++)
+    {
+        parameters.typ = types[t];
+        const gg::Lattice lattice(parameters);
+        EXPECT_EQ(lattice.shape(), gg::get_shape(parameters));
+        EXPECT_EQ(lattice.area(), gg::get_area(parameters));
+        for (int yi = -3; yi <= 3; yi++)
+        {
+            for (unsigned int layer = 0; layer < ((parameters.typ == gg::GridType::triangular) ? 2u : 1u); layer++)
+            {
+                gg::Position first;
+                first.xi = -4; first.yi = yi; first.upside_down = (layer == 1);
+                std::vector<gg::Vector> centers(9), points(9 * lattice.shape());
+                lattice.centers(first, 9, &centers[0]);
+                lattice.points(first, 9, &points[0]);
+                for (unsigned int i = 0; i < 9; i++)
+                {
+                    gg::Position position = first;
+                    position.xi += (int)i;
+                    const gg::Vector center = lattice.center(position);
+                    const std::array<gg::Vector, 6> element_points = lattice.points(position);
+                    EXPECT_TRUE(centers[i].x == center.x && centers[i].y == center.y);
+                    gg::Vector sum(0.0, 0.0);
+                    for (unsigned int p = 0; p < lattice.shape(); p++)
+                    {
+                        EXPECT_TRUE(points[i * lattice.shape() + p].x == element_points[p].x && points[i * lattice.shape() + p].y == element_points[p].y);
+                        sum = sum + element_points[p];
+                    }
+                    EXPECT_NEAR((sum / lattice.shape() - center).norm(), 0.0, 1e-12);
+                    EXPECT_NEAR((lattice.transform(lattice.lattice_coord(center)) - center).norm(), 0.0, 1e-12);
+
+                    //Elements tile the plane, their area is the lattice area and neighbors share points of faces
+                    double area = 0.0;
+                    for (unsigned int p = 0; p < lattice.shape(); p++)
+                    {
+                        const unsigned int next = (p + 1) % lattice.shape();
+                        area += 0.5 * (element_points[p].x * element_points[next].y - element_points[next].x * element_points[p].y);
+                        const gg::FacePosition neighbor = gg::get_face_neighbor(parameters, { position, p });
+                        const std::array<gg::Vector, 6> neighbor_points = lattice.points(neighbor.position);
+                        EXPECT_NEAR((neighbor_points[neighbor.face] - element_points[next]).norm(), 0.0, 1e-12);
+                        EXPECT_NEAR((neighbor_points[(neighbor.face + 1) % lattice.shape()] - element_points[p]).norm(), 0.0, 1e-12);
+                    }
+                    EXPECT_NEAR(area, lattice.area(), 1e-12);
+                }
+            }
+        }
+    }
+}
+
+template <class L> void check_lattice_traits()
+{
+    gg::Parameters parameters;
+    parameters.typ = L::typ;
+    parameters.inclination = 0.3;
+    const gg::Lattice lattice(parameters);
+    for (int xi = -2; xi <= 2; xi++)
+    {
+        for (int yi = -2; yi <= 2; yi++)
+        {
+            gg::Position position;
+            position.xi = xi; position.yi = yi; position.upside_down = (L::typ == gg::GridType::triangular) && ((xi + yi) % 2 != 0);
+            for (unsigned int i = 0; i < L::shape; i++)
+            {
+                const gg::FacePosition neighbor = L::face_neighbor({ position, i });
+                const gg::FacePosition back = L::face_neighbor(neighbor);
+                EXPECT_TRUE(back.position.xi == xi && back.position.yi == yi && back.position.upside_down == position.upside_down && back.face == i);
+
+                //Neighbors of the point describe the same point, in topology and in geometry
+                const gg::PointPosition canonical = L::canonical_point({ position, i });
+                const std::array<gg::PointPosition, 6> neighbors = L::point_neighbors({ position, i });
+                const gg::Vector coord = lattice.points(position)[i];
+                for (unsigned int n = 0; n < 6 && neighbors[n].point < L::shape; n++)
+                {
+                    const gg::PointPosition neighbor_canonical = L::canonical_point(neighbors[n]);
+                    EXPECT_TRUE(!(neighbor_canonical.position < canonical.position) && !(canonical.position < neighbor_canonical.position) && neighbor_canonical.point == canonical.point);
+                    EXPECT_NEAR((lattice.points(neighbors[n].position)[neighbors[n].point] - coord).norm(), 0.0, 1e-12);
+                }
+            }
+        }
+    }
+}
+
+TEST (GridTest, LatticeTraitsTest)
+{
+    check_lattice_traits<gg::LatticeTraits<gg::GridType::triangular>>();
+    check_lattice_traits<gg::LatticeTraits<gg::GridType::square>>();
+    check_lattice_traits<gg::LatticeTraits<gg::GridType::hexagonal>>();
+}
+
+TEST (GridTest, SharedPointsTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Circle(gg::Vector(0.0, 0.0), 0.5, true));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.2, 0.1), 0.15, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.04);
+    cell_parameters.inclination = 0.3;
+    cell_parameters.storage = gg::Storage::indexed;
+    const gg::Generation generations[2] = { gg::Generation::flood_fill, gg::Generation::scanline };
+    for (unsigned int g = 0; g < 2; g++)
+    {
+        //Points and faces shared by several cells are created once
+        cell_parameters.generation = generations[g];
+        gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+        const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+        std::vector<std::pair<double, double>> coords;
+        for (unsigned int point = 0; point < indexed.point_coords.size(); point++) coords.push_back({ indexed.point_coords[point].x, indexed.point_coords[point].y });
+        std::sort(coords.begin(), coords.end());
+        EXPECT_EQ(std::unique(coords.begin(), coords.end()) - coords.begin(), (std::ptrdiff_t)coords.size());
+        std::vector<unsigned int> uses(indexed.face_points.size(), 0);
+        for (unsigned int s = 0; s < indexed.sides.size(); s++) uses[indexed.sides[s].face]++;
+        for (unsigned int face = 0; face < uses.size(); face++)
+        {
+            EXPECT_GE(uses[face], 1);
+            EXPECT_LE(uses[face], 2);
+        }
+    }
+}
+
+TEST (GridTest, LocatorTest)
+{
+    gg::Parameters parameters;
+    parameters.size = gg::Vector(0.3, 0.2);
+    parameters.origin = gg::Vector(0.1, -0.2);
+    parameters.inclination = 0.4;
+    const gg::GridType types[3] = { gg::GridType::triangular, gg::GridType::square, gg::GridType::hexagonal };
+    for (unsigned int t = 0; t < 3; t++)
+    {
+        parameters.typ = types[t];
+        for (int xi = -3; xi <= 3; xi++)
+        {
+            for (int yi = -3; yi <= 3; yi++)
+            {
+                gg::Position position;
+                position.xi = xi; position.yi = yi; position.upside_down = (parameters.typ == gg::GridType::triangular) && ((xi + yi) % 2 != 0);
+                const gg::Position found = gg::get_position(parameters, gg::get_center(parameters, position));
+                EXPECT_TRUE(found.xi == xi && found.yi == yi && found.upside_down == position.upside_down);
+            }
+        }
+    }
+
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, 1.0), gg::Vector(1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, -1.0), gg::Vector(-1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, -1.0), gg::Vector(-1.0, 1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, 1.0), gg::Vector(1.0, 1.0), false));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.4, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.05);
+    cell_parameters.origin = gg::Vector(-0.513, -0.517);
+    cell_parameters.inclination = 0.2;
+    cell_parameters.storage = gg::Storage::indexed;
+    cell_parameters.locator = true;
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+    const gg::CellLocator &locator = cell_grid.locator();
+    const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+    for (unsigned int cell = 0; cell < indexed.cell_centers.size(); cell++) EXPECT_EQ(locator.locate(indexed.cell_centers[cell]), cell);
+    EXPECT_EQ(locator.locate(gg::Vector(0.3, 0.1)), gg::no_index);
+    EXPECT_EQ(locator.locate(gg::Vector(0.3, 0.49)), gg::no_index);
+    EXPECT_EQ(locator.locate(gg::Vector(2.0, 0.0)), gg::no_index);
+    std::vector<gg::Vector> coords;
+    for (unsigned int i = 0; i < 1000; i++) coords.push_back(gg::Vector(-1.1 + 0.0022 * i, 0.1 + 0.0007 * i));
+    std::vector<unsigned int> cells;
+    gg::ThreadPool pool(4);
+    for (unsigned int repetition = 0; repetition < 3; repetition++)
+    {
+        locator.locate(coords, cells, pool);
+        for (unsigned int i = 0; i < coords.size(); i++) EXPECT_EQ(cells[i], locator.locate(coords[i]));
+    }
+}
+
+TEST (GridTest, RefinementTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, 1.0), gg::Vector(1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, -1.0), gg::Vector(-1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, -1.0), gg::Vector(-1.0, 1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, 1.0), gg::Vector(1.0, 1.0), false));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.4, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.1, 0.1);
+    cell_parameters.origin = gg::Vector(-0.513, -0.517);
+    cell_parameters.threshold_area = 0.0;
+    cell_parameters.storage = gg::Storage::indexed;
+    gg::CellGrid<> coarse_grid(cell_parameters, boundaries);
+    cell_parameters.refinement = 2;
+    gg::CellGrid<> refined_grid(cell_parameters, boundaries);
+    cell_parameters.refinement = 0;
+    cell_parameters.size = gg::Vector(0.025, 0.025);
+    gg::CellGrid<> fine_grid(cell_parameters, boundaries);
+
+    const std::vector<double> &areas = refined_grid.indexed().cell_areas;
+    const double area = std::accumulate(areas.begin(), areas.end(), 0.0);
+    const std::vector<double> &coarse_areas = coarse_grid.indexed().cell_areas;
+    const double coarse_area = std::accumulate(coarse_areas.begin(), coarse_areas.end(), 0.0);
+    EXPECT_NEAR(area, 4.0 - M_PI * 0.4 * 0.4, 1e-3);
+    EXPECT_LT(fabs(area - (4.0 - M_PI * 0.4 * 0.4)), fabs(coarse_area - (4.0 - M_PI * 0.4 * 0.4)));
+    EXPECT_GT(areas.size(), coarse_grid.indexed().cell_areas.size());
+    EXPECT_LT(areas.size(), fine_grid.indexed().cell_areas.size() / 2);
+    const gg::CellConnectivity &connectivity = refined_grid.connectivity();
+    std::vector<unsigned int> face_count(connectivity.face_cells.size(), 0);
+    for (unsigned int i = 0; i < connectivity.cell_faces.size(); i++) face_count[connectivity.cell_faces[i]]++;
+    for (unsigned int face = 0; face < connectivity.face_cells.size(); face++)
+    {
+        ASSERT_NE(connectivity.face_cells[face][0], gg::no_index);
+        EXPECT_EQ(face_count[face], (connectivity.face_cells[face][1] == gg::no_index) ? 1 : 2);
+    }
+
+    cell_parameters.refinement = 2;
+    cell_parameters.typ = gg::GridType::triangular;
+    EXPECT_THROW(gg::CellGrid<>(cell_parameters, boundaries), std::runtime_error);
+}
+
+TEST (GridTest, OrderingTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, 1.0), gg::Vector(1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(1.0, -1.0), gg::Vector(-1.0, -1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, -1.0), gg::Vector(-1.0, 1.0), false));
+    boundaries.push_back(new gg::Line(gg::Vector(-1.0, 1.0), gg::Vector(1.0, 1.0), false));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.4, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.05);
+    cell_parameters.origin = gg::Vector(0.013, 0.017);
+    cell_parameters.threshold_area = 0.0;
+    cell_parameters.storage = gg::Storage::indexed;
+    cell_parameters.incremental = true;
+    cell_parameters.locator = true;
+    gg::CellGrid<> lattice_grid(cell_parameters, boundaries);
+    const gg::IndexedCellGrid &lattice_indexed = lattice_grid.indexed();
+    std::vector<double> lattice_areas = lattice_indexed.cell_areas;
+    std::sort(lattice_areas.begin(), lattice_areas.end());
+
+    const gg::Ordering orderings[3] = { gg::Ordering::morton, gg::Ordering::hilbert, gg::Ordering::cuthill_mckee };
+    for (unsigned int o = 0; o < 3; o++)
+    {
+        //Same cells under different indexes, connectivity and locator follow them
+        cell_parameters.ordering = orderings[o];
+        gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+        const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+        ASSERT_EQ(indexed.cell_areas.size(), lattice_indexed.cell_areas.size());
+        EXPECT_EQ(indexed.face_points.size(), lattice_indexed.face_points.size());
+        EXPECT_EQ(indexed.point_coords.size(), lattice_indexed.point_coords.size());
+        EXPECT_NE(indexed.cell_centers[0].x, lattice_indexed.cell_centers[0].x);
+        std::vector<double> areas = indexed.cell_areas;
+        std::sort(areas.begin(), areas.end());
+        EXPECT_EQ(areas, lattice_areas);
+        const gg::CellConnectivity &connectivity = cell_grid.connectivity();
+        for (unsigned int face = 0; face < connectivity.face_cells.size(); face++)
+        {
+            const std::array<unsigned int, 2> cells = connectivity.face_cells[face];
+            ASSERT_NE(cells[0], gg::no_index);
+            if (cells[1] == gg::no_index) continue;
+            const gg::Vector normal = indexed.face_normals[face], outwards = indexed.face_centers[face] - indexed.cell_centers[cells[0]];
+            EXPECT_GT(normal.dot(outwards), 0.0);
+        }
+        for (unsigned int cell = 0; cell < lattice_indexed.cell_centers.size(); cell += 7)
+        {
+            const gg::Vector center = lattice_indexed.cell_centers[cell];
+            const unsigned int found = cell_grid.locator().locate(center);
+            ASSERT_NE(found, gg::no_index);
+            EXPECT_EQ(indexed.cell_areas[found], lattice_indexed.cell_areas[cell]);
+        }
+        if (orderings[o] == gg::Ordering::cuthill_mckee) { EXPECT_LE(gg::get_bandwidth(indexed), gg::get_bandwidth(lattice_indexed)); }
+
+        //Update reports new indexes
+        const std::vector<double> old_areas = indexed.cell_areas;
+        boundaries[4] = gg::Boundary(new gg::Circle(gg::Vector(0.33, 0.12), 0.4, false));
+        const gg::CellGridChanges changes = cell_grid.update(boundaries, { 4 });
+        boundaries[4] = gg::Boundary(new gg::Circle(gg::Vector(0.3, 0.1), 0.4, false));
+        std::vector<bool> modified(indexed.cell_areas.size(), false);
+        for (unsigned int i = 0; i < changes.modified_cells.size(); i++) modified[changes.modified_cells[i]] = true;
+        for (unsigned int cell = 0; cell < changes.cell_map.size(); cell++)
+        {
+            if (changes.cell_map[cell] != gg::no_index && !modified[changes.cell_map[cell]]) { EXPECT_EQ(old_areas[cell], indexed.cell_areas[changes.cell_map[cell]]); }
+        }
+    }
+
+    //Refined grid
+    cell_parameters.incremental = false;
+    cell_parameters.locator = false;
+    cell_parameters.refinement = 2;
+    cell_parameters.ordering = gg::Ordering::lattice;
+    gg::CellGrid<> refined_grid(cell_parameters, boundaries);
+    cell_parameters.ordering = gg::Ordering::hilbert;
+    gg::CellGrid<> ordered_grid(cell_parameters, boundaries);
+    std::vector<double> refined_areas = refined_grid.indexed().cell_areas, ordered_areas = ordered_grid.indexed().cell_areas;
+    std::sort(refined_areas.begin(), refined_areas.end());
+    std::sort(ordered_areas.begin(), ordered_areas.end());
+    EXPECT_EQ(refined_areas, ordered_areas);
+    EXPECT_EQ(refined_grid.connectivity().cell_faces.size(), ordered_grid.connectivity().cell_faces.size());
+}
+
+TEST (GridTest, PartitionTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Circle(gg::Vector(0.0, 0.0), 1.0, true));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.3, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.05);
+    cell_parameters.origin = gg::Vector(0.013, 0.017);
+    cell_parameters.inclination = 0.2;
+    cell_parameters.storage = gg::Storage::indexed;
+    const gg::Generation generations[2] = { gg::Generation::flood_fill, gg::Generation::scanline };
+    for (unsigned int g = 0; g < 2; g++)
+    {
+        cell_parameters.generation = generations[g];
+        cell_parameters.parts = 1;
+        cell_parameters.part = 0;
+        gg::GridStatistics whole_statistics;
+        gg::CellGrid<> whole_grid(cell_parameters, boundaries, whole_statistics);
+        const gg::IndexedCellGrid &whole = whole_grid.indexed();
+        const unsigned int cells = (unsigned int)whole.cell_areas.size();
+        EXPECT_TRUE(whole_grid.partition().global_cells.empty());
+        cell_parameters.parts = 5;
+        cell_parameters.ghost_layers = 2;
+        std::vector<gg::CellGrid<>> grids;
+        for (unsigned int part = 0; part < cell_parameters.parts; part++)
+        {
+            //Parts search only lattice cells around them
+            cell_parameters.part = part;
+            gg::GridStatistics part_statistics;
+            grids.push_back(gg::CellGrid<>(cell_parameters, boundaries, part_statistics));
+            EXPECT_LT(2 * part_statistics.allocations(), whole_statistics.allocations());
+        }
+
+        //Owned cells stitch back to the whole grid, with the same geometry and neighbors
+        std::vector<unsigned int> owners(cells, gg::no_index);
+        for (unsigned int part = 0; part < cell_parameters.parts; part++)
+        {
+            const gg::IndexedCellGrid &indexed = grids[part].indexed();
+            const gg::CellPartition &partition = grids[part].partition();
+            ASSERT_EQ(partition.global_cells.size(), indexed.cell_areas.size());
+            EXPECT_GT(partition.owned, cells / cell_parameters.parts - 1);
+            EXPECT_LT(partition.owned, cells / cell_parameters.parts + 2);
+            EXPECT_GT(partition.global_cells.size(), partition.owned);
+            for (unsigned int cell = 0; cell < indexed.cell_areas.size(); cell++)
+            {
+                const unsigned int global = partition.global_cells[cell];
+                EXPECT_EQ(indexed.cell_areas[cell], whole.cell_areas[global]);
+                EXPECT_EQ(partition.cell_parts[cell] == part, cell < partition.owned);
+                if (cell >= partition.owned) continue;
+                EXPECT_EQ(owners[global], gg::no_index);
+                owners[global] = part;
+                ASSERT_EQ(indexed.side_offsets[cell + 1] - indexed.side_offsets[cell], whole.side_offsets[global + 1] - whole.side_offsets[global]);
+                for (unsigned int s = 0; s < indexed.side_offsets[cell + 1] - indexed.side_offsets[cell]; s++)
+                {
+                    const gg::IndexedSide &side = indexed.sides[indexed.side_offsets[cell] + s], &whole_side = whole.sides[whole.side_offsets[global] + s];
+                    EXPECT_EQ((side.cell == gg::no_index) ? gg::no_index : partition.global_cells[side.cell], whole_side.cell);
+                    EXPECT_EQ(indexed.face_centers[side.face].x, whole.face_centers[whole_side.face].x);
+                    EXPECT_EQ(indexed.point_coords[side.point].y, whole.point_coords[whole_side.point].y);
+                }
+            }
+        }
+        for (unsigned int cell = 0; cell < cells; cell++) EXPECT_NE(owners[cell], gg::no_index);
+
+        //Cells sent by one part are the cells received by the other
+        for (unsigned int part = 0; part < cell_parameters.parts; part++)
+        {
+            for (unsigned int other = 0; other < cell_parameters.parts; other++)
+            {
+                const gg::CellPartition &sender = grids[part].partition(), &receiver = grids[other].partition();
+                std::vector<unsigned int> sent, received;
+                for (unsigned int i = sender.send_offsets[other]; i < sender.send_offsets[other + 1]; i++) sent.push_back(sender.global_cells[sender.send_cells[i]]);
+                for (unsigned int i = receiver.receive_offsets[part]; i < receiver.receive_offsets[part + 1]; i++) received.push_back(receiver.global_cells[receiver.receive_cells[i]]);
+                EXPECT_EQ(sent, received);
+            }
+        }
+    }
+
+    cell_parameters.part = 5;
+    EXPECT_THROW(gg::CellGrid<>(cell_parameters, boundaries), std::runtime_error);
+}
+
+TEST (GridTest, GeometryTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Circle(gg::Vector(0.0, 0.0), 1.0, true));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.3, false));
+    gg::CellGridParameters cell_parameters;
+    cell_parameters.size = gg::Vector(0.05, 0.05);
+    cell_parameters.origin = gg::Vector(0.013, 0.017);
+    cell_parameters.inclination = 0.2;
+    cell_parameters.storage = gg::Storage::indexed;
+    cell_parameters.geometry = true;
+    gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+    const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+    const gg::CellConnectivity &connectivity = cell_grid.connectivity();
+    const gg::CellGeometry &geometry = cell_grid.geometry();
+    ASSERT_EQ(geometry.face_records.size(), indexed.face_points.size());
+    ASSERT_EQ(geometry.cell_records.size(), indexed.cell_centers.size());
+    EXPECT_LT(geometry.unit_normals.size(), indexed.face_points.size() / 4);
+    EXPECT_LT(geometry.inverse_areas.size(), indexed.cell_centers.size() / 4);
+
+    //Factors of faces agree with their geometry
+    const double epsilon = 1e-9;
+    for (unsigned int face = 0; face < indexed.face_points.size(); face++)
+    {
+        const unsigned int record = geometry.face_records[face];
+        ASSERT_LT(record, geometry.unit_normals.size());
+        const std::array<unsigned int, 2> cells = connectivity.face_cells[face];
+        const gg::Vector owner = indexed.cell_centers[cells[0]], center = indexed.face_centers[face];
+        const gg::Vector normal = geometry.unit_normals[record] * indexed.face_lengths[face];
+        EXPECT_NEAR(fabs(normal.dot(indexed.face_normals[face])), indexed.face_lengths[face] * indexed.face_lengths[face], epsilon);
+        EXPECT_GT(normal.dot(center - owner), 0.0);
+        const gg::Vector delta = ((cells[1] == gg::no_index) ? center : indexed.cell_centers[cells[1]]) - owner;
+        EXPECT_NEAR(geometry.deltas[record].x, delta.x, epsilon);
+        EXPECT_NEAR(geometry.deltas[record].y, delta.y, epsilon);
+        EXPECT_NEAR(geometry.distances[record], delta.norm(), epsilon);
+        const gg::Vector split = geometry.deltas[record] * geometry.diffusion_coefficients[record] + geometry.non_orthogonal_corrections[record];
+        EXPECT_NEAR(split.x, normal.x, epsilon);
+        EXPECT_NEAR(split.y, normal.y, epsilon);
+        EXPECT_NEAR(geometry.skewness_corrections[record].dot(normal), 0.0, epsilon);
+        EXPECT_GE(geometry.weights[record], 0.0);
+        EXPECT_LE(geometry.weights[record], 1.0);
+    }
+
+    //Least squares gradient is exact for linear fields
+    const auto field = [](gg::Vector coord) -> double { return 2.0 * coord.x + 3.0 * coord.y; };
+    for (unsigned int cell = 0; cell < indexed.cell_centers.size(); cell++)
+    {
+        const unsigned int record = geometry.cell_records[cell];
+        ASSERT_LT(record, geometry.inverse_areas.size());
+        EXPECT_NEAR(geometry.inverse_areas[record] * indexed.cell_areas[cell], 1.0, epsilon);
+        gg::Vector sum(0.0, 0.0);
+        for (unsigned int s = indexed.side_offsets[cell]; s < indexed.side_offsets[cell + 1]; s++)
+        {
+            const gg::IndexedSide &side = indexed.sides[s];
+            const gg::Vector coord = (side.cell == gg::no_index) ? indexed.face_centers[side.face] : indexed.cell_centers[side.cell];
+            sum = sum + (coord - indexed.cell_centers[cell]) * (field(coord) - field(indexed.cell_centers[cell]));
+        }
+        const std::array<double, 3> &matrix = geometry.gradient_matrices[record];
+        EXPECT_NEAR(matrix[0] * sum.x + matrix[1] * sum.y, 2.0, 1e-6);
+        EXPECT_NEAR(matrix[1] * sum.x + matrix[2] * sum.y, 3.0, 1e-6);
+    }
+}
+
+TEST (GridTest, LatticeViewTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Circle(gg::Vector(0.0, 0.0), 1.0, true));
+    boundaries.push_back(new gg::Circle(gg::Vector(0.3, 0.1), 0.3, false));
+    const gg::GridType types[3] = { gg::GridType::triangular, gg::GridType::square, gg::GridType::hexagonal };
+    for (unsigned int t = 0; t < 3; t++)
+    {
+        gg::CellGridParameters cell_parameters;
+        cell_parameters.typ = types[t];
+        cell_parameters.size = gg::Vector(0.01, 0.01);
+        cell_parameters.origin = gg::Vector(0.0013, 0.0017);
+        cell_parameters.inclination = 0.2;
+        cell_parameters.generation = gg::Generation::scanline;
+        cell_parameters.storage = gg::Storage::indexed;
+        gg::CellGrid<> cell_grid(cell_parameters, boundaries);
+        const gg::IndexedCellGrid &indexed = cell_grid.indexed();
+        const gg::LatticeView<> view(cell_parameters, boundaries);
+        const unsigned int shape = gg::Lattice(cell_parameters).shape();
+
+        //Same cells as in the grid, only cut cells are stored
+        ASSERT_EQ(view.size(), indexed.cell_areas.size());
+        EXPECT_LT(view.stored(), view.size() / 10);
+        EXPECT_LT(view.memory(), view.size() * sizeof(gg::ViewCell) / 10);
+        for (unsigned int cell = 0; cell < indexed.cell_areas.size(); cell++)
+        {
+            const unsigned int found = view.find(gg::get_position(cell_parameters, indexed.cell_centers[cell]));
+            ASSERT_NE(found, gg::no_index);
+            const gg::ViewCell view_cell = view.cell(found);
+            EXPECT_NEAR(view_cell.area, indexed.cell_areas[cell], 1e-12);
+            EXPECT_NEAR(view_cell.center.x, indexed.cell_centers[cell].x, 1e-12);
+            EXPECT_NEAR(view_cell.center.y, indexed.cell_centers[cell].y, 1e-12);
+            EXPECT_EQ(view_cell.point_count, indexed.side_offsets[cell + 1] - indexed.side_offsets[cell]);
+        }
+
+        //Iteration, random access and neighbors agree
+        unsigned int count = 0;
+        for (gg::LatticeView<>::Iterator cell = view.begin(); cell != view.end(); ++cell, count++)
+        {
+            const gg::ViewCell view_cell = *cell;
+            EXPECT_EQ(cell.index(), count);
+            EXPECT_EQ(view.find(view_cell.position), count);
+            for (unsigned int face = 0; face < shape; face++)
+            {
+                const unsigned int neighbor = view.neighbor(count, face);
+                if (neighbor != gg::no_index) { EXPECT_EQ(view.neighbor(neighbor, gg::get_face_neighbor(cell_parameters, { view_cell.position, face }).face), count); }
+            }
+
+            //Faces of neighbors are the same, faces without neighbors lie on boundaries or on faces of removed cells
+            unsigned int boundary_faces = 0;
+            for (unsigned int side = 0; side < view_cell.point_count; side++)
+            {
+                const gg::ViewFace face = view.face(count, side);
+                EXPECT_EQ(face.owner, count);
+                EXPECT_EQ(face.points[0].x, view_cell.points[side].x);
+                EXPECT_EQ(face.points[0].y, view_cell.points[side].y);
+                if (face.face == gg::no_index) { boundary_faces++; EXPECT_NE(face.boundary, gg::no_index); EXPECT_EQ(face.neighbor, gg::no_index); continue; }
+                EXPECT_EQ(face.neighbor, view.neighbor(count, face.face));
+                if (face.neighbor == gg::no_index) continue;
+                const gg::ViewCell neighbor_cell = view.cell(face.neighbor);
+                const unsigned int neighbor_face = gg::get_face_neighbor(cell_parameters, { view_cell.position, face.face }).face;
+                const unsigned int neighbor_side = (unsigned int)(std::find(neighbor_cell.faces.begin(), neighbor_cell.faces.begin() + neighbor_cell.point_count, neighbor_face) - neighbor_cell.faces.begin());
+                ASSERT_LT(neighbor_side, neighbor_cell.point_count);
+                const gg::ViewFace opposite = view.face(face.neighbor, neighbor_side);
+                EXPECT_EQ(opposite.neighbor, count);
+                EXPECT_NEAR((opposite.points[0] - face.points[1]).norm(), 0.0, 1e-12);
+                EXPECT_NEAR((opposite.points[1] - face.points[0]).norm(), 0.0, 1e-12);
+            }
+            if (view_cell.boundary == gg::no_index) { EXPECT_EQ(boundary_faces, 0); }
+            else { EXPECT_GT(boundary_faces, 0); }
+        }
+        EXPECT_EQ(count, view.size());
+        EXPECT_THROW(view.cell(view.size()), std::runtime_error);
+        EXPECT_THROW(view.face(0, view.cell(0).point_count), std::runtime_error);
+    }
+}
+
+//Line that is never hit, the batch must call its intersection() instead of the line kernel
+class HiddenLine : public gg::Line
+{
+public:
+    HiddenLine(gg::Vector a, gg::Vector b) : gg::Line(a, b, false) {}
+    virtual gg::Intersection intersection(gg::Vector, gg::Vector) const { return gg::Intersection(); }
+};
+
+TEST (GridTest, FigureBatchTest)
+{
+    std::vector<gg::Boundary> boundaries;
+    for (unsigned int i = 0; i < 7; i++) boundaries.push_back(new gg::Line(gg::Vector(0.1 * i, -1.0), gg::Vector(0.1 * i + 0.05, 1.0), false));
+    for (unsigned int i = 0; i < 5; i++) boundaries.push_back(new gg::Circle(gg::Vector(0.13 * i, 0.0), 0.2, true));
+    for (unsigned int i = 0; i < 3; i++) boundaries.push_back(new gg::Arc(gg::Vector(0.17 * i, 0.0), 0.3, true, -M_PI / 2, M_PI));
+    gg::FigureBatch batch, shifted_batch;
+    const unsigned int shift = 0x80000000u;
+    for (unsigned int i = 0; i < boundaries.size(); i++)
+    {
+        batch.push_back(boundaries[i].figure(), i);
+        shifted_batch.push_back(boundaries[i].figure(), shift + i);
+    }
+
+    const gg::InstructionSet instruction_set = gg::FigureBatch::instruction_set();
+    const gg::InstructionSet instruction_sets[3] = { gg::InstructionSet::scalar, gg::InstructionSet::sse2, gg::InstructionSet::avx2 };
+    std::vector<gg::BatchHit> scalar_hits;
+    for (unsigned int s = 0; s < 3; s++)
+    {
+        if (!gg::FigureBatch::instruction_set(instruction_sets[s])) continue;
+        for (unsigned int k = 0; k < 50; k++)
+        {
+            const gg::Vector a(-0.5 + 0.02 * k, 0.01 * k - 0.25), b(1.0, 0.1);
+            unsigned int nearest = (unsigned int)-1;
+            gg::Intersection intersection;
+            for (unsigned int i = 0; i < boundaries.size(); i++)
+            {
+                const gg::Intersection new_intersection = boundaries[i].figure()->intersection(a, b);
+                if (new_intersection.valid && (!intersection.valid || (new_intersection.coord-a).squared_norm() < (intersection.coord-a).squared_norm()))
+                {
+                    intersection = new_intersection;
+                    nearest = i;
+                }
+            }
+            gg::BatchHit hit, shifted_hit;
+            batch.nearest(a, b, hit);
+            shifted_batch.nearest(a, b, shifted_hit);
+
+            //Indexes above 2^31 are not mistaken for negative numbers
+            EXPECT_EQ(shifted_hit.figure, hit.figure);
+            EXPECT_EQ(shifted_hit.index, (hit.figure == nullptr) ? hit.index : (shift + hit.index));
+
+            //Hits agree with Figure::intersection() and are exactly the same with every instruction set
+            EXPECT_EQ(hit.index, nearest);
+            if (nearest != (unsigned int)-1)
+            {
+                EXPECT_EQ(hit.figure, boundaries[nearest].figure());
+                EXPECT_NEAR((a + (b - a) * hit.t - intersection.coord).norm(), 0.0, 1e-12);
+            }
+            if (s == 0) scalar_hits.push_back(hit);
+            else
+            {
+                EXPECT_EQ(hit.t, scalar_hits[k].t);
+                EXPECT_EQ(hit.index, scalar_hits[k].index);
+                EXPECT_EQ(hit.figure, scalar_hits[k].figure);
+            }
+        }
+    }
+    gg::FigureBatch::instruction_set(instruction_set);
+
+    //Subclasses of built-in figures keep their own intersection()
+    const HiddenLine hidden(gg::Vector(0.0, -1.0), gg::Vector(0.0, 1.0));
+    gg::FigureBatch hidden_batch;
+    hidden_batch.push_back(&hidden, 0);
+    gg::BatchHit hidden_hit;
+    hidden_batch.nearest(gg::Vector(-1.0, 0.0), gg::Vector(1.0, 0.0), hidden_hit);
+    EXPECT_EQ(hidden_hit.figure, nullptr);
+
+    //Ties between indexes on both sides of 2^31 are won by the lower index
+    const gg::Line line(gg::Vector(0.0, -1.0), gg::Vector(0.0, 1.0), false);
+    gg::FigureBatch tie_batch;
+    const unsigned int tie_indexes[4] = { shift + 2, shift + 1, shift, shift - 1 };
+    for (unsigned int i = 0; i < 4; i++) tie_batch.push_back(line, tie_indexes[i]);
+    for (unsigned int s = 0; s < 3; s++)
+    {
+        if (!gg::FigureBatch::instruction_set(instruction_sets[s])) continue;
+        gg::BatchHit hit;
+        tie_batch.nearest(gg::Vector(-1.0, 0.0), gg::Vector(1.0, 0.0), hit);
+        EXPECT_EQ(hit.index, shift - 1);
+    }
+    gg::FigureBatch::instruction_set(instruction_set);
+}
+
+//Figure that consists of parallel vertical lines and relies on the default Figure::intersections()
+class CombFigure : public gg::Figure
+{
+public:
+    std::vector<double> teeth;
+    virtual gg::Intersection intersection(gg::Vector a, gg::Vector b) const
+    {
+        gg::Intersection nearest;
+        double nearest_t = 2.0;
+        for (std::vector<double>::const_iterator x = teeth.begin(); x != teeth.end(); x++)
+        {
+            if (a.x == b.x) continue;
+            const double t = (*x - a.x) / (b.x - a.x);
+            if (t < 0.0 || t > 1.0 || t >= nearest_t) continue;
+            nearest_t = t;
+            nearest = gg::Intersection(a + (b - a) * t, gg::Vector(0.0, 1.0), gg::Vector(1.0, 0.0));
+        }
+        return nearest;
+    }
+};
+
+TEST (GridTest, CustomFigureTest)
+{
+    //Default intersections() finds every crossing in order, in both directions
+    CombFigure comb;
+    comb.teeth = { 0.7, 0.1, 0.5, 0.3 };
+    std::vector<gg::Intersection> intersections;
+    comb.intersections(gg::Vector(0.0, 0.0), gg::Vector(1.0, 0.5), intersections);
+    ASSERT_EQ(intersections.size(), 4);
+    for (unsigned int i = 0; i < 4; i++) EXPECT_NEAR(intersections[i].coord.x, 0.1 + 0.2 * i, 1e-12);
+    intersections.clear();
+    comb.intersections(gg::Vector(1.0, 0.5), gg::Vector(0.0, 0.0), intersections);
+    ASSERT_EQ(intersections.size(), 4);
+    for (unsigned int i = 0; i < 4; i++) EXPECT_NEAR(intersections[i].coord.x, 0.7 - 0.2 * i, 1e-12);
+
+    //Crossings that are very close to each other are not merged
+    comb.teeth = { 0.5, 0.5 + 1e-6 };
+    intersections.clear();
+    comb.intersections(gg::Vector(0.0, 0.0), gg::Vector(1.0, 0.0), intersections);
+    EXPECT_EQ(intersections.size(), 2);
+}
+
+TEST (GridTest, BoundaryIndexTest)
+{
+    //Arc bounds contain only the angular span of the arc
+    const gg::Box quarter = gg::Arc(gg::Vector(1.0, 1.0), 2.0, true, 0.0, M_PI / 2).bounds();
+    EXPECT_NEAR(quarter.min.x, 1.0, 1e-12); EXPECT_NEAR(quarter.min.y, 1.0, 1e-12);
+    EXPECT_NEAR(quarter.max.x, 3.0, 1e-12); EXPECT_NEAR(quarter.max.y, 3.0, 1e-12);
+    const gg::Box wrapped = gg::Arc(gg::Vector(0.0, 0.0), 1.0, true, 3 * M_PI / 4, M_PI / 2).bounds();
+    EXPECT_NEAR(wrapped.min.x, -1.0, 1e-12); EXPECT_NEAR(wrapped.max.x, -sqrt(0.5), 1e-12);
+    EXPECT_NEAR(wrapped.min.y, -sqrt(0.5), 1e-12); EXPECT_NEAR(wrapped.max.y, sqrt(0.5), 1e-12);
+
+    //Nearest hits of the index agree with testing every boundary, the outer circle covers all bins
+    std::vector<gg::Boundary> boundaries;
+    boundaries.push_back(new gg::Circle(gg::Vector(0.0, 0.0), 2.0, true));
+    const unsigned int arcs = 256;
+    for (unsigned int i = 0; i < arcs; i++) boundaries.push_back(new gg::Arc(gg::Vector(0.0, 0.0), 1.0, true, -M_PI + 2 * M_PI * i / arcs, 2 * M_PI / arcs));
+    gg::Parameters parameters;
+    parameters.size = gg::Vector(0.01, 0.01);
+    const gg::BoundaryIndex<gg::Boundary> index(parameters, boundaries);
+    for (unsigned int k = 0; k < 100; k++)
+    {
+        const gg::Vector a(-1.5 + 0.03 * k, 0.02 * k - 1.0), b(1.9 - 0.01 * k, 0.5 - 0.015 * k);
+        gg::Intersection intersection;
+        for (unsigned int i = 0; i < boundaries.size(); i++)
+        {
+            const gg::Intersection new_intersection = boundaries[i].intersection(a, b);
+            if (new_intersection.valid && (!intersection.valid || (new_intersection.coord-a).squared_norm() < (intersection.coord-a).squared_norm())) intersection = new_intersection;
+        }
+        const gg::Boundary *boundary = nullptr;
+        const gg::Intersection index_intersection = index.intersection(a, b, boundary);
+        EXPECT_EQ(index_intersection.valid, intersection.valid);
+        if (intersection.valid && index_intersection.valid)
+        {
+            EXPECT_NEAR((index_intersection.coord - intersection.coord).norm(), 0.0, 1e-9);
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,58 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include <vector>
+#include <cstddef>
+
+namespace gg
+{
+    ///Storage of objects in large contiguous blocks, objects are never moved and are destroyed together with the arena or one by one
+    template <class T>
+    class Arena
+    {
+    protected:
+        struct Block
+        {
+            T *data;
+            std::size_t size;
+            std::size_t capacity;
+        };
+        std::vector<Block> _blocks;
+        std::vector<T*> _free;  //Memory of destroyed objects, reused by new objects
+        std::size_t _size = 0;
+        std::size_t _reserved = 0;
+        T *_allocate();
+    public:
+        ///Creates empty arena
+        Arena();
+        ///Transfers arena, pointers to objects stay valid
+        ///@param other Arena to be transferred
+        Arena(Arena &&other);
+        ///Transfers arena, pointers to objects stay valid
+        ///@param other Arena to be transferred
+        Arena &operator=(Arena &&other);
+        Arena(const Arena &other) = delete;
+        Arena &operator=(const Arena &other) = delete;
+        ///Reserves space for given number of objects in addition to existing ones, so they are allocated in one block
+        ///@param count Number of objects
+        void reserve(std::size_t count);
+        ///Constructs new object in the arena
+        ///@param args Arguments of the constructor
+        template <class... A> T *create(A&&... args);
+        ///Destroys object, its memory is reused by the next created object
+        ///@param object Object created by the arena
+        void destroy(T *object);
+        ///Gets number of objects
+        std::size_t size() const;
+        ///Destroys all objects and frees memory
+        void clear();
+        ///Destroys all objects and frees memory
+        ~Arena();
+    };
+}
@@ -0,0 +1,115 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "arena.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <new>
+
+/*
+    Objects are placement-constructed in raw blocks of memory, every next block is at least as large as all previous blocks together,
+    so the number of allocations is logarithmic. Blocks are never reallocated, pointers to objects stay valid until the arena is cleared
+    Objects destroyed one by one leave their memory in the free list, new objects take it before growing the last block
+*/
+
+template <class T> gg::Arena<T>::Arena() {}
+
+template <class T> gg::Arena<T>::Arena(Arena &&other) : _blocks(std::move(other._blocks)), _free(std::move(other._free)), _size(other._size), _reserved(other._reserved)
+{
+    other._blocks.clear();
+    other._free.clear();
+    other._size = 0;
+    other._reserved = 0;
+}
+
+template <class T> gg::Arena<T> &gg::Arena<T>::operator=(Arena &&other)
+{
+    if (this == &other) return *this;
+    clear();
+    _blocks.swap(other._blocks);
+    _free.swap(other._free);
+    _size = other._size;
+    _reserved = other._reserved;
+    other._size = 0;
+    other._reserved = 0;
+    return *this;
+}
+
+template <class T> T *gg::Arena<T>::_allocate()
+{
+    if (_blocks.empty() || _blocks.back().size == _blocks.back().capacity || _reserved != 0)
+    {
+        Block block;
+        block.capacity = (_reserved > 64) ? _reserved : 64;
+        if (_reserved == 0 && block.capacity < _size) block.capacity = _size;
+        block.data = static_cast<T*>(::operator new(block.capacity * sizeof(T)));
+        block.size = 0;
+        _blocks.push_back(block);
+        _reserved = 0;
+    }
+    return _blocks.back().data + _blocks.back().size;
+}
+
+template <class T> void gg::Arena<T>::reserve(std::size_t count)
+{
+    const std::size_t free = _blocks.empty() ? 0 : (_blocks.back().capacity - _blocks.back().size);
+    if (count > free) _reserved = count;
+}
+
+template <class T> template <class... A> T *gg::Arena<T>::create(A&&... args)
+{
+    T *object;
+    if (!_free.empty())
+    {
+        object = new(_free.back()) T(std::forward<A>(args)...);
+        _free.pop_back();
+    }
+    else
+    {
+        object = new(_allocate()) T(std::forward<A>(args)...);
+        _blocks.back().size++;
+    }
+    _size++;
+    return object;
+}
+
+template <class T> void gg::Arena<T>::destroy(T *object)
+{
+    object->~T();
+    _free.push_back(object);
+    _size--;
+}
+
+template <class T> std::size_t gg::Arena<T>::size() const
+{
+    return _size;
+}
+
+template <class T> void gg::Arena<T>::clear()
+{
+    std::sort(_free.begin(), _free.end(), std::less<T*>());
+    for (typename std::vector<Block>::iterator block = _blocks.begin(); block != _blocks.end(); block++)
+    {
+        for (std::size_t i = 0; i < block->size; i++)
+        {
+            if (!std::binary_search(_free.begin(), _free.end(), block->data + i, std::less<T*>())) block->data[i].~T();
+        }
+        ::operator delete(block->data);
+    }
+    _blocks.clear();
+    _free.clear();
+    _size = 0;
+    _reserved = 0;
+}
+
+template <class T> gg::Arena<T>::~Arena()
+{
+    clear();
+}
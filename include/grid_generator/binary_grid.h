@@ -0,0 +1,116 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "indexed_grid.h"
+#include <cstddef>
+#include <string>
+
+namespace gg
+{
+    ///Version of binary grid format, files of other versions are rejected
+    ///The format stores arrays of IndexedPointGrid or IndexedCellGrid as they are in memory (native byte order, 64-byte aligned), so files are portable only between machines of the same architecture
+    const unsigned int binary_grid_version = 1;
+
+    ///Read-only view of contiguous array, does not own the memory
+    template <class T>
+    class ArrayView
+    {
+    protected:
+        const T *_data = nullptr;
+        std::size_t _size = 0;
+    public:
+        ///Creates empty view
+        ArrayView() {}
+        ///Creates view of array
+        ///@param data Pointer to the first element
+        ///@param size Number of elements
+        ArrayView(const T *data, std::size_t size) : _data(data), _size(size) {}
+        ///Gets pointer to the first element
+        const T *data() const { return _data; }
+        ///Gets number of elements
+        std::size_t size() const { return _size; }
+        ///Checks if view is empty
+        bool empty() const { return _size == 0; }
+        ///Gets element
+        const T &operator[](std::size_t i) const { return _data[i]; }
+        ///Gets pointer to the first element
+        const T *begin() const { return _data; }
+        ///Gets pointer past the last element
+        const T *end() const { return _data + _size; }
+    };
+
+    ///Point grid in mapped file, arrays have the same meaning as in IndexedPointGrid
+    struct MappedPointGrid
+    {
+        ArrayView<Vector> coords;                   ///< Coordinates of points
+        ArrayView<Vector> normals;                  ///< Normals of points
+        ArrayView<unsigned int> boundaries;         ///< Indexes of touched boundaries, or no_index
+        ArrayView<unsigned int> neighbor_offsets;   ///< Offsets of neighbors of points
+        ArrayView<unsigned int> neighbors;          ///< Indexes of neighbor points
+    };
+
+    ///Cellular grid in mapped file, arrays have the same meaning as in IndexedCellGrid
+    struct MappedCellGrid
+    {
+        ArrayView<Vector> point_coords;                     ///< Coordinates of points
+        ArrayView<Vector> point_normals;                    ///< Normals of points
+        ArrayView<unsigned int> point_boundaries;           ///< Indexes of boundaries the points lie on, or no_index
+        ArrayView<std::array<unsigned int, 2>> face_points; ///< Points of faces
+        ArrayView<Vector> face_centers;                     ///< Centers of faces
+        ArrayView<Vector> face_normals;                     ///< Normals of faces, length of normal is length of face
+        ArrayView<double> face_lengths;                     ///< Lengths of faces
+        ArrayView<unsigned int> face_boundaries;            ///< Indexes of boundaries the faces touch, or no_index
+        ArrayView<Vector> cell_centers;                     ///< Centers of cells
+        ArrayView<double> cell_areas;                       ///< Areas of cells
+        ArrayView<unsigned int> cell_boundaries;            ///< Indexes of boundaries the cells touch, or no_index
+        ArrayView<unsigned int> side_offsets;               ///< Offsets of sides of cells
+        ArrayView<IndexedSide> sides;                       ///< Sides of cells
+    };
+
+    ///Writes point grid to binary file
+    ///Only indexed grids can be written, grids generated with Storage::objects have no IndexedPointGrid and must be generated with Storage::indexed
+    ///@param path Path to the file
+    ///@param grid Point grid, for example PointGrid::indexed() of grid generated with Storage::indexed
+    void write_grid(const std::string &path, const IndexedPointGrid &grid);
+    ///Writes cellular grid to binary file
+    ///Only indexed grids can be written, grids generated with Storage::objects have no IndexedCellGrid and must be generated with Storage::indexed or streamed to IndexedCellSink
+    ///@param path Path to the file
+    ///@param grid Cellular grid, for example CellGrid::indexed() of grid generated with Storage::indexed
+    void write_grid(const std::string &path, const IndexedCellGrid &grid);
+
+    ///Binary grid file mapped into memory, arrays are views of mapped pages, nothing is copied or parsed
+    class MappedGrid
+    {
+    protected:
+        void *_data = nullptr;
+        std::size_t _size = 0;
+        void *_mapping = nullptr;   //Mapping handle (Windows only)
+        bool _cellular = false;
+        MappedPointGrid _point_grid;
+        MappedCellGrid _cell_grid;
+        void _unmap();
+    public:
+        ///Maps binary grid file, file is validated but not read
+        ///@param path Path to the file written by write_grid()
+        explicit MappedGrid(const std::string &path);
+        ///Transfers mapping, views stay valid
+        ///@param other Mapping to be transferred
+        MappedGrid(MappedGrid &&other);
+        MappedGrid(const MappedGrid &other) = delete;
+        MappedGrid &operator=(const MappedGrid &other) = delete;
+        ///Unmaps file, views become invalid
+        ~MappedGrid();
+        ///Checks if file contains cellular grid, otherwise it contains point grid
+        bool cellular() const;
+        ///Gets point grid, file must contain point grid
+        const MappedPointGrid &point_grid() const;
+        ///Gets cellular grid, file must contain cellular grid
+        const MappedCellGrid &cell_grid() const;
+    };
+}
@@ -0,0 +1,63 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common.h"
+#include "boundary_traits.h"
+#include "figure_batch.h"
+#include "statistics.h"
+#include <vector>
+
+namespace gg
+{
+    ///Uniform grid of bins over bounding boxes of boundary figures, finds boundaries that may intersect a segment
+    template <class B>
+    class BoundaryIndex
+    {
+    protected:
+        const std::vector<B> &_boundaries;
+        Box _bounds;
+        double _bin_size = 1.0;
+        unsigned int _width = 0;
+        unsigned int _height = 0;
+        std::vector<unsigned int> _offsets;     //Bin i contains _figures[_offsets[i]] ... _figures[_offsets[i+1]-1]
+        std::vector<unsigned int> _figures;     //Boundary indexes
+        std::vector<unsigned int> _global;      //Boundaries with infinite bounds or bounds that cover most bins, they are candidates for every segment
+        bool _finite = true;                    //All boundaries have finite bounds
+        FigureBatch _batch;                     //Figures of bins in the same order as _figures, then global figures
+        std::vector<FigureBatch::Offset> _batch_offsets; //Bin i contains _batch[_batch_offsets[i]] ... _batch[_batch_offsets[i+1]-1]
+        template <class F> void _walk(Vector a, Vector b, const F &function) const;
+    public:
+        ///Creates index
+        ///@param parameters Grid parameters, bins are not made smaller than grid elements
+        ///@param boundaries Grid boundaries, must outlive the index
+        BoundaryIndex(const Parameters &parameters, const std::vector<B> &boundaries);
+        ///Gets bounding box of all boundaries with finite bounds
+        Box bounds() const;
+        ///Checks if all boundaries have finite bounds
+        bool finite() const;
+        ///Gets boundary by index
+        const B &boundary(unsigned int index) const;
+        ///Finds boundaries whose bounding boxes may intersect the segment
+        ///@param a Beginning of the segment
+        ///@param b Ending of the segment
+        ///@param candidates Sorted boundary indexes, previous content is cleared
+        void candidates(Vector a, Vector b, std::vector<unsigned int> &candidates) const;
+        ///Searches for the intersection between boundaries and segment that is nearest to the beginning of the segment
+        ///@param a Beginning of the segment
+        ///@param b Ending of the segment
+        ///@param boundary Found boundary
+        Intersection intersection(Vector a, Vector b, const B *&boundary) const;
+        ///Searches for the intersection between boundaries and segment that is nearest to the beginning of the segment, counts the probe
+        ///@param a Beginning of the segment
+        ///@param b Ending of the segment
+        ///@param boundary Found boundary
+        ///@param statistics Statistics policy
+        template <class S> Intersection intersection(Vector a, Vector b, const B *&boundary, S &statistics) const;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "boundary_index.h"
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <math.h>
+
+/*
+    Bins are square, about four bins per figure, but at least as large as two grid elements and as large as an average figure,
+    so short segments visit few bins and figures are copied to few bins
+    Every figure is put in all bins its bounding box overlaps, bins are stored in compressed form (offsets + indexes)
+    Figures that overlap more than half of the bins are not copied, they are candidates for every segment, like figures with infinite bounds
+    Segment visits bins it goes through (Amanatides-Woo traversal), candidates from visited bins are merged and sorted,
+    so the boundaries are tested in their original order and results are equal to testing every boundary
+    Figures of every bin are also copied to a figure batch, the nearest intersection is searched bin by bin without merging,
+    testing the same figure twice does not change the nearest hit, and ties are won by lower index like in the original order
+    The walk stops as soon as the nearest hit lies before the exit from the current bin
+*/
+
+template <class B> gg::BoundaryIndex<B>::BoundaryIndex(const Parameters &parameters, const std::vector<B> &boundaries) : _boundaries(boundaries)
+{
+    //Find bounds
+    std::vector<Box> bounds(boundaries.size());
+    unsigned int bounded = 0;
+    for (unsigned int i = 0; i < boundaries.size(); i++)
+    {
+        bounds[i] = BoundaryTraits<B>::bounds(boundaries[i]);
+        if (bounds[i].finite()) { _bounds.extend(bounds[i]); bounded++; }
+        else _finite = false;
+    }
+    if (_bounds.empty())
+    {
+        for (unsigned int i = 0; i < boundaries.size(); i++) _global.push_back(i);
+        for (std::vector<unsigned int>::const_iterator i = _global.begin(); i != _global.end(); i++) BoundaryTraits<B>::batch(boundaries[*i], _batch, *i);
+        return;
+    }
+
+    //Choose bin size, figures that cover more than half of the bounds do not count for the average figure
+    const Vector extent = _bounds.max - _bounds.min;
+    double area = 0.0;
+    unsigned int small = 0;
+    for (unsigned int i = 0; i < boundaries.size(); i++)
+    {
+        if (!bounds[i].finite()) continue;
+        const Vector size = bounds[i].max - bounds[i].min;
+        if (size.x * size.y > 0.5 * extent.x * extent.y) continue;
+        area += size.x * size.y;
+        small++;
+    }
+    _bin_size = 2 * fmax(fabs(parameters.size.x), fabs(parameters.size.y));
+    _bin_size = fmax(_bin_size, sqrt(extent.x * extent.y / (4.0 * bounded)));
+    _bin_size = fmax(_bin_size, fmax(extent.x, extent.y) / (4.0 * bounded));
+    if (small > 0) _bin_size = fmax(_bin_size, sqrt(area / small));
+    _width = (unsigned int)(extent.x / _bin_size) + 1;
+    _height = (unsigned int)(extent.y / _bin_size) + 1;
+
+    //Count figures in bins, then fill bins
+    const double epsilon = 1e-9 * _bin_size;
+    const std::size_t bins = (std::size_t)_width * _height;
+    std::vector<unsigned int> ranges(4 * boundaries.size());
+    std::vector<bool> binned(boundaries.size(), false);
+    _offsets.resize(bins + 1, 0);
+    for (unsigned int i = 0; i < boundaries.size(); i++)
+    {
+        if (bounds[i].finite())
+        {
+            ranges[4 * i + 0] = std::min(_width - 1, (unsigned int)fmax(0.0, (bounds[i].min.x - epsilon - _bounds.min.x) / _bin_size));
+            ranges[4 * i + 1] = std::min(_width - 1, (unsigned int)fmax(0.0, (bounds[i].max.x + epsilon - _bounds.min.x) / _bin_size));
+            ranges[4 * i + 2] = std::min(_height - 1, (unsigned int)fmax(0.0, (bounds[i].min.y - epsilon - _bounds.min.y) / _bin_size));
+            ranges[4 * i + 3] = std::min(_height - 1, (unsigned int)fmax(0.0, (bounds[i].max.y + epsilon - _bounds.min.y) / _bin_size));
+            const std::size_t covered = (std::size_t)(ranges[4 * i + 1] - ranges[4 * i + 0] + 1) * (ranges[4 * i + 3] - ranges[4 * i + 2] + 1);
+            binned[i] = bins < 4 || 2 * covered <= bins;
+        }
+        if (!binned[i]) { _global.push_back(i); continue; }
+        for (unsigned int y = ranges[4 * i + 2]; y <= ranges[4 * i + 3]; y++)
+        {
+            for (unsigned int x = ranges[4 * i + 0]; x <= ranges[4 * i + 1]; x++) _offsets[(std::size_t)y * _width + x + 1]++;
+        }
+    }
+    for (std::size_t bin = 0; bin < bins; bin++) _offsets[bin + 1] += _offsets[bin];
+    _figures.resize(_offsets.back());
+    std::vector<unsigned int> fill(_offsets.begin(), _offsets.end() - 1);
+    for (unsigned int i = 0; i < boundaries.size(); i++)
+    {
+        if (!binned[i]) continue;
+        for (unsigned int y = ranges[4 * i + 2]; y <= ranges[4 * i + 3]; y++)
+        {
+            for (unsigned int x = ranges[4 * i + 0]; x <= ranges[4 * i + 1]; x++) _figures[fill[(std::size_t)y * _width + x]++] = i;
+        }
+    }
+
+    //Copy bins to the batch
+    _batch_offsets.resize(_offsets.size());
+    for (std::size_t bin = 0; bin < bins; bin++)
+    {
+        _batch_offsets[bin] = _batch.end();
+        for (unsigned int i = _offsets[bin]; i < _offsets[bin + 1]; i++) BoundaryTraits<B>::batch(boundaries[_figures[i]], _batch, _figures[i]);
+    }
+    _batch_offsets.back() = _batch.end();
+    for (std::vector<unsigned int>::const_iterator i = _global.begin(); i != _global.end(); i++) BoundaryTraits<B>::batch(boundaries[*i], _batch, *i);
+}
+
+template <class B> gg::Box gg::BoundaryIndex<B>::bounds() const
+{
+    return _bounds;
+}
+
+template <class B> bool gg::BoundaryIndex<B>::finite() const
+{
+    return _finite;
+}
+
+template <class B> const B &gg::BoundaryIndex<B>::boundary(unsigned int index) const
+{
+    return _boundaries[index];
+}
+
+template <class B> template <class F> void gg::BoundaryIndex<B>::_walk(Vector a, Vector b, const F &function) const
+{
+    if (_width == 0) return;
+
+    //Segment in coordinates of bins, clipped to the grid of bins
+    const Vector begin = (a - _bounds.min) / _bin_size;
+    const Vector direction = (b - a) / _bin_size;
+    double t0 = 0.0, t1 = 1.0;
+    const double p[4] = { -direction.x, direction.x, -direction.y, direction.y };
+    const double q[4] = { begin.x, _width - begin.x, begin.y, _height - begin.y };
+    for (unsigned int i = 0; i < 4 && t0 <= t1; i++)
+    {
+        if (p[i] == 0.0) { if (q[i] < 0.0) t1 = -1.0; }
+        else if (p[i] < 0.0) t0 = fmax(t0, q[i] / p[i]);
+        else t1 = fmin(t1, q[i] / p[i]);
+    }
+    if (t0 > t1) return;
+
+    //Walk through bins, the function gets bin and segment parameter of the exit from the bin, and returns whether to stop
+    const Vector start = begin + direction * t0;
+    const Vector end = begin + direction * t1;
+    int x = std::max(0, std::min((int)_width - 1, (int)floor(start.x))), y = std::max(0, std::min((int)_height - 1, (int)floor(start.y)));
+    const int x_end = std::max(0, std::min((int)_width - 1, (int)floor(end.x))), y_end = std::max(0, std::min((int)_height - 1, (int)floor(end.y)));
+    const int step_x = (direction.x > 0.0) ? 1 : -1, step_y = (direction.y > 0.0) ? 1 : -1;
+    const double infinity = std::numeric_limits<double>::infinity();
+    const double delta_x = (direction.x != 0.0) ? fabs(1.0 / direction.x) : infinity;
+    const double delta_y = (direction.y != 0.0) ? fabs(1.0 / direction.y) : infinity;
+    double next_x = (direction.x != 0.0) ? (((direction.x > 0.0) ? (x + 1) : x) - start.x) / direction.x : infinity;
+    double next_y = (direction.y != 0.0) ? (((direction.y > 0.0) ? (y + 1) : y) - start.y) / direction.y : infinity;
+    unsigned int steps = abs(x_end - x) + abs(y_end - y);
+    while (true)
+    {
+        const double exit = (steps == 0) ? infinity : (t0 + fmin(next_x, next_y));
+        if (x >= 0 && y >= 0 && x < (int)_width && y < (int)_height && function((std::size_t)y * _width + x, exit)) break;
+        if (steps-- == 0) break;
+        if (next_x < next_y) { x += step_x; next_x += delta_x; }
+        else { y += step_y; next_y += delta_y; }
+    }
+}
+
+template <class B> void gg::BoundaryIndex<B>::candidates(Vector a, Vector b, std::vector<unsigned int> &candidates) const
+{
+    candidates.clear();
+    _walk(a, b, [this, &candidates](std::size_t bin, double) -> bool
+    {
+        candidates.insert(candidates.end(), _figures.begin() + _offsets[bin], _figures.begin() + _offsets[bin + 1]);
+        return false;
+    });
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (!_global.empty())
+    {
+        const std::size_t middle = candidates.size();
+        candidates.insert(candidates.end(), _global.begin(), _global.end());
+        std::inplace_merge(candidates.begin(), candidates.begin() + middle, candidates.end());
+    }
+}
+
+template <class B> gg::Intersection gg::BoundaryIndex<B>::intersection(Vector a, Vector b, const B *&boundary) const
+{
+    NoStatistics statistics;
+    return intersection(a, b, boundary, statistics);
+}
+
+template <class B> template <class S> gg::Intersection gg::BoundaryIndex<B>::intersection(Vector a, Vector b, const B *&boundary, S &statistics) const
+{
+    //Nearest hit, exits are compared with small tolerance because hits on borders of bins may belong to both bins
+    BatchHit hit;
+    const double tolerance = 1e-9;
+    _walk(a, b, [this, a, b, &hit, tolerance, &statistics](std::size_t bin, double exit) -> bool
+    {
+        if (_offsets[bin] == _offsets[bin + 1]) return false;
+        statistics.test(_offsets[bin + 1] - _offsets[bin]);
+        _batch.nearest(a, b, _batch_offsets[bin], _batch_offsets[bin + 1], hit);
+        return hit.t < exit - tolerance;
+    });
+    if (!_global.empty())
+    {
+        statistics.test((unsigned int)_global.size());
+        _batch.nearest(a, b, _batch_offsets.empty() ? FigureBatch::Offset() : _batch_offsets.back(), _batch.end(), hit);
+    }
+
+    //Only the nearest intersection is built
+    statistics.probe(hit.figure != nullptr);
+    if (hit.figure == nullptr) return Intersection();
+    boundary = &_boundaries[hit.index];
+    return BoundaryTraits<B>::intersection(*boundary, a, b);
+}
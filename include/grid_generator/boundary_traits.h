@@ -0,0 +1,47 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common.h"
+#include "figure_batch.h"
+#include <vector>
+
+namespace gg
+{
+    ///Access to boundaries used as grid template arguments
+    ///Members bounds(), intersection(), intersections() and batch() of the boundary are used if present, otherwise calls are forwarded to the virtual functions of figure()
+    template <class B>
+    struct BoundaryTraits
+    {
+    private:
+        template <class C> static auto _bounds(const C &boundary, int) -> decltype(boundary.bounds()) { return boundary.bounds(); }
+        static Box _bounds(const B &boundary, long) { return boundary.figure()->bounds(); }
+        template <class C> static auto _intersection(const C &boundary, Vector a, Vector b, int) -> decltype(boundary.intersection(a, b)) { return boundary.intersection(a, b); }
+        static Intersection _intersection(const B &boundary, Vector a, Vector b, long) { return boundary.figure()->intersection(a, b); }
+        template <class C> static auto _intersections(const C &boundary, Vector a, Vector b, std::vector<Intersection> &intersections, int) -> decltype(boundary.intersections(a, b, intersections)) { boundary.intersections(a, b, intersections); }
+        static void _intersections(const B &boundary, Vector a, Vector b, std::vector<Intersection> &intersections, long) { boundary.figure()->intersections(a, b, intersections); }
+        template <class C> static auto _batch(const C &boundary, FigureBatch &batch, unsigned int index, int) -> decltype(boundary.batch(batch, index)) { boundary.batch(batch, index); }
+        static void _batch(const B &boundary, FigureBatch &batch, unsigned int index, long) { batch.push_back(boundary.figure(), index); }
+    public:
+        ///Gets bounding box of boundary figure
+        static Box bounds(const B &boundary) { return _bounds(boundary, 0); }
+        ///Searches for intersection between boundary figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        static Intersection intersection(const B &boundary, Vector a, Vector b) { return _intersection(boundary, a, b, 0); }
+        ///Searches for all intersections between boundary figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        ///@param intersections Intersections ordered from beginning to ending, result is appended
+        static void intersections(const B &boundary, Vector a, Vector b, std::vector<Intersection> &intersections) { _intersections(boundary, a, b, intersections, 0); }
+        ///Adds boundary figure to figure batch
+        ///@param batch Figure batch
+        ///@param index Index of the boundary
+        static void batch(const B &boundary, FigureBatch &batch, unsigned int index) { _batch(boundary, batch, index, 0); }
+    };
+}
@@ -7,12 +7,26 @@
 */ 
 
 #pragma once
+#include "arena.h"
+#include "indexed_grid.h"
+#include "statistics.h"
+#include "sink.h"
+#include "locator.h"
+#include "partition.h"
 #include <vector>
 #include <set>
+#include <map>
 #include <array>
+#include <memory>
 
 namespace gg
 {
+    struct Position;
+    struct PointPosition;
+    struct TemporaryLatticeBase;
+    template <class B, class L> struct TemporaryCell;
+    class ThreadPool;
+
     ///Standalone point that is a part of point grid
     template <class B = Boundary>
     class Point
@@ -104,6 +118,15 @@ namespace gg
     struct CellGridParameters : Parameters
     {
         double threshold_area = 0.5;    ///< Minimal area of the cell by which the cell is created (0.0 <= threshold_area <= 1.0)
+        bool incremental = false;       ///< Keep state of lattice cells after generation, required by CellGrid::update()
+        unsigned int refinement = 0;    ///< Number of times cells near boundaries are divided in four (square grids only, not incremental)
+        double refinement_distance = 1.0;   ///< Cells closer to boundaries than refinement_distance sizes of the cell are divided
+        bool locator = false;           ///< Create CellLocator that finds cells by coordinates (not refined)
+        Ordering ordering = Ordering::lattice;  ///< Numbering of points, faces and cells (not streamed)
+        unsigned int parts = 1;         ///< Number of parts the domain is split into by recursive coordinate bisection of cells, only the part is searched and it is classified like in Generation::scanline (not refined, not incremental, not reordered, not streamed)
+        unsigned int part = 0;          ///< Part that is generated, see CellGrid::partition()
+        unsigned int ghost_layers = 1;  ///< Number of layers of face neighbor cells of other parts that are generated together with the part
+        bool geometry = false;          ///< Compute finite volume geometric factors, see CellGrid::geometry() (not streamed)
     };
     
     ///Cellular grid
@@ -111,19 +134,96 @@ namespace gg
     class CellGrid
     {
     protected:
+        Arena<P> _point_arena;
+        Arena<F> _face_arena;
+        Arena<C> _cell_arena;
         std::set<P*> _points;
         std::set<F*> _faces;
         std::set<C*> _cells;
+        IndexedCellGrid _indexed;
+        CellConnectivity _connectivity;
+        CellGeometry _geometry;
+        CellLocator _locator;
+        CellPartition _partition;
+        CellGridParameters _parameters;
+        std::unique_ptr<TemporaryLatticeBase> _lattice;                 //State of lattice cells (TemporaryLattice<B, L>), kept if parameters.incremental
+        std::vector<P*> _point_objects;                                 //Points by index, kept in objects mode if parameters.incremental
+        std::vector<F*> _face_objects;                                  //Faces by index, kept in objects mode if parameters.incremental
+        std::vector<C*> _cell_objects;                                  //Cells by index, kept in objects mode if parameters.incremental
+        const B *_boundaries = nullptr;                                 //Boundaries used for generation
+        std::vector<Box> _bounds;                                       //Bounds of boundaries at the time of generation (or of the last update)
+        CellGrid();
+        template <class S> void _generate(const CellGridParameters &parameters, const std::vector<B> &boundaries, S &statistics);
+        template <class L, class S> void _generate(const CellGridParameters &parameters, const std::vector<B> &boundaries, const std::vector<PointPosition> *seeds, ThreadPool &pool, S &statistics);
+        template <class L, class S> void _partition_cells(const CellGridParameters &parameters, const std::vector<B> &boundaries, std::vector<Position> &local_positions, S &statistics);
+        template <class L, class S> void _search(const CellGridParameters &parameters, const std::vector<B> &boundaries, const std::vector<PointPosition> *seeds, const std::vector<Position> *part, ThreadPool &pool, S &statistics);
+        template <class L, class K, class S> void _stream(const CellGridParameters &parameters, const std::vector<B> &boundaries, K &sink, ThreadPool &pool, S &statistics);
+        template <class L, class S> CellGridChanges _update(const std::vector<B> &boundaries, const std::vector<unsigned int> &changed, ThreadPool &pool, S &statistics);
+        template <class S> void _generate_refined(const CellGridParameters &parameters, const std::vector<B> &boundaries, ThreadPool &pool, S &statistics);
+        template <class S> void _connect(unsigned int point_count, ThreadPool &pool, S &statistics);
+        template <class S> void _compute_geometry(const std::vector<unsigned int> *faces, const std::vector<unsigned int> *cells, std::vector<unsigned int> *free_face_records, std::vector<unsigned int> *free_cell_records, ThreadPool &pool, S &statistics);
+        template <class PS, class FS, class CS, class S> void _create_objects(const std::vector<const PS*> &point_sources, const std::vector<const FS*> &face_sources, const std::vector<const CS*> &cell_sources, S &statistics);
+        void _create_sides();
+        template <class L> std::size_t _memory(std::size_t cells) const;
     public:
         ///Creates cellular grid
         ///@param parameters Cell grid parameters
         ///@param boundaries Grid boundaries
         CellGrid(const CellGridParameters &parameters, const std::vector<B> &boundaries);
-        ///Gets list of points
+        ///Creates cellular grid and records statistics of generation
+        ///@param parameters Cell grid parameters
+        ///@param boundaries Grid boundaries
+        ///@param statistics Statistics policy, for example GridStatistics
+        template <class S> CellGrid(const CellGridParameters &parameters, const std::vector<B> &boundaries, S &statistics);
+        ///Generates cellular grid without storing it, points, faces and cells are passed to the sink as soon as they are created
+        ///Indexes are the same as in the grid generated with Storage::indexed, parameters.storage, parameters.incremental, parameters.locator, parameters.ordering and parameters.geometry are ignored
+        ///With Generation::scanline, the search is interleaved with the pass, so temporary memory is proportional to one column of the lattice, flood fill searches the whole domain first
+        ///@param parameters Cell grid parameters
+        ///@param boundaries Grid boundaries
+        ///@param sink Sink, for example IndexedCellSink
+        template <class K> static void stream(const CellGridParameters &parameters, const std::vector<B> &boundaries, K &sink);
+        ///Generates cellular grid without storing it and records statistics of generation
+        ///@param parameters Cell grid parameters
+        ///@param boundaries Grid boundaries
+        ///@param sink Sink, for example IndexedCellSink
+        ///@param statistics Statistics policy, for example GridStatistics
+        template <class K, class S> static void stream(const CellGridParameters &parameters, const std::vector<B> &boundaries, K &sink, S &statistics);
+        ///Transfers cellular grid, pointers to points, faces and cells stay valid
+        ///@param other Grid to be transferred
+        CellGrid(CellGrid &&other) = default;
+        CellGrid(const CellGrid &other) = delete;
+        CellGrid &operator=(const CellGrid &other) = delete;
+        ///Destroys grid and all its points, faces and cells
+        ~CellGrid();
+        ///Gets list of points, empty unless storage is Storage::objects
         std::set<P*> &points();
-        ///Gets list of faces
+        ///Gets list of faces, empty unless storage is Storage::objects
         std::set<F*> &faces();
-        ///Gets list of cells
+        ///Gets list of cells, empty unless storage is Storage::objects
         std::set<C*> &cells();
+        ///Gets points, faces and cells stored in contiguous arrays, empty unless storage is Storage::indexed
+        IndexedCellGrid &indexed();
+        ///Gets points, faces and cells stored in contiguous arrays, empty unless storage is Storage::indexed
+        const IndexedCellGrid &indexed() const;
+        ///Gets cell-face, face-cell, cell-point and point-cell connectivity in compressed sparse row format
+        const CellConnectivity &connectivity() const;
+        ///Gets finite volume geometric factors, empty unless parameters.geometry
+        const CellGeometry &geometry() const;
+        ///Gets locator that finds cells by coordinates, empty unless parameters.locator
+        const CellLocator &locator() const;
+        ///Gets global indexes of cells and cells exchanged with other parts, empty unless parameters.parts is greater than 1
+        const CellPartition &partition() const;
+        ///Updates grid after some boundaries were changed, only the region around old and new positions of changed boundaries is searched again
+        ///The grid must be generated with parameters.incremental. Changes must not connect or disconnect parts of the domain outside of the region
+        ///Only cells of the region are calculated again and connectivity is patched in place, points, faces and cells outside of the region keep their indexes and objects
+        ///New elements are numbered after old ones, and the last elements fill holes of removed elements, returned maps translate old indexes to new ones
+        ///@param boundaries Grid boundaries, the same vector that was used for generation, changed boundaries are replaced in place
+        ///@param changed Indexes of changed boundaries
+        CellGridChanges update(const std::vector<B> &boundaries, const std::vector<unsigned int> &changed);
+        ///Updates grid after some boundaries were changed and records statistics of the update
+        ///@param boundaries Grid boundaries, the same vector that was used for generation, changed boundaries are replaced in place
+        ///@param changed Indexes of changed boundaries
+        ///@param statistics Statistics policy, for example GridStatistics
+        template <class S> CellGridChanges update(const std::vector<B> &boundaries, const std::vector<unsigned int> &changed, S &statistics);
     };
 }
\ No newline at end of file
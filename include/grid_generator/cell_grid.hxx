@@ -9,7 +9,21 @@
 #pragma once
 #include "cell_grid.h"
 #include "common_internal.h"
+#include "lattice_traits.h"
+#include "scanline.hxx"
+#include "lattice_view.hxx"
+#include "quadtree.hxx"
+#include "boundary_index.hxx"
+#include "arena.hxx"
+#include "ordering.hxx"
+#include "csr_patch.hxx"
+#include "parallel.hxx"
+#include <algorithm>
+#include <climits>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <stdexcept>
 #include <math.h>
 
 /*
@@ -18,10 +32,40 @@
     Active and passive points are both "reached" points, they are divided in two for optimization reasons
     Active points should be searched around, while the search around passive points is already complete and will bring no more results
     Active cell is a cell that has active points. The algorithm searches around active cells.
-    Because the point is located in multiple cells simultaneously, the search is performed in each cell
-    To prevent any inconsistency when searching along faces in different cells, the algorithm performs the search one time, and then saves the result
-    
-    Because adding/removing elements from set cannot be done while iterating through it, there are sets like "to_be_active", etc.
+    Because the point is located in multiple cells simultaneously, points and faces are stored once in the vertex and edge tables of the lattice
+    Cells refer to them by indexes, so status, probe result and created point or face are shared
+    A new cell finds the indexes in a hash table by canonical positions of its points and faces (the smallest position that describes the point or face)
+    Cells are kept in a hash table by position and are never moved once created, waves of the search and other ordered passes are lists of cells sorted by position
+
+    Because points cannot become active while the wave iterates through active points, there are lists like "to_be_active", etc.
+
+    Scanline generation does not search, it classifies every point by crossings of its lattice row with boundaries
+    Points shared by several cells are classified only once (in the row of their canonical position), so cells always agree on them
+    Only faces between inside and outside points are probed, faces between two inside points are considered free of boundaries
+
+    With multiple threads, rows and faces that are about to be probed are probed in parallel beforehand
+    The serial algorithm takes these results, so the result does not depend on the number of threads
+    Threads are created once per generation (or update) and all stages run their parallel loops on this pool
+    Areas, cells, points, faces and flips are calculated in parallel. Points and faces are numbered by a serial pass in order of cells,
+    the first cell that has a shared point or face owns it, and only the owner writes it, so no locks are needed
+    In objects mode, objects are created in the same serial order right from the lattice, and arrays keep only topology until sides are linked
+
+    Refined grids are generated by quadtree, they consist of leaves of different size instead of lattice cells, see quadtree.hxx
+    Leaves are handled like lattice cells, but their points and faces are addressed by vertices and edges of the tree
+
+    Streamed grids create points, faces and sides of every cell in one pass and pass them to the sink right away
+    Cells only touch neighbors that differ by at most one in X index, and cells are ordered by X index first,
+    so when the pass reaches column X, cells, points and faces of columns before X-1 are released
+    With scanline generation, the search itself runs column by column a few columns ahead of the pass, so only a few columns are kept at any time
+    Flood fill knows that a cell is reached only at the end, so it searches the whole domain first
+
+    Partitioned grids first split the cells of the lattice view (see lattice_view.hxx), which stores only cells cut by boundaries,
+    then scanline generation searches only the window around cells of the part and its ghost layers. Other cells are never created
+
+    Incremental grids keep the cells after generation. Update forgets points and faces in the region around changed boundaries,
+    and continues the flood fill from reached points on the border of the region. Points outside of the region are not searched again
+    Forgotten points and faces take their old indexes back if they are created again. Only rows of cells of the region (and of moved cells)
+    are spliced into the connectivity, last elements fill holes of removed elements, so other elements keep their indexes and objects
 */
 
 namespace gg
@@ -34,27 +78,35 @@ namespace gg
         passive
     };
 
-    template <class B, class P, class F, class C>
-    struct TemporaryCell
+    struct TemporaryVertex
     {
-        struct TemporaryPoint
-        {
-            PointStatus status = PointStatus::unreached;
+        PointStatus status = PointStatus::unreached;
 
-            P *point = nullptr;
-        };
-        std::vector<TemporaryPoint> points;
+        unsigned int point = no_index;
+        unsigned int old_point = no_index;  //Index of the point before update
+        unsigned int cells = 0;             //Number of cells that share the point
+    };
 
-        struct TemporaryFace
-        {
-            bool probed = false;        //Face was probed and intersections were searched
-            Intersection intersection;  //Found intersection, includes coordinate and normal (result of probing)
-            const B *boundary = nullptr;//Found boundary (result of probing)
+    template <class B>
+    struct TemporaryEdge
+    {
+        bool probed = false;        //Face was probed and intersections were searched
+        Intersection intersection = Intersection(); //Found intersection, includes coordinate and normal (result of probing), invalid until probed
+        const B *boundary = nullptr;//Found boundary (result of probing)
+        unsigned int probe = no_index;//Index of speculative probe of the face
 
-            P *point = nullptr;
-            F *face = nullptr;
-        };
-        std::vector<TemporaryFace> faces;
+        unsigned int point = no_index;
+        unsigned int face = no_index;
+        unsigned int old_point = no_index;  //Index of the point on the face before update
+        unsigned int old_face = no_index;   //Index of the face before update
+        unsigned int cells = 0;             //Number of cells that share the face
+    };
+
+    template <class B, class L>
+    struct TemporaryCell
+    {
+        std::array<unsigned int, L::shape> vertices;//Indexes of points in the vertex table of the lattice
+        std::array<unsigned int, L::shape> edges;   //Indexes of faces in the edge table of the lattice
 
         Intersection intersection;  //Found intersection (also propagated due to failed cells)
         const B *boundary = nullptr;//Found boundary (also propagated due to failed cells)
@@ -63,9 +115,71 @@ namespace gg
         double area;
         Vector center;
         
-        C *cell = nullptr;
+        unsigned int cell = no_index;
+    };
+
+    template <class L>
+    struct TemporaryIds
+    {
+        std::array<unsigned int, L::shape> vertices;//Indexes of points whose canonical position is this element, or no_index
+        std::array<unsigned int, L::shape> edges;   //Indexes of faces whose canonical position is this element, or no_index
+
+        TemporaryIds() { vertices.fill(no_index); edges.fill(no_index); }
+    };
+
+    ///State of lattice cells of any grid type
+    struct TemporaryLatticeBase
+    {
+        virtual ~TemporaryLatticeBase() {}
+    };
+
+    template <class B, class L>
+    struct TemporaryLattice : TemporaryLatticeBase
+    {
+        typedef std::pair<const Position, TemporaryCell<B, L>> Entry;
+
+        std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> cells;
+        std::unordered_map<Position, TemporaryIds<L>, PositionHash> ids; //Indexes of vertices and edges by canonical positions of their points and faces
+        std::vector<TemporaryVertex> vertices;  //Every lattice point is stored once and shared by all of its cells
+        std::vector<TemporaryEdge<B>> edges;    //Every lattice face is stored once and shared by both of its cells
+        std::vector<Position> cell_positions;   //Positions of cells by their indexes
+        std::vector<Position> touched;          //Positions of cells in the region of update and of cells created by it
+
+        ///Gets all cells in order of their positions
+        std::vector<Entry*> ordered()
+        {
+            std::vector<Entry*> entries;
+            entries.reserve(cells.size());
+            for (typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = cells.begin(); cell != cells.end(); cell++) entries.push_back(&*cell);
+            std::sort(entries.begin(), entries.end(), [](const Entry *a, const Entry *b) { return a->first < b->first; });
+            return entries;
+        }
+    };
+
+    template <class B>
+    struct TemporaryProbe
+    {
+        unsigned int edge;          //Probed edge
+        Vector a;                   //Beginning of the probe
+        Vector b;                   //Ending of the probe
+        Intersection intersection;  //Found intersection
+        const B *boundary = nullptr;//Found boundary
+    };
+
+    template <class B>
+    struct TemporaryRefinedCell
+    {
+        Intersection intersection;  //Found intersection
+        const B *boundary = nullptr;//Found boundary
+        double area;
+        Vector center;
+    };
 
-        TemporaryCell(const CellGridParameters &parameters) : points(get_shape(parameters)), faces(get_shape(parameters)) {}
+    struct TemporaryRow
+    {
+        bool ready = false;             //Crossings were searched
+        bool valid = false;             //Row may lie inside of the domain
+        std::vector<Crossing> crossings;//Crossings with boundaries
     };
 }
 
@@ -134,398 +248,3069 @@ template <class B, class P, class F> std::vector<typename gg::Cell<B, P, F>::Sid
 
 template <class B, class P, class F, class C> gg::CellGrid<B, P, F, C>::CellGrid(const CellGridParameters &parameters, const std::vector<B> &boundaries)
 {
-    //STAGE 0: declare sets and variables
-    const double area = get_area(parameters);
-    std::map<Position, TemporaryCell<B, P, F, C>> active, passive;
+    NoStatistics statistics;
+    _generate(parameters, boundaries, statistics);
+}
+
+template <class B, class P, class F, class C> template <class S> gg::CellGrid<B, P, F, C>::CellGrid(const CellGridParameters &parameters, const std::vector<B> &boundaries, S &statistics)
+{
+    _generate(parameters, boundaries, statistics);
+}
+
+template <class B, class P, class F, class C> gg::CellGrid<B, P, F, C>::CellGrid() {}
 
-    //STAGE 1: add first cell
+template <class B, class P, class F, class C> template <class K> void gg::CellGrid<B, P, F, C>::stream(const CellGridParameters &parameters, const std::vector<B> &boundaries, K &sink)
+{
+    NoStatistics statistics;
+    stream(parameters, boundaries, sink, statistics);
+}
+
+template <class B, class P, class F, class C> template <class K, class S> void gg::CellGrid<B, P, F, C>::stream(const CellGridParameters &parameters, const std::vector<B> &boundaries, K &sink, S &statistics)
+{
+    if (parameters.parts != 1 || parameters.part != 0) throw std::runtime_error("gg::CellGrid::stream(): Streamed grid cannot be partitioned");
+    CellGridParameters stream_parameters = parameters;
+    stream_parameters.storage = Storage::indexed;
+    stream_parameters.incremental = false;
+    stream_parameters.ordering = Ordering::lattice;
+    stream_parameters.geometry = false;
+    CellGrid grid;
+    ThreadPool pool(get_threads(stream_parameters));
+    if (stream_parameters.refinement > 0)
     {
-        TemporaryCell<B, P, F, C> new_cell(parameters);
-        new_cell.points[0].status = PointStatus::active;
-        active.insert({Position(), new_cell});
-        const std::array<PointPosition, 6> neighbors = get_point_neighbors(parameters, { Position(), 0 });
-        for (std::array<PointPosition, 6>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end() && neighbor->point < 100; neighbor++)
-        {
-            new_cell = TemporaryCell<B, P, F, C>(parameters);
-            new_cell.points[neighbor->point].status = PointStatus::active;
-            active.insert({neighbor->position, new_cell});
-        }
+        //Refined grids are generated in contiguous arrays and passed afterwards
+        grid._parameters = stream_parameters;
+        grid._generate_refined(stream_parameters, boundaries, pool, statistics);
+        const IndexedCellGrid &indexed = grid._indexed;
+        for (unsigned int point = 0; point < indexed.point_coords.size(); point++)
+            sink.point(point, indexed.point_coords[point], indexed.point_normals[point], indexed.point_boundaries[point]);
+        for (unsigned int face = 0; face < indexed.face_points.size(); face++)
+            sink.face(face, indexed.face_points[face], indexed.face_centers[face], indexed.face_normals[face], indexed.face_lengths[face], indexed.face_boundaries[face]);
+        for (unsigned int cell = 0; cell < indexed.cell_centers.size(); cell++)
+            sink.cell(cell, indexed.cell_centers[cell], indexed.cell_areas[cell], indexed.cell_boundaries[cell], &indexed.sides[indexed.side_offsets[cell]], indexed.side_offsets[cell + 1] - indexed.side_offsets[cell]);
     }
-
-    //STAGE 2: add all cells
-    while (!active.empty())
+    else switch (stream_parameters.typ)
     {
-        //Iterate through active, probe unprobed faces, add new cells to to_be_active
-        std::map<Position, TemporaryCell<B, P, F, C>> to_be_active;
-        for (typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator cell = active.begin(); cell != active.end(); cell++)
-        {
-            //For each point
-            std::array<Vector, 6> points = get_points(parameters, cell->first);
-            for (unsigned int p = 0; p < get_shape(parameters); p++)
-            {
-                if (cell->second.points[p].status != PointStatus::active) continue;
-
-                //Trying to probe counterclockwise
-                const unsigned int next_ccw = ((p == (get_shape(parameters) - 1)) ? 0 : (p + 1));
-                if (!cell->second.faces[p].probed)
-                {
-                    Intersection intersection;
-                    const B* pboundary;
-                    for (typename std::vector<B>::const_iterator boundary = boundaries.begin(); boundary != boundaries.end(); boundary++)
-                    {
-                        Intersection new_intersection = boundary->figure()->intersection(points[p], points[next_ccw]);
-                        if (new_intersection.valid && (!intersection.valid || ((new_intersection.coord-points[p]).squared_norm() < (intersection.coord-points[p]).squared_norm())))
-                        {
-                            intersection = new_intersection;
-                            pboundary = &(*boundary);
-                        }
-                    }
-                    const FacePosition neighbor = get_face_neighbor(parameters, { cell->first, p });
-                    typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator find = active.find(neighbor.position);
-                    cell->second.faces[p].probed = true;
-                    find->second.faces[neighbor.face].probed = true;
-                    if (intersection.valid)
-                    {
-                        cell->second.faces[p].intersection  = find->second.faces[neighbor.face].intersection= intersection;
-                        cell->second.faces[p].boundary      = find->second.faces[neighbor.face].boundary    = pboundary;
-                        cell->second.intersection           = find->second.intersection                     = intersection;
-                        cell->second.boundary               = find->second.boundary                         = pboundary;
-                    }
-                }
-                if (!cell->second.faces[p].intersection.valid && cell->second.points[next_ccw].status == PointStatus::unreached)
-                {
-                    cell->second.points[next_ccw].status = PointStatus::to_be_active;
-                    const std::array<PointPosition, 6> neighbors = get_point_neighbors(parameters, { cell->first, next_ccw });
-                    for (std::array<PointPosition, 6>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end() && neighbor->point < 100; neighbor++)
-                    {
-                        if (to_be_active.find(neighbor->position) != to_be_active.end()) //to_be_active points remain to_be_active
-                        {
-                            to_be_active.find(neighbor->position)->second.points[neighbor->point].status = PointStatus::to_be_active;
-                        }
-                        else if (active.find(neighbor->position) != active.end()) //Active points remain active
-                        {
-                            active.find(neighbor->position)->second.points[neighbor->point].status = PointStatus::to_be_active;
-                        }
-                        else if (passive.find(neighbor->position) != passive.end()) //Passive points become to_be_active
-                        {
-                            passive.find(neighbor->position)->second.points[neighbor->point].status = PointStatus::to_be_active;
-                            to_be_active.insert(*passive.find(neighbor->position));
-                            passive.erase(neighbor->position);
-                        }
-                        else //Create to_be_active point
-                        {
-                            TemporaryCell<B, P, F, C> new_cell(parameters);
-                            new_cell.points[neighbor->point].status = PointStatus::to_be_active;
-                            to_be_active.insert({neighbor->position, new_cell});
-                        }
-                    }
-                }
+        case GridType::triangular: grid.template _stream<LatticeTraits<GridType::triangular>>(stream_parameters, boundaries, sink, pool, statistics); break;
+        case GridType::hexagonal: grid.template _stream<LatticeTraits<GridType::hexagonal>>(stream_parameters, boundaries, sink, pool, statistics); break;
+        default: grid.template _stream<LatticeTraits<GridType::square>>(stream_parameters, boundaries, sink, pool, statistics); break;
+    }
+}
 
-                //Trying to probe clockwise
-                unsigned int next_cw = ((p == 0) ? (get_shape(parameters) - 1) : (p - 1));
-                if (!cell->second.faces[next_cw].probed)
-                {
-                    Intersection intersection;
-                    const B* pboundary;
-                    for (typename std::vector<B>::const_iterator boundary = boundaries.begin(); boundary != boundaries.end(); boundary++)
-                    {
-                        Intersection new_intersection = boundary->figure()->intersection(points[p], points[next_cw]);
-                        if (new_intersection.valid && (!intersection.valid || ((new_intersection.coord-points[p]).squared_norm() < (intersection.coord-points[p]).squared_norm())))
-                        {
-                            intersection = new_intersection;
-                            pboundary = &(*boundary);
-                        }
-                    }
-                    const FacePosition neighbor = get_face_neighbor(parameters, { cell->first, next_cw });
-                    typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator find = active.find(neighbor.position);
-                    cell->second.faces[next_cw].probed = true;
-                    find->second.faces[neighbor.face].probed = true;
-                    if (intersection.valid)
-                    {
-                        cell->second.faces[next_cw].intersection    = find->second.faces[neighbor.face].intersection= intersection;
-                        cell->second.faces[next_cw].boundary        = find->second.faces[neighbor.face].boundary    = pboundary;
-                        cell->second.intersection                   = find->second.intersection                     = intersection;
-                        cell->second.boundary                       = find->second.boundary                         = pboundary;
-                    }
-                }
-                if (!cell->second.faces[next_cw].intersection.valid && cell->second.points[next_cw].status == PointStatus::unreached)
-                {
-                    cell->second.points[next_cw].status = PointStatus::to_be_active;
-                    const std::array<PointPosition, 6> neighbors = get_point_neighbors(parameters, { cell->first, next_cw });
-                    for (std::array<PointPosition, 6>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end() && neighbor->point < 100; neighbor++)
-                    {
-                        if (to_be_active.find(neighbor->position) != to_be_active.end()) //to_be_active points remain to_be_active
-                        {
-                            to_be_active.find(neighbor->position)->second.points[neighbor->point].status = PointStatus::to_be_active;
-                        }
-                        else if (active.find(neighbor->position) != active.end()) //Active points remain active
-                        {
-                            active.find(neighbor->position)->second.points[neighbor->point].status = PointStatus::to_be_active;
-                        }
-                        else if (passive.find(neighbor->position) != passive.end()) //Passive points become to_be_active
-                        {
-                            passive.find(neighbor->position)->second.points[neighbor->point].status = PointStatus::to_be_active;
-                            to_be_active.insert(*passive.find(neighbor->position));
-                            passive.erase(neighbor->position);
-                        }
-                        else //Create to_be_active point
-                        {
-                            TemporaryCell<B, P, F, C> new_cell(parameters);
-                            new_cell.points[neighbor->point].status = PointStatus::to_be_active;
-                            to_be_active.insert({neighbor->position, new_cell});
-                        }
-                    }
-                }
-            }
-        }
+template <class B, class P, class F, class C> template <class S> void gg::CellGrid<B, P, F, C>::_generate(const CellGridParameters &parameters, const std::vector<B> &boundaries, S &statistics)
+{
+    if (parameters.parts != 1 || parameters.part != 0)
+    {
+        if (parameters.part >= parameters.parts) throw std::runtime_error("gg::CellGrid::CellGrid(): Invalid part");
+        if (parameters.refinement > 0) throw std::runtime_error("gg::CellGrid::CellGrid(): Refined grid cannot be partitioned");
+        if (parameters.incremental) throw std::runtime_error("gg::CellGrid::CellGrid(): Incremental grid cannot be partitioned");
+        if (parameters.ordering != Ordering::lattice) throw std::runtime_error("gg::CellGrid::CellGrid(): Partitioned grid cannot be reordered");
+    }
+    ThreadPool pool(get_threads(parameters));
+    if (parameters.refinement > 0)
+    {
+        if (parameters.incremental) throw std::runtime_error("gg::CellGrid::CellGrid(): Refined grid cannot be incremental");
+        if (parameters.locator) throw std::runtime_error("gg::CellGrid::CellGrid(): Refined grid cannot have locator");
+        _parameters = parameters;
+        _generate_refined(parameters, boundaries, pool, statistics);
+        return;
+    }
+    switch (parameters.typ)
+    {
+        case GridType::triangular: _generate<LatticeTraits<GridType::triangular>>(parameters, boundaries, nullptr, pool, statistics); break;
+        case GridType::hexagonal: _generate<LatticeTraits<GridType::hexagonal>>(parameters, boundaries, nullptr, pool, statistics); break;
+        default: _generate<LatticeTraits<GridType::square>>(parameters, boundaries, nullptr, pool, statistics); break;
+    }
+}
 
-        //Add fresh active cells
-        active.insert(to_be_active.begin(), to_be_active.end());
+template <class B, class P, class F, class C> template <class L, class S> void gg::CellGrid<B, P, F, C>::_generate(const CellGridParameters &parameters, const std::vector<B> &boundaries, const std::vector<PointPosition> *seeds, ThreadPool &pool, S &statistics)
+{
+    //STAGES 0-4: search cells and calculate their area, partitioned grids search only around cells of the part
+    std::vector<Position> part_positions;
+    if (parameters.parts > 1) _partition_cells<L>(parameters, boundaries, part_positions, statistics);
+    _search<L>(parameters, boundaries, seeds, (parameters.parts > 1) ? &part_positions : nullptr, pool, statistics);
+    TemporaryLattice<B, L> &state = static_cast<TemporaryLattice<B, L>&>(*_lattice);
+    std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells = state.cells;
+    std::vector<TemporaryVertex> &vertices = state.vertices;
+    std::vector<TemporaryEdge<B>> &edges = state.edges;
+    const Lattice lattice(parameters);
+    const auto lookup = [&](std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells, Position position) -> typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator
+    {
+        statistics.lookup();
+        return cells.find(position);
+    };
 
-        //Make to_be_active points active, make active points passive, divide active into new_active and passive
-        std::map<Position, TemporaryCell<B, P, F, C>> new_active;
-        for (typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator cell = active.begin(); cell != active.end(); cell++)
+    //STAGE 5: create cells
+    statistics.begin("cells");
+    typedef std::pair<const Position, TemporaryCell<B, L>> Entry;
+    std::vector<Entry*> complete;   //Complete cells in order of their indexes
+    if (parameters.parts > 1)
+    {
+        //Only cells of the part and its ghost layers are created, in order of the partition
+        complete.resize(part_positions.size());
+        for (unsigned int c = 0; c < part_positions.size(); c++)
         {
-            bool active = false;
-            for (unsigned int p = 0; p < get_shape(parameters); p++)
-            {
-                if (cell->second.points[p].status == PointStatus::to_be_active)
-                {
-                    cell->second.points[p].status = PointStatus::active;
-                    active = true;
-                }
-                else if (cell->second.points[p].status == PointStatus::active)
-                {
-                    cell->second.points[p].status = PointStatus::passive;
-                }
-            }
-            if (active) new_active.insert(*cell);
-            else passive.insert(*cell);
+            const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, part_positions[c]);
+            if (cell == cells.end() || !cell->second.complete) throw std::runtime_error("gg::CellGrid::CellGrid(): Part does not match the lattice");
+            cell->second.cell = c;
+            complete[c] = &*cell;
         }
-        active = new_active;
     }
-
-    //STAGE 3: calculate area
-    for (typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator cell = passive.begin(); cell != passive.end(); cell++)
+    else
     {
-        bool complete = true;
-        for (unsigned int p = 0; p < get_shape(parameters); p++)
+        const std::vector<Entry*> entries = state.ordered();
+        for (typename std::vector<Entry*>::const_iterator entry = entries.begin(); entry != entries.end(); entry++)
         {
-            if (cell->second.points[p].status != PointStatus::passive || !cell->second.faces[p].intersection.valid) { complete = false; break; }
+            if (!(*entry)->second.complete) continue;
+            (*entry)->second.cell = (unsigned int)complete.size();
+            complete.push_back(*entry);
         }
-        if (complete)
+    }
+    const unsigned int cell_count = (unsigned int)complete.size();
+    //In objects mode, objects are created directly from the lattice and only topology is stored in arrays, unless ordering or geometry need the arrays
+    const bool direct = parameters.storage == Storage::objects && parameters.ordering == Ordering::lattice && !parameters.geometry;
+    std::vector<P*> &point_objects = _point_objects;
+    std::vector<F*> &face_objects = _face_objects;
+    std::vector<C*> &cell_objects = _cell_objects;
+    std::vector<const TemporaryCell<B, L>*> cell_sources;
+    if (direct)
+    {
+        cell_objects.resize(cell_count);
+        _cell_arena.reserve(cell_count);
+        for (unsigned int c = 0; c < cell_count; c++)
         {
-            //Complete cell, no calculations needed
-            cell->second.complete = true;
-            cell->second.area = area;
-            cell->second.center = get_center(parameters, cell->first);
+            const TemporaryCell<B, L> &cell = complete[c]->second;
+            if (cell.boundary == nullptr) cell_objects[c] = _cell_arena.create(cell.center, cell.area);
+            else cell_objects[c] = _cell_arena.create(cell.center, cell.area, cell.intersection, cell.boundary);
+            _cells.insert(cell_objects[c]);
         }
-        else
+    }
+    else
+    {
+        cell_sources.resize(cell_count);
+        _indexed.cell_centers.resize(cell_count);
+        _indexed.cell_areas.resize(cell_count);
+        _indexed.cell_boundaries.resize(cell_count);
+        parallel_for(pool, cell_count, [&](unsigned int c)
         {
-            //Create list of points
-            std::array<Vector, 6> points = get_points(parameters, cell->first);
-            std::array<Vector, 12> point_list;
-            unsigned int point_list_size = 0;
-            for (unsigned int p = 0; p < get_shape(parameters); p++)
-            {
-                unsigned int next_ccw = ((p == (get_shape(parameters) - 1)) ? 0 : (p + 1));
-                if (cell->second.points[p].status == PointStatus::passive) point_list[point_list_size++] = points[p];
-                if (cell->second.points[p].status != cell->second.points[next_ccw].status) point_list[point_list_size++] = cell->second.faces[p].intersection.coord;
-            }
-
-            //Calculate area
-            cell->second.area = 0;
-            cell->second.center = Vector(0, 0);
-            for (unsigned int p = 1; p < (point_list_size - 1); p++)
-            {
-                double a = (point_list[p] - point_list[0]).norm();
-                double b = (point_list[p+1] - point_list[0]).norm();
-                double c = (point_list[p+1] - point_list[p]).norm();
-                double s = 0.5 * (a + b + c);
-                double local_area = sqrt(s * (s - a) * (s - b) * (s - c));
-                Vector local_center = (point_list[0] + point_list[p] + point_list[p+1]) / 3;
-                cell->second.area = cell->second.area + local_area;
-                cell->second.center = cell->second.center + (local_center * local_area);
-            }
-            cell->second.center = cell->second.center / cell->second.area;
-            if (parameters.threshold_area <= 0.0) cell->second.complete = true;
-            else if (parameters.threshold_area >= 1.0) cell->second.complete = false;
-            else cell->second.complete = (cell->second.area > (parameters.threshold_area * area));
-        }
+            const TemporaryCell<B, L> &cell = complete[c]->second;
+            _indexed.cell_centers[c] = cell.center;
+            _indexed.cell_areas[c] = cell.area;
+            _indexed.cell_boundaries[c] = (cell.boundary == nullptr) ? no_index : (unsigned int)(cell.boundary - &boundaries[0]);
+            cell_sources[c] = &cell;
+        });
     }
 
-    //STAGE 4: apply failed cells
-    for (typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator cell = passive.begin(); cell != passive.end(); cell++)
+    statistics.end();
+
+    //STAGE 6: create points
+    //Points are numbered serially in order of the first cell that has them, the cell owns the point and creates it in parallel, other cells only refer to it
+    statistics.begin("points");
+    std::vector<unsigned int> point_owners; //Owner cell and its slot (points, then faces) of every point
+    for (unsigned int c = 0; c < cell_count; c++)
     {
-        if (!cell->second.complete)
+        const TemporaryCell<B, L> &cell = complete[c]->second;
+        _indexed.side_offsets.push_back((unsigned int)_indexed.sides.size());
+        for (unsigned int p = 0; p < L::shape; p++)
         {
-            for (unsigned int f = 0; f < get_shape(parameters); f++)
+            TemporaryVertex &vertex = vertices[cell.vertices[p]];
+            if (vertex.status == PointStatus::passive)
             {
-                const FacePosition neighbor = get_face_neighbor(parameters, { cell->first, f });
-                typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator find = passive.find(neighbor.position);
-                if (find != passive.end() && find->second.complete)
+                if (vertex.point == no_index)
                 {
-                    find->second.intersection = cell->second.intersection;
-                    find->second.boundary = cell->second.boundary;
+                    vertex.point = (unsigned int)point_owners.size();
+                    point_owners.push_back(c * 2 * L::shape + p);
+                }
+                _indexed.sides.push_back({ vertex.point, no_index, no_index, false });
+            }
+            unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            if (vertex.status != vertices[cell.vertices[next_ccw]].status) //same as edge.intersection.valid ?
+            {
+                TemporaryEdge<B> &edge = edges[cell.edges[p]];
+                if (edge.point == no_index)
+                {
+                    edge.point = (unsigned int)point_owners.size();
+                    point_owners.push_back(c * 2 * L::shape + L::shape + p);
                 }
+                _indexed.sides.push_back({ edge.point, no_index, no_index, false });
             }
         }
     }
-
-    //STAGE 5: create cells
-    for (typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator cell = passive.begin(); cell != passive.end(); cell++)
+    _indexed.side_offsets.push_back((unsigned int)_indexed.sides.size());
+    const unsigned int point_count = (unsigned int)point_owners.size();
+    std::vector<const TemporaryEdge<B>*> point_sources; //Face where the point was found, nullptr for regular points
+    if (direct)
     {
-        if (!cell->second.complete) continue;
-
-        if (cell->second.boundary == nullptr) _cells.insert(cell->second.cell = new C(cell->second.center, cell->second.area));
-        else _cells.insert(cell->second.cell = new C(cell->second.center, cell->second.area, cell->second.intersection, cell->second.boundary));
+        point_objects.resize(point_count);
+        _point_arena.reserve(point_count);
+        for (unsigned int point = 0; point < point_count; point++)
+        {
+            const Entry &cell = *complete[point_owners[point] / (2 * L::shape)];
+            const unsigned int slot = point_owners[point] % (2 * L::shape);
+            if (slot < L::shape) point_objects[point] = _point_arena.create(lattice.points(cell.first)[slot]);
+            else
+            {
+                const TemporaryEdge<B> &edge = edges[cell.second.edges[slot - L::shape]];
+                point_objects[point] = _point_arena.create(edge.intersection, edge.boundary);
+            }
+            _points.insert(point_objects[point]);
+        }
     }
-
-    //STAGE 6: create points
-    for (typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator cell = passive.begin(); cell != passive.end(); cell++)
+    else
     {
-        if (cell->second.cell == nullptr) continue;
-
-        //For each point
-        std::array<Vector, 6> points = get_points(parameters, cell->first);
-        for (unsigned int p = 0; p < get_shape(parameters); p++)
+        point_sources.resize(point_count);
+        _indexed.point_coords.resize(point_count);
+        _indexed.point_normals.resize(point_count);
+        _indexed.point_boundaries.resize(point_count);
+        parallel_for(pool, point_count, [&](unsigned int point)
         {
-            //Regular points
-            if (cell->second.points[p].status == PointStatus::passive)
+            const Entry &cell = *complete[point_owners[point] / (2 * L::shape)];
+            const unsigned int slot = point_owners[point] % (2 * L::shape);
+            if (slot < L::shape)
             {
-                if (cell->second.points[p].point == nullptr)
-                {
-                    _points.insert(cell->second.points[p].point = new P(points[p]));
-                    const std::array<PointPosition, 6> neighbors = get_point_neighbors(parameters, { cell->first, p });
-                    for (std::array<PointPosition, 6>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end() && neighbor->point < 100; neighbor++)
-                        passive.find(neighbor->position)->second.points[neighbor->point].point = cell->second.points[p].point;
-                }
-                cell->second.cell->sides().push_back({ cell->second.points[p].point, nullptr, nullptr, false });
+                //Regular points
+                _indexed.point_coords[point] = lattice.points(cell.first)[slot];
+                _indexed.point_normals[point] = Vector(0, 0);
+                _indexed.point_boundaries[point] = no_index;
+                point_sources[point] = nullptr;
             }
-
-            //Points on faces
-            unsigned int next_ccw = ((p == (get_shape(parameters) - 1)) ? 0 : (p + 1));
-            if (cell->second.points[p].status != cell->second.points[next_ccw].status) //same as cell->second.points[p].intersection.valid ?
+            else
             {
-                if (cell->second.faces[p].point == nullptr)
-                {
-                    _points.insert(cell->second.faces[p].point = new P(cell->second.faces[p].intersection, cell->second.faces[p].boundary));
-                    const FacePosition neighbor = get_face_neighbor(parameters, { cell->first, p });
-                    passive.find(neighbor.position)->second.faces[neighbor.face].point = cell->second.faces[p].point;
-                }
-                cell->second.cell->sides().push_back({ cell->second.faces[p].point, nullptr, nullptr, false });
+                //Points on faces
+                const TemporaryEdge<B> &edge = edges[cell.second.edges[slot - L::shape]];
+                _indexed.point_coords[point] = edge.intersection.coord;
+                _indexed.point_normals[point] = edge.intersection.normal;
+                _indexed.point_boundaries[point] = (edge.boundary == nullptr) ? no_index : (unsigned int)(edge.boundary - &boundaries[0]);
+                point_sources[point] = &edge;
             }
-        }
+        });
     }
 
+    statistics.end();
+
     //STAGE 7: create faces
-    for (typename std::map<Position, TemporaryCell<B, P, F, C>>::iterator cell = passive.begin(); cell != passive.end(); cell++)
+    //Faces are numbered serially like points, their geometry and the neighbors of sides are found in parallel
+    statistics.begin("faces");
+    std::vector<const TemporaryEdge<B>*> face_sources; //Face where the boundary was found, nullptr for regular faces
+    const auto create_face = [&](unsigned int a, unsigned int b, const TemporaryEdge<B> *source) -> unsigned int
     {
-        if (cell->second.cell == nullptr) continue;
+        _indexed.face_points.push_back({ a, b });
+        face_sources.push_back(source);
+        return (unsigned int)(_indexed.face_points.size() - 1);
+    };
+    for (unsigned int c = 0; c < cell_count; c++)
+    {
+        const TemporaryCell<B, L> &cell = complete[c]->second;
 
         //Creating faces
-        P *irregular_face_start = nullptr;
+        IndexedSide *sides = &_indexed.sides[_indexed.side_offsets[c]];
+        unsigned int irregular_face_start = no_index;
         unsigned int side_counter = 0;
-        for (unsigned int p = 0; p < get_shape(parameters); p++)
+        for (unsigned int p = 0; p < L::shape; p++)
         {
-            unsigned int next_ccw = ((p == (get_shape(parameters) - 1)) ? 0 : (p + 1));
-            if (cell->second.points[p].status == PointStatus::passive || cell->second.points[next_ccw].status == PointStatus::passive)
+            unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            const TemporaryVertex &first = vertices[cell.vertices[p]], &second = vertices[cell.vertices[next_ccw]];
+            if (first.status == PointStatus::passive || second.status == PointStatus::passive)
             {
                 //At least one of the points is passive, the face should exist
-                const FacePosition neighbor = get_face_neighbor(parameters, { cell->first, p });
-                if (cell->second.faces[p].face == nullptr)
+                TemporaryEdge<B> &edge = edges[cell.edges[p]];
+                if (edge.face == no_index)
                 {
-                    //The face doesn't exist and needs to be created
-                    F *face;
-                    if (cell->second.points[p].status == PointStatus::passive && cell->second.points[next_ccw].status != PointStatus::passive)
+                    //The face doesn't exist and needs to be created, once for both cells that share it
+                    if (first.status == PointStatus::passive && second.status != PointStatus::passive)
                     {
                         //First point is normal point, second point is face point
-                        face = new F(cell->second.points[p].point, cell->second.faces[p].point, cell->second.faces[p].intersection, cell->second.faces[p].boundary);
+                        edge.face = create_face(first.point, edge.point, &edge);
                     }
-                    else if (cell->second.points[p].status != PointStatus::passive && cell->second.points[next_ccw].status == PointStatus::passive)
+                    else if (first.status != PointStatus::passive && second.status == PointStatus::passive)
                     {
                         //First point is face point, second point is normal point
-                        face = new F(cell->second.points[next_ccw].point, cell->second.faces[p].point, cell->second.faces[p].intersection, cell->second.faces[p].boundary);
+                        edge.face = create_face(second.point, edge.point, &edge);
                     }
                     else
                     {
                         //Normal regular face
-                        face = new F(cell->second.points[p].point, cell->second.points[next_ccw].point);
+                        edge.face = create_face(first.point, second.point, nullptr);
                     }
-                    _faces.insert(face);
-                    cell->second.faces[p].face = face;
-                    passive.find(neighbor.position)->second.faces[neighbor.face].face = face;;
                 }
 
                 //Now when regular faces are created, one can decide what to do with it
-                if (cell->second.points[p].status != PointStatus::passive && cell->second.points[next_ccw].status == PointStatus::passive)
+                if (first.status != PointStatus::passive && second.status == PointStatus::passive)
                 {
                     //First point is face point, second point is normal point -> Close irregular face and add normal face
-                    if (irregular_face_start != nullptr)
+                    if (irregular_face_start != no_index)
                     {
-                        F *irregular_face = new F(irregular_face_start, cell->second.faces[p].point, cell->second.faces[p].intersection, cell->second.faces[p].boundary);
-                        _faces.insert(irregular_face);
-                        cell->second.cell->sides()[side_counter].face = irregular_face;
+                        sides[side_counter].face = create_face(irregular_face_start, edge.point, &edge);
                         side_counter++;
-                        irregular_face_start = nullptr;
+                        irregular_face_start = no_index;
                     }
-                    cell->second.cell->sides()[side_counter].face = cell->second.faces[p].face;
-                    cell->second.cell->sides()[side_counter].cell = passive.find(neighbor.position)->second.cell;
+                    sides[side_counter].face = edge.face;
                     side_counter++;
                 }
-                else if (cell->second.points[p].status == PointStatus::passive && cell->second.points[next_ccw].status != PointStatus::passive)
+                else if (first.status == PointStatus::passive && second.status != PointStatus::passive)
                 {
                     //First point is normal point, second point is face point -> Add normal face and open irregular face
-                    cell->second.cell->sides()[side_counter].face = cell->second.faces[p].face;
-                    cell->second.cell->sides()[side_counter].cell = passive.find(neighbor.position)->second.cell;
+                    sides[side_counter].face = edge.face;
                     side_counter++;
 
-                    irregular_face_start = cell->second.faces[p].point;
+                    irregular_face_start = edge.point;
                 }
                 else
                 {
                     //Normal regular face -> just add it
-                    cell->second.cell->sides()[side_counter].face = cell->second.faces[p].face;
-                    cell->second.cell->sides()[side_counter].cell = passive.find(neighbor.position)->second.cell;
+                    sides[side_counter].face = edge.face;
                     side_counter++;
                 }
             }
         }
         //Closing open irregular face
-        if (irregular_face_start != nullptr)
+        if (irregular_face_start != no_index)
         {
-            for (unsigned int p = 0; p < get_shape(parameters); p++)
+            for (unsigned int p = 0; p < L::shape; p++)
             {
-                if (cell->second.faces[p].point != nullptr)
+                const TemporaryEdge<B> &edge = edges[cell.edges[p]];
+                if (edge.point != no_index)
                 {
-                    F *irregular_face = new F(irregular_face_start, cell->second.faces[p].point, cell->second.faces[p].intersection, cell->second.faces[p].boundary);
-                    _faces.insert(irregular_face);
-                    cell->second.cell->sides()[side_counter].face = irregular_face;
+                    sides[side_counter].face = create_face(irregular_face_start, edge.point, &edge);
                     break;
                 }
             }
         }
-    } 
+    }
+    const unsigned int face_count = (unsigned int)_indexed.face_points.size();
+    if (direct)
+    {
+        face_objects.resize(face_count);
+        _face_arena.reserve(face_count);
+        for (unsigned int face = 0; face < face_count; face++)
+        {
+            P *a = point_objects[_indexed.face_points[face][0]], *b = point_objects[_indexed.face_points[face][1]];
+            if (face_sources[face] == nullptr) face_objects[face] = _face_arena.create(a, b);
+            else face_objects[face] = _face_arena.create(a, b, face_sources[face]->intersection, face_sources[face]->boundary);
+            _faces.insert(face_objects[face]);
+        }
+    }
+    else
+    {
+        _indexed.face_centers.resize(face_count);
+        _indexed.face_normals.resize(face_count);
+        _indexed.face_lengths.resize(face_count);
+        _indexed.face_boundaries.resize(face_count);
+        parallel_for(pool, face_count, [&](unsigned int face)
+        {
+            const Vector a_coord = _indexed.point_coords[_indexed.face_points[face][0]], b_coord = _indexed.point_coords[_indexed.face_points[face][1]];
+            _indexed.face_centers[face] = (a_coord + b_coord) * 0.5;
+            _indexed.face_normals[face] = rotate_ccw(a_coord - b_coord);
+            _indexed.face_lengths[face] = (a_coord - b_coord).norm();
+            const TemporaryEdge<B> *source = face_sources[face];
+            _indexed.face_boundaries[face] = (source == nullptr || source->boundary == nullptr) ? no_index : (unsigned int)(source->boundary - &boundaries[0]);
+        });
+    }
+    parallel_for(pool, cell_count, [&](unsigned int c)
+    {
+        //Sides of regular faces lead to neighbors, sides of irregular faces lead nowhere
+        const Entry &cell = *complete[c];
+        IndexedSide *sides = &_indexed.sides[_indexed.side_offsets[c]];
+        bool irregular = false;
+        unsigned int side_counter = 0;
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            const PointStatus first = vertices[cell.second.vertices[p]].status, second = vertices[cell.second.vertices[next_ccw]].status;
+            if (first != PointStatus::passive && second != PointStatus::passive) continue;
+            if (first != PointStatus::passive && irregular) { side_counter++; irregular = false; }
+            else if (first == PointStatus::passive && second != PointStatus::passive) irregular = true;
+            const FacePosition neighbor = L::face_neighbor({ cell.first, p });
+            sides[side_counter++].cell = lookup(cells, neighbor.position)->second.cell;
+        }
+    });
+
+    statistics.memory(_memory<L>(cells.size()));
+    statistics.end();
+
+    //Ordering, lattice state follows the new indexes so that update can compare them
+    if (parameters.ordering != Ordering::lattice)
+    {
+        statistics.begin("ordering");
+        const GridReordering reordering = reorder(_indexed, get_cell_order(_indexed, parameters, parameters.ordering));
+        permute(complete, reordering.cell_map);
+        permute(cell_sources, reordering.cell_map);
+        permute(point_sources, reordering.point_map);
+        permute(face_sources, reordering.face_map);
+        for (unsigned int c = 0; c < cell_count; c++) complete[c]->second.cell = c;
+        for (std::vector<TemporaryVertex>::iterator vertex = vertices.begin(); vertex != vertices.end(); vertex++)
+        {
+            if (vertex->point != no_index) vertex->point = reordering.point_map[vertex->point];
+        }
+        for (typename std::vector<TemporaryEdge<B>>::iterator edge = edges.begin(); edge != edges.end(); edge++)
+        {
+            if (edge->point != no_index) edge->point = reordering.point_map[edge->point];
+            if (edge->face != no_index) edge->face = reordering.face_map[edge->face];
+        }
+        statistics.end();
+    }
+
+    //Locator, cells that are not whole lattice elements keep their polygons
+    if (parameters.locator)
+    {
+        statistics.begin("locator");
+        _locator = CellLocator(parameters);
+        std::vector<Vector> polygon;
+        for (unsigned int c = 0; c < cell_count; c++)
+        {
+            const Entry &cell = *complete[c];
+            bool whole = true;
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                if (vertices[cell.second.vertices[p]].status != PointStatus::passive || edges[cell.second.edges[p]].intersection.valid) { whole = false; break; }
+            }
+            polygon.clear();
+            if (!whole)
+            {
+                for (unsigned int s = _indexed.side_offsets[c]; s < _indexed.side_offsets[c + 1]; s++)
+                {
+                    const unsigned int point = _indexed.sides[s].point;
+                    polygon.push_back(direct ? point_objects[point]->coord() : _indexed.point_coords[point]);
+                }
+            }
+            _locator.insert(cell.first, c, polygon);
+        }
+        statistics.end();
+    }
 
-    //STAGE 8: calculating if faces are flipped
-    for (typename std::set<C*>::iterator icell = _cells.begin(); icell != _cells.end(); icell++)
+    //Update finds cells by their indexes
+    if (parameters.incremental)
     {
-        C *cell = *icell;
-        for (unsigned int f = 0; f < cell->sides().size(); f++) cell->sides()[f].inwards = ((cell->center() - cell->sides()[f].face->center()).dot(cell->sides()[f].face->normal()) >= 0.0);
+        state.cell_positions.resize(cell_count);
+        for (unsigned int c = 0; c < cell_count; c++) state.cell_positions[c] = complete[c]->first;
     }
-}
 
-template <class B, class P, class F, class C>std::set<P*> &gg::CellGrid<B, P, F, C>::points()
-{
-    return _points;
+    //STAGES 8-10: calculate flips and connectivity, create objects
+    _connect(point_count, pool, statistics);
+    if (direct)
+    {
+        statistics.begin("objects");
+        _create_sides();
+        statistics.end();
+    }
+    else if (parameters.storage == Storage::objects) _create_objects(point_sources, face_sources, cell_sources, statistics);
+    if (!parameters.incremental) _lattice.reset();
 }
 
-template <class B, class P, class F, class C>std::set<F*> &gg::CellGrid<B, P, F, C>::faces()
+template <class B, class P, class F, class C> template <class L, class S> void gg::CellGrid<B, P, F, C>::_partition_cells(const CellGridParameters &parameters, const std::vector<B> &boundaries, std::vector<Position> &local_positions, S &statistics)
 {
-    return _faces;
-}
+    //Cells of the whole domain are taken from the lattice view, which stores only cells cut by boundaries
+    //Global indexes follow the order of positions (X index first), like in the grid generated without partitioning
+    statistics.begin("partition");
+    CellGridParameters view_parameters = parameters;
+    view_parameters.parts = 1;
+    view_parameters.part = 0;
+    const LatticeView<B> view(view_parameters, boundaries);
+    const unsigned int cell_count = view.size();
+    const unsigned int part = parameters.part, parts = parameters.parts;
 
-template <class B, class P, class F, class C>std::set<C*> &gg::CellGrid<B, P, F, C>::cells()
-{
-    return _cells;
-}
\ No newline at end of file
+    //View cells are ordered by Y index, so counting them by columns keeps the order of positions within columns
+    std::vector<Vector> centers(cell_count);
+    std::vector<unsigned int> globals(cell_count);
+    int xmin = INT_MAX, xmax = INT_MIN;
+    for (typename LatticeView<B>::Iterator cell = view.begin(); cell != view.end(); ++cell)
+    {
+        const ViewCell view_cell = *cell;
+        centers[cell.index()] = view_cell.center;
+        xmin = std::min(xmin, view_cell.position.xi);
+        xmax = std::max(xmax, view_cell.position.xi);
+    }
+    if (cell_count > 0)
+    {
+        std::vector<unsigned int> column_offsets(xmax - xmin + 2, 0);
+        for (typename LatticeView<B>::Iterator cell = view.begin(); cell != view.end(); ++cell) column_offsets[(*cell).position.xi - xmin + 1]++;
+        for (unsigned int x = 1; x < column_offsets.size(); x++) column_offsets[x] += column_offsets[x - 1];
+        for (typename LatticeView<B>::Iterator cell = view.begin(); cell != view.end(); ++cell) globals[cell.index()] = column_offsets[(*cell).position.xi - xmin]++;
+    }
+    std::vector<unsigned int> order(cell_count);
+    for (unsigned int c = 0; c < cell_count; c++) order[globals[c]] = c;
+
+    //Neighbors through faces, faces of cut cells exist if one of their points is inside
+    const auto get_neighbors = [&](unsigned int c, std::array<unsigned int, L::shape> &neighbors)
+    {
+        const ViewCell cell = view.cell(c);
+        neighbors.fill(no_index);
+        for (unsigned int s = 0; s < cell.point_count; s++)
+        {
+            if (cell.faces[s] == no_index) continue;
+            statistics.lookup();
+            neighbors[cell.faces[s]] = view.find(L::face_neighbor({ cell.position, cell.faces[s] }).position);
+        }
+    };
+    std::array<unsigned int, L::shape> neighbors;
+
+    //Owners, and distances of cells from the part, measured in face neighbors
+    const std::vector<unsigned int> owners = get_cell_parts(centers, parts);
+    std::vector<unsigned int> layers(cell_count, no_index);
+    std::vector<unsigned int> front, next_front;
+    for (unsigned int c = 0; c < cell_count; c++)
+    {
+        if (owners[c] == part) { layers[c] = 0; front.push_back(c); }
+    }
+    for (unsigned int layer = 1; layer <= parameters.ghost_layers && !front.empty(); layer++)
+    {
+        next_front.clear();
+        for (std::vector<unsigned int>::const_iterator c = front.begin(); c != front.end(); c++)
+        {
+            get_neighbors(*c, neighbors);
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const unsigned int neighbor = neighbors[p];
+                if (neighbor != no_index && layers[neighbor] == no_index) { layers[neighbor] = layer; next_front.push_back(neighbor); }
+            }
+        }
+        front.swap(next_front);
+    }
+
+    //Local cells, owned cells followed by ghosts
+    _partition = CellPartition();
+    _partition.parts = parts;
+    _partition.part = part;
+    std::vector<unsigned int> local_cells(cell_count, no_index);
+    local_positions.clear();
+    for (unsigned int pass = 0; pass < 2; pass++)
+    {
+        for (unsigned int global = 0; global < cell_count; global++)
+        {
+            const unsigned int c = order[global];
+            if (layers[c] == no_index || (owners[c] == part) != (pass == 0)) continue;
+            local_cells[c] = (unsigned int)_partition.global_cells.size();
+            _partition.global_cells.push_back(global);
+            _partition.cell_parts.push_back(owners[c]);
+            local_positions.push_back(view.cell(c).position);
+        }
+        if (pass == 0) _partition.owned = (unsigned int)_partition.global_cells.size();
+    }
+
+    //Ghosts are received from their owners
+    _partition.receive_offsets.assign(parts + 1, 0);
+    for (unsigned int cell = _partition.owned; cell < _partition.global_cells.size(); cell++) _partition.receive_offsets[_partition.cell_parts[cell] + 1]++;
+    for (unsigned int p = 0; p < parts; p++) _partition.receive_offsets[p + 1] += _partition.receive_offsets[p];
+    _partition.receive_cells.resize(_partition.receive_offsets.back());
+    {
+        std::vector<unsigned int> receive_counters(_partition.receive_offsets.begin(), _partition.receive_offsets.end() - 1);
+        for (unsigned int cell = _partition.owned; cell < _partition.global_cells.size(); cell++) _partition.receive_cells[receive_counters[_partition.cell_parts[cell]]++] = cell;
+    }
+
+    //Owned cells are sent to parts they are ghosts of, paths to these parts lie inside of local cells
+    std::vector<unsigned int> visited(cell_count, no_index);
+    std::vector<unsigned int> sent;
+    _partition.send_offsets.push_back(0);
+    for (unsigned int p = 0; p < parts; p++)
+    {
+        sent.clear();
+        front.clear();
+        for (unsigned int r = _partition.receive_offsets[p]; r < _partition.receive_offsets[p + 1]; r++)
+        {
+            const unsigned int c = order[_partition.global_cells[_partition.receive_cells[r]]];
+            visited[c] = p;
+            front.push_back(c);
+        }
+        for (unsigned int layer = 1; layer <= parameters.ghost_layers && !front.empty(); layer++)
+        {
+            next_front.clear();
+            for (std::vector<unsigned int>::const_iterator c = front.begin(); c != front.end(); c++)
+            {
+                get_neighbors(*c, neighbors);
+                for (unsigned int q = 0; q < L::shape; q++)
+                {
+                    const unsigned int neighbor = neighbors[q];
+                    if (neighbor == no_index || local_cells[neighbor] == no_index || visited[neighbor] == p) continue;
+                    visited[neighbor] = p;
+                    next_front.push_back(neighbor);
+                    if (owners[neighbor] == part) sent.push_back(local_cells[neighbor]);
+                }
+            }
+            front.swap(next_front);
+        }
+        std::sort(sent.begin(), sent.end());
+        _partition.send_cells.insert(_partition.send_cells.end(), sent.begin(), sent.end());
+        _partition.send_offsets.push_back((unsigned int)_partition.send_cells.size());
+    }
+    statistics.memory(view.memory() + cell_count * (sizeof(Vector) + 6 * sizeof(unsigned int)));
+    statistics.end();
+}
+
+template <class B, class P, class F, class C> template <class L, class S> void gg::CellGrid<B, P, F, C>::_search(const CellGridParameters &parameters, const std::vector<B> &boundaries, const std::vector<PointPosition> *seeds, const std::vector<Position> *part, ThreadPool &pool, S &statistics)
+{
+    //STAGE 0: declare sets and variables
+    statistics.begin("index");
+    if (seeds == nullptr)
+    {
+        _parameters = parameters;
+        _lattice.reset(new TemporaryLattice<B, L>());
+        if (parameters.incremental)
+        {
+            _boundaries = boundaries.empty() ? nullptr : &boundaries[0];
+            _bounds.resize(boundaries.size());
+            for (unsigned int i = 0; i < boundaries.size(); i++) _bounds[i] = BoundaryTraits<B>::bounds(boundaries[i]);
+        }
+    }
+    const Lattice lattice(parameters);
+    const double area = lattice.area();
+    const BoundaryIndex<B> index(parameters, boundaries);
+    TemporaryLattice<B, L> &state = static_cast<TemporaryLattice<B, L>&>(*_lattice);
+    std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells = state.cells;
+    std::vector<TemporaryVertex> &vertices = state.vertices;
+    std::vector<TemporaryEdge<B>> &edges = state.edges;
+    const auto lookup = [&](std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells, Position position) -> typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator
+    {
+        statistics.lookup();
+        return cells.find(position);
+    };
+
+    const auto identify = [&](Position position) -> TemporaryIds<L>&
+    {
+        statistics.lookup();
+        return state.ids[position];
+    };
+
+    //Cells are created once, their points and faces are found in the tables by canonical positions, or added to the tables if they are not there yet
+    //Tables may grow on creation, so vertices and edges are addressed by indexes and not held by reference
+    const auto create = [&](Position position) -> typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator
+    {
+        typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, position);
+        if (cell != cells.end()) return cell;
+        TemporaryCell<B, L> new_cell;
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            const PointPosition point = L::canonical_point({ position, p });
+            unsigned int &vertex = identify(point.position).vertices[point.point];
+            if (vertex == no_index)
+            {
+                vertex = (unsigned int)vertices.size();
+                vertices.push_back(TemporaryVertex());
+            }
+            vertices[vertex].cells++;
+            new_cell.vertices[p] = vertex;
+
+            const FacePosition face = L::canonical_face({ position, p });
+            unsigned int &edge = identify(face.position).edges[face.face];
+            if (edge == no_index)
+            {
+                edge = (unsigned int)edges.size();
+                edges.push_back(TemporaryEdge<B>());
+            }
+            edges[edge].cells++;
+            new_cell.edges[p] = edge;
+        }
+        statistics.allocation();
+        if (seeds != nullptr) state.touched.push_back(position);
+        return cells.insert({ position, new_cell }).first;
+    };
+
+    //Saves the result of the probe to the face and to both cells that share it
+    typedef std::pair<const Position, TemporaryCell<B, L>> Entry;
+    const auto save = [&](Entry &cell, unsigned int face, Intersection intersection, const B *pboundary)
+    {
+        TemporaryEdge<B> &edge = edges[cell.second.edges[face]];
+        edge.probed = true;
+        if (!intersection.valid) return;
+        edge.intersection = intersection;
+        edge.boundary = pboundary;
+        cell.second.intersection = intersection;
+        cell.second.boundary = pboundary;
+        const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator neighbor = lookup(cells, L::face_neighbor({ cell.first, face }).position);
+        if (neighbor == cells.end()) return; //Neighbor lies outside of the window of the part
+        neighbor->second.intersection = intersection;
+        neighbor->second.boundary = pboundary;
+    };
+
+    //Faces that are about to be probed are probed in parallel beforehand, the serial algorithm then takes the results
+    //Results are taken only if the probe is exactly the same, so they never differ from the serial ones
+    std::vector<TemporaryProbe<B>> probes;
+    const auto speculate = [&](unsigned int edge, Vector a, Vector b)
+    {
+        if (edges[edge].probe != no_index) return;
+        TemporaryProbe<B> probe;
+        probe.edge = edge;
+        probe.a = a;
+        probe.b = b;
+        edges[edge].probe = (unsigned int)probes.size();
+        probes.push_back(probe);
+    };
+    const auto run_speculative = [&]()
+    {
+        parallel_for(pool, (unsigned int)probes.size(), [&](unsigned int i)
+        {
+            probes[i].intersection = index.intersection(probes[i].a, probes[i].b, probes[i].boundary, statistics);
+        });
+    };
+    const auto probe = [&](unsigned int edge, Vector a, Vector b, const B *&pboundary) -> Intersection
+    {
+        if (edges[edge].probe != no_index)
+        {
+            const TemporaryProbe<B> &probe = probes[edges[edge].probe];
+            if (probe.a.x == a.x && probe.a.y == a.y && probe.b.x == b.x && probe.b.y == b.y)
+            {
+                pboundary = probe.boundary;
+                return probe.intersection;
+            }
+        }
+        return index.intersection(a, b, pboundary, statistics);
+    };
+    const auto clear_speculative = [&]()
+    {
+        for (typename std::vector<TemporaryProbe<B>>::iterator probe = probes.begin(); probe != probes.end(); probe++) edges[probe->edge].probe = no_index;
+        probes.clear();
+    };
+    statistics.end();
+
+    if (seeds != nullptr || (parameters.generation == Generation::flood_fill && part == nullptr))
+    {
+        std::vector<Entry*> active, to_be_active;                       //Cells with active and to_be_active points, ordered by position
+        std::vector<unsigned int> active_points, to_be_active_points;   //Active and to_be_active points
+        const auto reach = [&](PointPosition point, PointStatus status, std::vector<Entry*> &status_cells, std::vector<unsigned int> &status_points)
+        {
+            typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = create(point.position);
+            const unsigned int vertex = cell->second.vertices[point.point];
+            if (vertices[vertex].status == status) return;
+            vertices[vertex].status = status;
+            status_points.push_back(vertex);
+            status_cells.push_back(&*cell);
+            const std::array<PointPosition, 6> neighbors = L::point_neighbors(point);
+            for (std::array<PointPosition, 6>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end() && neighbor->point < 100; neighbor++)
+                status_cells.push_back(&*create(neighbor->position));
+        };
+        const auto order = [](std::vector<Entry*> &list)
+        {
+            std::sort(list.begin(), list.end(), [](const Entry *a, const Entry *b) { return a->first < b->first; });
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+        };
+
+        //STAGE 1: add first cells (or cells of points prepared by update)
+        statistics.begin("flood fill");
+        if (seeds != nullptr)
+        {
+            for (std::vector<PointPosition>::const_iterator seed = seeds->begin(); seed != seeds->end(); seed++) reach(*seed, PointStatus::active, active, active_points);
+        }
+        else reach({ Position(), 0 }, PointStatus::active, active, active_points);
+        order(active);
+
+        //STAGE 2: add all cells
+        while (!active.empty())
+        {
+            statistics.wave();
+
+            //Speculatively probe unprobed faces around active points
+            for (typename std::vector<Entry*>::iterator entry = active.begin(); entry != active.end() && pool.threads() > 1; entry++)
+            {
+                Entry *cell = *entry;
+                std::array<Vector, 6> points = lattice.points(cell->first);
+                for (unsigned int p = 0; p < L::shape; p++)
+                {
+                    if (vertices[cell->second.vertices[p]].status != PointStatus::active) continue;
+                    const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                    const unsigned int next_cw = ((p == 0) ? (L::shape - 1) : (p - 1));
+                    if (!edges[cell->second.edges[p]].probed) speculate(cell->second.edges[p], points[p], points[next_ccw]);
+                    if (!edges[cell->second.edges[next_cw]].probed) speculate(cell->second.edges[next_cw], points[p], points[next_cw]);
+                }
+            }
+            run_speculative();
+
+            //Iterate through active, probe unprobed faces, reach points behind free faces
+            for (typename std::vector<Entry*>::iterator entry = active.begin(); entry != active.end(); entry++)
+            {
+                Entry *cell = *entry;
+                std::array<Vector, 6> points = lattice.points(cell->first);
+                for (unsigned int p = 0; p < L::shape; p++)
+                {
+                    if (vertices[cell->second.vertices[p]].status != PointStatus::active) continue;
+
+                    //Trying to probe counterclockwise, then clockwise
+                    const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                    const unsigned int next_cw = ((p == 0) ? (L::shape - 1) : (p - 1));
+                    const unsigned int faces[2] = { p, next_cw }, nexts[2] = { next_ccw, next_cw };
+                    for (unsigned int i = 0; i < 2; i++)
+                    {
+                        if (!edges[cell->second.edges[faces[i]]].probed)
+                        {
+                            const B *pboundary = nullptr;
+                            const Intersection intersection = probe(cell->second.edges[faces[i]], points[p], points[nexts[i]], pboundary);
+                            save(*cell, faces[i], intersection, pboundary);
+                        }
+                        if (!edges[cell->second.edges[faces[i]]].intersection.valid && vertices[cell->second.vertices[nexts[i]]].status == PointStatus::unreached)
+                            reach({ cell->first, nexts[i] }, PointStatus::to_be_active, to_be_active, to_be_active_points);
+                    }
+                }
+            }
+
+            clear_speculative();
+
+            //Make to_be_active points active, make active points passive
+            for (std::vector<unsigned int>::const_iterator vertex = active_points.begin(); vertex != active_points.end(); vertex++) vertices[*vertex].status = PointStatus::passive;
+            for (std::vector<unsigned int>::const_iterator vertex = to_be_active_points.begin(); vertex != to_be_active_points.end(); vertex++) vertices[*vertex].status = PointStatus::active;
+            active_points.swap(to_be_active_points);
+            to_be_active_points.clear();
+            order(to_be_active);
+            active.swap(to_be_active);
+            to_be_active.clear();
+            statistics.memory(_memory<L>(cells.size()));
+        }
+
+        //Cells forgotten by update may stay without reached points, only cells touched by update can change
+        if (seeds != nullptr)
+        {
+            std::sort(state.touched.begin(), state.touched.end());
+            state.touched.erase(std::unique(state.touched.begin(), state.touched.end()), state.touched.end());
+            for (std::vector<Position>::const_iterator position = state.touched.begin(); position != state.touched.end(); position++)
+            {
+                const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, *position);
+                if (cell == cells.end()) continue;
+                bool reached = false;
+                for (unsigned int p = 0; p < L::shape && !reached; p++) reached = (vertices[cell->second.vertices[p]].status == PointStatus::passive);
+                if (reached) continue;
+
+                //Points and faces that no cell shares anymore are removed from the tables, so cells created there later start with new ones
+                for (unsigned int p = 0; p < L::shape; p++)
+                {
+                    if (--vertices[cell->second.vertices[p]].cells == 0)
+                    {
+                        const PointPosition point = L::canonical_point({ *position, p });
+                        identify(point.position).vertices[point.point] = no_index;
+                    }
+                    if (--edges[cell->second.edges[p]].cells == 0)
+                    {
+                        const FacePosition face = L::canonical_face({ *position, p });
+                        identify(face.position).edges[face.face] = no_index;
+                    }
+                }
+                cells.erase(cell);
+            }
+        }
+        statistics.end();
+    }
+    else
+    {
+        //STAGE 1: add cells that have points between crossings, points are classified by rows of their canonical positions
+        statistics.begin("scanline");
+        Scanline<B> scanline(parameters, index);
+        const unsigned int layers = (parameters.typ == GridType::triangular) ? 2 : 1;
+        std::vector<TemporaryRow> rows;
+        Position zero, one;
+        one.yi = 1;
+        int ymin, ymax;
+        if (scanline.rows(lattice.center(zero), lattice.center(one), ymin, ymax))
+        {
+            //Canonical positions may lie in neighbor rows
+            const int row_ymin = ymin - 1, row_ymax = ymax + 1;
+
+            //Partitioned grids search only the window around cells of the part, it is one element larger so that neighbors of the part are searched too
+            int window_xmin = INT_MAX, window_xmax = INT_MIN, window_ymin = ymin, window_ymax = ymax;
+            if (part != nullptr)
+            {
+                window_ymin = INT_MAX;
+                window_ymax = INT_MIN;
+                for (std::vector<Position>::const_iterator position = part->begin(); position != part->end(); position++)
+                {
+                    window_xmin = std::min(window_xmin, position->xi - 1);
+                    window_xmax = std::max(window_xmax, position->xi + 1);
+                    window_ymin = std::max(ymin, std::min(window_ymin, position->yi - 1));
+                    window_ymax = std::min(ymax, std::max(window_ymax, position->yi + 1));
+                }
+            }
+            const int first_row = std::max(row_ymin, window_ymin - 1), last_row = std::min(row_ymax, window_ymax + 1);
+            rows.resize((row_ymax - row_ymin + 1) * layers * L::shape);
+
+            //Rows of canonical positions are the same in every cell, they are intersected in parallel beforehand
+            std::vector<unsigned int> canonical_rows;
+            for (unsigned int layer = 0; layer < layers; layer++)
+            {
+                Position position;
+                position.upside_down = (layer == 1);
+                for (unsigned int p = 0; p < L::shape; p++)
+                {
+                    const PointPosition canonical = L::canonical_point({ position, p });
+                    const unsigned int kind = (canonical.position.upside_down ? 1 : 0) * L::shape + canonical.point;
+                    if (std::find(canonical_rows.begin(), canonical_rows.end(), kind) == canonical_rows.end()) canonical_rows.push_back(kind);
+                }
+            }
+            parallel_for(pool, (unsigned int)(std::max(last_row - first_row + 1, 0) * canonical_rows.size()), [&](unsigned int i)
+            {
+                const unsigned int kind = canonical_rows[i % canonical_rows.size()];
+                Position row_zero, row_one;
+                row_zero.yi = first_row + (int)(i / canonical_rows.size());
+                row_zero.upside_down = (kind >= L::shape);
+                row_one = row_zero;
+                row_one.xi = 1;
+                const unsigned int point = kind % L::shape;
+                TemporaryRow &row = rows[(row_zero.yi - row_ymin) * layers * L::shape + kind];
+                int row_xmin, row_xmax;
+                row.valid = scanline.columns(lattice.points(row_zero)[point], lattice.points(row_one)[point], row_xmin, row_xmax, row.crossings);
+                row.ready = true;
+            });
+
+            for (int yi = window_ymin; yi <= window_ymax; yi++)
+            {
+                for (unsigned int layer = 0; layer < layers; layer++)
+                {
+                    zero.xi = 0; zero.yi = yi; zero.upside_down = (layer == 1);
+                    one = zero; one.xi = 1;
+                    int xmin, xmax;
+                    scanline.columns(lattice.center(zero), lattice.center(one), xmin, xmax);
+                    if (part != nullptr)
+                    {
+                        xmin = std::max(xmin, window_xmin + 1);
+                        xmax = std::min(xmax, window_xmax - 1);
+                    }
+                    Position position = zero;
+                    for (position.xi = xmin - 1; position.xi <= xmax + 1; position.xi++)
+                    {
+                        std::array<bool, L::shape> inside_points;
+                        bool inside = false;
+                        for (unsigned int p = 0; p < L::shape; p++)
+                        {
+                            inside_points[p] = false;
+                            const PointPosition canonical = L::canonical_point({ position, p });
+                            if (canonical.position.yi < row_ymin || canonical.position.yi > row_ymax) continue;
+                            TemporaryRow &row = rows[((canonical.position.yi - row_ymin) * layers + (canonical.position.upside_down ? 1 : 0)) * L::shape + canonical.point];
+                            if (!row.ready)
+                            {
+                                Position row_zero = canonical.position, row_one = canonical.position;
+                                row_zero.xi = 0;
+                                row_one.xi = 1;
+                                int row_xmin, row_xmax;
+                                row.valid = scanline.columns(lattice.points(row_zero)[canonical.point], lattice.points(row_one)[canonical.point], row_xmin, row_xmax, row.crossings);
+                                row.ready = true;
+                            }
+                            if (row.valid && Scanline<B>::inside(row.crossings, canonical.position.xi))
+                            {
+                                inside_points[p] = true;
+                                inside = true;
+                            }
+                        }
+                        if (!inside) continue;
+                        typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = create(position);
+                        for (unsigned int p = 0; p < L::shape; p++)
+                        {
+                            if (inside_points[p]) vertices[cell->second.vertices[p]].status = PointStatus::passive;
+                        }
+                    }
+                }
+            }
+        }
+
+        //STAGE 2: probe faces that connect inside and outside points, speculatively in parallel, then serially
+        const std::vector<Entry*> entries = state.ordered();
+        for (typename std::vector<Entry*>::const_iterator entry = entries.begin(); entry != entries.end() && pool.threads() > 1; entry++)
+        {
+            Entry *cell = *entry;
+            std::array<Vector, 6> points = lattice.points(cell->first);
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                const PointStatus status = vertices[cell->second.vertices[p]].status;
+                if (edges[cell->second.edges[p]].probed || status == vertices[cell->second.vertices[next_ccw]].status) continue;
+                if (status == PointStatus::passive) speculate(cell->second.edges[p], points[p], points[next_ccw]);
+                else speculate(cell->second.edges[p], points[next_ccw], points[p]);
+            }
+        }
+        run_speculative();
+        for (typename std::vector<Entry*>::const_iterator entry = entries.begin(); entry != entries.end(); entry++)
+        {
+            Entry *cell = *entry;
+            std::array<Vector, 6> points = lattice.points(cell->first);
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                const PointStatus status = vertices[cell->second.vertices[p]].status;
+                if (edges[cell->second.edges[p]].probed || status == vertices[cell->second.vertices[next_ccw]].status) continue;
+
+                //Probing from inside point to outside point
+                const Vector inside_coord = (status == PointStatus::passive) ? points[p] : points[next_ccw];
+                const Vector outside_coord = (status == PointStatus::passive) ? points[next_ccw] : points[p];
+                const B *pboundary = nullptr;
+                const Intersection intersection = probe(cell->second.edges[p], inside_coord, outside_coord, pboundary);
+                save(*cell, p, intersection, pboundary);
+            }
+        }
+        clear_speculative();
+        statistics.memory(_memory<L>(cells.size()));
+        statistics.end();
+    }
+
+    //STAGE 3: calculate area, cells are independent and are calculated in parallel, update calculates only cells it touched
+    statistics.begin("area");
+    std::vector<Entry*> entries;
+    if (seeds != nullptr)
+    {
+        for (std::vector<Position>::const_iterator position = state.touched.begin(); position != state.touched.end(); position++)
+        {
+            const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, *position);
+            if (cell != cells.end()) entries.push_back(&*cell);
+        }
+    }
+    else entries = state.ordered();
+    parallel_for(pool, (unsigned int)entries.size(), [&](unsigned int i)
+    {
+        Entry *cell = entries[i];
+        bool complete = true;
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            if (vertices[cell->second.vertices[p]].status != PointStatus::passive || !edges[cell->second.edges[p]].intersection.valid) { complete = false; break; }
+        }
+        if (complete)
+        {
+            //Complete cell, no calculations needed
+            cell->second.complete = true;
+            cell->second.area = area;
+            cell->second.center = lattice.center(cell->first);
+        }
+        else
+        {
+            //Create list of points
+            std::array<Vector, 6> points = lattice.points(cell->first);
+            std::array<Vector, 12> point_list;
+            unsigned int point_list_size = 0;
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                const PointStatus status = vertices[cell->second.vertices[p]].status;
+                if (status == PointStatus::passive) point_list[point_list_size++] = points[p];
+                if (status != vertices[cell->second.vertices[next_ccw]].status) point_list[point_list_size++] = edges[cell->second.edges[p]].intersection.coord;
+            }
+
+            //Calculate area
+            cell->second.area = 0;
+            cell->second.center = Vector(0, 0);
+            for (unsigned int p = 1; p < (point_list_size - 1); p++)
+            {
+                double a = (point_list[p] - point_list[0]).norm();
+                double b = (point_list[p+1] - point_list[0]).norm();
+                double c = (point_list[p+1] - point_list[p]).norm();
+                double s = 0.5 * (a + b + c);
+                double local_area = sqrt(s * (s - a) * (s - b) * (s - c));
+                Vector local_center = (point_list[0] + point_list[p] + point_list[p+1]) / 3;
+                cell->second.area = cell->second.area + local_area;
+                cell->second.center = cell->second.center + (local_center * local_area);
+            }
+            cell->second.center = cell->second.center / cell->second.area;
+            if (parameters.threshold_area <= 0.0) cell->second.complete = true;
+            else if (parameters.threshold_area >= 1.0) cell->second.complete = false;
+            else cell->second.complete = (cell->second.area > (parameters.threshold_area * area));
+        }
+    });
+
+    statistics.end();
+
+    //STAGE 4: apply failed cells
+    statistics.begin("failed cells");
+    for (typename std::vector<Entry*>::iterator entry = entries.begin(); entry != entries.end(); entry++)
+    {
+        Entry *cell = *entry;
+        if (!cell->second.complete)
+        {
+            for (unsigned int f = 0; f < L::shape; f++)
+            {
+                const FacePosition neighbor = L::face_neighbor({ cell->first, f });
+                typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator find = lookup(cells, neighbor.position);
+                if (find != cells.end() && find->second.complete)
+                {
+                    find->second.intersection = cell->second.intersection;
+                    find->second.boundary = cell->second.boundary;
+                }
+            }
+        }
+    }
+
+    statistics.end();
+}
+
+template <class B, class P, class F, class C> template <class L, class K, class S> void gg::CellGrid<B, P, F, C>::_stream(const CellGridParameters &parameters, const std::vector<B> &boundaries, K &sink, ThreadPool &pool, S &statistics)
+{
+    //Flood fill knows that a cell is reached only after the whole search, scanline search is interleaved with emission column by column
+    const bool interleaved = (parameters.generation != Generation::flood_fill);
+    if (interleaved)
+    {
+        _parameters = parameters;
+        _lattice.reset(new TemporaryLattice<B, L>());
+    }
+    else _search<L>(parameters, boundaries, nullptr, nullptr, pool, statistics);
+    TemporaryLattice<B, L> &state = static_cast<TemporaryLattice<B, L>&>(*_lattice);
+    std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells = state.cells;
+    const Lattice lattice(parameters);
+    const auto lookup = [&](std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells, Position position) -> typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator
+    {
+        statistics.lookup();
+        return cells.find(position);
+    };
+
+    //Interleaved search keeps vertices and edges only of recent columns, they are addressed by indexes minus the number of released ones
+    std::deque<TemporaryVertex> window_vertices;
+    std::deque<TemporaryEdge<B>> window_edges;
+    unsigned int vertex_base = 0, edge_base = 0;
+    const auto vertex = [&](unsigned int index) -> TemporaryVertex& { return interleaved ? window_vertices[index - vertex_base] : state.vertices[index]; };
+    const auto edge = [&](unsigned int index) -> TemporaryEdge<B>& { return interleaved ? window_edges[index - edge_base] : state.edges[index]; };
+
+    //STAGES 6-8: create points, faces and sides of every cell, pass them to the sink and release columns that are not needed anymore
+    struct Column
+    {
+        int xi;             //X index of the column
+        unsigned int point; //First point created in the column
+        unsigned int face;  //First face created in the column
+    };
+    std::deque<Column> columns;
+    std::deque<Position> emitted;                       //Positions of emitted cells of kept columns
+    std::deque<Vector> point_coords;                    //Coordinates of points of kept columns
+    std::deque<std::array<Vector, 2>> face_geometry;    //Centers and normals of faces of kept columns
+    unsigned int cell_count = 0, point_count = 0, face_count = 0, point_base = 0, face_base = 0;
+    std::vector<IndexedSide> sides;
+    std::vector<Vector> side_coords;
+    const auto create_point = [&](Vector coord, Vector normal, const B *boundary) -> unsigned int
+    {
+        sink.point(point_count, coord, normal, (boundary == nullptr) ? no_index : (unsigned int)(boundary - &boundaries[0]));
+        point_coords.push_back(coord);
+        return point_count++;
+    };
+    const auto create_face = [&](unsigned int a, unsigned int b, const TemporaryEdge<B> *source) -> unsigned int
+    {
+        const Vector a_coord = point_coords[a - point_base], b_coord = point_coords[b - point_base];
+        const Vector center = (a_coord + b_coord) * 0.5, normal = rotate_ccw(a_coord - b_coord);
+        sink.face(face_count, std::array<unsigned int, 2>{{ a, b }}, center, normal, (a_coord - b_coord).norm(),
+            (source == nullptr || source->boundary == nullptr) ? no_index : (unsigned int)(source->boundary - &boundaries[0]));
+        face_geometry.push_back({{ center, normal }});
+        return face_count++;
+    };
+    const auto memory = [&]() -> std::size_t
+    {
+        return _memory<L>(cells.size()) + window_vertices.size() * sizeof(TemporaryVertex) + window_edges.size() * sizeof(TemporaryEdge<B>)
+            + emitted.size() * sizeof(Position) + point_coords.size() * sizeof(Vector) + face_geometry.size() * 2 * sizeof(Vector);
+    };
+    typedef std::pair<const Position, TemporaryCell<B, L>> Entry;
+    const auto emit = [&](Entry *cell)
+    {
+        //Release columns before X-1
+        if (columns.empty() || columns.back().xi != cell->first.xi)
+        {
+            columns.push_back({ cell->first.xi, point_count, face_count });
+            while (columns.front().xi < cell->first.xi - 1) columns.pop_front();
+            for (; point_base < columns.front().point; point_base++) point_coords.pop_front();
+            for (; face_base < columns.front().face; face_base++) face_geometry.pop_front();
+            for (; !emitted.empty() && emitted.front().xi < cell->first.xi - 1; emitted.pop_front()) cells.erase(emitted.front());
+        }
+        emitted.push_back(cell->first);
+        if (cell->second.cell == no_index) return;
+
+        //Creating points, same as stage 6
+        sides.clear();
+        std::array<Vector, 6> points = lattice.points(cell->first);
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            TemporaryVertex &point = vertex(cell->second.vertices[p]);
+            if (point.status == PointStatus::passive)
+            {
+                if (point.point == no_index) point.point = create_point(points[p], Vector(0, 0), nullptr);
+                sides.push_back({ point.point, no_index, no_index, false });
+            }
+            unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            if (point.status != vertex(cell->second.vertices[next_ccw]).status)
+            {
+                TemporaryEdge<B> &face = edge(cell->second.edges[p]);
+                if (face.point == no_index) face.point = create_point(face.intersection.coord, face.intersection.normal, face.boundary);
+                sides.push_back({ face.point, no_index, no_index, false });
+            }
+        }
+
+        //Creating faces, same as stage 7
+        unsigned int irregular_face_start = no_index;
+        unsigned int side_counter = 0;
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            const TemporaryVertex &first = vertex(cell->second.vertices[p]), &second = vertex(cell->second.vertices[next_ccw]);
+            if (first.status != PointStatus::passive && second.status != PointStatus::passive) continue;
+            const FacePosition neighbor = L::face_neighbor({ cell->first, p });
+            TemporaryEdge<B> &face = edge(cell->second.edges[p]);
+            if (face.face == no_index)
+            {
+                if (first.status == PointStatus::passive && second.status != PointStatus::passive) face.face = create_face(first.point, face.point, &face);
+                else if (first.status != PointStatus::passive && second.status == PointStatus::passive) face.face = create_face(second.point, face.point, &face);
+                else face.face = create_face(first.point, second.point, nullptr);
+            }
+
+            if (first.status != PointStatus::passive && second.status == PointStatus::passive)
+            {
+                if (irregular_face_start != no_index)
+                {
+                    sides[side_counter++].face = create_face(irregular_face_start, face.point, &face);
+                    irregular_face_start = no_index;
+                }
+                sides[side_counter].face = face.face;
+                sides[side_counter++].cell = lookup(cells, neighbor.position)->second.cell;
+            }
+            else if (first.status == PointStatus::passive && second.status != PointStatus::passive)
+            {
+                sides[side_counter].face = face.face;
+                sides[side_counter++].cell = lookup(cells, neighbor.position)->second.cell;
+                irregular_face_start = face.point;
+            }
+            else
+            {
+                sides[side_counter].face = face.face;
+                sides[side_counter++].cell = lookup(cells, neighbor.position)->second.cell;
+            }
+        }
+        if (irregular_face_start != no_index)
+        {
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const TemporaryEdge<B> &face = edge(cell->second.edges[p]);
+                if (face.point != no_index)
+                {
+                    sides[side_counter].face = create_face(irregular_face_start, face.point, &face);
+                    break;
+                }
+            }
+        }
+
+        //Calculating if faces are flipped, same as stage 8
+        for (typename std::vector<IndexedSide>::iterator side = sides.begin(); side != sides.end(); side++)
+        {
+            const std::array<Vector, 2> &face = face_geometry[side->face - face_base];
+            side->inwards = ((cell->second.center - face[0]).dot(face[1]) >= 0.0);
+        }
+        sink.cell(cell->second.cell, cell->second.center, cell->second.area, (cell->second.boundary == nullptr) ? no_index : (unsigned int)(cell->second.boundary - &boundaries[0]),
+            sides.data(), (unsigned int)sides.size());
+    };
+
+    if (!interleaved)
+    {
+        //STAGE 5: number cells
+        statistics.begin("cells");
+        const std::vector<Entry*> entries = state.ordered();
+        for (typename std::vector<Entry*>::const_iterator entry = entries.begin(); entry != entries.end(); entry++)
+        {
+            if ((*entry)->second.complete) (*entry)->second.cell = cell_count++;
+        }
+        statistics.end();
+
+        statistics.begin("stream");
+        for (typename std::vector<Entry*>::const_iterator entry = entries.begin(); entry != entries.end(); entry++) emit(*entry);
+        statistics.memory(memory());
+        statistics.end();
+        _lattice.reset();
+        return;
+    }
+
+    //STAGE 0: create index and intersect rows, like in scanline generation of _search()
+    statistics.begin("index");
+    const double area = lattice.area();
+    const BoundaryIndex<B> index(parameters, boundaries);
+    const Scanline<B> scanline(parameters, index);
+    const unsigned int layers = (parameters.typ == GridType::triangular) ? 2 : 1;
+    std::vector<TemporaryRow> rows;
+    std::vector<std::array<int, 2>> ranges;  //Ranges of X indexes of rows of elements
+    Position zero, one;
+    one.yi = 1;
+    int ymin = 0, ymax = -1, row_ymin = 0, row_ymax = -1, xbegin = 0, xend = -1;
+    if (scanline.rows(lattice.center(zero), lattice.center(one), ymin, ymax))
+    {
+        row_ymin = ymin - 1;
+        row_ymax = ymax + 1;
+        rows.resize((row_ymax - row_ymin + 1) * layers * L::shape);
+        std::vector<unsigned int> canonical_rows;
+        for (unsigned int layer = 0; layer < layers; layer++)
+        {
+            Position position;
+            position.upside_down = (layer == 1);
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const PointPosition canonical = L::canonical_point({ position, p });
+                const unsigned int kind = (canonical.position.upside_down ? 1 : 0) * L::shape + canonical.point;
+                if (std::find(canonical_rows.begin(), canonical_rows.end(), kind) == canonical_rows.end()) canonical_rows.push_back(kind);
+            }
+        }
+        parallel_for(pool, (unsigned int)((row_ymax - row_ymin + 1) * canonical_rows.size()), [&](unsigned int i)
+        {
+            const unsigned int kind = canonical_rows[i % canonical_rows.size()];
+            Position row_zero, row_one;
+            row_zero.yi = row_ymin + (int)(i / canonical_rows.size());
+            row_zero.upside_down = (kind >= L::shape);
+            row_one = row_zero;
+            row_one.xi = 1;
+            TemporaryRow &row = rows[(row_zero.yi - row_ymin) * layers * L::shape + kind];
+            int row_xmin, row_xmax;
+            row.valid = scanline.columns(lattice.points(row_zero)[kind % L::shape], lattice.points(row_one)[kind % L::shape], row_xmin, row_xmax, row.crossings);
+            row.ready = true;
+        });
+        ranges.resize((ymax - ymin + 1) * layers);
+        xbegin = INT_MAX;
+        xend = INT_MIN;
+        for (int yi = ymin; yi <= ymax; yi++)
+        {
+            for (unsigned int layer = 0; layer < layers; layer++)
+            {
+                zero.xi = 0; zero.yi = yi; zero.upside_down = (layer == 1);
+                one = zero; one.xi = 1;
+                std::array<int, 2> &range = ranges[(yi - ymin) * layers + layer];
+                scanline.columns(lattice.center(zero), lattice.center(one), range[0], range[1]);
+                range[0]--;
+                range[1]++;
+                xbegin = std::min(xbegin, range[0]);
+                xend = std::max(xend, range[1]);
+            }
+        }
+    }
+    statistics.end();
+
+    //Cells are created like in _search(), vertices and edges of columns that were not released are shared
+    const auto identify = [&](Position position) -> TemporaryIds<L>&
+    {
+        statistics.lookup();
+        return state.ids[position];
+    };
+    const auto create = [&](Position position) -> typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator
+    {
+        typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, position);
+        if (cell != cells.end()) return cell;
+        TemporaryCell<B, L> new_cell;
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            const PointPosition point = L::canonical_point({ position, p });
+            unsigned int &vertex_index = identify(point.position).vertices[point.point];
+            if (vertex_index == no_index)
+            {
+                vertex_index = vertex_base + (unsigned int)window_vertices.size();
+                window_vertices.push_back(TemporaryVertex());
+            }
+            vertex(vertex_index).cells++;
+            new_cell.vertices[p] = vertex_index;
+
+            const FacePosition face = L::canonical_face({ position, p });
+            unsigned int &edge_index = identify(face.position).edges[face.face];
+            if (edge_index == no_index)
+            {
+                edge_index = edge_base + (unsigned int)window_edges.size();
+                window_edges.push_back(TemporaryEdge<B>());
+            }
+            edge(edge_index).cells++;
+            new_cell.edges[p] = edge_index;
+        }
+        statistics.allocation();
+        return cells.insert({ position, new_cell }).first;
+    };
+
+    //Columns pass through the pipeline: X is created, X-1 is probed, calculated and numbered, failed cells of X-2 are applied, X-3 is emitted
+    //Probes and failed cells of a column touch only neighbor columns, so every stage sees the same cells as in _search()
+    struct Window
+    {
+        int xi;             //X index of the column
+        unsigned int vertex;//First vertex created in the column
+        unsigned int edge;  //First edge created in the column
+        std::vector<Entry*> cells;  //Cells of the column in order of positions
+    };
+    std::deque<Window> windows;
+    const std::vector<Entry*> no_cells;
+    const auto column = [&](int xi) -> const std::vector<Entry*>&
+    {
+        return (xi < windows.front().xi) ? no_cells : windows[xi - windows.front().xi].cells;
+    };
+    std::vector<Entry*> entries;
+    std::vector<TemporaryProbe<B>> probes;
+    statistics.begin("stream");
+    for (int x = xbegin; x <= xend + 3; x++)
+    {
+        //STAGE 1: add cells of column X that have points between crossings
+        windows.push_back({ x, vertex_base + (unsigned int)window_vertices.size(), edge_base + (unsigned int)window_edges.size(), std::vector<Entry*>() });
+        for (int yi = ymin; yi <= ymax && x <= xend; yi++)
+        {
+            for (unsigned int layer = 0; layer < layers; layer++)
+            {
+                const std::array<int, 2> &range = ranges[(yi - ymin) * layers + layer];
+                if (x < range[0] || x > range[1]) continue;
+                Position position;
+                position.xi = x; position.yi = yi; position.upside_down = (layer == 1);
+                std::array<bool, L::shape> inside_points;
+                bool inside = false;
+                for (unsigned int p = 0; p < L::shape; p++)
+                {
+                    inside_points[p] = false;
+                    const PointPosition canonical = L::canonical_point({ position, p });
+                    if (canonical.position.yi < row_ymin || canonical.position.yi > row_ymax) continue;
+                    const TemporaryRow &row = rows[((canonical.position.yi - row_ymin) * layers + (canonical.position.upside_down ? 1 : 0)) * L::shape + canonical.point];
+                    if (row.valid && Scanline<B>::inside(row.crossings, canonical.position.xi))
+                    {
+                        inside_points[p] = true;
+                        inside = true;
+                    }
+                }
+                if (!inside) continue;
+                typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = create(position);
+                windows.back().cells.push_back(&*cell);
+                for (unsigned int p = 0; p < L::shape; p++)
+                {
+                    if (inside_points[p]) vertex(cell->second.vertices[p]).status = PointStatus::passive;
+                }
+            }
+        }
+
+        //Canonical positions of points and faces of later columns lie in column X or later, so identifiers of column X-1 are not needed anymore
+        for (int yi = row_ymin; yi <= row_ymax; yi++)
+        {
+            for (unsigned int layer = 0; layer < layers; layer++)
+            {
+                Position position;
+                position.xi = x - 1; position.yi = yi; position.upside_down = (layer == 1);
+                state.ids.erase(position);
+            }
+        }
+
+        //STAGE 2: probe faces of column X-1 that connect inside and outside points, speculatively in parallel, then serially
+        entries = column(x - 1);
+        for (typename std::vector<Entry*>::iterator entry = entries.begin(); entry != entries.end() && pool.threads() > 1; entry++)
+        {
+            Entry *cell = *entry;
+            std::array<Vector, 6> points = lattice.points(cell->first);
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                const PointStatus status = vertex(cell->second.vertices[p]).status;
+                TemporaryEdge<B> &face = edge(cell->second.edges[p]);
+                if (face.probed || face.probe != no_index || status == vertex(cell->second.vertices[next_ccw]).status) continue;
+                TemporaryProbe<B> probe;
+                probe.edge = cell->second.edges[p];
+                probe.a = (status == PointStatus::passive) ? points[p] : points[next_ccw];
+                probe.b = (status == PointStatus::passive) ? points[next_ccw] : points[p];
+                face.probe = (unsigned int)probes.size();
+                probes.push_back(probe);
+            }
+        }
+        parallel_for(pool, (unsigned int)probes.size(), [&](unsigned int i)
+        {
+            probes[i].intersection = index.intersection(probes[i].a, probes[i].b, probes[i].boundary, statistics);
+        });
+        for (typename std::vector<Entry*>::iterator entry = entries.begin(); entry != entries.end(); entry++)
+        {
+            Entry *cell = *entry;
+            std::array<Vector, 6> points = lattice.points(cell->first);
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                const PointStatus status = vertex(cell->second.vertices[p]).status;
+                TemporaryEdge<B> &face = edge(cell->second.edges[p]);
+                if (face.probed || status == vertex(cell->second.vertices[next_ccw]).status) continue;
+
+                //Probing from inside point to outside point, the result is saved to the face and to both cells that share it
+                const B *pboundary = nullptr;
+                const Intersection intersection = (face.probe != no_index) ? probes[face.probe].intersection : index.intersection(
+                    (status == PointStatus::passive) ? points[p] : points[next_ccw], (status == PointStatus::passive) ? points[next_ccw] : points[p], pboundary, statistics);
+                if (face.probe != no_index) pboundary = probes[face.probe].boundary;
+                face.probed = true;
+                face.probe = no_index;
+                if (!intersection.valid) continue;
+                face.intersection = intersection;
+                face.boundary = pboundary;
+                TemporaryCell<B, L> &neighbor = lookup(cells, L::face_neighbor({ cell->first, p }).position)->second;
+                cell->second.intersection = neighbor.intersection = intersection;
+                cell->second.boundary = neighbor.boundary = pboundary;
+            }
+        }
+        probes.clear();
+
+        //STAGE 3: calculate area of column X-1, same as in _search(), and number complete cells
+        parallel_for(pool, (unsigned int)entries.size(), [&](unsigned int i)
+        {
+            Entry *cell = entries[i];
+            bool complete = true;
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                if (vertex(cell->second.vertices[p]).status != PointStatus::passive || !edge(cell->second.edges[p]).intersection.valid) { complete = false; break; }
+            }
+            if (complete)
+            {
+                cell->second.complete = true;
+                cell->second.area = area;
+                cell->second.center = lattice.center(cell->first);
+                return;
+            }
+            std::array<Vector, 6> points = lattice.points(cell->first);
+            std::array<Vector, 12> point_list;
+            unsigned int point_list_size = 0;
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+                const PointStatus status = vertex(cell->second.vertices[p]).status;
+                if (status == PointStatus::passive) point_list[point_list_size++] = points[p];
+                if (status != vertex(cell->second.vertices[next_ccw]).status) point_list[point_list_size++] = edge(cell->second.edges[p]).intersection.coord;
+            }
+            cell->second.area = 0;
+            cell->second.center = Vector(0, 0);
+            for (unsigned int p = 1; p < (point_list_size - 1); p++)
+            {
+                double a = (point_list[p] - point_list[0]).norm();
+                double b = (point_list[p+1] - point_list[0]).norm();
+                double c = (point_list[p+1] - point_list[p]).norm();
+                double s = 0.5 * (a + b + c);
+                double local_area = sqrt(s * (s - a) * (s - b) * (s - c));
+                Vector local_center = (point_list[0] + point_list[p] + point_list[p+1]) / 3;
+                cell->second.area = cell->second.area + local_area;
+                cell->second.center = cell->second.center + (local_center * local_area);
+            }
+            cell->second.center = cell->second.center / cell->second.area;
+            if (parameters.threshold_area <= 0.0) cell->second.complete = true;
+            else if (parameters.threshold_area >= 1.0) cell->second.complete = false;
+            else cell->second.complete = (cell->second.area > (parameters.threshold_area * area));
+        });
+        for (typename std::vector<Entry*>::iterator entry = entries.begin(); entry != entries.end(); entry++)
+        {
+            if ((*entry)->second.complete) (*entry)->second.cell = cell_count++;
+        }
+
+        //STAGE 4: apply failed cells of column X-2
+        for (typename std::vector<Entry*>::const_iterator entry = column(x - 2).begin(); entry != column(x - 2).end(); entry++)
+        {
+            Entry *cell = *entry;
+            if (cell->second.complete) continue;
+            for (unsigned int f = 0; f < L::shape; f++)
+            {
+                typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator find = lookup(cells, L::face_neighbor({ cell->first, f }).position);
+                if (find != cells.end() && find->second.complete)
+                {
+                    find->second.intersection = cell->second.intersection;
+                    find->second.boundary = cell->second.boundary;
+                }
+            }
+        }
+
+        //STAGES 6-8: emit column X-3, cells before X-4 are released by emission, vertices and edges of columns before X-4 are released here
+        statistics.memory(memory());
+        for (typename std::vector<Entry*>::const_iterator entry = column(x - 3).begin(); entry != column(x - 3).end(); entry++) emit(*entry);
+        while (windows.front().xi < x - 4) windows.pop_front();
+        for (; vertex_base < windows.front().vertex; vertex_base++) window_vertices.pop_front();
+        for (; edge_base < windows.front().edge; edge_base++) window_edges.pop_front();
+    }
+    statistics.end();
+    _lattice.reset();
+}
+
+template <class B, class P, class F, class C> template <class L> std::size_t gg::CellGrid<B, P, F, C>::_memory(std::size_t cells) const
+{
+    //Estimation, hash nodes have a pointer to the next node, buckets are pointers
+    const TemporaryLattice<B, L> &state = static_cast<const TemporaryLattice<B, L>&>(*_lattice);
+    const std::size_t cell_size = sizeof(void*) + sizeof(std::pair<const Position, TemporaryCell<B, L>>);
+    const std::size_t ids_size = sizeof(void*) + sizeof(std::pair<const Position, TemporaryIds<L>>);
+    return cells * cell_size + state.ids.size() * ids_size + (state.cells.bucket_count() + state.ids.bucket_count()) * sizeof(void*)
+        + state.vertices.capacity() * sizeof(TemporaryVertex) + state.edges.capacity() * sizeof(TemporaryEdge<B>)
+        + (_indexed.point_coords.capacity() + _indexed.point_normals.capacity() + _indexed.face_centers.capacity() + _indexed.face_normals.capacity() + _indexed.cell_centers.capacity()) * sizeof(Vector)
+        + (_indexed.face_lengths.capacity() + _indexed.cell_areas.capacity()) * sizeof(double)
+        + (_indexed.point_boundaries.capacity() + 2 * _indexed.face_points.capacity() + _indexed.face_boundaries.capacity() + _indexed.cell_boundaries.capacity() + _indexed.side_offsets.capacity()) * sizeof(unsigned int)
+        + _indexed.sides.capacity() * sizeof(IndexedSide);
+}
+
+template <class B, class P, class F, class C> template <class S> void gg::CellGrid<B, P, F, C>::_generate_refined(const CellGridParameters &parameters, const std::vector<B> &boundaries, ThreadPool &pool, S &statistics)
+{
+    //STAGE 0: create index
+    statistics.begin("index");
+    const BoundaryIndex<B> index(parameters, boundaries);
+    statistics.end();
+
+    //STAGES 1-4: create tree and reach its vertices
+    const Quadtree<B> tree(parameters, index, parameters.refinement, parameters.refinement_distance, pool, statistics);
+    const std::vector<typename Quadtree<B>::Vertex> &vertices = tree.vertices();
+    const std::vector<typename Quadtree<B>::Edge> &edges = tree.edges();
+    const std::vector<unsigned int> &leaf_offsets = tree.leaf_offsets();
+    const std::vector<unsigned int> &leaf_vertices = tree.leaf_vertices();
+    const std::vector<unsigned int> &leaf_edges = tree.leaf_edges();
+    const unsigned int leaves = (unsigned int)tree.leaves().size();
+    const auto next = [&](unsigned int leaf, unsigned int k) -> unsigned int
+    {
+        return (k + 1 == leaf_offsets[leaf + 1]) ? leaf_offsets[leaf] : (k + 1);
+    };
+
+    //STAGE 5: calculate area and create cells
+    statistics.begin("cells");
+    std::vector<TemporaryRefinedCell<B>> cells(leaves);
+    std::vector<unsigned int> leaf_cells(leaves, no_index);
+    std::vector<const TemporaryRefinedCell<B>*> cell_sources;
+    for (unsigned int leaf = 0; leaf < leaves; leaf++)
+    {
+        TemporaryRefinedCell<B> &cell = cells[leaf];
+        bool reached = false, complete = true;
+        for (unsigned int k = leaf_offsets[leaf]; k < leaf_offsets[leaf + 1]; k++)
+        {
+            if (vertices[leaf_vertices[k]].reached) reached = true;
+            else complete = false;
+            const typename Quadtree<B>::Edge &edge = edges[leaf_edges[k]];
+            if (edge.intersection.valid)
+            {
+                complete = false;
+                if (!cell.intersection.valid) { cell.intersection = edge.intersection; cell.boundary = edge.boundary; }
+            }
+        }
+        if (!reached) continue;
+
+        if (complete)
+        {
+            cell.area = tree.area(leaf);
+            cell.center = tree.center(leaf);
+        }
+        else
+        {
+            //Polygon of reached vertices and intersections, area and center by shoelace formula
+            std::array<Vector, 16> point_list;
+            unsigned int point_list_size = 0;
+            for (unsigned int k = leaf_offsets[leaf]; k < leaf_offsets[leaf + 1]; k++)
+            {
+                const bool k_reached = vertices[leaf_vertices[k]].reached;
+                if (k_reached) point_list[point_list_size++] = vertices[leaf_vertices[k]].coord;
+                if (k_reached != vertices[leaf_vertices[next(leaf, k)]].reached) point_list[point_list_size++] = edges[leaf_edges[k]].intersection.coord;
+            }
+            double double_area = 0.0;
+            Vector center(0, 0);
+            for (unsigned int p = 0; p < point_list_size; p++)
+            {
+                const Vector a = point_list[p] - point_list[0], b = point_list[(p + 1) % point_list_size] - point_list[0];
+                const double cross = a.x * b.y - a.y * b.x;
+                double_area = double_area + cross;
+                center = center + (a + b) * cross;
+            }
+            cell.area = fabs(0.5 * double_area);
+            cell.center = (double_area == 0.0) ? point_list[0] : (point_list[0] + center / (3.0 * double_area));
+            if (parameters.threshold_area > 0.0 && !(cell.area > parameters.threshold_area * tree.area(leaf))) continue;
+        }
+        leaf_cells[leaf] = (unsigned int)_indexed.cell_centers.size();
+        _indexed.cell_centers.push_back(cell.center);
+        _indexed.cell_areas.push_back(cell.area);
+        _indexed.cell_boundaries.push_back((cell.boundary == nullptr) ? no_index : (unsigned int)(cell.boundary - &boundaries[0]));
+        cell_sources.push_back(&cell);
+    }
+    statistics.end();
+
+    //STAGE 6: create points
+    statistics.begin("points");
+    std::vector<unsigned int> vertex_points(vertices.size(), no_index), edge_points(edges.size(), no_index);
+    std::vector<const typename Quadtree<B>::Edge*> point_sources;   //Edge where the point was found, nullptr for regular points
+    for (unsigned int leaf = 0; leaf < leaves; leaf++)
+    {
+        if (leaf_cells[leaf] == no_index) continue;
+        _indexed.side_offsets.push_back((unsigned int)_indexed.sides.size());
+        for (unsigned int k = leaf_offsets[leaf]; k < leaf_offsets[leaf + 1]; k++)
+        {
+            const unsigned int vertex = leaf_vertices[k], edge = leaf_edges[k];
+            if (vertices[vertex].reached)
+            {
+                if (vertex_points[vertex] == no_index)
+                {
+                    vertex_points[vertex] = (unsigned int)_indexed.point_coords.size();
+                    _indexed.point_coords.push_back(vertices[vertex].coord);
+                    _indexed.point_normals.push_back(Vector(0, 0));
+                    _indexed.point_boundaries.push_back(no_index);
+                    point_sources.push_back(nullptr);
+                }
+                _indexed.sides.push_back({ vertex_points[vertex], no_index, no_index, false });
+            }
+            if (vertices[vertex].reached != vertices[leaf_vertices[next(leaf, k)]].reached)
+            {
+                if (edge_points[edge] == no_index)
+                {
+                    edge_points[edge] = (unsigned int)_indexed.point_coords.size();
+                    _indexed.point_coords.push_back(edges[edge].intersection.coord);
+                    _indexed.point_normals.push_back(edges[edge].intersection.normal);
+                    _indexed.point_boundaries.push_back((edges[edge].boundary == nullptr) ? no_index : (unsigned int)(edges[edge].boundary - &boundaries[0]));
+                    point_sources.push_back(&edges[edge]);
+                }
+                _indexed.sides.push_back({ edge_points[edge], no_index, no_index, false });
+            }
+        }
+    }
+    _indexed.side_offsets.push_back((unsigned int)_indexed.sides.size());
+    statistics.end();
+
+    //STAGE 7: create faces, sides of leaves with hanging vertices have two faces
+    statistics.begin("faces");
+    std::vector<unsigned int> edge_faces(edges.size(), no_index);
+    std::vector<const typename Quadtree<B>::Edge*> face_sources; //Edge where the boundary was found, nullptr for regular faces
+    const auto create_face = [&](unsigned int a, unsigned int b, const typename Quadtree<B>::Edge *source) -> unsigned int
+    {
+        const Vector a_coord = _indexed.point_coords[a], b_coord = _indexed.point_coords[b];
+        _indexed.face_points.push_back({ a, b });
+        _indexed.face_centers.push_back((a_coord + b_coord) * 0.5);
+        _indexed.face_normals.push_back(rotate_ccw(a_coord - b_coord));
+        _indexed.face_lengths.push_back((a_coord - b_coord).norm());
+        _indexed.face_boundaries.push_back((source == nullptr || source->boundary == nullptr) ? no_index : (unsigned int)(source->boundary - &boundaries[0]));
+        face_sources.push_back(source);
+        return (unsigned int)(_indexed.face_points.size() - 1);
+    };
+    for (unsigned int leaf = 0; leaf < leaves; leaf++)
+    {
+        if (leaf_cells[leaf] == no_index) continue;
+        IndexedSide *sides = &_indexed.sides[_indexed.side_offsets[leaf_cells[leaf]]];
+        unsigned int irregular_face_start = no_index;
+        unsigned int side_counter = 0;
+        for (unsigned int k = leaf_offsets[leaf]; k < leaf_offsets[leaf + 1]; k++)
+        {
+            const unsigned int vertex = leaf_vertices[k], next_vertex = leaf_vertices[next(leaf, k)], edge = leaf_edges[k];
+            const bool reached = vertices[vertex].reached, next_reached = vertices[next_vertex].reached;
+            if (!reached && !next_reached) continue;
+            const unsigned int neighbor_leaf = (edges[edge].leaves[0] == leaf) ? edges[edge].leaves[1] : edges[edge].leaves[0];
+            const unsigned int neighbor_cell = (neighbor_leaf == no_index) ? no_index : leaf_cells[neighbor_leaf];
+            if (edge_faces[edge] == no_index)
+            {
+                if (reached && !next_reached) edge_faces[edge] = create_face(vertex_points[vertex], edge_points[edge], &edges[edge]);
+                else if (!reached && next_reached) edge_faces[edge] = create_face(vertex_points[next_vertex], edge_points[edge], &edges[edge]);
+                else edge_faces[edge] = create_face(vertex_points[vertex], vertex_points[next_vertex], nullptr);
+            }
+
+            if (!reached && next_reached)
+            {
+                //First point is face point, second point is normal point -> Close irregular face and add normal face
+                if (irregular_face_start != no_index)
+                {
+                    sides[side_counter++].face = create_face(irregular_face_start, edge_points[edge], &edges[edge]);
+                    irregular_face_start = no_index;
+                }
+                sides[side_counter].face = edge_faces[edge];
+                sides[side_counter++].cell = neighbor_cell;
+            }
+            else if (reached && !next_reached)
+            {
+                //First point is normal point, second point is face point -> Add normal face and open irregular face
+                sides[side_counter].face = edge_faces[edge];
+                sides[side_counter++].cell = neighbor_cell;
+                irregular_face_start = edge_points[edge];
+            }
+            else
+            {
+                //Normal regular face -> just add it
+                sides[side_counter].face = edge_faces[edge];
+                sides[side_counter++].cell = neighbor_cell;
+            }
+        }
+        //Closing open irregular face
+        if (irregular_face_start != no_index)
+        {
+            for (unsigned int k = leaf_offsets[leaf]; k < leaf_offsets[leaf + 1]; k++)
+            {
+                if (edge_points[leaf_edges[k]] != no_index)
+                {
+                    sides[side_counter].face = create_face(irregular_face_start, edge_points[leaf_edges[k]], &edges[leaf_edges[k]]);
+                    break;
+                }
+            }
+        }
+    }
+    statistics.memory(cells.capacity() * sizeof(TemporaryRefinedCell<B>) + (leaf_cells.capacity() + vertex_points.capacity() + edge_points.capacity() + edge_faces.capacity()) * sizeof(unsigned int)
+        + vertices.capacity() * sizeof(typename Quadtree<B>::Vertex) + edges.capacity() * sizeof(typename Quadtree<B>::Edge));
+    statistics.end();
+
+    //Ordering, elements of the curve are leaves of the finest level
+    if (parameters.ordering != Ordering::lattice)
+    {
+        statistics.begin("ordering");
+        Parameters finest = parameters;
+        finest.size = parameters.size / (double)(1u << parameters.refinement);
+        const GridReordering reordering = reorder(_indexed, get_cell_order(_indexed, finest, parameters.ordering));
+        permute(cell_sources, reordering.cell_map);
+        permute(point_sources, reordering.point_map);
+        permute(face_sources, reordering.face_map);
+        statistics.end();
+    }
+
+    //STAGES 8-10: calculate flips and connectivity, create objects
+    _connect((unsigned int)_indexed.point_coords.size(), pool, statistics);
+    if (parameters.storage == Storage::objects) _create_objects(point_sources, face_sources, cell_sources, statistics);
+}
+
+template <class B, class P, class F, class C> template <class S> void gg::CellGrid<B, P, F, C>::_connect(unsigned int point_count, ThreadPool &pool, S &statistics)
+{
+    const std::vector<F*> &face_objects = _face_objects;
+    const std::vector<C*> &cell_objects = _cell_objects;
+    //STAGE 8: calculating if faces are flipped, sides of every cell are calculated in parallel, from objects if they were created directly
+    statistics.begin("flips");
+    const unsigned int cell_count = (unsigned int)_indexed.side_offsets.size() - 1;
+    parallel_for(pool, cell_count, [&](unsigned int cell)
+    {
+        for (unsigned int s = _indexed.side_offsets[cell]; s < _indexed.side_offsets[cell + 1]; s++)
+        {
+            const unsigned int face = _indexed.sides[s].face;
+            if (cell_objects.empty()) _indexed.sides[s].inwards = ((_indexed.cell_centers[cell] - _indexed.face_centers[face]).dot(_indexed.face_normals[face]) >= 0.0);
+            else _indexed.sides[s].inwards = ((cell_objects[cell]->center() - face_objects[face]->center()).dot(face_objects[face]->normal()) >= 0.0);
+        }
+    });
+
+    statistics.end();
+
+    //STAGE 9: create connectivity
+    statistics.begin("connectivity");
+    _connectivity.cell_offsets = _indexed.side_offsets;
+    _connectivity.cell_faces.resize(_indexed.sides.size());
+    _connectivity.cell_face_inwards.resize(_indexed.sides.size());
+    _connectivity.cell_points.resize(_indexed.sides.size());
+    _connectivity.face_cells.assign(_indexed.face_points.size(), std::array<unsigned int, 2>{{ no_index, no_index }});
+    _connectivity.point_offsets.assign(point_count + 1, 0);
+    for (unsigned int cell = 0; cell < cell_count; cell++)
+    {
+        for (unsigned int s = _indexed.side_offsets[cell]; s < _indexed.side_offsets[cell + 1]; s++)
+        {
+            const IndexedSide &side = _indexed.sides[s];
+            _connectivity.cell_faces[s] = side.face;
+            _connectivity.cell_face_inwards[s] = side.inwards ? 1 : 0;
+            _connectivity.cell_points[s] = side.point;
+            std::array<unsigned int, 2> &face_cells = _connectivity.face_cells[side.face];
+            if (face_cells[0] == no_index) face_cells[0] = cell;
+            else if (side.inwards) face_cells[1] = cell;
+            else { face_cells[1] = face_cells[0]; face_cells[0] = cell; }
+            _connectivity.point_offsets[side.point + 1]++;
+        }
+    }
+    for (unsigned int point = 0; point < point_count; point++) _connectivity.point_offsets[point + 1] += _connectivity.point_offsets[point];
+    _connectivity.point_cells.resize(_connectivity.point_offsets.back());
+    {
+        std::vector<unsigned int> point_counters(_connectivity.point_offsets.begin(), _connectivity.point_offsets.end() - 1);
+        for (unsigned int cell = 0; cell < cell_count; cell++)
+        {
+            for (unsigned int s = _indexed.side_offsets[cell]; s < _indexed.side_offsets[cell + 1]; s++) _connectivity.point_cells[point_counters[_indexed.sides[s].point]++] = cell;
+        }
+    }
+    statistics.end();
+    if (_parameters.geometry) _compute_geometry(nullptr, nullptr, nullptr, nullptr, pool, statistics);
+}
+
+template <class B, class P, class F, class C> template <class S> void gg::CellGrid<B, P, F, C>::_compute_geometry(const std::vector<unsigned int> *faces, const std::vector<unsigned int> *cells, std::vector<unsigned int> *free_face_records, std::vector<unsigned int> *free_cell_records, ThreadPool &pool, S &statistics)
+{
+    //Geometric factors, faces and cells are compared with whole lattice elements in parallel, their own records are numbered serially and filled in parallel
+    //Update passes only faces and cells it changed, they keep their own records or take free records of removed faces and cells
+    statistics.begin("geometry");
+    const bool arrays = !_indexed.side_offsets.empty(); //In objects mode, arrays are released after objects are created
+    const unsigned int face_count = (unsigned int)_connectivity.face_cells.size(), cell_count = (unsigned int)_connectivity.cell_offsets.size() - 1;
+    const Lattice lattice(_parameters);
+    const double epsilon = 1e-9 * sqrt(lattice.area());
+    CellGeometry &geometry = _geometry;
+    const auto cell_center = [&](unsigned int cell) -> Vector { return arrays ? _indexed.cell_centers[cell] : _cell_objects[cell]->center(); };
+    const auto cell_area = [&](unsigned int cell) -> double { return arrays ? _indexed.cell_areas[cell] : _cell_objects[cell]->area(); };
+    const auto face_center = [&](unsigned int face) -> Vector { return arrays ? _indexed.face_centers[face] : _face_objects[face]->center(); };
+    const auto face_normal = [&](unsigned int face) -> Vector { return arrays ? _indexed.face_normals[face] : _face_objects[face]->normal(); };
+    const auto face_length = [&](unsigned int face) -> double { return arrays ? _indexed.face_lengths[face] : _face_objects[face]->length(); };
+    const auto resize_faces = [&](unsigned int records)
+    {
+        geometry.unit_normals.resize(records);
+        geometry.deltas.resize(records);
+        geometry.distances.resize(records);
+        geometry.weights.resize(records);
+        geometry.diffusion_coefficients.resize(records);
+        geometry.non_orthogonal_corrections.resize(records);
+        geometry.skewness_corrections.resize(records);
+    };
+    const auto set_face = [&](unsigned int record, Vector normal, Vector owner, Vector center, const Vector *neighbor)
+    {
+        if (normal.dot(center - owner) < 0.0) normal = normal * -1.0;
+        const Vector delta = (neighbor == nullptr) ? (center - owner) : (*neighbor - owner);
+        const double coefficient = normal.dot(normal) / normal.dot(delta);
+        geometry.unit_normals[record] = normal / normal.norm();
+        geometry.deltas[record] = delta;
+        geometry.distances[record] = delta.norm();
+        geometry.weights[record] = (neighbor == nullptr) ? 1.0 : (normal.dot(*neighbor - center) / normal.dot(delta));
+        geometry.diffusion_coefficients[record] = coefficient;
+        geometry.non_orthogonal_corrections[record] = normal - delta * coefficient;
+        geometry.skewness_corrections[record] = center - (owner + delta * (normal.dot(center - owner) / normal.dot(delta)));
+    };
+    const auto set_cell = [&](unsigned int record, double area, const std::vector<Vector> &deltas)
+    {
+        double xx = 0.0, xy = 0.0, yy = 0.0;
+        for (std::vector<Vector>::const_iterator delta = deltas.begin(); delta != deltas.end(); delta++)
+        {
+            xx += delta->x * delta->x;
+            xy += delta->x * delta->y;
+            yy += delta->y * delta->y;
+        }
+        const double determinant = xx * yy - xy * xy;
+        geometry.inverse_areas[record] = 1.0 / area;
+        if (determinant == 0.0) geometry.gradient_matrices[record] = std::array<double, 3>{{ 0.0, 0.0, 0.0 }};
+        else geometry.gradient_matrices[record] = std::array<double, 3>{{ yy / determinant, -xy / determinant, xx / determinant }};
+    };
+    //Own record of the face or cell, the old one if it had one, otherwise a free one or a new one
+    const auto own_record = [](unsigned int old, unsigned int shared, std::vector<unsigned int> *free, unsigned int &records) -> unsigned int
+    {
+        if (old != no_index && old >= shared) return old;
+        if (free != nullptr && !free->empty()) { const unsigned int record = free->back(); free->pop_back(); return record; }
+        return records++;
+    };
+
+    //Shared records of faces between whole lattice elements (neighbor is the reflection of the element through the face center), and of whole lattice elements
+    const unsigned int orientations = (_parameters.typ == GridType::triangular) ? 2 : 1;
+    const unsigned int shared_faces = orientations * lattice.shape();
+    std::vector<unsigned int> all_faces, all_cells;
+    if (faces == nullptr)
+    {
+        geometry = CellGeometry();
+        resize_faces(shared_faces);
+        std::vector<Vector> shared_deltas;
+        for (unsigned int orientation = 0; orientation < orientations; orientation++)
+        {
+            Position position;
+            position.upside_down = (orientation == 1);
+            const Vector center = lattice.center(position);
+            const std::array<Vector, 6> points = lattice.points(position);
+            for (unsigned int p = 0; p < lattice.shape(); p++)
+            {
+                const Vector a = points[p], b = points[(p + 1) % lattice.shape()];
+                const Vector middle = (a + b) * 0.5, neighbor = middle * 2.0 - center;
+                set_face(orientation * lattice.shape() + p, rotate_ccw(a - b), center, middle, &neighbor);
+                if (orientation == 0) shared_deltas.push_back(neighbor - center);
+            }
+        }
+        geometry.inverse_areas.resize(1);
+        geometry.gradient_matrices.resize(1);
+        set_cell(0, lattice.area(), shared_deltas);
+        geometry.face_records.assign(face_count, no_index);
+        geometry.cell_records.assign(cell_count, no_index);
+        all_faces.resize(face_count);
+        for (unsigned int face = 0; face < face_count; face++) all_faces[face] = face;
+        all_cells.resize(cell_count);
+        for (unsigned int cell = 0; cell < cell_count; cell++) all_cells[cell] = cell;
+        faces = &all_faces;
+        cells = &all_cells;
+    }
+    const auto whole = [&](unsigned int cell) -> bool
+    {
+        return std::abs(cell_area(cell) - lattice.area()) <= epsilon * sqrt(lattice.area());
+    };
+    const auto same = [&](Vector a, Vector b) -> bool
+    {
+        return std::abs(a.x - b.x) <= epsilon && std::abs(a.y - b.y) <= epsilon;
+    };
+
+    //Faces
+    std::vector<unsigned int> matches(faces->size());
+    parallel_for(pool, (unsigned int)faces->size(), [&](unsigned int i)
+    {
+        const unsigned int face = (*faces)[i];
+        matches[i] = no_index;
+        const std::array<unsigned int, 2> face_cells = _connectivity.face_cells[face];
+        if (face_cells[1] == no_index || !whole(face_cells[0]) || !whole(face_cells[1])) return;
+        const Vector owner = cell_center(face_cells[0]), center = face_center(face);
+        Vector normal = face_normal(face) / face_length(face);
+        if (normal.dot(center - owner) < 0.0) normal = normal * -1.0;
+        const Vector delta = cell_center(face_cells[1]) - owner;
+        for (unsigned int record = 0; record < shared_faces; record++)
+        {
+            if (same(delta, geometry.deltas[record]) && same(normal, geometry.unit_normals[record])) { matches[i] = record; break; }
+        }
+    });
+    std::vector<unsigned int> own_faces;
+    unsigned int face_records = (unsigned int)geometry.unit_normals.size();
+    for (unsigned int i = 0; i < faces->size(); i++)
+    {
+        const unsigned int face = (*faces)[i], old = geometry.face_records[face];
+        if (matches[i] != no_index)
+        {
+            if (old != no_index && old >= shared_faces && free_face_records != nullptr) free_face_records->push_back(old);
+            geometry.face_records[face] = matches[i];
+            continue;
+        }
+        geometry.face_records[face] = own_record(old, shared_faces, free_face_records, face_records);
+        own_faces.push_back(face);
+    }
+    resize_faces(face_records);
+    parallel_for(pool, (unsigned int)own_faces.size(), [&](unsigned int i)
+    {
+        const unsigned int face = own_faces[i];
+        const std::array<unsigned int, 2> face_cells = _connectivity.face_cells[face];
+        const Vector owner = cell_center(face_cells[0]);
+        if (face_cells[1] == no_index) set_face(geometry.face_records[face], face_normal(face), owner, face_center(face), nullptr);
+        else
+        {
+            const Vector neighbor = cell_center(face_cells[1]);
+            set_face(geometry.face_records[face], face_normal(face), owner, face_center(face), &neighbor);
+        }
+    });
+
+    //Cells, whole cells share the record if all their faces do
+    matches.resize(cells->size());
+    parallel_for(pool, (unsigned int)cells->size(), [&](unsigned int i)
+    {
+        const unsigned int cell = (*cells)[i];
+        bool shared = whole(cell) && (_connectivity.cell_offsets[cell + 1] - _connectivity.cell_offsets[cell] == lattice.shape());
+        for (unsigned int s = _connectivity.cell_offsets[cell]; s < _connectivity.cell_offsets[cell + 1] && shared; s++) shared = geometry.face_records[_connectivity.cell_faces[s]] < shared_faces;
+        matches[i] = shared ? 0 : no_index;
+    });
+    std::vector<unsigned int> own_cells;
+    unsigned int cell_records = (unsigned int)geometry.inverse_areas.size();
+    for (unsigned int i = 0; i < cells->size(); i++)
+    {
+        const unsigned int cell = (*cells)[i], old = geometry.cell_records[cell];
+        if (matches[i] != no_index)
+        {
+            if (old != no_index && old >= 1 && free_cell_records != nullptr) free_cell_records->push_back(old);
+            geometry.cell_records[cell] = 0;
+            continue;
+        }
+        geometry.cell_records[cell] = own_record(old, 1, free_cell_records, cell_records);
+        own_cells.push_back(cell);
+    }
+    geometry.inverse_areas.resize(cell_records);
+    geometry.gradient_matrices.resize(cell_records);
+    parallel_for(pool, (unsigned int)own_cells.size(), [&](unsigned int i)
+    {
+        const unsigned int cell = own_cells[i];
+        std::vector<Vector> deltas;
+        for (unsigned int s = _connectivity.cell_offsets[cell]; s < _connectivity.cell_offsets[cell + 1]; s++)
+        {
+            const unsigned int face = _connectivity.cell_faces[s];
+            const std::array<unsigned int, 2> face_cells = _connectivity.face_cells[face];
+            const unsigned int neighbor = (face_cells[0] == cell) ? face_cells[1] : face_cells[0];
+            deltas.push_back(((neighbor == no_index) ? face_center(face) : cell_center(neighbor)) - cell_center(cell));
+        }
+        set_cell(geometry.cell_records[cell], cell_area(cell), deltas);
+    });
+
+    statistics.end();
+}
+
+template <class B, class P, class F, class C> template <class PS, class FS, class CS, class S> void gg::CellGrid<B, P, F, C>::_create_objects(const std::vector<const PS*> &point_sources, const std::vector<const FS*> &face_sources, const std::vector<const CS*> &cell_sources, S &statistics)
+{
+    //STAGE 10: create objects from contiguous arrays
+    statistics.begin("objects");
+    std::vector<P*> &point_objects = _point_objects;
+    point_objects.resize(_indexed.point_coords.size());
+    _point_arena.reserve(point_objects.size());
+    for (unsigned int point = 0; point < point_objects.size(); point++)
+    {
+        if (point_sources[point] == nullptr) point_objects[point] = _point_arena.create(_indexed.point_coords[point]);
+        else point_objects[point] = _point_arena.create(point_sources[point]->intersection, point_sources[point]->boundary);
+        _points.insert(point_objects[point]);
+    }
+    std::vector<F*> &face_objects = _face_objects;
+    face_objects.resize(_indexed.face_points.size());
+    _face_arena.reserve(face_objects.size());
+    for (unsigned int face = 0; face < face_objects.size(); face++)
+    {
+        P *a = point_objects[_indexed.face_points[face][0]], *b = point_objects[_indexed.face_points[face][1]];
+        if (face_sources[face] == nullptr) face_objects[face] = _face_arena.create(a, b);
+        else face_objects[face] = _face_arena.create(a, b, face_sources[face]->intersection, face_sources[face]->boundary);
+        _faces.insert(face_objects[face]);
+    }
+    std::vector<C*> &cell_objects = _cell_objects;
+    cell_objects.resize(_indexed.cell_centers.size());
+    _cell_arena.reserve(cell_objects.size());
+    for (unsigned int cell = 0; cell < cell_objects.size(); cell++)
+    {
+        if (cell_sources[cell]->boundary == nullptr) cell_objects[cell] = _cell_arena.create(cell_sources[cell]->center, cell_sources[cell]->area);
+        else cell_objects[cell] = _cell_arena.create(cell_sources[cell]->center, cell_sources[cell]->area, cell_sources[cell]->intersection, cell_sources[cell]->boundary);
+        _cells.insert(cell_objects[cell]);
+    }
+    _create_sides();
+    statistics.end();
+}
+
+template <class B, class P, class F, class C> void gg::CellGrid<B, P, F, C>::_create_sides()
+{
+    //Sides of objects are linked by pointers, arrays are not needed anymore, objects by index are kept only for update
+    for (unsigned int cell = 0; cell < _cell_objects.size(); cell++)
+    {
+        _cell_objects[cell]->sides().reserve(_indexed.side_offsets[cell + 1] - _indexed.side_offsets[cell]);
+        for (unsigned int s = _indexed.side_offsets[cell]; s < _indexed.side_offsets[cell + 1]; s++)
+        {
+            const IndexedSide &side = _indexed.sides[s];
+            _cell_objects[cell]->sides().push_back({ _point_objects[side.point], _face_objects[side.face], (side.cell == no_index) ? nullptr : _cell_objects[side.cell], side.inwards });
+        }
+    }
+    _indexed = IndexedCellGrid();
+    if (!_parameters.incremental)
+    {
+        std::vector<P*>().swap(_point_objects);
+        std::vector<F*>().swap(_face_objects);
+        std::vector<C*>().swap(_cell_objects);
+    }
+}
+
+
+template <class B, class P, class F, class C> gg::CellGrid<B, P, F, C>::~CellGrid() {}
+
+template <class B, class P, class F, class C>std::set<P*> &gg::CellGrid<B, P, F, C>::points()
+{
+    return _points;
+}
+
+template <class B, class P, class F, class C>std::set<F*> &gg::CellGrid<B, P, F, C>::faces()
+{
+    return _faces;
+}
+
+template <class B, class P, class F, class C>std::set<C*> &gg::CellGrid<B, P, F, C>::cells()
+{
+    return _cells;
+}
+
+template <class B, class P, class F, class C> gg::IndexedCellGrid &gg::CellGrid<B, P, F, C>::indexed()
+{
+    return _indexed;
+}
+
+template <class B, class P, class F, class C> const gg::IndexedCellGrid &gg::CellGrid<B, P, F, C>::indexed() const
+{
+    return _indexed;
+}
+
+template <class B, class P, class F, class C> const gg::CellConnectivity &gg::CellGrid<B, P, F, C>::connectivity() const
+{
+    return _connectivity;
+}
+
+template <class B, class P, class F, class C> const gg::CellGeometry &gg::CellGrid<B, P, F, C>::geometry() const
+{
+    return _geometry;
+}
+
+template <class B, class P, class F, class C> const gg::CellLocator &gg::CellGrid<B, P, F, C>::locator() const
+{
+    return _locator;
+}
+
+template <class B, class P, class F, class C> const gg::CellPartition &gg::CellGrid<B, P, F, C>::partition() const
+{
+    return _partition;
+}
+
+template <class B, class P, class F, class C> gg::CellGridChanges gg::CellGrid<B, P, F, C>::update(const std::vector<B> &boundaries, const std::vector<unsigned int> &changed)
+{
+    NoStatistics statistics;
+    return update(boundaries, changed, statistics);
+}
+
+template <class B, class P, class F, class C> template <class S> gg::CellGridChanges gg::CellGrid<B, P, F, C>::update(const std::vector<B> &boundaries, const std::vector<unsigned int> &changed, S &statistics)
+{
+    if (_lattice == nullptr) throw std::runtime_error("gg::CellGrid::update(): Grid was not generated with parameters.incremental");
+    ThreadPool pool(get_threads(_parameters));
+    switch (_parameters.typ)
+    {
+        case GridType::triangular: return _update<LatticeTraits<GridType::triangular>>(boundaries, changed, pool, statistics);
+        case GridType::hexagonal: return _update<LatticeTraits<GridType::hexagonal>>(boundaries, changed, pool, statistics);
+        default: return _update<LatticeTraits<GridType::square>>(boundaries, changed, pool, statistics);
+    }
+}
+
+template <class B, class P, class F, class C> template <class L, class S> gg::CellGridChanges gg::CellGrid<B, P, F, C>::_update(const std::vector<B> &boundaries, const std::vector<unsigned int> &changed, ThreadPool &pool, S &statistics)
+{
+    if (boundaries.size() != _bounds.size() || (!boundaries.empty() && &boundaries[0] != _boundaries)) throw std::runtime_error("gg::CellGrid::update(): Boundaries are not the ones used for generation");
+    const CellGridParameters &parameters = _parameters;
+    const Lattice lattice(parameters);
+    TemporaryLattice<B, L> &state = static_cast<TemporaryLattice<B, L>&>(*_lattice);
+    std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells = state.cells;
+    std::vector<TemporaryVertex> &vertices = state.vertices;
+    std::vector<TemporaryEdge<B>> &edges = state.edges;
+    const auto lookup = [&](std::unordered_map<Position, TemporaryCell<B, L>, PositionHash> &cells, Position position) -> typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator
+    {
+        statistics.lookup();
+        return cells.find(position);
+    };
+
+    //STAGE 0: find region that contains old and new bounds of changed boundaries, extended by one cell
+    statistics.begin("region");
+    Box region;
+    for (std::vector<unsigned int>::const_iterator boundary = changed.begin(); boundary != changed.end(); boundary++)
+    {
+        if (*boundary >= boundaries.size()) throw std::runtime_error("gg::CellGrid::update(): Invalid boundary index");
+        region.extend(_bounds[*boundary]);
+        _bounds[*boundary] = BoundaryTraits<B>::bounds(boundaries[*boundary]);
+        region.extend(_bounds[*boundary]);
+    }
+    const std::array<Vector, 6> cell_points = lattice.points(Position());
+    double diameter = 0.0;
+    for (unsigned int p = 0; p < L::shape; p++)
+    {
+        for (unsigned int q = 0; q < p; q++) diameter = std::max(diameter, (cell_points[p] - cell_points[q]).norm());
+    }
+    region.min = region.min - Vector(diameter, diameter);
+    region.max = region.max + Vector(diameter, diameter);
+    const auto affected = [&](Vector coord) -> bool
+    {
+        return coord.x >= region.min.x && coord.x <= region.max.x && coord.y >= region.min.y && coord.y <= region.max.y;
+    };
+
+    //Find positions of cells with points in the region, faces that cross the region have at least one point in it
+    std::vector<Position> positions;
+    if (!region.empty() && !region.finite())
+    {
+        for (typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::const_iterator cell = cells.begin(); cell != cells.end(); cell++) positions.push_back(cell->first);
+        std::sort(positions.begin(), positions.end());
+    }
+    else if (!region.empty())
+    {
+        double xmin = INFINITY, xmax = -INFINITY, ymin = INFINITY, ymax = -INFINITY;
+        const Vector corners[4] = { region.min, Vector(region.max.x, region.min.y), region.max, Vector(region.min.x, region.max.y) };
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            const Vector coord = lattice.lattice_coord(corners[i]);
+            double xi, yi;
+            switch (parameters.typ)
+            {
+                case GridType::triangular: yi = coord.y / (0.5 * sqrt(3)); xi = coord.x - 0.5 * yi; break;
+                case GridType::hexagonal: yi = coord.y / sqrt(3); xi = 0.5 * (coord.x - yi); break;
+                default: yi = coord.y; xi = coord.x; break;
+            }
+            xmin = std::min(xmin, xi); xmax = std::max(xmax, xi);
+            ymin = std::min(ymin, yi); ymax = std::max(ymax, yi);
+        }
+        const unsigned int layers = (parameters.typ == GridType::triangular) ? 2 : 1;
+        Position position;
+        for (position.yi = (int)floor(ymin) - 2; position.yi <= (int)ceil(ymax) + 2; position.yi++)
+        {
+            for (position.xi = (int)floor(xmin) - 2; position.xi <= (int)ceil(xmax) + 2; position.xi++)
+            {
+                for (unsigned int layer = 0; layer < layers; layer++)
+                {
+                    position.upside_down = (layer == 1);
+                    const std::array<Vector, 6> points = lattice.points(position);
+                    for (unsigned int p = 0; p < L::shape; p++)
+                    {
+                        if (affected(points[p])) { positions.push_back(position); break; }
+                    }
+                }
+            }
+        }
+    }
+
+    //Remember complete cells of the region, and vertices and edges of all cells of the region
+    CellConnectivity &connectivity = _connectivity;
+    const unsigned int old_cell_count = (unsigned int)connectivity.cell_offsets.size() - 1;
+    const unsigned int old_face_count = (unsigned int)connectivity.face_cells.size();
+    const unsigned int old_point_count = (unsigned int)connectivity.point_offsets.size() - 1;
+    std::map<unsigned int, std::pair<double, Vector>> region_old;   //Areas and centers of complete cells of the region by their old indexes
+    std::vector<unsigned int> region_vertices, region_edges;
+    state.touched.clear();
+
+    //Forget points and faces in the region, cells are kept to preserve their indexes (if they are complete again)
+    //Forgotten points and faces remember their old indexes, they take them back if they are reached again
+    std::vector<PointPosition> reached;
+    for (std::vector<Position>::const_iterator position = positions.begin(); position != positions.end(); position++)
+    {
+        typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, *position);
+        if (cell == cells.end()) continue;
+        state.touched.push_back(*position);
+        if (cell->second.cell != no_index) region_old[cell->second.cell] = std::make_pair(cell->second.area, cell->second.center);
+        const std::array<Vector, 6> points = lattice.points(*position);
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            region_vertices.push_back(cell->second.vertices[p]);
+            region_edges.push_back(cell->second.edges[p]);
+            if (!affected(points[p])) continue;
+            TemporaryVertex &vertex = vertices[cell->second.vertices[p]];
+            if (vertex.status == PointStatus::passive) reached.push_back({ *position, p });
+            vertex.status = PointStatus::unreached;
+            if (vertex.point != no_index) { vertex.old_point = vertex.point; vertex.point = no_index; }
+        }
+        cell->second.intersection = Intersection();
+        cell->second.boundary = nullptr;
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            TemporaryEdge<B> &face = edges[cell->second.edges[p]];
+            if (affected(points[p]) || affected(points[next_ccw]))
+            {
+                face.probed = false;
+                face.intersection = Intersection();
+                face.boundary = nullptr;
+                if (face.point != no_index || face.face != no_index)
+                {
+                    face.old_point = face.point;
+                    face.old_face = face.face;
+                    face.point = face.face = no_index;
+                }
+            }
+            else if (face.intersection.valid && !cell->second.intersection.valid)
+            {
+                cell->second.intersection = face.intersection;
+                cell->second.boundary = face.boundary;
+            }
+        }
+    }
+    std::vector<unsigned int> region_cells; //Old indexes of complete cells of the region, ascending
+    for (typename std::map<unsigned int, std::pair<double, Vector>>::const_iterator cell = region_old.begin(); cell != region_old.end(); cell++) region_cells.push_back(cell->first);
+    const auto region_cell = [&](unsigned int cell) -> bool
+    {
+        return std::binary_search(region_cells.begin(), region_cells.end(), cell);
+    };
+
+    //Reached points next to forgotten points become active, together with all their cells
+    std::vector<PointPosition> seeds;
+    for (std::vector<Position>::const_iterator position = positions.begin(); position != positions.end(); position++)
+    {
+        typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, *position);
+        if (cell == cells.end()) continue;
+        const std::array<Vector, 6> points = lattice.points(*position);
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            const unsigned int next_cw = ((p == 0) ? (L::shape - 1) : (p - 1));
+            if (vertices[cell->second.vertices[p]].status == PointStatus::passive
+            && ((vertices[cell->second.vertices[next_ccw]].status == PointStatus::unreached && affected(points[next_ccw]))
+            || (vertices[cell->second.vertices[next_cw]].status == PointStatus::unreached && affected(points[next_cw])))) seeds.push_back({ *position, p });
+        }
+    }
+
+    //Points of the region that lie inside of the domain become active too, so parts of the domain that appear in the region are found like in Generation::scanline
+    if (parameters.generation == Generation::scanline && !positions.empty())
+    {
+        const BoundaryIndex<B> index(parameters, boundaries);
+        const Scanline<B> scanline(parameters, index);
+        std::map<std::pair<Position, unsigned int>, TemporaryRow> rows;
+        for (std::vector<Position>::const_iterator position = positions.begin(); position != positions.end(); position++)
+        {
+            const std::array<Vector, 6> points = lattice.points(*position);
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                if (!affected(points[p])) continue;
+                const PointPosition canonical = L::canonical_point({ *position, p });
+                Position row_zero = canonical.position, row_one = canonical.position;
+                row_zero.xi = 0;
+                row_one.xi = 1;
+                TemporaryRow &row = rows[{ row_zero, canonical.point }];
+                if (!row.ready)
+                {
+                    int row_xmin, row_xmax;
+                    row.valid = scanline.columns(lattice.points(row_zero)[canonical.point], lattice.points(row_one)[canonical.point], row_xmin, row_xmax, row.crossings);
+                    row.ready = true;
+                }
+                if (row.valid && Scanline<B>::inside(row.crossings, canonical.position.xi)) seeds.push_back({ *position, p });
+            }
+        }
+    }
+
+    //If no reached point is left, the search starts from points that were reached before the update
+    if (seeds.empty() && !positions.empty())
+    {
+        bool connected = false;
+        for (std::vector<TemporaryVertex>::const_iterator vertex = vertices.begin(); vertex != vertices.end() && !connected; vertex++) connected = (vertex->status == PointStatus::passive);
+        if (!connected)
+        {
+            if (reached.empty()) throw std::runtime_error("gg::CellGrid::update(): No reached points to start search from");
+            seeds = reached;
+        }
+    }
+    statistics.end();
+
+    //STAGES 1-4: search from active points, only cells touched by the search are calculated again
+    _search<L>(parameters, boundaries, &seeds, nullptr, pool, statistics);
+    typedef std::pair<const Position, TemporaryCell<B, L>> Entry;
+    const bool arrays = !_indexed.side_offsets.empty(); //In objects mode, arrays are released after objects are created
+    const auto contains = [](const std::vector<unsigned int> &sorted, unsigned int index) -> bool
+    {
+        return std::binary_search(sorted.begin(), sorted.end(), index);
+    };
+    const auto moved = [](const std::map<unsigned int, unsigned int> &moves, unsigned int index) -> unsigned int
+    {
+        const std::map<unsigned int, unsigned int>::const_iterator move = moves.find(index);
+        return (move == moves.end()) ? index : move->second;
+    };
+    const auto unique = [](std::vector<unsigned int> &list)
+    {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    };
+
+    //STAGE 5: number cells, complete cells of the region keep their indexes, new cells are numbered after the old ones
+    statistics.begin("cells");
+    std::vector<Entry*> dirty;  //Complete cells touched by the update in order of positions, their sides are created again
+    std::vector<unsigned int> dirty_cells;  //Old (or temporary) indexes of touched cells
+    unsigned int added_cells = 0;
+    for (std::vector<Position>::const_iterator position = state.touched.begin(); position != state.touched.end(); position++)
+    {
+        const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, *position);
+        if (cell == cells.end()) continue;
+        if (!cell->second.complete) { cell->second.cell = no_index; continue; }
+        if (cell->second.cell == no_index) cell->second.cell = old_cell_count + added_cells++;
+        dirty.push_back(&*cell);
+        dirty_cells.push_back(cell->second.cell);
+    }
+    std::vector<unsigned int> free_cells;   //Old cells of the region that do not exist anymore, ascending
+    for (std::vector<unsigned int>::const_iterator cell = region_cells.begin(); cell != region_cells.end(); cell++)
+    {
+        const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator find = lookup(cells, state.cell_positions[*cell]);
+        if (find == cells.end() || find->second.cell != *cell) free_cells.push_back(*cell);
+    }
+    statistics.end();
+
+    //STAGE 6: create points and faces of touched cells like in _generate(), forgotten points and faces take their old indexes back
+    //Points and faces outside of the region are kept, only points and faces that are written here get new values
+    statistics.begin("sides");
+    unsigned int added_points = 0, added_faces = 0;
+    std::map<unsigned int, unsigned int> written_point_indexes, written_face_indexes;   //Index in written lists by index of the point or face
+    std::vector<unsigned int> written_points, written_faces;
+    std::vector<Vector> written_point_coords;
+    std::vector<const TemporaryEdge<B>*> written_point_sources, written_face_sources;
+    std::vector<std::array<unsigned int, 2>> written_face_points;
+    const auto create_point = [&](unsigned int &point, unsigned int old_point, Vector coord, const TemporaryEdge<B> *source) -> unsigned int
+    {
+        if (point != no_index) return point;
+        point = (old_point != no_index) ? old_point : (old_point_count + added_points++);
+        written_point_indexes[point] = (unsigned int)written_points.size();
+        written_points.push_back(point);
+        written_point_coords.push_back(coord);
+        written_point_sources.push_back(source);
+        return point;
+    };
+    const auto create_face = [&](unsigned int a, unsigned int b, const TemporaryEdge<B> *source, unsigned int old_face) -> unsigned int
+    {
+        const unsigned int face = (old_face != no_index) ? old_face : (old_face_count + added_faces++);
+        written_face_indexes[face] = (unsigned int)written_faces.size();
+        written_faces.push_back(face);
+        written_face_points.push_back(std::array<unsigned int, 2>{{ a, b }});
+        written_face_sources.push_back(source);
+        return face;
+    };
+    const auto point_coord = [&](unsigned int point) -> Vector
+    {
+        const std::map<unsigned int, unsigned int>::const_iterator written = written_point_indexes.find(point);
+        if (written != written_point_indexes.end()) return written_point_coords[written->second];
+        return arrays ? _indexed.point_coords[point] : _point_objects[point]->coord();
+    };
+    const auto face_geometry = [&](unsigned int face, Vector &center, Vector &normal)
+    {
+        const std::map<unsigned int, unsigned int>::const_iterator written = written_face_indexes.find(face);
+        if (written != written_face_indexes.end())
+        {
+            const Vector a = point_coord(written_face_points[written->second][0]), b = point_coord(written_face_points[written->second][1]);
+            center = (a + b) * 0.5;
+            normal = rotate_ccw(a - b);
+        }
+        else if (arrays) { center = _indexed.face_centers[face]; normal = _indexed.face_normals[face]; }
+        else { center = _face_objects[face]->center(); normal = _face_objects[face]->normal(); }
+    };
+    std::vector<unsigned int> dirty_offsets(1, 0), dirty_points, dirty_faces, dirty_old_sides, irregular;
+    std::vector<unsigned char> dirty_inwards;
+    for (unsigned int d = 0; d < dirty.size(); d++)
+    {
+        TemporaryCell<B, L> &cell = dirty[d]->second;
+        const std::array<Vector, 6> points = lattice.points(dirty[d]->first);
+        const unsigned int begin = (unsigned int)dirty_points.size();
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            TemporaryVertex &vertex = vertices[cell.vertices[p]];
+            if (vertex.status == PointStatus::passive) dirty_points.push_back(create_point(vertex.point, vertex.old_point, points[p], nullptr));
+            const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            if (vertex.status != vertices[cell.vertices[next_ccw]].status)
+            {
+                TemporaryEdge<B> &edge = edges[cell.edges[p]];
+                dirty_points.push_back(create_point(edge.point, edge.old_point, edge.intersection.coord, &edge));
+            }
+        }
+        dirty_faces.resize(dirty_points.size(), no_index);
+
+        //Old faces of the cell that are not faces of its edges are irregular, they are taken back in order
+        irregular.clear();
+        dirty_old_sides.push_back(0);
+        if (cell.cell < old_cell_count)
+        {
+            dirty_old_sides.back() = connectivity.cell_offsets[cell.cell + 1] - connectivity.cell_offsets[cell.cell];
+            for (unsigned int s = connectivity.cell_offsets[cell.cell]; s < connectivity.cell_offsets[cell.cell + 1]; s++)
+            {
+                const unsigned int face = connectivity.cell_faces[s];
+                bool regular = false;
+                for (unsigned int p = 0; p < L::shape && !regular; p++) regular = (edges[cell.edges[p]].face == face || edges[cell.edges[p]].old_face == face);
+                if (!regular) irregular.push_back(face);
+            }
+        }
+        unsigned int irregular_counter = 0;
+        const auto irregular_face = [&]() -> unsigned int
+        {
+            return (irregular_counter < irregular.size()) ? irregular[irregular_counter++] : no_index;
+        };
+
+        //Creating faces, same as in _generate()
+        unsigned int irregular_face_start = no_index;
+        unsigned int side_counter = begin;
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            const unsigned int next_ccw = ((p == (L::shape - 1)) ? 0 : (p + 1));
+            const TemporaryVertex &first = vertices[cell.vertices[p]], &second = vertices[cell.vertices[next_ccw]];
+            if (first.status != PointStatus::passive && second.status != PointStatus::passive) continue;
+            TemporaryEdge<B> &edge = edges[cell.edges[p]];
+            if (edge.face == no_index)
+            {
+                if (first.status == PointStatus::passive && second.status != PointStatus::passive) edge.face = create_face(first.point, edge.point, &edge, edge.old_face);
+                else if (first.status != PointStatus::passive && second.status == PointStatus::passive) edge.face = create_face(second.point, edge.point, &edge, edge.old_face);
+                else edge.face = create_face(first.point, second.point, nullptr, edge.old_face);
+            }
+            if (first.status != PointStatus::passive && second.status == PointStatus::passive)
+            {
+                if (irregular_face_start != no_index)
+                {
+                    dirty_faces[side_counter++] = create_face(irregular_face_start, edge.point, &edge, irregular_face());
+                    irregular_face_start = no_index;
+                }
+                dirty_faces[side_counter++] = edge.face;
+            }
+            else if (first.status == PointStatus::passive && second.status != PointStatus::passive)
+            {
+                dirty_faces[side_counter++] = edge.face;
+                irregular_face_start = edge.point;
+            }
+            else dirty_faces[side_counter++] = edge.face;
+        }
+        if (irregular_face_start != no_index)
+        {
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                const TemporaryEdge<B> &edge = edges[cell.edges[p]];
+                if (edge.point != no_index)
+                {
+                    dirty_faces[side_counter] = create_face(irregular_face_start, edge.point, &edge, irregular_face());
+                    break;
+                }
+            }
+        }
+
+        //Flips, same as in _connect()
+        for (unsigned int s = begin; s < dirty_points.size(); s++)
+        {
+            Vector center, normal;
+            face_geometry(dirty_faces[s], center, normal);
+            dirty_inwards.push_back(((cell.center - center).dot(normal) >= 0.0) ? 1 : 0);
+        }
+        dirty_offsets.push_back((unsigned int)dirty_points.size());
+    }
+
+    //Points and faces of old cells of the region are removed if no cell has them anymore
+    std::vector<unsigned int> used_points(dirty_points), used_faces(dirty_faces), free_points, free_faces;
+    std::vector<unsigned int> candidate_points, candidate_faces;
+    unique(used_points);
+    unique(used_faces);
+    for (std::vector<unsigned int>::const_iterator cell = region_cells.begin(); cell != region_cells.end(); cell++)
+    {
+        for (unsigned int s = connectivity.cell_offsets[*cell]; s < connectivity.cell_offsets[*cell + 1]; s++)
+        {
+            candidate_points.push_back(connectivity.cell_points[s]);
+            candidate_faces.push_back(connectivity.cell_faces[s]);
+        }
+    }
+    unique(candidate_points);
+    unique(candidate_faces);
+    for (std::vector<unsigned int>::const_iterator point = candidate_points.begin(); point != candidate_points.end(); point++)
+    {
+        if (contains(used_points, *point)) continue;
+        bool kept = false;
+        for (unsigned int i = connectivity.point_offsets[*point]; i < connectivity.point_offsets[*point + 1] && !kept; i++) kept = !region_cell(connectivity.point_cells[i]);
+        if (!kept) free_points.push_back(*point);
+    }
+    for (std::vector<unsigned int>::const_iterator face = candidate_faces.begin(); face != candidate_faces.end(); face++)
+    {
+        if (contains(used_faces, *face)) continue;
+        bool kept = false;
+        for (unsigned int i = 0; i < 2 && !kept; i++) kept = (connectivity.face_cells[*face][i] != no_index && !region_cell(connectivity.face_cells[*face][i]));
+        if (!kept) free_faces.push_back(*face);
+    }
+    statistics.end();
+
+    //STAGE 7: number new elements, last elements fill holes of removed elements, other elements keep their indexes
+    statistics.begin("numbering");
+    const auto compact = [&](unsigned int count, unsigned int added, const std::vector<unsigned int> &free, std::map<unsigned int, unsigned int> &moves) -> unsigned int
+    {
+        const unsigned int new_count = count + added - (unsigned int)free.size();
+        std::vector<unsigned int>::const_iterator hole = free.begin();
+        for (unsigned int index = new_count; index < count + added; index++)
+        {
+            if (!contains(free, index)) moves[index] = *hole++;
+        }
+        return new_count;
+    };
+    std::map<unsigned int, unsigned int> point_moves, face_moves, cell_moves;   //New indexes of moved elements by their old (or temporary) indexes
+    const unsigned int point_count = compact(old_point_count, added_points, free_points, point_moves);
+    const unsigned int face_count = compact(old_face_count, added_faces, free_faces, face_moves);
+    const unsigned int cell_count = compact(old_cell_count, added_cells, free_cells, cell_moves);
+    const auto clean_kept = [&](unsigned int cell) -> bool
+    {
+        return cell != no_index && !region_cell(cell) && cell_moves.find(cell) == cell_moves.end();
+    };
+    const auto old_inwards = [&](unsigned int cell, unsigned int face) -> bool
+    {
+        for (unsigned int s = connectivity.cell_offsets[cell]; s < connectivity.cell_offsets[cell + 1]; s++)
+        {
+            if (connectivity.cell_faces[s] == face) return connectivity.cell_face_inwards[s] != 0;
+        }
+        return false;
+    };
+
+    //Replaced rows of cells: touched cells and moved cells, with new indexes of their points and faces
+    std::map<unsigned int, unsigned int> dirty_indexes; //Index in dirty by old (or temporary) index of the cell
+    std::vector<std::pair<unsigned int, unsigned int>> replaced;    //New and old (or temporary) index of the cell
+    for (unsigned int d = 0; d < dirty.size(); d++)
+    {
+        dirty_indexes[dirty_cells[d]] = d;
+        replaced.push_back(std::make_pair(moved(cell_moves, dirty_cells[d]), dirty_cells[d]));
+    }
+    for (std::map<unsigned int, unsigned int>::const_iterator move = cell_moves.begin(); move != cell_moves.end(); move++)
+    {
+        if (move->first < old_cell_count && !region_cell(move->first)) replaced.push_back(std::make_pair(move->second, move->first));
+    }
+    std::sort(replaced.begin(), replaced.end());
+    std::vector<unsigned int> rows, row_offsets(1, 0), row_points, row_faces;
+    std::vector<unsigned char> row_inwards;
+    std::vector<Entry*> row_entries;
+    for (std::vector<std::pair<unsigned int, unsigned int>>::const_iterator row = replaced.begin(); row != replaced.end(); row++)
+    {
+        rows.push_back(row->first);
+        const std::map<unsigned int, unsigned int>::const_iterator d = dirty_indexes.find(row->second);
+        if (d != dirty_indexes.end())
+        {
+            for (unsigned int s = dirty_offsets[d->second]; s < dirty_offsets[d->second + 1]; s++)
+            {
+                row_points.push_back(moved(point_moves, dirty_points[s]));
+                row_faces.push_back(moved(face_moves, dirty_faces[s]));
+                row_inwards.push_back(dirty_inwards[s]);
+            }
+            row_entries.push_back(dirty[d->second]);
+        }
+        else
+        {
+            for (unsigned int s = connectivity.cell_offsets[row->second]; s < connectivity.cell_offsets[row->second + 1]; s++)
+            {
+                row_points.push_back(moved(point_moves, connectivity.cell_points[s]));
+                row_faces.push_back(moved(face_moves, connectivity.cell_faces[s]));
+                row_inwards.push_back(connectivity.cell_face_inwards[s]);
+            }
+            row_entries.push_back(&*lookup(cells, state.cell_positions[row->second]));
+        }
+        row_offsets.push_back((unsigned int)row_points.size());
+    }
+
+    //Cells of faces and points that were touched, moved or lost cells, cells of other faces and points do not change
+    std::map<unsigned int, std::vector<std::pair<unsigned int, bool>>> face_entries;   //Cells and flips by new index of the face
+    std::map<unsigned int, std::vector<unsigned int>> point_entries;                    //Cells by new index of the point
+    std::vector<unsigned int> affected_faces(used_faces), affected_points(used_points);
+    std::set_difference(candidate_faces.begin(), candidate_faces.end(), free_faces.begin(), free_faces.end(), std::back_inserter(affected_faces));
+    std::set_difference(candidate_points.begin(), candidate_points.end(), free_points.begin(), free_points.end(), std::back_inserter(affected_points));
+    for (std::map<unsigned int, unsigned int>::const_iterator move = face_moves.begin(); move != face_moves.end(); move++) affected_faces.push_back(move->first);
+    for (std::map<unsigned int, unsigned int>::const_iterator move = point_moves.begin(); move != point_moves.end(); move++) affected_points.push_back(move->first);
+    for (std::map<unsigned int, unsigned int>::const_iterator move = cell_moves.begin(); move != cell_moves.end(); move++)
+    {
+        if (move->first >= old_cell_count || region_cell(move->first)) continue;
+        for (unsigned int s = connectivity.cell_offsets[move->first]; s < connectivity.cell_offsets[move->first + 1]; s++)
+        {
+            affected_faces.push_back(connectivity.cell_faces[s]);
+            affected_points.push_back(connectivity.cell_points[s]);
+        }
+    }
+    unique(affected_faces);
+    unique(affected_points);
+    for (std::vector<unsigned int>::const_iterator face = affected_faces.begin(); face != affected_faces.end(); face++)
+    {
+        std::vector<std::pair<unsigned int, bool>> &entries = face_entries[moved(face_moves, *face)];
+        if (*face >= old_face_count) continue;
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            const unsigned int cell = connectivity.face_cells[*face][i];
+            if (clean_kept(cell)) entries.push_back(std::make_pair(cell, old_inwards(cell, *face)));
+        }
+    }
+    for (std::vector<unsigned int>::const_iterator point = affected_points.begin(); point != affected_points.end(); point++)
+    {
+        std::vector<unsigned int> &entries = point_entries[moved(point_moves, *point)];
+        if (*point >= old_point_count) continue;
+        for (unsigned int i = connectivity.point_offsets[*point]; i < connectivity.point_offsets[*point + 1]; i++)
+        {
+            if (clean_kept(connectivity.point_cells[i])) entries.push_back(connectivity.point_cells[i]);
+        }
+    }
+    for (unsigned int r = 0; r < rows.size(); r++)
+    {
+        for (unsigned int s = row_offsets[r]; s < row_offsets[r + 1]; s++)
+        {
+            face_entries[row_faces[s]].push_back(std::make_pair(rows[r], row_inwards[s] != 0));
+            point_entries[row_points[s]].push_back(rows[r]);
+        }
+    }
+    std::vector<std::pair<unsigned int, std::array<unsigned int, 2>>> new_face_cells;
+    for (typename std::map<unsigned int, std::vector<std::pair<unsigned int, bool>>>::iterator face = face_entries.begin(); face != face_entries.end(); face++)
+    {
+        std::sort(face->second.begin(), face->second.end());
+        std::array<unsigned int, 2> face_cells = {{ no_index, no_index }};
+        for (std::vector<std::pair<unsigned int, bool>>::const_iterator entry = face->second.begin(); entry != face->second.end(); entry++)
+        {
+            if (face_cells[0] == no_index) face_cells[0] = entry->first;
+            else if (entry->second) face_cells[1] = entry->first;
+            else { face_cells[1] = face_cells[0]; face_cells[0] = entry->first; }
+        }
+        new_face_cells.push_back(std::make_pair(face->first, face_cells));
+    }
+    std::vector<unsigned int> point_rows, point_row_offsets(1, 0), point_row_cells;
+    for (std::map<unsigned int, std::vector<unsigned int>>::iterator point = point_entries.begin(); point != point_entries.end(); point++)
+    {
+        std::sort(point->second.begin(), point->second.end());
+        point_rows.push_back(point->first);
+        point_row_cells.insert(point_row_cells.end(), point->second.begin(), point->second.end());
+        point_row_offsets.push_back((unsigned int)point_row_cells.size());
+    }
+
+    //Kept cells and faces that refer to moved points and faces
+    std::vector<unsigned int> remapped_cells, remapped_faces;
+    for (std::map<unsigned int, unsigned int>::const_iterator move = point_moves.begin(); move != point_moves.end() && move->first < old_point_count; move++)
+    {
+        for (unsigned int i = connectivity.point_offsets[move->first]; i < connectivity.point_offsets[move->first + 1]; i++)
+        {
+            const unsigned int cell = connectivity.point_cells[i];
+            if (clean_kept(cell)) remapped_cells.push_back(cell);
+            for (unsigned int s = connectivity.cell_offsets[cell]; s < connectivity.cell_offsets[cell + 1]; s++)
+            {
+                const unsigned int face = connectivity.cell_faces[s];
+                if (!contains(free_faces, face) && written_face_indexes.find(face) == written_face_indexes.end()) remapped_faces.push_back(moved(face_moves, face));
+            }
+        }
+    }
+    for (std::map<unsigned int, unsigned int>::const_iterator move = face_moves.begin(); move != face_moves.end() && move->first < old_face_count; move++)
+    {
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            if (clean_kept(connectivity.face_cells[move->first][i])) remapped_cells.push_back(connectivity.face_cells[move->first][i]);
+        }
+    }
+    unique(remapped_cells);
+    unique(remapped_faces);
+
+    //Lattice follows the new indexes
+    for (std::vector<unsigned int>::const_iterator v = region_vertices.begin(); v != region_vertices.end(); v++)
+    {
+        TemporaryVertex &vertex = vertices[*v];
+        if (vertex.point != no_index && contains(free_points, vertex.point)) vertex.point = no_index;
+        vertex.old_point = no_index;
+    }
+    for (std::vector<unsigned int>::const_iterator e = region_edges.begin(); e != region_edges.end(); e++)
+    {
+        TemporaryEdge<B> &edge = edges[*e];
+        if (edge.point != no_index && contains(free_points, edge.point)) edge.point = no_index;
+        if (edge.face != no_index && contains(free_faces, edge.face)) edge.face = no_index;
+        edge.old_point = edge.old_face = no_index;
+    }
+    for (typename std::vector<Entry*>::const_iterator cell = dirty.begin(); cell != dirty.end(); cell++)
+    {
+        for (unsigned int p = 0; p < L::shape; p++)
+        {
+            TemporaryVertex &vertex = vertices[(*cell)->second.vertices[p]];
+            TemporaryEdge<B> &edge = edges[(*cell)->second.edges[p]];
+            if (vertex.point != no_index) vertex.point = moved(point_moves, vertex.point);
+            if (edge.point != no_index) edge.point = moved(point_moves, edge.point);
+            if (edge.face != no_index) edge.face = moved(face_moves, edge.face);
+        }
+    }
+    for (std::map<unsigned int, unsigned int>::const_iterator move = point_moves.begin(); move != point_moves.end() && move->first < old_point_count; move++)
+    {
+        for (unsigned int i = connectivity.point_offsets[move->first]; i < connectivity.point_offsets[move->first + 1]; i++)
+        {
+            const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, state.cell_positions[connectivity.point_cells[i]]);
+            if (cell == cells.end()) continue;
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                if (vertices[cell->second.vertices[p]].point == move->first) vertices[cell->second.vertices[p]].point = move->second;
+                if (edges[cell->second.edges[p]].point == move->first) edges[cell->second.edges[p]].point = move->second;
+            }
+        }
+    }
+    for (std::map<unsigned int, unsigned int>::const_iterator move = face_moves.begin(); move != face_moves.end() && move->first < old_face_count; move++)
+    {
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            if (connectivity.face_cells[move->first][i] == no_index) continue;
+            const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, state.cell_positions[connectivity.face_cells[move->first][i]]);
+            if (cell == cells.end()) continue;
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                if (edges[cell->second.edges[p]].face == move->first) edges[cell->second.edges[p]].face = move->second;
+            }
+        }
+    }
+    std::vector<Position> free_positions;
+    for (std::vector<unsigned int>::const_iterator cell = free_cells.begin(); cell != free_cells.end(); cell++) free_positions.push_back(state.cell_positions[*cell]);
+    for (unsigned int r = 0; r < rows.size(); r++) row_entries[r]->second.cell = rows[r];
+    move_values(state.cell_positions, cell_moves, cell_count);
+    for (unsigned int r = 0; r < rows.size(); r++) state.cell_positions[rows[r]] = row_entries[r]->first;
+    statistics.end();
+
+    //STAGE 8: patch connectivity, replaced rows are spliced in place and other rows are shifted
+    statistics.begin("connectivity");
+    replace_rows(connectivity.cell_offsets, connectivity.cell_faces, cell_count, rows, row_offsets, row_faces);
+    replace_rows(connectivity.cell_offsets, connectivity.cell_face_inwards, cell_count, rows, row_offsets, row_inwards);
+    replace_rows(connectivity.cell_offsets, connectivity.cell_points, cell_count, rows, row_offsets, row_points);
+    if (arrays)
+    {
+        std::vector<IndexedSide> row_sides(row_points.size());
+        for (unsigned int s = 0; s < row_points.size(); s++) row_sides[s] = { row_points[s], row_faces[s], no_index, row_inwards[s] != 0 };
+        replace_rows(_indexed.side_offsets, _indexed.sides, cell_count, rows, row_offsets, row_sides);
+        replace_offsets(_indexed.side_offsets, cell_count, rows, row_offsets);
+    }
+    replace_offsets(connectivity.cell_offsets, cell_count, rows, row_offsets);
+    for (std::vector<unsigned int>::const_iterator cell = remapped_cells.begin(); cell != remapped_cells.end(); cell++)
+    {
+        for (unsigned int s = connectivity.cell_offsets[*cell]; s < connectivity.cell_offsets[*cell + 1]; s++)
+        {
+            connectivity.cell_points[s] = moved(point_moves, connectivity.cell_points[s]);
+            connectivity.cell_faces[s] = moved(face_moves, connectivity.cell_faces[s]);
+            if (!arrays) continue;
+            _indexed.sides[s].point = connectivity.cell_points[s];
+            _indexed.sides[s].face = connectivity.cell_faces[s];
+        }
+    }
+    connectivity.face_cells.resize(face_count, std::array<unsigned int, 2>{{ no_index, no_index }});
+    for (std::vector<std::pair<unsigned int, std::array<unsigned int, 2>>>::const_iterator face = new_face_cells.begin(); face != new_face_cells.end(); face++) connectivity.face_cells[face->first] = face->second;
+    replace_rows(connectivity.point_offsets, connectivity.point_cells, point_count, point_rows, point_row_offsets, point_row_cells);
+    replace_offsets(connectivity.point_offsets, point_count, point_rows, point_row_offsets);
+    const auto neighbor = [&](unsigned int cell, unsigned int face) -> unsigned int
+    {
+        const std::array<unsigned int, 2> &face_cells = connectivity.face_cells[face];
+        return (face_cells[0] == cell) ? face_cells[1] : face_cells[0];
+    };
+    std::vector<unsigned int> dirty_finals; //New indexes of touched cells, ascending
+    for (typename std::vector<Entry*>::const_iterator cell = dirty.begin(); cell != dirty.end(); cell++) dirty_finals.push_back((*cell)->second.cell);
+    std::sort(dirty_finals.begin(), dirty_finals.end());
+    statistics.end();
+
+    //STAGE 9: write touched points, faces and cells, moved elements take holes of removed elements
+    if (arrays)
+    {
+        statistics.begin("arrays");
+        move_values(_indexed.point_coords, point_moves, point_count);
+        move_values(_indexed.point_normals, point_moves, point_count);
+        move_values(_indexed.point_boundaries, point_moves, point_count);
+        for (unsigned int i = 0; i < written_points.size(); i++)
+        {
+            const unsigned int point = moved(point_moves, written_points[i]);
+            const TemporaryEdge<B> *source = written_point_sources[i];
+            _indexed.point_coords[point] = written_point_coords[i];
+            _indexed.point_normals[point] = (source == nullptr) ? Vector(0, 0) : source->intersection.normal;
+            _indexed.point_boundaries[point] = (source == nullptr || source->boundary == nullptr) ? no_index : (unsigned int)(source->boundary - &boundaries[0]);
+        }
+        move_values(_indexed.face_points, face_moves, face_count);
+        move_values(_indexed.face_centers, face_moves, face_count);
+        move_values(_indexed.face_normals, face_moves, face_count);
+        move_values(_indexed.face_lengths, face_moves, face_count);
+        move_values(_indexed.face_boundaries, face_moves, face_count);
+        for (std::vector<unsigned int>::const_iterator face = remapped_faces.begin(); face != remapped_faces.end(); face++)
+        {
+            for (unsigned int i = 0; i < 2; i++) _indexed.face_points[*face][i] = moved(point_moves, _indexed.face_points[*face][i]);
+        }
+        for (unsigned int i = 0; i < written_faces.size(); i++)
+        {
+            const unsigned int face = moved(face_moves, written_faces[i]);
+            const TemporaryEdge<B> *source = written_face_sources[i];
+            _indexed.face_points[face] = std::array<unsigned int, 2>{{ moved(point_moves, written_face_points[i][0]), moved(point_moves, written_face_points[i][1]) }};
+            const Vector a_coord = _indexed.point_coords[_indexed.face_points[face][0]], b_coord = _indexed.point_coords[_indexed.face_points[face][1]];
+            _indexed.face_centers[face] = (a_coord + b_coord) * 0.5;
+            _indexed.face_normals[face] = rotate_ccw(a_coord - b_coord);
+            _indexed.face_lengths[face] = (a_coord - b_coord).norm();
+            _indexed.face_boundaries[face] = (source == nullptr || source->boundary == nullptr) ? no_index : (unsigned int)(source->boundary - &boundaries[0]);
+        }
+        move_values(_indexed.cell_centers, cell_moves, cell_count);
+        move_values(_indexed.cell_areas, cell_moves, cell_count);
+        move_values(_indexed.cell_boundaries, cell_moves, cell_count);
+        for (typename std::vector<Entry*>::const_iterator entry = dirty.begin(); entry != dirty.end(); entry++)
+        {
+            const TemporaryCell<B, L> &cell = (*entry)->second;
+            _indexed.cell_centers[cell.cell] = cell.center;
+            _indexed.cell_areas[cell.cell] = cell.area;
+            _indexed.cell_boundaries[cell.cell] = (cell.boundary == nullptr) ? no_index : (unsigned int)(cell.boundary - &boundaries[0]);
+        }
+
+        //Sides of replaced rows lead to neighbors, sides of kept cells are corrected only for faces that changed cells
+        for (std::vector<unsigned int>::const_iterator cell = rows.begin(); cell != rows.end(); cell++)
+        {
+            for (unsigned int s = _indexed.side_offsets[*cell]; s < _indexed.side_offsets[*cell + 1]; s++) _indexed.sides[s].cell = neighbor(*cell, _indexed.sides[s].face);
+        }
+        for (std::vector<std::pair<unsigned int, std::array<unsigned int, 2>>>::const_iterator face = new_face_cells.begin(); face != new_face_cells.end(); face++)
+        {
+            for (unsigned int i = 0; i < 2; i++)
+            {
+                const unsigned int cell = face->second[i];
+                if (cell == no_index || contains(rows, cell)) continue;
+                for (unsigned int s = _indexed.side_offsets[cell]; s < _indexed.side_offsets[cell + 1]; s++)
+                {
+                    if (_indexed.sides[s].face == face->first) _indexed.sides[s].cell = neighbor(cell, face->first);
+                }
+            }
+        }
+
+        //Failed cells pass their boundaries to complete neighbors, like in _search()
+        for (std::vector<Position>::const_iterator position = state.touched.begin(); position != state.touched.end(); position++)
+        {
+            const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator cell = lookup(cells, *position);
+            if (cell == cells.end() || cell->second.complete) continue;
+            for (unsigned int f = 0; f < L::shape; f++)
+            {
+                const typename std::unordered_map<Position, TemporaryCell<B, L>, PositionHash>::iterator find = lookup(cells, L::face_neighbor({ cell->first, f }).position);
+                if (find == cells.end() || !find->second.complete || find->second.cell == no_index) continue;
+                _indexed.cell_boundaries[find->second.cell] = (find->second.boundary == nullptr) ? no_index : (unsigned int)(find->second.boundary - &boundaries[0]);
+            }
+        }
+        statistics.end();
+    }
+
+    //STAGE 10: objects of removed elements are destroyed, objects of moved and unchanged elements keep their pointers
+    if (!arrays && parameters.storage == Storage::objects)
+    {
+        statistics.begin("objects");
+        for (std::vector<unsigned int>::const_iterator point = free_points.begin(); point != free_points.end(); point++)
+        {
+            _points.erase(_point_objects[*point]);
+            _point_arena.destroy(_point_objects[*point]);
+            _point_objects[*point] = nullptr;
+        }
+        for (std::vector<unsigned int>::const_iterator face = free_faces.begin(); face != free_faces.end(); face++)
+        {
+            _faces.erase(_face_objects[*face]);
+            _face_arena.destroy(_face_objects[*face]);
+            _face_objects[*face] = nullptr;
+        }
+        for (std::vector<unsigned int>::const_iterator cell = free_cells.begin(); cell != free_cells.end(); cell++)
+        {
+            _cells.erase(_cell_objects[*cell]);
+            _cell_arena.destroy(_cell_objects[*cell]);
+            _cell_objects[*cell] = nullptr;
+        }
+        move_values(_point_objects, point_moves, point_count);
+        move_values(_face_objects, face_moves, face_count);
+        move_values(_cell_objects, cell_moves, cell_count);
+        for (unsigned int i = 0; i < written_points.size(); i++)
+        {
+            P *&object = _point_objects[moved(point_moves, written_points[i])];
+            const TemporaryEdge<B> *source = written_point_sources[i];
+            const Vector coord = written_point_coords[i], normal = (source == nullptr) ? Vector(0, 0) : source->intersection.normal;
+            if (object != nullptr && object->coord().x == coord.x && object->coord().y == coord.y && object->normal().x == normal.x && object->normal().y == normal.y) continue;
+            if (object != nullptr) { _points.erase(object); _point_arena.destroy(object); }
+            object = (source == nullptr) ? _point_arena.create(coord) : _point_arena.create(source->intersection, source->boundary);
+            _points.insert(object);
+        }
+        for (unsigned int i = 0; i < written_faces.size(); i++)
+        {
+            F *&object = _face_objects[moved(face_moves, written_faces[i])];
+            const TemporaryEdge<B> *source = written_face_sources[i];
+            P *a = _point_objects[moved(point_moves, written_face_points[i][0])], *b = _point_objects[moved(point_moves, written_face_points[i][1])];
+            const Vector center = (a->coord() + b->coord()) * 0.5, normal = rotate_ccw(a->coord() - b->coord());
+            if (object != nullptr && object->points()[0] == a && object->points()[1] == b
+            && object->center().x == center.x && object->center().y == center.y && object->normal().x == normal.x && object->normal().y == normal.y) continue;
+            if (object != nullptr) { _faces.erase(object); _face_arena.destroy(object); }
+            object = (source == nullptr) ? _face_arena.create(a, b) : _face_arena.create(a, b, source->intersection, source->boundary);
+            _faces.insert(object);
+        }
+        for (typename std::vector<Entry*>::const_iterator entry = dirty.begin(); entry != dirty.end(); entry++)
+        {
+            const TemporaryCell<B, L> &cell = (*entry)->second;
+            C *&object = _cell_objects[cell.cell];
+            if (object != nullptr && object->center().x == cell.center.x && object->center().y == cell.center.y && object->area() == cell.area) { object->sides().clear(); continue; }
+            if (object != nullptr) { _cells.erase(object); _cell_arena.destroy(object); }
+            object = (cell.boundary == nullptr) ? _cell_arena.create(cell.center, cell.area) : _cell_arena.create(cell.center, cell.area, cell.intersection, cell.boundary);
+            _cells.insert(object);
+        }
+
+        //Sides of touched cells are created again, sides of other cells are corrected only for faces that changed cells
+        for (std::vector<unsigned int>::const_iterator cell = dirty_finals.begin(); cell != dirty_finals.end(); cell++)
+        {
+            for (unsigned int s = connectivity.cell_offsets[*cell]; s < connectivity.cell_offsets[*cell + 1]; s++)
+            {
+                const unsigned int next = neighbor(*cell, connectivity.cell_faces[s]);
+                _cell_objects[*cell]->sides().push_back({ _point_objects[connectivity.cell_points[s]], _face_objects[connectivity.cell_faces[s]], (next == no_index) ? nullptr : _cell_objects[next], connectivity.cell_face_inwards[s] != 0 });
+            }
+        }
+        for (std::vector<std::pair<unsigned int, std::array<unsigned int, 2>>>::const_iterator face = new_face_cells.begin(); face != new_face_cells.end(); face++)
+        {
+            for (unsigned int i = 0; i < 2; i++)
+            {
+                const unsigned int cell = face->second[i];
+                if (cell == no_index || contains(dirty_finals, cell)) continue;
+                const unsigned int next = neighbor(cell, face->first);
+                for (typename std::vector<typename C::Side>::iterator side = _cell_objects[cell]->sides().begin(); side != _cell_objects[cell]->sides().end(); side++)
+                {
+                    if (side->face == _face_objects[face->first]) side->cell = (next == no_index) ? nullptr : _cell_objects[next];
+                }
+            }
+        }
+        statistics.end();
+    }
+
+    //Locator, removed cells are cleared and replaced rows get new polygons
+    if (parameters.locator)
+    {
+        statistics.begin("locator");
+        for (std::vector<Position>::const_iterator position = free_positions.begin(); position != free_positions.end(); position++) _locator.set(*position, no_index);
+        std::vector<unsigned int> polygon_offsets(1, 0);
+        std::vector<Vector> polygon_points;
+        for (unsigned int r = 0; r < rows.size(); r++)
+        {
+            const Entry &cell = *row_entries[r];
+            bool whole = true;
+            for (unsigned int p = 0; p < L::shape; p++)
+            {
+                if (vertices[cell.second.vertices[p]].status != PointStatus::passive || edges[cell.second.edges[p]].intersection.valid) { whole = false; break; }
+            }
+            if (!whole)
+            {
+                for (unsigned int s = connectivity.cell_offsets[rows[r]]; s < connectivity.cell_offsets[rows[r] + 1]; s++)
+                {
+                    const unsigned int point = connectivity.cell_points[s];
+                    polygon_points.push_back(arrays ? _indexed.point_coords[point] : _point_objects[point]->coord());
+                }
+            }
+            polygon_offsets.push_back((unsigned int)polygon_points.size());
+            _locator.set(cell.first, rows[r]);
+        }
+        _locator.replace(cell_count, rows, polygon_offsets, polygon_points);
+        statistics.end();
+    }
+
+    //Geometric factors of changed faces and of their cells, records of removed faces and cells are reused
+    if (parameters.geometry)
+    {
+        const unsigned int shared_faces = ((parameters.typ == GridType::triangular) ? 2 : 1) * L::shape;
+        std::vector<unsigned int> free_face_records, free_cell_records;
+        for (std::vector<unsigned int>::const_iterator face = free_faces.begin(); face != free_faces.end(); face++)
+        {
+            const unsigned int record = _geometry.face_records[*face];
+            if (record != no_index && record >= shared_faces) free_face_records.push_back(record);
+        }
+        for (std::vector<unsigned int>::const_iterator cell = free_cells.begin(); cell != free_cells.end(); cell++)
+        {
+            const unsigned int record = _geometry.cell_records[*cell];
+            if (record != no_index && record >= 1) free_cell_records.push_back(record);
+        }
+        move_values(_geometry.face_records, face_moves, face_count);
+        move_values(_geometry.cell_records, cell_moves, cell_count);
+        for (std::vector<unsigned int>::const_iterator face = written_faces.begin(); face != written_faces.end(); face++)
+        {
+            if (*face >= old_face_count) _geometry.face_records[moved(face_moves, *face)] = no_index;
+        }
+        for (unsigned int d = 0; d < dirty.size(); d++)
+        {
+            if (dirty_cells[d] >= old_cell_count) _geometry.cell_records[dirty[d]->second.cell] = no_index;
+        }
+        std::vector<unsigned int> geometry_faces, geometry_cells(dirty_finals);
+        for (std::vector<std::pair<unsigned int, std::array<unsigned int, 2>>>::const_iterator face = new_face_cells.begin(); face != new_face_cells.end(); face++)
+        {
+            geometry_faces.push_back(face->first);
+            for (unsigned int i = 0; i < 2; i++)
+            {
+                if (face->second[i] != no_index) geometry_cells.push_back(face->second[i]);
+            }
+        }
+        unique(geometry_cells);
+        _compute_geometry(&geometry_faces, &geometry_cells, &free_face_records, &free_cell_records, pool, statistics);
+    }
+
+    //STAGE 11: translate old indexes to new ones
+    statistics.begin("changes");
+    CellGridChanges changes;
+    const auto translate = [](std::vector<unsigned int> &map, unsigned int count, const std::vector<unsigned int> &free, const std::map<unsigned int, unsigned int> &moves)
+    {
+        map.resize(count);
+        for (unsigned int i = 0; i < count; i++) map[i] = i;
+        for (std::vector<unsigned int>::const_iterator index = free.begin(); index != free.end(); index++) map[*index] = no_index;
+        for (std::map<unsigned int, unsigned int>::const_iterator move = moves.begin(); move != moves.end() && move->first < count; move++) map[move->first] = move->second;
+    };
+    translate(changes.point_map, old_point_count, free_points, point_moves);
+    translate(changes.face_map, old_face_count, free_faces, face_moves);
+    translate(changes.cell_map, old_cell_count, free_cells, cell_moves);
+    for (unsigned int d = 0; d < dirty.size(); d++)
+    {
+        const TemporaryCell<B, L> &cell = dirty[d]->second;
+        if (dirty_cells[d] >= old_cell_count) { changes.added_cells.push_back(cell.cell); continue; }
+        const std::pair<double, Vector> &old = region_old[dirty_cells[d]];
+        if (old.first != cell.area || old.second.x != cell.center.x || old.second.y != cell.center.y || dirty_old_sides[d] != dirty_offsets[d + 1] - dirty_offsets[d])
+            changes.modified_cells.push_back(cell.cell);
+    }
+    std::sort(changes.added_cells.begin(), changes.added_cells.end());
+    std::sort(changes.modified_cells.begin(), changes.modified_cells.end());
+    changes.removed_cells = free_cells;
+    std::vector<Position>().swap(state.touched);
+    statistics.end();
+    return changes;
+}
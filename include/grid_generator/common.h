@@ -8,6 +8,7 @@
 
 #pragma once
 #include <vector>
+#include <math.h>
 
 namespace gg
 {
@@ -19,6 +20,29 @@ namespace gg
         hexagonal
     };
 
+    ///Generation algorithm
+    enum class Generation
+    {
+        flood_fill, ///< Grid grows from the origin until it meets boundaries, origin must lie inside of the domain
+        scanline    ///< Every lattice row is intersected with boundaries, elements between crossings are inside
+    };
+
+    ///Storage of grid elements
+    enum class Storage
+    {
+        objects,    ///< Elements are objects of template classes linked with pointers, see points(), faces() and cells()
+        indexed     ///< Elements are stored in contiguous arrays and linked with indexes, see indexed()
+    };
+
+    ///Numbering of grid elements
+    enum class Ordering
+    {
+        lattice,        ///< Cells are numbered in order of lattice positions (row by row), points and faces in order of the first cell that has them
+        morton,         ///< Cells are numbered along Z-order curve over lattice positions, points and faces in order of the first cell that has them
+        hilbert,        ///< Cells are numbered along Hilbert curve over lattice positions, points and faces in order of the first cell that has them
+        cuthill_mckee   ///< Cells are numbered by reverse Cuthill-McKee algorithm that reduces bandwidth of cell adjacency, points and faces in order of the first cell that has them
+    };
+
     ///2D Vector
     struct Vector
     {
@@ -46,6 +70,30 @@ namespace gg
         double squared_norm() const;
     };
 
+    ///Axis-aligned bounding box
+    struct Box
+    {
+        ///Minimal coordinate
+        Vector min;
+        ///Maximal coordinate
+        Vector max;
+        ///Creates empty box
+        Box();
+        ///Creates box from given corners
+        Box(Vector min, Vector max);
+        ///Checks if box contains no points
+        bool empty() const;
+        ///Checks if box has finite size
+        bool finite() const;
+        ///Extends box so that it contains the other box
+        void extend(const Box &b);
+    };
+
+    ///Rotates vector counterclockwise
+    Vector rotate_ccw(Vector v);
+    ///Rotates vector clockwise
+    Vector rotate_cw(Vector v);
+
     ///Intersection between figure and segment
     struct Intersection
     {
@@ -68,9 +116,18 @@ namespace gg
     {
     public:
         ///Searches for intersection between figure and line
+        ///Must return the intersection nearest to the beginning of the line, the default intersections() relies on it
         ///@param a Beginning of the line
         ///@param b Ending of the line
         virtual Intersection intersection(Vector a, Vector b) const = 0;
+        ///Searches for all intersections between figure and line, default implementation calls intersection() repeatedly
+        ///from the last found intersection and stops at the first intersection that does not lie after it, override if intersection() may return farther intersections
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        ///@param intersections Intersections ordered from beginning to ending, result is appended
+        virtual void intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const;
+        ///Gets bounding box of the figure, default implementation returns infinite box
+        virtual Box bounds() const;
         ///@brief Destroys figure
         virtual ~Figure() = 0;
     };
@@ -92,6 +149,17 @@ namespace gg
         ///@param a Beginning of the line
         ///@param b Ending of the line
         virtual Intersection intersection(Vector a, Vector b) const;
+        ///Searches for all intersections between figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        ///@param intersections Intersections ordered from beginning to ending, result is appended
+        virtual void intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const;
+        ///Gets bounding box of the figure
+        virtual Box bounds() const;
+        ///Gets center of the circle
+        Vector center() const;
+        ///Gets radius of the circle
+        double radius() const;
     };
 
     ///Arc figure
@@ -115,6 +183,21 @@ namespace gg
         ///@param a Beginning of the line
         ///@param b Ending of the line
         virtual Intersection intersection(Vector a, Vector b) const;
+        ///Searches for all intersections between figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        ///@param intersections Intersections ordered from beginning to ending, result is appended
+        virtual void intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const;
+        ///Gets bounding box of the figure
+        virtual Box bounds() const;
+        ///Gets center of the arc
+        Vector center() const;
+        ///Gets radius of the arc
+        double radius() const;
+        ///Gets azimuth of the beginning of the arc
+        double azimuth() const;
+        ///Gets angle of the arc
+        double angle() const;
     };
 
     ///Line figure
@@ -134,9 +217,23 @@ namespace gg
         ///@param a Beginning of the line
         ///@param b Ending of the line
         virtual Intersection intersection(Vector a, Vector b) const;
+        ///Searches for all intersections between figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        ///@param intersections Intersections ordered from beginning to ending, result is appended
+        virtual void intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const;
+        ///Gets bounding box of the figure
+        virtual Box bounds() const;
+        ///Gets beginning of the line
+        Vector a() const;
+        ///Gets ending of the line
+        Vector b() const;
     };
 
+    class FigureBatch;
+
     ///Boundary consists of boundary figure and boundary conditions
+    ///Custom boundaries used as grid template arguments must provide figure(), other functions are optional (see BoundaryTraits)
     class Boundary
     {
     protected:
@@ -148,12 +245,85 @@ namespace gg
         ///Transfers boundary
         ///@param other Boundary to be transferred
         Boundary(Boundary &&other);
+        ///Replaces boundary, frees previous figure
+        ///@param other Boundary to be transferred
+        Boundary &operator=(Boundary &&other);
         ///Returns boundary figure
         const Figure *figure() const;
+        ///Gets bounding box of boundary figure
+        Box bounds() const;
+        ///Searches for intersection between boundary figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        Intersection intersection(Vector a, Vector b) const;
+        ///Searches for all intersections between boundary figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        ///@param intersections Intersections ordered from beginning to ending, result is appended
+        void intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const;
+        ///Adds boundary figure to figure batch
+        ///@param batch Figure batch
+        ///@param index Index of the boundary
+        void batch(FigureBatch &batch, unsigned int index) const;
         ///Destroys boundary and frees figure
         ~Boundary();
     };
 
+    ///Boundary with line, circle or arc figure stored by value, calls to the figure are not virtual
+    class StaticBoundary
+    {
+    public:
+        ///Type of boundary figure
+        enum class Type
+        {
+            line,   ///< Line
+            circle, ///< Circle
+            arc     ///< Arc
+        };
+    protected:
+        Type _type;
+        union
+        {
+            Line _line;
+            Circle _circle;
+            Arc _arc;
+        };
+        void _construct(const StaticBoundary &other);
+        void _destroy();
+    public:
+        ///Creates boundary with line figure
+        StaticBoundary(const Line &line);
+        ///Creates boundary with circle figure
+        StaticBoundary(const Circle &circle);
+        ///Creates boundary with arc figure
+        StaticBoundary(const Arc &arc);
+        ///Copies boundary
+        StaticBoundary(const StaticBoundary &other);
+        ///Copies boundary
+        StaticBoundary &operator=(const StaticBoundary &other);
+        ///Gets type of boundary figure
+        Type type() const;
+        ///Returns boundary figure
+        const Figure *figure() const;
+        ///Gets bounding box of boundary figure
+        Box bounds() const;
+        ///Searches for intersection between boundary figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        Intersection intersection(Vector a, Vector b) const;
+        ///Searches for all intersections between boundary figure and line
+        ///@param a Beginning of the line
+        ///@param b Ending of the line
+        ///@param intersections Intersections ordered from beginning to ending, result is appended
+        void intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const;
+        ///Adds boundary figure to figure batch
+        ///@param batch Figure batch
+        ///@param index Index of the boundary
+        void batch(FigureBatch &batch, unsigned int index) const;
+        ///Destroys boundary
+        ~StaticBoundary();
+    };
+
     ///Grid parameters
     struct Parameters
     {
@@ -161,9 +331,117 @@ namespace gg
         Vector origin = Vector(0.0, 0.0);   ///< Grid origin
         Vector size = Vector(1.0, 1.0);     ///< Size of element side
         double inclination = 0.0;           ///< Grid inclination (radians, counterclockwise)
+        Generation generation = Generation::flood_fill; ///< Generation algorithm
+        Storage storage = Storage::objects; ///< Storage of grid elements
+        unsigned int threads = 1;           ///< Number of threads used for generation, 0 means one thread per processor core
     };
 }
 
+//Functions called for every probe are inline, so grids instantiated with StaticBoundary inline calls to built-in figures
+
+inline gg::Vector gg::rotate_ccw(Vector v)
+{
+    return Vector(v.y, -v.x);
+}
+
+inline gg::Vector gg::rotate_cw(Vector v)
+{
+    return Vector(-v.y, v.x);
+}
+
+inline gg::Vector::Vector() {}
+
+inline gg::Vector::Vector(double x, double y) : x(x), y(y) {}
+
+inline gg::Vector gg::Vector::operator*(double b) const
+{
+    return Vector(x * b, y * b);
+}
+
+inline gg::Vector gg::Vector::operator/(double b) const
+{
+    return Vector(x / b, y / b);
+}
+
+inline gg::Vector gg::Vector::operator+(const Vector &b) const
+{
+    return Vector(x + b.x, y + b.y);
+}
+
+inline gg::Vector gg::Vector::operator-(const Vector &b) const
+{
+    return Vector(x - b.x, y - b.y);
+}
+
+inline double gg::Vector::dot(const Vector &b) const
+{
+    return x * b.x + y * b.y;
+}
+
+inline double gg::Vector::norm() const
+{
+    return sqrt(x * x + y * y);
+}
+
+inline double gg::Vector::squared_norm() const
+{
+    return x * x + y * y;
+}
+
+inline gg::Intersection gg::Line::intersection(Vector a, Vector b) const
+{
+    //Equation "a + (b - a) * t = _a + (_b - _a) * s" transformed into "A * [t s] = b" and solved
+    const double A00 = b.x - a.x;
+    const double A01 = -_b.x + _a.x;
+    const double A10 = b.y - a.y;
+    const double A11 = -_b.y + _a.y;
+    const double b0 = -a.x + _a.x;
+    const double b1 = -a.y + _a.y;
+    const double determinant = A00 * A11 - A01 * A10;
+    if (determinant == 0.0) return Intersection(); //Parallel lines
+    const double t = (A11 * b0 - A01 * b1) / determinant;
+    if (t < 0.0 || t > 1.0) return Intersection();
+    const double s = (-A10 * b0 + A00 * b1) / determinant;
+    if (s < 0.0 || s > 1.0) return Intersection();
+    return Intersection(a + (b - a) * t, _b - _a, _normal_cw ? rotate_cw(_b-_a) : rotate_ccw(_b-_a));
+}
+
+inline void gg::Line::intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const
+{
+    const Intersection intersection = this->intersection(a, b);
+    if (intersection.valid) intersections.push_back(intersection);
+}
+
+inline gg::Box gg::StaticBoundary::bounds() const
+{
+    switch (_type)
+    {
+    case Type::line: return _line.Line::bounds();
+    case Type::circle: return _circle.Circle::bounds();
+    default: return _arc.Arc::bounds();
+    }
+}
+
+inline gg::Intersection gg::StaticBoundary::intersection(Vector a, Vector b) const
+{
+    switch (_type)
+    {
+    case Type::line: return _line.Line::intersection(a, b);
+    case Type::circle: return _circle.Circle::intersection(a, b);
+    default: return _arc.Arc::intersection(a, b);
+    }
+}
+
+inline void gg::StaticBoundary::intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const
+{
+    switch (_type)
+    {
+    case Type::line: _line.Line::intersections(a, b, intersections); break;
+    case Type::circle: _circle.Circle::intersections(a, b, intersections); break;
+    default: _arc.Arc::intersections(a, b, intersections); break;
+    }
+}
+
 /** @mainpage Grid generator
 
 This library is used for grid generation. The library can generate two types of grids: point grid and cellular grid. Point grids consist only of points on 2D plane. Cellular grids is a 2D hierarchical grid with points, faces and cells. All underlying classes are template arguments, allowing almost unlimited customization.
@@ -9,6 +9,7 @@
 #pragma once
 #include "common.h"
 #include <array>
+#include <cstddef>
 
 namespace gg
 {
@@ -19,6 +20,13 @@ namespace gg
         int yi = 0;
         bool upside_down = false;
         bool operator<(const Position &b) const;
+        bool operator==(const Position &b) const;
+    };
+
+    ///Hash of position for hash tables of the lattice
+    struct PositionHash
+    {
+        std::size_t operator()(Position position) const;
     };
 
     ///Structure that describes element and its face
@@ -35,6 +43,62 @@ namespace gg
         unsigned int point;
     };
 
+    ///Point where a lattice row crosses a boundary
+    struct Crossing
+    {
+        double x;       ///< Fractional X index of the crossing
+        bool entering;  ///< Row enters the domain at the crossing, otherwise leaves it
+        bool operator<(const Crossing &b) const;
+    };
+
+    ///Lattice of perfect elements, precomputed once from parameters
+    ///Lattice coordinate of the element center is xi * basis X + yi * basis Y + center offset, coordinates of points are offsets from xi * basis X + yi * basis Y
+    ///Lattice coordinates are scaled by the size, rotated by the inclination and moved by the origin
+    class Lattice
+    {
+    protected:
+        Vector _origin;
+        Vector _size;
+        double _cos, _sin;                      //Rotation by inclination
+        double _inverse_cos, _inverse_sin;      //Rotation by -inclination
+        std::array<Vector, 2> _basis;           //Lattice coordinates of one step in X and Y index
+        std::array<Vector, 2> _center_offsets;  //Offsets of the center, for normal and upside down elements
+        std::array<std::array<Vector, 6>, 2> _point_offsets;    //Offsets of the points, for normal and upside down elements
+        GridType _typ;
+        unsigned int _shape;
+        double _area;
+        Vector _base(Position position) const;
+
+    public:
+        ///Creates lattice
+        ///@param parameters Grid parameters
+        explicit Lattice(const Parameters &parameters);
+        ///Gets number of points/faces
+        unsigned int shape() const;
+        ///Gets area of the perfect cell
+        double area() const;
+        ///Transforms coordinate from the frame of the grid (size, inclination and origin are applied)
+        Vector transform(Vector lattice_coord) const;
+        ///Transforms coordinate to the frame of the grid (origin, inclination and size are undone)
+        Vector lattice_coord(Vector coord) const;
+        ///Gets center of the element
+        Vector center(Position position) const;
+        ///Gets points of the element
+        std::array<Vector, 6> points(Position position) const;
+        ///Gets centers of consecutive elements in a row
+        ///@param first First element, other elements have increasing X index and the same Y index and orientation
+        ///@param count Number of elements
+        ///@param centers Array of count centers
+        void centers(Position first, unsigned int count, Vector *centers) const;
+        ///Gets points of consecutive elements in a row
+        ///@param first First element, other elements have increasing X index and the same Y index and orientation
+        ///@param count Number of elements
+        ///@param points Array of count * shape() points, points of every element are stored together
+        void points(Position first, unsigned int count, Vector *points) const;
+        ///Gets position of the perfect element that contains the coordinate
+        Position position(Vector coord) const;
+    };
+
     ///Gets number of points/faces
     unsigned int get_shape(const Parameters &parameters);
     ///Gets area of the perfect cell
@@ -47,11 +111,24 @@ namespace gg
     FacePosition get_face_neighbor(const Parameters &parameters, FacePosition face);
     ///Gets neighbors of the point
     std::array<PointPosition, 6> get_point_neighbors(const Parameters &parameters, PointPosition point);
+    ///Gets the smallest of all positions that describe the same point
+    PointPosition get_canonical_point(const Parameters &parameters, PointPosition point);
+    ///Transforms coordinate to the frame of the grid (origin, inclination and size are undone)
+    Vector get_lattice_coord(const Parameters &parameters, Vector coord);
+    ///Gets position of the perfect element that contains the coordinate
+    Position get_position(const Parameters &parameters, Vector coord);
 
-    ///Rotates vector counterclockwise
-    Vector rotate_ccw(Vector v);
-    ///Rotates vector clockwise
-    Vector rotate_cw(Vector v);
     ///Rotates vector
     Vector rotate(Vector v, double angle);
+    ///Checks if angle (from -pi to pi) lies in the arc
+    bool angle_in_arc(double arc_azimuth, double arc_angle, double angle);
+    ///Intersects segment with circle
+    ///@param center Center of the circle
+    ///@param radius Radius of the circle
+    ///@param a Beginning of the segment
+    ///@param b Ending of the segment
+    ///@param length Length of the segment
+    ///@param distances Distances from the beginning to intersections that lie on the segment, nearest first
+    ///@return Number of intersections
+    unsigned int circle_intersections(Vector center, double radius, Vector a, Vector b, double &length, double distances[2]);
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include <vector>
+#include <map>
+
+namespace gg
+{
+    ///Replaces rows of values in compressed sparse row format in place, other rows keep their values
+    ///@param offsets Offsets of rows before the replacement, they are replaced by replace_offsets() after all arrays of values
+    ///@param values Values of rows
+    ///@param count New number of rows, rows beyond it are removed
+    ///@param rows Replaced rows, ascending, rows beyond the old number of rows are added
+    ///@param row_offsets Values of row rows[i] are row_values[row_offsets[i]] ... row_values[row_offsets[i+1]-1]
+    ///@param row_values Values of replaced rows
+    template <class T> void replace_rows(const std::vector<unsigned int> &offsets, std::vector<T> &values, unsigned int count,
+        const std::vector<unsigned int> &rows, const std::vector<unsigned int> &row_offsets, const std::vector<T> &row_values);
+    ///Replaces offsets of rows in compressed sparse row format, see replace_rows()
+    ///@param offsets Offsets of rows
+    ///@param count New number of rows, rows beyond it are removed
+    ///@param rows Replaced rows, ascending, rows beyond the old number of rows are added
+    ///@param row_offsets New length of row rows[i] is row_offsets[i+1] - row_offsets[i]
+    void replace_offsets(std::vector<unsigned int> &offsets, unsigned int count, const std::vector<unsigned int> &rows, const std::vector<unsigned int> &row_offsets);
+    ///Moves values to new indexes and removes values beyond the new number of values
+    ///@param values Values addressed by old indexes
+    ///@param moves New indexes by old indexes, old indexes beyond the number of values are skipped
+    ///@param count New number of values
+    template <class T> void move_values(std::vector<T> &values, const std::map<unsigned int, unsigned int> &moves, unsigned int count);
+}
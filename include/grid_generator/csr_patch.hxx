@@ -0,0 +1,54 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "csr_patch.h"
+#include <algorithm>
+
+template <class T> void gg::replace_rows(const std::vector<unsigned int> &offsets, std::vector<T> &values, unsigned int count,
+    const std::vector<unsigned int> &rows, const std::vector<unsigned int> &row_offsets, const std::vector<T> &row_values)
+{
+    //Blocks of values between replaced rows are shifted by the change of length of rows before them
+    //Blocks shifted right are moved starting from the last one, blocks shifted left starting from the first one, so no block overwrites another one before it is moved
+    const unsigned int old_count = (unsigned int)offsets.size() - 1;
+    const unsigned int old_size = offsets[std::min(count, old_count)];
+    const auto row_begin = [&](unsigned int row) -> unsigned int { return offsets[std::min(row, old_count)]; };
+    const auto row_end = [&](unsigned int row) -> unsigned int { return (row < old_count) ? offsets[row + 1] : offsets[old_count]; };
+    const auto block_begin = [&](unsigned int block) -> unsigned int { return (block == 0) ? 0 : row_end(rows[block - 1]); };
+    const auto block_end = [&](unsigned int block) -> unsigned int { return (block == rows.size()) ? old_size : row_begin(rows[block]); };
+    std::vector<long long> shifts(rows.size() + 1); //Shift of the block before row rows[i], the last block follows the last row
+    long long shift = 0;
+    for (unsigned int i = 0; i < rows.size(); i++)
+    {
+        shifts[i] = shift;
+        shift += (long long)(row_offsets[i + 1] - row_offsets[i]) - (long long)(row_end(rows[i]) - row_begin(rows[i]));
+    }
+    shifts[rows.size()] = shift;
+    const std::size_t new_size = (std::size_t)((long long)old_size + shift);
+    if (new_size > values.size()) values.resize(new_size);
+    for (unsigned int block = (unsigned int)rows.size(); block > 0; block--)
+    {
+        if (shifts[block] > 0) std::move_backward(values.begin() + block_begin(block), values.begin() + block_end(block), values.begin() + (block_end(block) + shifts[block]));
+    }
+    for (unsigned int block = 1; block <= rows.size(); block++)
+    {
+        if (shifts[block] < 0) std::move(values.begin() + block_begin(block), values.begin() + block_end(block), values.begin() + (block_begin(block) + shifts[block]));
+    }
+    for (unsigned int i = 0; i < rows.size(); i++)
+        std::copy(row_values.begin() + row_offsets[i], row_values.begin() + row_offsets[i + 1], values.begin() + (row_begin(rows[i]) + shifts[i]));
+    values.resize(new_size);
+}
+
+template <class T> void gg::move_values(std::vector<T> &values, const std::map<unsigned int, unsigned int> &moves, unsigned int count)
+{
+    for (std::map<unsigned int, unsigned int>::const_iterator move = moves.begin(); move != moves.end(); move++)
+    {
+        if (move->first < values.size()) values[move->second] = values[move->first];
+    }
+    values.resize(count);
+}
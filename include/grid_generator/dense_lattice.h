@@ -0,0 +1,47 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common_internal.h"
+#include <vector>
+#include <cstddef>
+
+namespace gg
+{
+    ///Dense storage of values indexed by lattice position, grows dynamically
+    template <class T>
+    class DenseLattice
+    {
+    protected:
+        int _xmin = 0;
+        int _ymin = 0;
+        unsigned int _width = 0;
+        unsigned int _height = 0;
+        unsigned int _layers;
+        T _empty;
+        std::vector<T> _values;
+        void _grow(Position position);
+    public:
+        ///Creates empty lattice
+        ///@param parameters Grid parameters
+        ///@param empty Value of positions that were never assigned
+        DenseLattice(const Parameters &parameters, T empty);
+        ///Reserves space for the given range of positions
+        ///@param xmin Minimal X index
+        ///@param xmax Maximal X index
+        ///@param ymin Minimal Y index
+        ///@param ymax Maximal Y index
+        void reserve(int xmin, int xmax, int ymin, int ymax);
+        ///Gets value of position, returns empty value if position was never assigned
+        T get(Position position) const;
+        ///Gets reference to value of position, grows the storage if needed
+        T &at(Position position);
+        ///Gets number of allocated positions
+        std::size_t capacity() const;
+    };
+}
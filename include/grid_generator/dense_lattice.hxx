@@ -0,0 +1,82 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "dense_lattice.h"
+
+/*
+    Values are stored row by row in one flat array, upside down elements (triangular grid only) are stored next to normal ones
+    When a position outside of the stored range is accessed, the range is at least doubled in the needed direction, so growth is amortized
+*/
+
+template <class T> gg::DenseLattice<T>::DenseLattice(const Parameters &parameters, T empty) :
+    _layers(parameters.typ == GridType::triangular ? 2 : 1), _empty(empty) {}
+
+template <class T> void gg::DenseLattice<T>::reserve(int xmin, int xmax, int ymin, int ymax)
+{
+    if (_width != 0 && xmin >= _xmin && xmax < _xmin + (int)_width && ymin >= _ymin && ymax < _ymin + (int)_height) return;
+    if (_width != 0)
+    {
+        if (_xmin < xmin) xmin = _xmin;
+        if (_xmin + (int)_width - 1 > xmax) xmax = _xmin + (int)_width - 1;
+        if (_ymin < ymin) ymin = _ymin;
+        if (_ymin + (int)_height - 1 > ymax) ymax = _ymin + (int)_height - 1;
+    }
+    const unsigned int width = xmax - xmin + 1;
+    const unsigned int height = ymax - ymin + 1;
+    std::vector<T> values((std::size_t)width * height * _layers, _empty);
+    for (unsigned int y = 0; y < _height; y++)
+    {
+        for (unsigned int x = 0; x < _width * _layers; x++)
+        {
+            values[((std::size_t)(_ymin + y - ymin) * width + (_xmin - xmin)) * _layers + x] = _values[(std::size_t)y * _width * _layers + x];
+        }
+    }
+    _values.swap(values);
+    _xmin = xmin;
+    _ymin = ymin;
+    _width = width;
+    _height = height;
+}
+
+template <class T> void gg::DenseLattice<T>::_grow(Position position)
+{
+    if (_width == 0) { reserve(position.xi - 8, position.xi + 8, position.yi - 8, position.yi + 8); return; }
+    int xmin = _xmin, xmax = _xmin + (int)_width - 1, ymin = _ymin, ymax = _ymin + (int)_height - 1;
+    if (position.xi < xmin) xmin = position.xi < xmin - (int)_width ? position.xi : xmin - (int)_width;
+    if (position.xi > xmax) xmax = position.xi > xmax + (int)_width ? position.xi : xmax + (int)_width;
+    if (position.yi < ymin) ymin = position.yi < ymin - (int)_height ? position.yi : ymin - (int)_height;
+    if (position.yi > ymax) ymax = position.yi > ymax + (int)_height ? position.yi : ymax + (int)_height;
+    reserve(xmin, xmax, ymin, ymax);
+}
+
+template <class T> T gg::DenseLattice<T>::get(Position position) const
+{
+    const unsigned int x = position.xi - _xmin;
+    const unsigned int y = position.yi - _ymin;
+    if (x >= _width || y >= _height) return _empty;
+    return _values[((std::size_t)y * _width + x) * _layers + (position.upside_down ? 1 : 0)];
+}
+
+template <class T> T &gg::DenseLattice<T>::at(Position position)
+{
+    unsigned int x = position.xi - _xmin;
+    unsigned int y = position.yi - _ymin;
+    if (x >= _width || y >= _height)
+    {
+        _grow(position);
+        x = position.xi - _xmin;
+        y = position.yi - _ymin;
+    }
+    return _values[((std::size_t)y * _width + x) * _layers + (position.upside_down ? 1 : 0)];
+}
+
+template <class T> std::size_t gg::DenseLattice<T>::capacity() const
+{
+    return _values.capacity();
+}
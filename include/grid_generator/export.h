@@ -0,0 +1,52 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "indexed_grid.h"
+#include <string>
+#include <vector>
+
+namespace gg
+{
+    ///Field of values written by exporters, one value per cell of cellular grid or per point of point grid
+    struct ExportField
+    {
+        std::string name;           ///< Name of the field
+        std::vector<double> values; ///< Values
+    };
+
+    ///Creates field of cell areas
+    ///@param grid Cellular grid
+    ExportField area_field(const IndexedCellGrid &grid);
+    ///Creates field that is 1 for cells that touch a boundary and 0 for other cells
+    ///@param grid Cellular grid
+    ExportField boundary_field(const IndexedCellGrid &grid);
+
+    ///Writes cellular grid to VTK unstructured grid file (.vtu) with appended raw binary data, cells are written as polygons
+    ///@param path Path to the file
+    ///@param grid Cellular grid, for example CellGrid::indexed() of grid generated with Storage::indexed
+    ///@param fields Cell fields
+    void write_vtu(const std::string &path, const IndexedCellGrid &grid, const std::vector<ExportField> &fields = std::vector<ExportField>());
+    ///Writes point grid to VTK unstructured grid file (.vtu) with appended raw binary data, points are written as vertices
+    ///@param path Path to the file
+    ///@param grid Point grid, for example PointGrid::indexed() of grid generated with Storage::indexed
+    ///@param fields Point fields
+    void write_vtu(const std::string &path, const IndexedPointGrid &grid, const std::vector<ExportField> &fields = std::vector<ExportField>());
+    ///Writes cellular grid to binary Gmsh file (.msh) of version 4.1
+    ///Gmsh has no polygon elements, so cells with three and four sides are written as triangles and quadrangles and other cells are divided into triangles
+    ///Elements are numbered from one, triangles first, and every element gets the field value of its cell
+    ///@param path Path to the file
+    ///@param grid Cellular grid, for example CellGrid::indexed() of grid generated with Storage::indexed
+    ///@param fields Cell fields
+    void write_msh(const std::string &path, const IndexedCellGrid &grid, const std::vector<ExportField> &fields = std::vector<ExportField>());
+    ///Writes point grid to binary Gmsh file (.msh) of version 4.1, points are written as point elements
+    ///@param path Path to the file
+    ///@param grid Point grid, for example PointGrid::indexed() of grid generated with Storage::indexed
+    ///@param fields Point fields
+    void write_msh(const std::string &path, const IndexedPointGrid &grid, const std::vector<ExportField> &fields = std::vector<ExportField>());
+}
@@ -0,0 +1,101 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common.h"
+#include <vector>
+
+namespace gg
+{
+    ///Instruction set used by figure batches
+    enum class InstructionSet
+    {
+        scalar, ///< Plain C++
+        sse2,   ///< SSE2, two figures at once
+        avx2    ///< AVX2, four figures at once
+    };
+
+    ///Nearest hit found in figure batch
+    struct BatchHit
+    {
+        ///Parameter of the hit along the segment, from 0 (beginning) to 1 (ending), infinity if nothing is hit
+        double t;
+        ///Index of the hit figure, given in FigureBatch::push_back()
+        unsigned int index;
+        ///Hit figure
+        const Figure *figure;
+        ///Creates empty hit
+        BatchHit();
+    };
+
+    ///Figures stored as structure of arrays, every figure type in separate arrays, intersects one segment with many figures at once
+    class FigureBatch
+    {
+    public:
+        ///Offset in the batch, figures of every type are counted separately
+        struct Offset
+        {
+            unsigned int lines = 0;     ///< Number of lines before the offset
+            unsigned int circles = 0;   ///< Number of circles before the offset
+            unsigned int arcs = 0;      ///< Number of arcs before the offset
+            unsigned int others = 0;    ///< Number of other figures before the offset
+        };
+    protected:
+        //Lines, a and a - b
+        std::vector<double> _line_ax, _line_ay, _line_dx, _line_dy;
+        std::vector<unsigned int> _line_index;
+        std::vector<const Figure*> _line_figure;
+        //Circles and arcs, center and squared radius (and azimuth and angle of arcs)
+        std::vector<double> _circle_cx, _circle_cy, _circle_r2;
+        std::vector<unsigned int> _circle_index;
+        std::vector<const Figure*> _circle_figure;
+        std::vector<double> _arc_cx, _arc_cy, _arc_r2, _arc_azimuth, _arc_angle;
+        std::vector<unsigned int> _arc_index;
+        std::vector<const Figure*> _arc_figure;
+        //Figures of unknown type, tested with Figure::intersection()
+        std::vector<unsigned int> _other_index;
+        std::vector<const Figure*> _other_figure;
+    public:
+        ///Adds figure to the end of the batch, lines, circles and arcs are recognized, other figures (including their subclasses) are tested with Figure::intersection()
+        ///@param figure Figure, must outlive the batch
+        ///@param index Index of the figure, figures with lower indexes win ties
+        void push_back(const Figure *figure, unsigned int index);
+        ///Adds line to the end of the batch
+        ///@param line Line, must outlive the batch
+        ///@param index Index of the line, figures with lower indexes win ties
+        void push_back(const Line &line, unsigned int index);
+        ///Adds circle to the end of the batch
+        ///@param circle Circle, must outlive the batch
+        ///@param index Index of the circle, figures with lower indexes win ties
+        void push_back(const Circle &circle, unsigned int index);
+        ///Adds arc to the end of the batch
+        ///@param arc Arc, must outlive the batch
+        ///@param index Index of the arc, figures with lower indexes win ties
+        void push_back(const Arc &arc, unsigned int index);
+        ///Gets end of the batch
+        Offset end() const;
+        ///Searches for the nearest intersection between segment and figures in range, updates hit if the found intersection is nearer
+        ///@param a Beginning of the segment
+        ///@param b Ending of the segment
+        ///@param begin Beginning of the range
+        ///@param end Ending of the range
+        ///@param hit Nearest hit
+        void nearest(Vector a, Vector b, const Offset &begin, const Offset &end, BatchHit &hit) const;
+        ///Searches for the nearest intersection between segment and all figures
+        ///@param a Beginning of the segment
+        ///@param b Ending of the segment
+        ///@param hit Nearest hit
+        void nearest(Vector a, Vector b, BatchHit &hit) const;
+        ///Gets instruction set used by all batches
+        static InstructionSet instruction_set();
+        ///Sets instruction set used by all batches, by default the best supported instruction set is used
+        ///Thread-safe, searches that already started finish with the previous instruction set
+        ///@return Whether the instruction set is supported
+        static bool instruction_set(InstructionSet instruction_set);
+    };
+}
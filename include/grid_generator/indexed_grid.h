@@ -0,0 +1,96 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common.h"
+#include <vector>
+#include <array>
+
+namespace gg
+{
+    ///Index that refers to nothing (no neighbor cell, no boundary)
+    const unsigned int no_index = (unsigned int)-1;
+
+    ///Point grid stored in contiguous arrays, points are addressed by 32-bit indexes
+    struct IndexedPointGrid
+    {
+        std::vector<Vector> coords;                 ///< Coordinates of points
+        std::vector<Vector> normals;                ///< Normals of points, zero if point does not touch a boundary
+        std::vector<unsigned int> boundaries;       ///< Indexes of touched boundaries, or no_index
+        std::vector<unsigned int> neighbor_offsets; ///< Neighbors of point i are neighbors[neighbor_offsets[i]] ... neighbors[neighbor_offsets[i+1]-1]
+        std::vector<unsigned int> neighbors;        ///< Indexes of neighbor points
+    };
+
+    ///Side of indexed cell
+    struct IndexedSide
+    {
+        unsigned int point; ///< Point (clockwise in respect to face)
+        unsigned int face;  ///< Face
+        unsigned int cell;  ///< Neighbor cell, or no_index
+        bool inwards;       ///< Face normal points inwards, otherwise outwards
+    };
+
+    ///Cellular grid stored in contiguous arrays, points, faces and cells are addressed by 32-bit indexes
+    struct IndexedCellGrid
+    {
+        std::vector<Vector> point_coords;                       ///< Coordinates of points
+        std::vector<Vector> point_normals;                      ///< Normals of points, zero if point does not lie on a boundary
+        std::vector<unsigned int> point_boundaries;             ///< Indexes of boundaries the points lie on, or no_index
+        std::vector<std::array<unsigned int, 2>> face_points;   ///< Points of faces
+        std::vector<Vector> face_centers;                       ///< Centers of faces
+        std::vector<Vector> face_normals;                       ///< Normals of faces, not normalized, length of normal is length of face
+        std::vector<double> face_lengths;                       ///< Lengths of faces
+        std::vector<unsigned int> face_boundaries;              ///< Indexes of boundaries the faces touch, or no_index
+        std::vector<Vector> cell_centers;                       ///< Centers of cells
+        std::vector<double> cell_areas;                         ///< Areas of cells
+        std::vector<unsigned int> cell_boundaries;              ///< Indexes of boundaries the cells touch, or no_index
+        std::vector<unsigned int> side_offsets;                 ///< Sides of cell i are sides[side_offsets[i]] ... sides[side_offsets[i+1]-1]
+        std::vector<IndexedSide> sides;                         ///< Sides of cells
+    };
+
+    ///Connectivity of cellular grid in compressed sparse row format, points, faces and cells are addressed by 32-bit indexes
+    ///Indexes are the same as in IndexedCellGrid, in case of Storage::objects they are the order of creation of points, faces and cells
+    struct CellConnectivity
+    {
+        std::vector<unsigned int> cell_offsets;                 ///< Faces and points of cell i are cell_faces[cell_offsets[i]] ... cell_faces[cell_offsets[i+1]-1]
+        std::vector<unsigned int> cell_faces;                   ///< Indexes of faces of cells, counterclockwise
+        std::vector<unsigned char> cell_face_inwards;           ///< 1 if face normal points inside of the cell, 0 otherwise
+        std::vector<unsigned int> cell_points;                  ///< Indexes of points of cells, counterclockwise
+        std::vector<std::array<unsigned int, 2>> face_cells;    ///< Owner and neighbor cell of faces, normal of inner face points from owner to neighbor, neighbor of boundary face is no_index
+        std::vector<unsigned int> point_offsets;                ///< Cells of point i are point_cells[point_offsets[i]] ... point_cells[point_offsets[i+1]-1]
+        std::vector<unsigned int> point_cells;                  ///< Indexes of cells of points, ascending
+    };
+
+    ///Finite volume geometric factors of cellular grid in structure-of-arrays form, owners and neighbors of faces are the ones in CellConnectivity::face_cells
+    ///Faces and cells of whole lattice elements share records at the beginning of the arrays, other faces and cells have records of their own
+    struct CellGeometry
+    {
+        std::vector<unsigned int> face_records;                 ///< Records of faces
+        std::vector<Vector> unit_normals;                       ///< Unit normals of faces, pointing from owner outwards
+        std::vector<Vector> deltas;                             ///< Vectors from owner center to neighbor center, or to face center for boundary faces
+        std::vector<double> distances;                          ///< Lengths of deltas
+        std::vector<double> weights;                            ///< Interpolation weights of owners, value on face is weight * owner value + (1 - weight) * neighbor value
+        std::vector<double> diffusion_coefficients;             ///< Coefficients of orthogonal diffusion flux |S|^2 / (S * delta), S is outward face normal of length of face
+        std::vector<Vector> non_orthogonal_corrections;         ///< Non-orthogonal parts of face normals S - delta * |S|^2 / (S * delta)
+        std::vector<Vector> skewness_corrections;               ///< Vectors from crossing of delta and face to face center
+        std::vector<unsigned int> cell_records;                 ///< Records of cells
+        std::vector<double> inverse_areas;                      ///< Inverse areas of cells
+        std::vector<std::array<double, 3>> gradient_matrices;   ///< Inverse least squares gradient matrices (xx, xy, yy), gradient is matrix * sum(delta * difference of values)
+    };
+
+    ///Changes of cellular grid made by update, old indexes refer to the grid before the update, new indexes to the grid after it
+    struct CellGridChanges
+    {
+        std::vector<unsigned int> point_map;        ///< New indexes of old points, no_index if the point was removed
+        std::vector<unsigned int> face_map;         ///< New indexes of old faces, no_index if the face was removed
+        std::vector<unsigned int> cell_map;         ///< New indexes of old cells, no_index if the cell was removed
+        std::vector<unsigned int> added_cells;      ///< New indexes of cells that did not exist before, ascending
+        std::vector<unsigned int> removed_cells;    ///< Old indexes of cells that do not exist anymore, ascending
+        std::vector<unsigned int> modified_cells;   ///< New indexes of cells whose area, center or number of sides changed, ascending
+    };
+}
@@ -0,0 +1,165 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common_internal.h"
+#include <array>
+
+namespace gg
+{
+    ///Topology of the lattice known at compile time, specialized for every grid type
+    ///Generators are instantiated for every specialization, the runtime parameters.typ selects the instantiation
+    template <GridType T> struct LatticeTraits;
+
+    ///Functions shared by all lattice traits
+    template <class L>
+    struct LatticeTraitsBase
+    {
+        ///Gets the smallest of all positions that describe the same point
+        static PointPosition canonical_point(PointPosition point)
+        {
+            const std::array<PointPosition, 6> neighbors = L::point_neighbors(point);
+            for (std::array<PointPosition, 6>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end() && neighbor->point < 100; neighbor++)
+            {
+                if (neighbor->position < point.position || (!(point.position < neighbor->position) && neighbor->point < point.point)) point = *neighbor;
+            }
+            return point;
+        }
+
+        ///Gets the smaller of the two positions that describe the same face
+        static FacePosition canonical_face(FacePosition face)
+        {
+            const FacePosition neighbor = L::face_neighbor(face);
+            return (neighbor.position < face.position) ? neighbor : face;
+        }
+    };
+
+    ///Topology of triangular lattice
+    template <>
+    struct LatticeTraits<GridType::triangular> : LatticeTraitsBase<LatticeTraits<GridType::triangular>>
+    {
+        static constexpr GridType typ = GridType::triangular;
+        static constexpr unsigned int shape = 3;    ///< Number of points/faces
+
+        ///Gets neighbors of the face
+        static FacePosition face_neighbor(FacePosition face)
+        {
+            //Offsets of normal element, upside down element has opposite offsets
+            static constexpr int offsets[3][2] = { { 0, -1 }, { 0, 0 }, { -1, 0 } };
+            const int one = face.position.upside_down ? -1 : 1;
+            face.position.xi += one * offsets[face.face][0];
+            face.position.yi += one * offsets[face.face][1];
+            face.position.upside_down = !face.position.upside_down;
+            return face;
+        }
+
+        ///Gets neighbors of the point
+        static std::array<PointPosition, 6> point_neighbors(PointPosition point)
+        {
+            //Point, X and Y offsets (opposite for upside down element) and orientation change of every neighbor
+            static constexpr int neighbors[3][5][4] =
+            {
+                { { 2, -1, 0, 1 }, { 1, -1, 0, 0 }, { 0, -1, -1, 1 }, { 2, 0, -1, 0 }, { 1, 0, -1, 1 } },
+                { { 0, 0, -1, 1 }, { 2, 1, -1, 0 }, { 1, 1, -1, 1 }, { 0, 1, 0, 0 }, { 2, 0, 0, 1 } },
+                { { 1, 0, 0, 1 }, { 0, 0, 1, 0 }, { 2, -1, 1, 1 }, { 1, -1, 1, 0 }, { 0, -1, 0, 1 } }
+            };
+            std::array<PointPosition, 6> result;
+            for (unsigned int i = 0; i < 6; i++) { result[i].position = point.position; result[i].point = (unsigned int)-1; }
+            const int one = point.position.upside_down ? -1 : 1;
+            for (unsigned int i = 0; i < 5; i++)
+            {
+                const int *neighbor = neighbors[point.point][i];
+                result[i].point = (unsigned int)neighbor[0];
+                result[i].position.xi += one * neighbor[1];
+                result[i].position.yi += one * neighbor[2];
+                if (neighbor[3] != 0) result[i].position.upside_down = !point.position.upside_down;
+            }
+            return result;
+        }
+    };
+
+    ///Topology of square lattice
+    template <>
+    struct LatticeTraits<GridType::square> : LatticeTraitsBase<LatticeTraits<GridType::square>>
+    {
+        static constexpr GridType typ = GridType::square;
+        static constexpr unsigned int shape = 4;    ///< Number of points/faces
+
+        ///Gets neighbors of the face
+        static FacePosition face_neighbor(FacePosition face)
+        {
+            static constexpr int offsets[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+            face.position.xi += offsets[face.face][0];
+            face.position.yi += offsets[face.face][1];
+            face.face = (face.face + 2) % 4;
+            return face;
+        }
+
+        ///Gets neighbors of the point
+        static std::array<PointPosition, 6> point_neighbors(PointPosition point)
+        {
+            static constexpr int offsets[4][3][2] =
+            {
+                { { -1, 0 }, { -1, -1 }, { 0, -1 } },
+                { { 0, -1 }, { 1, -1 }, { 1, 0 } },
+                { { 1, 0 }, { 1, 1 }, { 0, 1 } },
+                { { 0, 1 }, { -1, 1 }, { -1, 0 } }
+            };
+            std::array<PointPosition, 6> result;
+            for (unsigned int i = 0; i < 6; i++) { result[i].position = point.position; result[i].point = (unsigned int)-1; }
+            for (unsigned int i = 0; i < 3; i++)
+            {
+                result[i].position.xi += offsets[point.point][i][0];
+                result[i].position.yi += offsets[point.point][i][1];
+                result[i].point = (point.point + 1 + i) % 4;
+            }
+            return result;
+        }
+    };
+
+    ///Topology of hexagonal lattice
+    template <>
+    struct LatticeTraits<GridType::hexagonal> : LatticeTraitsBase<LatticeTraits<GridType::hexagonal>>
+    {
+        static constexpr GridType typ = GridType::hexagonal;
+        static constexpr unsigned int shape = 6;    ///< Number of points/faces
+
+        ///Gets neighbors of the face
+        static FacePosition face_neighbor(FacePosition face)
+        {
+            static constexpr int offsets[6][2] = { { 1, -1 }, { 1, 0 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { 0, -1 } };
+            face.position.xi += offsets[face.face][0];
+            face.position.yi += offsets[face.face][1];
+            face.face = (face.face + 3) % 6;
+            return face;
+        }
+
+        ///Gets neighbors of the point
+        static std::array<PointPosition, 6> point_neighbors(PointPosition point)
+        {
+            static constexpr int offsets[6][2][2] =
+            {
+                { { 0, -1 }, { 1, -1 } },
+                { { 1, -1 }, { 1, 0 } },
+                { { 1, 0 }, { 0, 1 } },
+                { { 0, 1 }, { -1, 1 } },
+                { { -1, 1 }, { -1, 0 } },
+                { { -1, 0 }, { 0, -1 } }
+            };
+            std::array<PointPosition, 6> result;
+            for (unsigned int i = 0; i < 6; i++) { result[i].position = point.position; result[i].point = (unsigned int)-1; }
+            for (unsigned int i = 0; i < 2; i++)
+            {
+                result[i].position.xi += offsets[point.point][i][0];
+                result[i].position.yi += offsets[point.point][i][1];
+                result[i].point = (point.point + 2 + 2 * i) % 6;
+            }
+            return result;
+        }
+    };
+}
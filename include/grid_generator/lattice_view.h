@@ -0,0 +1,120 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "cell_grid.h"
+#include "common_internal.h"
+#include "indexed_grid.h"
+#include <vector>
+#include <array>
+
+namespace gg
+{
+    ///Cell of lattice view, whole lattice elements are synthesized from the lattice, elements cut by boundaries are stored
+    struct ViewCell
+    {
+        Position position;              ///< Lattice element of the cell
+        Vector center;                  ///< Center of the cell
+        double area;                    ///< Area of the cell
+        unsigned int boundary;          ///< Index of a boundary that cuts the cell, or no_index
+        unsigned int point_count;       ///< Number of points
+        std::array<Vector, 12> points;  ///< Points of the cell, counterclockwise, points on faces of the lattice element lie on boundaries
+        std::array<unsigned int, 12> faces; ///< Face of the lattice element that contains side points[i] ... points[i+1], or no_index for sides on boundaries
+    };
+
+    ///Side of a lattice view cell, faces are not stored and are addressed by cell and side
+    struct ViewFace
+    {
+        unsigned int owner;             ///< Index of the cell
+        unsigned int neighbor;          ///< Index of the neighbor cell behind the face, or no_index
+        unsigned int face;              ///< Face of the lattice element of the owner, or no_index for faces on boundaries
+        unsigned int boundary;          ///< Index of the boundary for faces on boundaries, or no_index
+        std::array<Vector, 2> points;   ///< Points of the face, counterclockwise in the owner
+    };
+
+    ///Cellular grid that does not store whole lattice elements
+    ///Lattice rows are classified like in Generation::scanline, every row is split into spans of whole and cut elements
+    ///Whole elements are synthesized on access, only cut elements are stored, so the memory is proportional to the length of boundaries
+    ///Cells are numbered row by row (by Y index, orientation and X index), refinement, ordering and partitioning are not supported
+    ///Side i of a cell is face (i, i+1) of its points, faces are returned by face() without global numbering
+    template <class B = Boundary>
+    class LatticeView
+    {
+    protected:
+        struct Span
+        {
+            Position first;         //First element
+            unsigned int count;     //Number of cells
+            unsigned int cut;       //First cut cell in _cut, or no_index if the cells are whole elements first.xi ... first.xi + count - 1
+            unsigned int offset;    //Index of the first cell
+        };
+        CellGridParameters _parameters;
+        Lattice _lattice;
+        std::vector<Span> _spans;
+        std::vector<ViewCell> _cut;
+        unsigned int _size = 0;
+        ViewCell _whole(Position position) const;
+
+    public:
+        ///Forward iterator over cells of the view, cells are returned by value
+        class Iterator
+        {
+        protected:
+            const LatticeView *_view;
+            unsigned int _span;
+            unsigned int _cell;
+        public:
+            ///Creates iterator
+            ///@param view Lattice view
+            ///@param span Span of the cell
+            ///@param cell Index of the cell
+            Iterator(const LatticeView *view, unsigned int span, unsigned int cell);
+            ///Gets cell
+            ViewCell operator*() const;
+            ///Gets index of the cell
+            unsigned int index() const;
+            ///Moves to the next cell
+            Iterator &operator++();
+            ///Checks if iterators point to the same cell
+            bool operator==(const Iterator &other) const;
+            ///Checks if iterators point to different cells
+            bool operator!=(const Iterator &other) const;
+        };
+
+        ///Creates lattice view, all boundary figures must have finite bounds
+        ///@param parameters Cell grid parameters, parameters.generation, parameters.storage, parameters.incremental and parameters.locator are ignored
+        ///@param boundaries Grid boundaries
+        LatticeView(const CellGridParameters &parameters, const std::vector<B> &boundaries);
+        ///Gets number of cells
+        unsigned int size() const;
+        ///Gets number of stored cells (cells cut by boundaries)
+        unsigned int stored() const;
+        ///Gets number of bytes occupied by spans and stored cells
+        std::size_t memory() const;
+        ///Gets cell by index
+        ///@param index Index of the cell
+        ViewCell cell(unsigned int index) const;
+        ///Finds cell of lattice element
+        ///@param position Lattice element
+        ///@return Index of the cell, or no_index
+        unsigned int find(Position position) const;
+        ///Gets neighbor cell
+        ///@param index Index of the cell
+        ///@param face Face of the lattice element
+        ///@return Index of the neighbor cell, or no_index
+        unsigned int neighbor(unsigned int index, unsigned int face) const;
+        ///Gets face of the cell
+        ///@param index Index of the cell
+        ///@param side Side of the cell, less than ViewCell::point_count
+        ViewFace face(unsigned int index, unsigned int side) const;
+        ///Gets iterator to the first cell
+        Iterator begin() const;
+        ///Gets iterator after the last cell
+        Iterator end() const;
+    };
+}
@@ -0,0 +1,271 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "lattice_view.h"
+#include "scanline.hxx"
+#include "boundary_index.hxx"
+#include <algorithm>
+#include <stdexcept>
+#include <math.h>
+
+/*
+    Points are classified by rows of their canonical positions, like in scanline generation of CellGrid
+    The status of point p of element xi changes only where xi + offset of the canonical position crosses a crossing of the point row
+    So every row of elements is split at such X indexes into intervals, elements of an interval have the same statuses of points
+    Intervals of inside points become spans of whole elements, intervals of mixed points are probed element by element
+*/
+
+template <class B> gg::LatticeView<B>::Iterator::Iterator(const LatticeView *view, unsigned int span, unsigned int cell) :
+    _view(view), _span(span), _cell(cell) {}
+
+template <class B> gg::ViewCell gg::LatticeView<B>::Iterator::operator*() const
+{
+    const Span &span = _view->_spans[_span];
+    if (span.cut != no_index) return _view->_cut[span.cut + (_cell - span.offset)];
+    Position position = span.first;
+    position.xi += (int)(_cell - span.offset);
+    return _view->_whole(position);
+}
+
+template <class B> unsigned int gg::LatticeView<B>::Iterator::index() const
+{
+    return _cell;
+}
+
+template <class B> typename gg::LatticeView<B>::Iterator &gg::LatticeView<B>::Iterator::operator++()
+{
+    _cell++;
+    if (_cell == _view->_spans[_span].offset + _view->_spans[_span].count) _span++;
+    return *this;
+}
+
+template <class B> bool gg::LatticeView<B>::Iterator::operator==(const Iterator &other) const
+{
+    return _cell == other._cell;
+}
+
+template <class B> bool gg::LatticeView<B>::Iterator::operator!=(const Iterator &other) const
+{
+    return _cell != other._cell;
+}
+
+template <class B> gg::LatticeView<B>::LatticeView(const CellGridParameters &parameters, const std::vector<B> &boundaries) :
+    _parameters(parameters), _lattice(parameters)
+{
+    if (parameters.refinement > 0) throw std::runtime_error("gg::LatticeView::LatticeView(): Lattice view cannot be refined");
+    if (parameters.ordering != Ordering::lattice) throw std::runtime_error("gg::LatticeView::LatticeView(): Lattice view cannot be reordered");
+    if (parameters.parts != 1) throw std::runtime_error("gg::LatticeView::LatticeView(): Lattice view cannot be partitioned");
+    const BoundaryIndex<B> index(parameters, boundaries);
+    const Scanline<B> scanline(parameters, index);
+    const unsigned int shape = _lattice.shape(), layers = (parameters.typ == GridType::triangular) ? 2 : 1;
+    const double area = _lattice.area();
+    Position zero, one;
+    one.yi = 1;
+    int ymin, ymax;
+    if (!scanline.rows(_lattice.center(zero), _lattice.center(one), ymin, ymax)) return;
+
+    std::array<std::vector<Crossing>, 6> crossings;
+    std::array<bool, 6> valid;
+    std::array<int, 6> offsets;
+    std::vector<int> breaks;
+    for (int yi = ymin; yi <= ymax; yi++)
+    {
+        for (unsigned int layer = 0; layer < layers; layer++)
+        {
+            //Rows of canonical positions of points, and X indexes where statuses of points change
+            zero.xi = 0; zero.yi = yi; zero.upside_down = (layer == 1);
+            one = zero; one.xi = 1;
+            int xmin, xmax;
+            scanline.columns(_lattice.center(zero), _lattice.center(one), xmin, xmax);
+            const int begin = xmin - 1, end = xmax + 2;
+            breaks.clear();
+            breaks.push_back(begin);
+            breaks.push_back(end);
+            for (unsigned int p = 0; p < shape; p++)
+            {
+                const PointPosition canonical = get_canonical_point(parameters, { zero, p });
+                Position row_zero = canonical.position, row_one = canonical.position;
+                row_zero.xi = 0;
+                row_one.xi = 1;
+                offsets[p] = canonical.position.xi;
+                int row_xmin, row_xmax;
+                valid[p] = (canonical.position.yi >= ymin - 1 && canonical.position.yi <= ymax + 1)
+                    && scanline.columns(_lattice.points(row_zero)[canonical.point], _lattice.points(row_one)[canonical.point], row_xmin, row_xmax, crossings[p]);
+                if (!valid[p]) continue;
+                for (std::vector<Crossing>::const_iterator crossing = crossings[p].begin(); crossing != crossings[p].end(); crossing++)
+                {
+                    const double x = ceil(crossing->x) - offsets[p];
+                    if (x > begin && x < end) breaks.push_back((int)x);
+                }
+            }
+            std::sort(breaks.begin(), breaks.end());
+            breaks.erase(std::unique(breaks.begin(), breaks.end()), breaks.end());
+
+            //Intervals between breaks
+            for (unsigned int i = 0; i + 1 < breaks.size(); i++)
+            {
+                std::array<bool, 6> inside_points;
+                unsigned int inside = 0;
+                for (unsigned int p = 0; p < shape; p++)
+                {
+                    inside_points[p] = valid[p] && Scanline<B>::inside(crossings[p], breaks[i] + offsets[p]);
+                    if (inside_points[p]) inside++;
+                }
+                if (inside == 0) continue;
+                Position position = zero;
+                if (inside == shape)
+                {
+                    //Whole elements
+                    position.xi = breaks[i];
+                    const unsigned int count = (unsigned int)(breaks[i + 1] - breaks[i]);
+                    if (!_spans.empty() && _spans.back().cut == no_index && _spans.back().first.yi == yi && _spans.back().first.upside_down == position.upside_down
+                        && _spans.back().first.xi + (int)_spans.back().count == position.xi) _spans.back().count += count;
+                    else _spans.push_back({ position, count, no_index, _size });
+                    _size += count;
+                    continue;
+                }
+
+                //Cut elements, probed from inside points to outside points
+                for (position.xi = breaks[i]; position.xi < breaks[i + 1]; position.xi++)
+                {
+                    const std::array<Vector, 6> points = _lattice.points(position);
+                    ViewCell cell;
+                    cell.position = position;
+                    cell.boundary = no_index;
+                    cell.point_count = 0;
+                    for (unsigned int p = 0; p < shape; p++)
+                    {
+                        const unsigned int next_ccw = ((p == (shape - 1)) ? 0 : (p + 1));
+                        if (inside_points[p]) { cell.faces[cell.point_count] = p; cell.points[cell.point_count++] = points[p]; }
+                        if (inside_points[p] == inside_points[next_ccw]) continue;
+                        const B *pboundary = nullptr;
+                        const Intersection intersection = inside_points[p] ? index.intersection(points[p], points[next_ccw], pboundary) : index.intersection(points[next_ccw], points[p], pboundary);
+                        if (!intersection.valid) continue;
+                        cell.faces[cell.point_count] = inside_points[p] ? no_index : p; //Side from exit point goes along the boundary
+                        cell.points[cell.point_count++] = intersection.coord;
+                        cell.boundary = (unsigned int)(pboundary - &boundaries[0]);
+                    }
+
+                    //Area and center, the same as in CellGrid
+                    cell.area = 0;
+                    cell.center = Vector(0, 0);
+                    for (unsigned int p = 1; p + 1 < cell.point_count; p++)
+                    {
+                        double a = (cell.points[p] - cell.points[0]).norm();
+                        double b = (cell.points[p+1] - cell.points[0]).norm();
+                        double c = (cell.points[p+1] - cell.points[p]).norm();
+                        double s = 0.5 * (a + b + c);
+                        double local_area = sqrt(s * (s - a) * (s - b) * (s - c));
+                        Vector local_center = (cell.points[0] + cell.points[p] + cell.points[p+1]) / 3;
+                        cell.area = cell.area + local_area;
+                        cell.center = cell.center + (local_center * local_area);
+                    }
+                    if (cell.point_count < 3 || !(cell.area > 0.0)) continue;
+                    cell.center = cell.center / cell.area;
+                    if (parameters.threshold_area >= 1.0 || (parameters.threshold_area > 0.0 && !(cell.area > (parameters.threshold_area * area)))) continue;
+
+                    if (!_spans.empty() && _spans.back().cut != no_index && _spans.back().first.yi == yi && _spans.back().first.upside_down == position.upside_down) _spans.back().count++;
+                    else _spans.push_back({ position, 1, (unsigned int)_cut.size(), _size });
+                    _cut.push_back(cell);
+                    _size++;
+                }
+            }
+        }
+    }
+}
+
+template <class B> gg::ViewCell gg::LatticeView<B>::_whole(Position position) const
+{
+    ViewCell cell;
+    cell.position = position;
+    cell.center = _lattice.center(position);
+    cell.area = _lattice.area();
+    cell.boundary = no_index;
+    cell.point_count = _lattice.shape();
+    const std::array<Vector, 6> points = _lattice.points(position);
+    std::copy(points.begin(), points.begin() + cell.point_count, cell.points.begin());
+    for (unsigned int p = 0; p < cell.point_count; p++) cell.faces[p] = p;
+    return cell;
+}
+
+template <class B> unsigned int gg::LatticeView<B>::size() const
+{
+    return _size;
+}
+
+template <class B> unsigned int gg::LatticeView<B>::stored() const
+{
+    return (unsigned int)_cut.size();
+}
+
+template <class B> std::size_t gg::LatticeView<B>::memory() const
+{
+    return _spans.capacity() * sizeof(Span) + _cut.capacity() * sizeof(ViewCell);
+}
+
+template <class B> gg::ViewCell gg::LatticeView<B>::cell(unsigned int index) const
+{
+    if (index >= _size) throw std::runtime_error("gg::LatticeView::cell(): Invalid index");
+    const typename std::vector<Span>::const_iterator span = std::upper_bound(_spans.begin(), _spans.end(), index,
+        [](unsigned int index, const Span &span) -> bool { return index < span.offset; }) - 1;
+    return *Iterator(this, (unsigned int)(span - _spans.begin()), index);
+}
+
+template <class B> unsigned int gg::LatticeView<B>::find(Position position) const
+{
+    //Spans are sorted by Y index, orientation and X index of their first elements
+    const auto before = [](const Position &a, const Position &b) -> bool
+    {
+        if (a.yi != b.yi) return a.yi < b.yi;
+        if (a.upside_down != b.upside_down) return b.upside_down;
+        return a.xi < b.xi;
+    };
+    typename std::vector<Span>::const_iterator span = std::upper_bound(_spans.begin(), _spans.end(), position,
+        [&](const Position &position, const Span &span) -> bool { return before(position, span.first); });
+    if (span == _spans.begin()) return no_index;
+    span--;
+    if (span->first.yi != position.yi || span->first.upside_down != position.upside_down) return no_index;
+    if (span->cut == no_index)
+    {
+        return (position.xi < span->first.xi + (int)span->count) ? (span->offset + (unsigned int)(position.xi - span->first.xi)) : no_index;
+    }
+    const typename std::vector<ViewCell>::const_iterator begin = _cut.begin() + span->cut, end = begin + span->count;
+    const typename std::vector<ViewCell>::const_iterator cell = std::lower_bound(begin, end, position.xi,
+        [](const ViewCell &cell, int xi) -> bool { return cell.position.xi < xi; });
+    return (cell != end && cell->position.xi == position.xi) ? (span->offset + (unsigned int)(cell - begin)) : no_index;
+}
+
+template <class B> unsigned int gg::LatticeView<B>::neighbor(unsigned int index, unsigned int face) const
+{
+    if (face >= _lattice.shape()) throw std::runtime_error("gg::LatticeView::neighbor(): Invalid face");
+    return find(get_face_neighbor(_parameters, { cell(index).position, face }).position);
+}
+
+template <class B> gg::ViewFace gg::LatticeView<B>::face(unsigned int index, unsigned int side) const
+{
+    const ViewCell owner = cell(index);
+    if (side >= owner.point_count) throw std::runtime_error("gg::LatticeView::face(): Invalid side");
+    ViewFace face;
+    face.owner = index;
+    face.face = owner.faces[side];
+    face.points = {{ owner.points[side], owner.points[(side + 1 == owner.point_count) ? 0 : (side + 1)] }};
+    face.neighbor = (face.face == no_index) ? no_index : find(get_face_neighbor(_parameters, { owner.position, face.face }).position);
+    face.boundary = (face.face == no_index) ? owner.boundary : no_index;
+    return face;
+}
+
+template <class B> typename gg::LatticeView<B>::Iterator gg::LatticeView<B>::begin() const
+{
+    return Iterator(this, 0, 0);
+}
+
+template <class B> typename gg::LatticeView<B>::Iterator gg::LatticeView<B>::end() const
+{
+    return Iterator(this, (unsigned int)_spans.size(), _size);
+}
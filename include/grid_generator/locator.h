@@ -0,0 +1,61 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common_internal.h"
+#include "dense_lattice.h"
+#include "indexed_grid.h"
+#include "parallel.h"
+#include <vector>
+
+namespace gg
+{
+    ///Finds cells of cellular grid that contain given coordinates
+    ///Coordinate is transformed to the position of the lattice element, that gives the cell in constant time
+    ///Only cells cut by boundaries keep their polygons and are checked by point-in-polygon test
+    class CellLocator
+    {
+    protected:
+        Lattice _lattice;
+        DenseLattice<unsigned int> _cells;          //Cell of every lattice element, or no_index
+        std::vector<unsigned int> _polygon_offsets; //Polygon of cell i is _polygon_points[_polygon_offsets[i]] ... _polygon_points[_polygon_offsets[i+1]-1], empty if cell is the whole element
+        std::vector<Vector> _polygon_points;        //Points of polygons of cut cells
+    public:
+        ///Creates empty locator
+        CellLocator();
+        ///Creates empty locator for the lattice
+        ///@param parameters Grid parameters
+        explicit CellLocator(const Parameters &parameters);
+        ///Adds cell, cells must be added in order of their indexes
+        ///@param position Position of the lattice element of the cell
+        ///@param cell Index of the cell
+        ///@param polygon Points of the cell counterclockwise, empty if the cell is the whole lattice element
+        void insert(Position position, unsigned int cell, const std::vector<Vector> &polygon);
+        ///Sets cell of the lattice element, used when cells are updated
+        ///@param position Position of the lattice element
+        ///@param cell Index of the cell, or no_index if the element has no cell
+        void set(Position position, unsigned int cell);
+        ///Replaces polygons of some cells, other cells keep their polygons
+        ///@param count New number of cells, polygons of cells beyond it are removed
+        ///@param cells Indexes of cells, ascending
+        ///@param offsets Polygon of cell cells[i] is points[offsets[i]] ... points[offsets[i+1]-1]
+        ///@param points Points of polygons
+        void replace(unsigned int count, const std::vector<unsigned int> &cells, const std::vector<unsigned int> &offsets, const std::vector<Vector> &points);
+        ///Finds cell that contains the coordinate
+        ///@param coord Coordinate
+        ///@return Index of the cell, or no_index if the coordinate lies outside of the grid
+        unsigned int locate(Vector coord) const;
+        ///Finds cells that contain the coordinates, coordinates are processed in parallel by threads of the pool
+        ///@param coords Coordinates
+        ///@param cells Indexes of cells, or no_index
+        ///@param pool Thread pool, created once by the caller and reused for all calls (see get_threads())
+        void locate(const std::vector<Vector> &coords, std::vector<unsigned int> &cells, ThreadPool &pool) const;
+        ///Checks if locator is empty
+        bool empty() const;
+    };
+}
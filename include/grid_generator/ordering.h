@@ -0,0 +1,41 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common.h"
+#include "indexed_grid.h"
+#include <vector>
+
+namespace gg
+{
+    ///New indexes of points, faces and cells after reordering of cellular grid
+    struct GridReordering
+    {
+        std::vector<unsigned int> point_map;    ///< New indexes of old points
+        std::vector<unsigned int> face_map;     ///< New indexes of old faces
+        std::vector<unsigned int> cell_map;     ///< New indexes of old cells
+    };
+
+    ///Gets order of cells of cellular grid
+    ///Space-filling curves are built over positions of lattice elements that contain cell centers, cells in the same element keep their order
+    ///@param grid Cellular grid
+    ///@param parameters Parameters of the lattice, elements of refined grids are smaller than elements of the original lattice
+    ///@param ordering Ordering
+    ///@return Old indexes of cells in the new order
+    std::vector<unsigned int> get_cell_order(const IndexedCellGrid &grid, const Parameters &parameters, Ordering ordering);
+    ///Renumbers cellular grid, points and faces are numbered in order of the first cell that has them
+    ///@param grid Cellular grid
+    ///@param order Old indexes of cells in the new order
+    GridReordering reorder(IndexedCellGrid &grid, const std::vector<unsigned int> &order);
+    ///Moves values to their new indexes
+    ///@param values Values addressed by old indexes, replaced by values addressed by new indexes
+    ///@param map New indexes of old values, permutation
+    template <class T> void permute(std::vector<T> &values, const std::vector<unsigned int> &map);
+    ///Gets bandwidth of cell adjacency (maximal difference between indexes of neighbor cells)
+    unsigned int get_bandwidth(const IndexedCellGrid &grid);
+}
@@ -0,0 +1,18 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "ordering.h"
+#include <algorithm>
+
+template <class T> void gg::permute(std::vector<T> &values, const std::vector<unsigned int> &map)
+{
+    std::vector<T> permuted(values.size());
+    for (unsigned int i = 0; i < values.size(); i++) permuted[map[i]] = values[i];
+    values.swap(permuted);
+}
@@ -0,0 +1,59 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gg
+{
+    ///Gets number of threads used for generation
+    ///@param parameters Grid parameters, zero threads means one thread per processor core
+    unsigned int get_threads(const Parameters &parameters);
+
+    ///Threads that are created once per generation and wait for jobs between stages
+    class ThreadPool
+    {
+    protected:
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _start;
+        std::condition_variable _finish;
+        const std::function<void()> *_job = nullptr;
+        unsigned int _job_number = 0;       //Incremented for every job, workers wait for a new number
+        unsigned int _running = 0;          //Workers that did not finish the job yet
+        bool _stop = false;
+        std::atomic<bool> _busy;            //Job is running, nested jobs are run by the calling thread
+        void _work();
+    public:
+        ///Creates thread pool
+        ///@param threads Number of threads, the calling thread is one of them
+        explicit ThreadPool(unsigned int threads);
+        ThreadPool(const ThreadPool &other) = delete;
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+        ///Gets number of threads, including the calling thread
+        unsigned int threads() const;
+        ///Runs job on every thread and waits until all of them finish, job must not throw
+        ///@param job Job
+        void run(const std::function<void()> &job);
+        ///Stops and joins threads
+        ~ThreadPool();
+    };
+
+    ///Calls function for every index on threads of the pool, indexes are given to threads in chunks on demand
+    ///Function must not depend on the order of calls, the first thrown exception is rethrown
+    ///@param pool Thread pool
+    ///@param count Number of indexes
+    ///@param function Function that takes index
+    template <class F> void parallel_for(ThreadPool &pool, unsigned int count, const F &function);
+}
@@ -0,0 +1,48 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "parallel.h"
+#include <exception>
+
+template <class F> void gg::parallel_for(ThreadPool &pool, unsigned int count, const F &function)
+{
+    const unsigned int threads = (pool.threads() > count) ? count : pool.threads();
+    if (threads <= 1)
+    {
+        for (unsigned int i = 0; i < count; i++) function(i);
+        return;
+    }
+
+    //Small chunks balance the load, several chunks per thread are enough
+    const unsigned int chunk = (count / (8 * threads) > 0) ? (count / (8 * threads)) : 1;
+    std::atomic<unsigned int> next(0);
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+    const std::function<void()> work = [&]()
+    {
+        try
+        {
+            while (true)
+            {
+                const unsigned int begin = next.fetch_add(chunk);
+                if (begin >= count) break;
+                const unsigned int end = (count - begin > chunk) ? (begin + chunk) : count;
+                for (unsigned int i = begin; i < end; i++) function(i);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if (exception == nullptr) exception = std::current_exception();
+            next = count;
+        }
+    };
+    pool.run(work);
+    if (exception != nullptr) std::rethrow_exception(exception);
+}
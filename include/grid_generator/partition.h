@@ -0,0 +1,36 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common.h"
+#include <vector>
+
+namespace gg
+{
+    ///Part of cellular grid generated by one of several processes
+    ///Local cells are owned cells of the part (in order of their global indexes), followed by ghost cells owned by other parts (in order of their global indexes)
+    ///Global indexes are indexes of cells in the grid generated without partitioning with Generation::scanline
+    struct CellPartition
+    {
+        unsigned int parts = 1;                         ///< Number of parts
+        unsigned int part = 0;                          ///< Index of the part
+        unsigned int owned = 0;                         ///< Number of owned cells, local cells owned ... are ghosts
+        std::vector<unsigned int> global_cells;         ///< Global indexes of local cells
+        std::vector<unsigned int> cell_parts;           ///< Parts that own local cells
+        std::vector<unsigned int> send_offsets;         ///< Owned cells that are ghosts of part i are send_cells[send_offsets[i]] ... send_cells[send_offsets[i+1]-1]
+        std::vector<unsigned int> send_cells;           ///< Local indexes of owned cells to be sent to other parts, ascending
+        std::vector<unsigned int> receive_offsets;      ///< Ghost cells owned by part i are receive_cells[receive_offsets[i]] ... receive_cells[receive_offsets[i+1]-1]
+        std::vector<unsigned int> receive_cells;        ///< Local indexes of ghost cells to be received from other parts, ascending
+    };
+
+    ///Splits cells into balanced parts by recursive coordinate bisection, every region is halved across its longer side
+    ///@param centers Centers of cells
+    ///@param parts Number of parts
+    ///@return Parts of cells
+    std::vector<unsigned int> get_cell_parts(const std::vector<Vector> &centers, unsigned int parts);
+}
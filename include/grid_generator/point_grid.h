@@ -8,6 +8,9 @@
 
 #pragma once
 #include "common.h"
+#include "arena.h"
+#include "indexed_grid.h"
+#include "statistics.h"
 #include <set>
 
 namespace gg
@@ -45,13 +48,33 @@ namespace gg
     class PointGrid
     {
     protected:
+        Arena<P> _point_arena;
         std::set<P*> _points;
+        IndexedPointGrid _indexed;
+        template <class S> void _generate(const PointGridParameters &parameters, const std::vector<B> &boundaries, S &statistics);
+        template <class L, class S> void _generate(const PointGridParameters &parameters, const std::vector<B> &boundaries, S &statistics);
     public:
         ///Creates point grid
         ///@param parameters Point grid parameters
         ///@param boundaries Grid boundaries
         PointGrid(const PointGridParameters &parameters, const std::vector<B> &boundaries);
-        ///Gets list of points
+        ///Creates point grid and records statistics of generation
+        ///@param parameters Point grid parameters
+        ///@param boundaries Grid boundaries
+        ///@param statistics Statistics policy, for example GridStatistics
+        template <class S> PointGrid(const PointGridParameters &parameters, const std::vector<B> &boundaries, S &statistics);
+        ///Transfers point grid, pointers to points stay valid
+        ///@param other Grid to be transferred
+        PointGrid(PointGrid &&other) = default;
+        PointGrid(const PointGrid &other) = delete;
+        PointGrid &operator=(const PointGrid &other) = delete;
+        ///Destroys grid and all its points
+        ~PointGrid();
+        ///Gets list of points, empty unless storage is Storage::objects
         std::set<P*> &points();
+        ///Gets points stored in contiguous arrays, empty unless storage is Storage::indexed
+        IndexedPointGrid &indexed();
+        ///Gets points stored in contiguous arrays, empty unless storage is Storage::indexed
+        const IndexedPointGrid &indexed() const;
     };
 }
\ No newline at end of file
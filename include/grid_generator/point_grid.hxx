@@ -9,7 +9,12 @@
 #pragma once
 #include "point_grid.h"
 #include "common_internal.h"
-#include <map>
+#include "lattice_traits.h"
+#include "dense_lattice.hxx"
+#include "scanline.hxx"
+#include "boundary_index.hxx"
+#include "arena.hxx"
+#include "parallel.hxx"
 
 /*
     Points are divided into active, passive and unreached
@@ -17,9 +22,20 @@
     Active and passive points are both "reached" points, they are divided in two categories for optimization reasons
     The algorithm actively searches around "active" point, but does not search around "passive" points
 
-    Because adding/removing elements from set cannot be done while iterating through it, there are sets like "to_be_active", etc.
+    Reached points are stored in one array in order of reaching, and a dense lattice maps positions to indexes in this array
+    Because of that the categories are just ranges of the array: [0, active_begin) are passive, [active_begin, active_end) are active,
+    and [active_end, size) are "to_be_active"
     
     In this version of the algorithm active points with guaranty become passive after one iteration, so no checks are done
+    Faces around active points are probed in parallel, then new points are appended by one thread in the serial order,
+    so the result does not depend on the number of threads
+
+    Scanline generation does not search, it takes all points between crossings of lattice rows with boundaries
+    Only points near crossings (and points next to outside points) are probed for boundary conditions
+    Rows and probes are independent and processed in parallel, rows are appended in order of their Y index
+
+    The order of reaching is also the order of the result, points are first written to contiguous arrays,
+    and point objects are created from the arrays only if storage is Storage::objects
 */
 
 namespace gg
@@ -54,79 +70,242 @@ template <class B> std::vector<gg::StandalonePoint<B>*> &gg::StandalonePoint<B>:
 
 template <class B, class P> gg::PointGrid<B, P>::PointGrid(const PointGridParameters &parameters, const std::vector<B> &boundaries)
 {
-    //STAGE 0: declare sets
-    std::map<Position, TemporaryStandalonePoint<B, P>> active, passive;
+    NoStatistics statistics;
+    _generate(parameters, boundaries, statistics);
+}
 
-    //STAGE 1: add first point
-    active.insert({ Position(), TemporaryStandalonePoint<B, P>() });
+template <class B, class P> template <class S> gg::PointGrid<B, P>::PointGrid(const PointGridParameters &parameters, const std::vector<B> &boundaries, S &statistics)
+{
+    _generate(parameters, boundaries, statistics);
+}
 
-    //STAGE 2: add all points
-    while (!active.empty())
+template <class B, class P> template <class S> void gg::PointGrid<B, P>::_generate(const PointGridParameters &parameters, const std::vector<B> &boundaries, S &statistics)
+{
+    switch (parameters.typ)
     {
-        //Iterate through active, add new points to "to_be_active"
-        std::map<Position, TemporaryStandalonePoint<B, P>> to_be_active;
-        for (typename std::map<Position, TemporaryStandalonePoint<B, P>>::iterator point = active.begin(); point != active.end(); point++)
+        case GridType::triangular: _generate<LatticeTraits<GridType::triangular>>(parameters, boundaries, statistics); break;
+        case GridType::hexagonal: _generate<LatticeTraits<GridType::hexagonal>>(parameters, boundaries, statistics); break;
+        default: _generate<LatticeTraits<GridType::square>>(parameters, boundaries, statistics); break;
+    }
+}
+
+template <class B, class P> template <class L, class S> void gg::PointGrid<B, P>::_generate(const PointGridParameters &parameters, const std::vector<B> &boundaries, S &statistics)
+{
+    //STAGE 0: declare containers
+    statistics.begin("index");
+    ThreadPool pool(get_threads(parameters));
+    const BoundaryIndex<B> index(parameters, boundaries);
+    const Lattice lattice(parameters);
+    DenseLattice<unsigned int> indexes(parameters, (unsigned int)-1);
+    std::vector<Position> positions;
+    std::vector<TemporaryStandalonePoint<B, P>> points;
+    const auto memory = [&]() -> std::size_t
+    {
+        return indexes.capacity() * sizeof(unsigned int) + positions.capacity() * sizeof(Position) + points.capacity() * sizeof(TemporaryStandalonePoint<B, P>)
+            + (_indexed.coords.capacity() + _indexed.normals.capacity()) * sizeof(Vector)
+            + (_indexed.boundaries.capacity() + _indexed.neighbor_offsets.capacity() + _indexed.neighbors.capacity()) * sizeof(unsigned int);
+    };
+    statistics.end();
+
+    if (parameters.generation == Generation::flood_fill)
+    {
+        //STAGE 1: add first point
+        statistics.begin("flood fill");
+        statistics.lookup();
+        indexes.at(Position()) = 0;
+        positions.push_back(Position());
+        points.push_back(TemporaryStandalonePoint<B, P>());
+
+        //STAGE 2: add all points
+        std::vector<unsigned char> open;    //Face of active point was probed and no boundary was found
+        unsigned int active_begin = 0, active_end = 1;
+        while (active_begin != active_end)
         {
-            const Vector active_coord = get_center(parameters, point->first);
-            for (unsigned int f = 0; f < get_shape(parameters); f++)    //Look on every neighbor
+            //Probe around active points in parallel, every thread writes only to its own points
+            statistics.wave();
+            open.assign((active_end - active_begin) * L::shape, 0);
+            parallel_for(pool, active_end - active_begin, [&](unsigned int i)
             {
-                const Position neighbor = get_face_neighbor(parameters, { point->first, f }).position;
-                if (passive.find(neighbor) != passive.end()) continue;  //Already passive, skip
-                if (active.find(neighbor) != active.end()) continue;    //Already active, skip
-                const Vector to_be_active_coord = get_center(parameters, neighbor);
-                
-                Intersection intersection;
-                const B *pboundary;
-                for (typename std::vector<B>::const_iterator boundary = boundaries.begin(); boundary != boundaries.end(); boundary++)
+                const unsigned int point = active_begin + i;
+                const Vector active_coord = lattice.center(positions[point]);
+                for (unsigned int f = 0; f < L::shape; f++)    //Look on every neighbor
                 {
-                    Intersection new_intersection = boundary->figure()->intersection(active_coord, to_be_active_coord);
-                    if (new_intersection.valid && (!intersection.valid || ((new_intersection.coord-active_coord).squared_norm() < (intersection.coord-active_coord).squared_norm())))
+                    const Position neighbor = L::face_neighbor({ positions[point], f }).position;
+                    statistics.lookup();
+                    if (indexes.get(neighbor) < active_end) continue;  //Already passive or active, skip
+                    const Vector to_be_active_coord = lattice.center(neighbor);
+
+                    const B *pboundary = nullptr;
+                    const Intersection intersection = index.intersection(active_coord, to_be_active_coord, pboundary, statistics);
+                    if (intersection.valid) //Boundary found, remember conditions
                     {
-                        intersection = new_intersection;
-                        pboundary = &(*boundary);
+                        points[point].intersection = intersection;
+                        points[point].boundary = pboundary;
                     }
+                    else open[i * L::shape + f] = 1;
                 }
-                if (intersection.valid) //Boundary found, remember conditions
+            });
+
+            //Append new points to the end in order of probing (they are "to_be_active")
+            for (unsigned int point = active_begin; point < active_end; point++)
+            {
+                for (unsigned int f = 0; f < L::shape; f++)
+                {
+                    if (!open[(point - active_begin) * L::shape + f]) continue;
+                    const Position neighbor = L::face_neighbor({ positions[point], f }).position;
+                    statistics.lookup();
+                    if (indexes.get(neighbor) == (unsigned int)-1) //Boundary not found, create point
+                    {
+                        statistics.lookup();
+                        indexes.at(neighbor) = (unsigned int)positions.size();
+                        positions.push_back(neighbor);
+                        points.push_back(TemporaryStandalonePoint<B, P>());
+                    }
+                }
+            }
+            active_begin = active_end;                      //All active are now passive, no checks needed
+            active_end = (unsigned int)positions.size();    //All to_be_active are now active
+            statistics.memory(memory() + open.capacity());
+        }
+        statistics.end();
+    }
+    else
+    {
+        //STAGE 1: add points between crossings, remember points near crossings
+        statistics.begin("scanline");
+        Scanline<B> scanline(parameters, index);
+        const unsigned int layers = (parameters.typ == GridType::triangular) ? 2 : 1;
+        std::vector<bool> near;
+        Position zero, one;
+        one.yi = 1;
+        int ymin, ymax;
+        if (scanline.rows(lattice.center(zero), lattice.center(one), ymin, ymax))
+        {
+            //Rows are intersected in parallel and appended in order
+            std::vector<std::vector<std::pair<int, bool>>> rows((ymax - ymin + 1) * layers);
+            parallel_for(pool, (unsigned int)rows.size(), [&](unsigned int row)
+            {
+                Position row_zero, row_one;
+                row_zero.yi = ymin + (int)(row / layers); row_zero.upside_down = (row % layers == 1);
+                row_one = row_zero; row_one.xi = 1;
+                std::vector<Crossing> crossings;
+                int xmin, xmax;
+                if (!scanline.columns(lattice.center(row_zero), lattice.center(row_one), xmin, xmax, crossings)) return;
+                for (int xi = xmin; xi <= xmax; xi++)
                 {
-                    point->second.intersection = intersection;
-                    point->second.boundary = pboundary;
+                    if (Scanline<B>::inside(crossings, xi)) rows[row].push_back({ xi, Scanline<B>::crossed(crossings, xi - 1, xi + 1) });
                 }
-                else  //Boundary not found, create point
+            });
+            for (unsigned int row = 0; row < rows.size(); row++)
+            {
+                Position position;
+                position.yi = ymin + (int)(row / layers); position.upside_down = (row % layers == 1);
+                for (std::vector<std::pair<int, bool>>::const_iterator point = rows[row].begin(); point != rows[row].end(); point++)
                 {
-                    if (to_be_active.find(neighbor) == to_be_active.end()) to_be_active.insert({neighbor, TemporaryStandalonePoint<B, P>()});
+                    position.xi = point->first;
+                    statistics.lookup();
+                    indexes.at(position) = (unsigned int)positions.size();
+                    positions.push_back(position);
+                    points.push_back(TemporaryStandalonePoint<B, P>());
+                    near.push_back(point->second);
                 }
             }
         }
-        passive.insert(active.begin(), active.end());   //All active are now passive, no checks needed
-        active = to_be_active;                          //All to_be_active are now active
+
+        //STAGE 2: probe points near crossings and points with outside neighbors, in parallel
+        parallel_for(pool, (unsigned int)positions.size(), [&](unsigned int point)
+        {
+            bool probe = near[point];
+            for (unsigned int f = 0; f < L::shape && !probe; f++)
+            {
+                statistics.lookup();
+                if (indexes.get(L::face_neighbor({ positions[point], f }).position) == (unsigned int)-1) probe = true;
+            }
+            if (!probe) return;
+
+            const Vector point_coord = lattice.center(positions[point]);
+            for (unsigned int f = 0; f < L::shape; f++)
+            {
+                const Vector neighbor_coord = lattice.center(L::face_neighbor({ positions[point], f }).position);
+                const B *pboundary = nullptr;
+                const Intersection intersection = index.intersection(point_coord, neighbor_coord, pboundary, statistics);
+                if (intersection.valid) //Boundary found, remember conditions
+                {
+                    points[point].intersection = intersection;
+                    points[point].boundary = pboundary;
+                }
+            }
+        });
+        statistics.memory(memory() + near.capacity() / 8);
+        statistics.end();
     }
 
-    //STAGE 3: create point objects
-    for (typename std::map<Position, TemporaryStandalonePoint<B, P>>::iterator point = passive.begin(); point != passive.end(); point++)
+    //STAGE 3: fill contiguous arrays
+    statistics.begin("arrays");
+    _indexed.coords.resize(positions.size());
+    _indexed.normals.resize(positions.size());
+    _indexed.boundaries.resize(positions.size());
+    _indexed.neighbor_offsets.resize(positions.size() + 1);
+    for (unsigned int run = 0; run < positions.size();)  //Centers of consecutive points in a row (all rows of scanline) are computed at once
     {
-        if (point->second.boundary == nullptr)
-        {
-            _points.insert(point->second.point = new P(get_center(parameters, point->first)));
-        }
-        else
+        unsigned int count = 1;
+        while (run + count < positions.size() && positions[run + count].yi == positions[run].yi && positions[run + count].upside_down == positions[run].upside_down
+            && positions[run + count].xi == positions[run].xi + (int)count) count++;
+        lattice.centers(positions[run], count, &_indexed.coords[run]);
+        run += count;
+    }
+    for (unsigned int point = 0; point < positions.size(); point++)
+    {
+        _indexed.normals[point] = (points[point].boundary == nullptr) ? Vector(0, 0) : points[point].intersection.normal;
+        _indexed.boundaries[point] = (points[point].boundary == nullptr) ? no_index : (unsigned int)(points[point].boundary - &boundaries[0]);
+        _indexed.neighbor_offsets[point] = (unsigned int)_indexed.neighbors.size();
+        for (unsigned int f = 0; f < L::shape; f++)
         {
-            _points.insert(point->second.point = new P(get_center(parameters, point->first), point->second.intersection, point->second.boundary));
+            statistics.lookup();
+            const unsigned int neighbor_index = indexes.get(L::face_neighbor({ positions[point], f }).position);
+            if (neighbor_index != (unsigned int)-1) _indexed.neighbors.push_back(neighbor_index);
         }
     }
+    _indexed.neighbor_offsets.back() = (unsigned int)_indexed.neighbors.size();
+    statistics.memory(memory());
+    statistics.end();
+    if (parameters.storage == Storage::indexed) return;
 
-    //STAGE 4: interconnect points
-    for (typename std::map<Position, TemporaryStandalonePoint<B, P>>::iterator point = passive.begin(); point != passive.end(); point++)
+    //STAGE 4: create point objects and interconnect them
+    statistics.begin("objects");
+    _point_arena.reserve(positions.size());
+    for (unsigned int point = 0; point < positions.size(); point++)
     {
-        for (unsigned int f = 0; f < get_shape(parameters); f++)
+        if (points[point].boundary == nullptr)
+        {
+            _points.insert(points[point].point = _point_arena.create(_indexed.coords[point]));
+        }
+        else
         {
-            const Position neighbor = get_face_neighbor(parameters, { point->first, f }).position;
-            typename std::map<Position, TemporaryStandalonePoint<B, P>>::iterator find = passive.find(neighbor);
-            if (find != passive.end()) point->second.point->neighbors().push_back(find->second.point);
+            _points.insert(points[point].point = _point_arena.create(_indexed.coords[point], points[point].intersection, points[point].boundary));
         }
     }
+    for (unsigned int point = 0; point < positions.size(); point++)
+    {
+        for (unsigned int n = _indexed.neighbor_offsets[point]; n < _indexed.neighbor_offsets[point + 1]; n++) points[point].point->neighbors().push_back(points[_indexed.neighbors[n]].point);
+    }
+    _indexed = IndexedPointGrid();
+    statistics.end();
 }
 
+template <class B, class P> gg::PointGrid<B, P>::~PointGrid() {}
+
 template <class B, class P> std::set<P*> &gg::PointGrid<B, P>::points()
 {
     return _points;
-}
\ No newline at end of file
+}
+
+template <class B, class P> gg::IndexedPointGrid &gg::PointGrid<B, P>::indexed()
+{
+    return _indexed;
+}
+
+template <class B, class P> const gg::IndexedPointGrid &gg::PointGrid<B, P>::indexed() const
+{
+    return _indexed;
+}
@@ -0,0 +1,88 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common_internal.h"
+#include "boundary_index.h"
+#include <vector>
+#include <array>
+
+namespace gg
+{
+    class ThreadPool;
+
+    ///Square lattice whose elements near boundaries are recursively divided in four, neighbor leaves differ by at most one level
+    ///Vertices are addressed by integer coordinates on the finest level, coarse element (x, y) spans vertices from (x * 2^levels, y * 2^levels) to ((x + 1) * 2^levels, (y + 1) * 2^levels)
+    template <class B>
+    class Quadtree
+    {
+    public:
+        ///Corner of leaves or hanging node in the middle of leaf side
+        struct Vertex
+        {
+            int x;          ///< X coordinate on the finest level
+            int y;          ///< Y coordinate on the finest level
+            Vector coord;   ///< Coordinate
+            bool reached;   ///< Vertex is reachable from the origin without crossing boundaries
+        };
+
+        ///Segment between two consecutive vertices of a leaf
+        struct Edge
+        {
+            std::array<unsigned int, 2> vertices;   ///< Vertices
+            std::array<unsigned int, 2> leaves;     ///< Leaves that share the edge, second is no_index on the border of the tree
+            bool probed = false;                    ///< Edge was probed from a reached vertex
+            Intersection intersection;              ///< Found intersection nearest to the reached vertex
+            const B *boundary = nullptr;            ///< Found boundary
+        };
+
+        ///Element that is not divided
+        struct Leaf
+        {
+            unsigned int level; ///< Level of refinement, coarse elements have level 0
+            int x;              ///< X index on its level
+            int y;              ///< Y index on its level
+        };
+    protected:
+        const Parameters &_parameters;
+        Lattice _lattice;
+        unsigned int _levels;
+        std::vector<Vertex> _vertices;
+        std::vector<Edge> _edges;
+        std::vector<Leaf> _leaves;
+        std::vector<unsigned int> _leaf_offsets;    //Vertices and edges of leaf i are _leaf_vertices[_leaf_offsets[i]] ... _leaf_vertices[_leaf_offsets[i+1]-1]
+        std::vector<unsigned int> _leaf_vertices;   //Vertices of leaves, counterclockwise
+        std::vector<unsigned int> _leaf_edges;      //Edges of leaves, edge k goes from vertex k to vertex k+1
+        Vector _coord(double x, double y) const;
+    public:
+        ///Creates tree, searches reachable vertices and probes edges
+        ///@param parameters Grid parameters, grid must be square
+        ///@param index Index of grid boundaries
+        ///@param levels Number of refinement levels
+        ///@param distance Elements closer to boundaries than distance sizes of the element are divided
+        ///@param pool Threads of the generation
+        ///@param statistics Statistics policy
+        template <class S> Quadtree(const Parameters &parameters, const BoundaryIndex<B> &index, unsigned int levels, double distance, ThreadPool &pool, S &statistics);
+        ///Gets vertices
+        const std::vector<Vertex> &vertices() const;
+        ///Gets edges
+        const std::vector<Edge> &edges() const;
+        ///Gets leaves, leaves of one coarse element are stored together in Z-order
+        const std::vector<Leaf> &leaves() const;
+        ///Gets offsets of leaf vertices and edges
+        const std::vector<unsigned int> &leaf_offsets() const;
+        ///Gets vertices of leaves, counterclockwise
+        const std::vector<unsigned int> &leaf_vertices() const;
+        ///Gets edges of leaves
+        const std::vector<unsigned int> &leaf_edges() const;
+        ///Gets area of the leaf
+        double area(unsigned int leaf) const;
+        ///Gets center of the leaf
+        Vector center(unsigned int leaf) const;
+    };
+}
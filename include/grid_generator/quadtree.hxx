@@ -0,0 +1,360 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "quadtree.h"
+#include "indexed_grid.h"
+#include "dense_lattice.hxx"
+#include "parallel.hxx"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+/*
+    First, coarse lattice points are reached by flood fill like in point grid, coarse elements with reached points are the roots of the tree
+    Elements are divided while a boundary crosses the element extended by the distance, then leaves that are two or more levels coarser than
+    their neighbors are divided until the tree is balanced
+    Sides of leaves that have finer neighbors get a hanging vertex in the middle, so every edge is shared by at most two leaves
+    Finally, vertices of leaves are reached by flood fill over the edges, edges are probed from reached vertices
+*/
+
+template <class B> gg::Vector gg::Quadtree<B>::_coord(double x, double y) const
+{
+    const double n = (double)(1 << _levels);
+    return _lattice.transform(Vector(x / n - 0.5, y / n - 0.5));
+}
+
+template <class B> template <class S> gg::Quadtree<B>::Quadtree(const Parameters &parameters, const BoundaryIndex<B> &index, unsigned int levels, double distance, ThreadPool &pool, S &statistics) :
+    _parameters(parameters), _lattice(parameters), _levels(levels)
+{
+    if (parameters.typ != GridType::square) throw std::runtime_error("gg::Quadtree::Quadtree(): Refinement is supported only for square grids");
+    if (levels > 16) throw std::runtime_error("gg::Quadtree::Quadtree(): Too many levels of refinement");
+    const int n = 1 << levels;
+    const auto floor_shift = [](int value, unsigned int shift) -> int
+    {
+        return (value >= 0) ? (value >> shift) : -((-value + (1 << shift) - 1) >> shift);
+    };
+
+    //STAGE 1: reach coarse points
+    statistics.begin("coarse flood fill");
+    std::vector<std::pair<int, int>> coarse;
+    {
+        DenseLattice<unsigned char> reached(parameters, 0);
+        std::vector<Position> points(1);
+        std::vector<unsigned char> open;
+        reached.at(Position()) = 1;
+        unsigned int active_begin = 0, active_end = 1;
+        while (active_begin != active_end)
+        {
+            statistics.wave();
+            open.assign((active_end - active_begin) * 4, 0);
+            parallel_for(pool, active_end - active_begin, [&](unsigned int i)
+            {
+                const Position point = points[active_begin + i];
+                for (unsigned int f = 0; f < 4; f++)
+                {
+                    Position neighbor = point;
+                    if (f == 0) neighbor.xi++; else if (f == 1) neighbor.yi++; else if (f == 2) neighbor.xi--; else neighbor.yi--;
+                    statistics.lookup();
+                    if (reached.get(neighbor) != 0) continue;
+                    const B *pboundary = nullptr;
+                    if (!index.intersection(_coord(point.xi * n, point.yi * n), _coord(neighbor.xi * n, neighbor.yi * n), pboundary, statistics).valid) open[i * 4 + f] = 1;
+                }
+            });
+            for (unsigned int point = active_begin; point < active_end; point++)
+            {
+                for (unsigned int f = 0; f < 4; f++)
+                {
+                    if (!open[(point - active_begin) * 4 + f]) continue;
+                    Position neighbor = points[point];
+                    if (f == 0) neighbor.xi++; else if (f == 1) neighbor.yi++; else if (f == 2) neighbor.xi--; else neighbor.yi--;
+                    statistics.lookup();
+                    unsigned char &value = reached.at(neighbor);
+                    if (value != 0) continue;
+                    value = 1;
+                    points.push_back(neighbor);
+                }
+            }
+            active_begin = active_end;
+            active_end = (unsigned int)points.size();
+        }
+
+        //Elements around reached points, ordered by Y and X index
+        std::vector<std::pair<int, int>> candidates;
+        for (std::vector<Position>::const_iterator point = points.begin(); point != points.end(); point++)
+        {
+            for (int dy = -1; dy <= 0; dy++) for (int dx = -1; dx <= 0; dx++) candidates.push_back({ point->yi + dy, point->xi + dx });
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        coarse.swap(candidates);
+    }
+    statistics.end();
+
+    //STAGE 2: divide elements near boundaries
+    statistics.begin("refinement");
+    std::map<std::array<int, 3>, bool> nodes;   //Level, X and Y of nodes of the tree, true for leaves
+    const auto near = [&](unsigned int level, int x, int y) -> bool
+    {
+        const int span = 1 << (levels - level);
+        const double margin = distance * span;
+        const Vector corners[4] =
+        {
+            _coord(x * span - margin, y * span - margin),
+            _coord((x + 1) * span + margin, y * span - margin),
+            _coord((x + 1) * span + margin, (y + 1) * span + margin),
+            _coord(x * span - margin, (y + 1) * span + margin)
+        };
+        const B *pboundary = nullptr;
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            if (index.intersection(corners[i], corners[(i + 1) % 4], pboundary, statistics).valid) return true;
+        }
+        if (index.intersection(corners[0], corners[2], pboundary, statistics).valid || index.intersection(corners[1], corners[3], pboundary, statistics).valid) return true;
+
+        //Boundaries that lie inside of the element completely
+        std::vector<unsigned int> candidates;
+        for (unsigned int diagonal = 0; diagonal < 2; diagonal++)
+        {
+            index.candidates(corners[diagonal], corners[diagonal + 2], candidates);
+            for (std::vector<unsigned int>::const_iterator candidate = candidates.begin(); candidate != candidates.end(); candidate++)
+            {
+                const Box bounds = BoundaryTraits<B>::bounds(index.boundary(*candidate));
+                if (!bounds.finite()) continue;
+                const Vector center = _lattice.lattice_coord((bounds.min + bounds.max) * 0.5);
+                const double cx = (center.x + 0.5) * n, cy = (center.y + 0.5) * n;
+                if (cx >= x * span - margin && cx <= (x + 1) * span + margin && cy >= y * span - margin && cy <= (y + 1) * span + margin) return true;
+            }
+        }
+        return false;
+    };
+    std::vector<std::array<int, 3>> stack;
+    for (std::vector<std::pair<int, int>>::const_iterator element = coarse.begin(); element != coarse.end(); element++)
+    {
+        stack.push_back({{ 0, element->second, element->first }});
+        while (!stack.empty())
+        {
+            const std::array<int, 3> node = stack.back();
+            stack.pop_back();
+            const bool leaf = (node[0] == (int)levels || !near(node[0], node[1], node[2]));
+            nodes[node] = leaf;
+            if (leaf) continue;
+            for (int child = 0; child < 4; child++) stack.push_back({{ node[0] + 1, 2 * node[1] + (child & 1), 2 * node[2] + (child >> 1) }});
+        }
+    }
+
+    //Balance the tree, leaves that are two or more levels coarser than their neighbors are divided
+    for (std::map<std::array<int, 3>, bool>::const_iterator node = nodes.begin(); node != nodes.end(); node++)
+    {
+        if (node->second && node->first[0] >= 2) stack.push_back(node->first);
+    }
+    while (!stack.empty())
+    {
+        const std::array<int, 3> node = stack.back();
+        stack.pop_back();
+        for (unsigned int f = 0; f < 4; f++)
+        {
+            const int nx = node[1] + ((f == 1) ? 1 : (f == 3) ? -1 : 0);
+            const int ny = node[2] + ((f == 2) ? 1 : (f == 0) ? -1 : 0);
+            for (int level = node[0] - 2; level >= 0; level--)
+            {
+                const unsigned int shift = node[0] - level;
+                std::map<std::array<int, 3>, bool>::iterator coarser = nodes.find({{ level, floor_shift(nx, shift), floor_shift(ny, shift) }});
+                if (coarser == nodes.end()) continue;
+                if (coarser->second)
+                {
+                    coarser->second = false;
+                    for (int child = 0; child < 4; child++)
+                    {
+                        const std::array<int, 3> new_node = {{ level + 1, 2 * coarser->first[1] + (child & 1), 2 * coarser->first[2] + (child >> 1) }};
+                        nodes[new_node] = true;
+                        stack.push_back(new_node);
+                    }
+                    stack.push_back(node);
+                }
+                break;
+            }
+        }
+    }
+    statistics.end();
+
+    //STAGE 3: create leaves, vertices and edges
+    statistics.begin("leaves");
+    std::map<std::pair<int, int>, unsigned int> vertex_indexes;
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> edge_indexes;
+    const auto vertex = [&](int x, int y) -> unsigned int
+    {
+        statistics.lookup();
+        std::map<std::pair<int, int>, unsigned int>::iterator find = vertex_indexes.find({ x, y });
+        if (find != vertex_indexes.end()) return find->second;
+        Vertex new_vertex;
+        new_vertex.x = x;
+        new_vertex.y = y;
+        new_vertex.coord = _coord(x, y);
+        new_vertex.reached = false;
+        _vertices.push_back(new_vertex);
+        statistics.allocation();
+        vertex_indexes.insert({ { x, y }, (unsigned int)(_vertices.size() - 1) });
+        return (unsigned int)(_vertices.size() - 1);
+    };
+    const auto edge = [&](unsigned int a, unsigned int b, unsigned int leaf) -> unsigned int
+    {
+        statistics.lookup();
+        const std::pair<unsigned int, unsigned int> key = (a < b) ? std::make_pair(a, b) : std::make_pair(b, a);
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int>::iterator find = edge_indexes.find(key);
+        if (find != edge_indexes.end())
+        {
+            _edges[find->second].leaves[1] = leaf;
+            return find->second;
+        }
+        Edge new_edge;
+        new_edge.vertices = {{ a, b }};
+        new_edge.leaves = {{ leaf, no_index }};
+        _edges.push_back(new_edge);
+        statistics.allocation();
+        edge_indexes.insert({ key, (unsigned int)(_edges.size() - 1) });
+        return (unsigned int)(_edges.size() - 1);
+    };
+    for (std::vector<std::pair<int, int>>::const_iterator element = coarse.begin(); element != coarse.end(); element++)
+    {
+        stack.push_back({{ 0, element->second, element->first }});
+        while (!stack.empty())
+        {
+            const std::array<int, 3> node = stack.back();
+            stack.pop_back();
+            if (!nodes[node])
+            {
+                for (int child = 3; child >= 0; child--) stack.push_back({{ node[0] + 1, 2 * node[1] + (child & 1), 2 * node[2] + (child >> 1) }});
+                continue;
+            }
+
+            //Corners counterclockwise, hanging vertices are in the middle of sides that have finer neighbors
+            const unsigned int leaf = (unsigned int)_leaves.size();
+            _leaves.push_back({ (unsigned int)node[0], node[1], node[2] });
+            _leaf_offsets.push_back((unsigned int)_leaf_vertices.size());
+            const int span = 1 << (levels - node[0]);
+            const int cx[4] = { node[1] * span, (node[1] + 1) * span, (node[1] + 1) * span, node[1] * span };
+            const int cy[4] = { node[2] * span, node[2] * span, (node[2] + 1) * span, (node[2] + 1) * span };
+            for (unsigned int f = 0; f < 4; f++)
+            {
+                _leaf_vertices.push_back(vertex(cx[f], cy[f]));
+                const int nx = node[1] + ((f == 1) ? 1 : (f == 3) ? -1 : 0);
+                const int ny = node[2] + ((f == 2) ? 1 : (f == 0) ? -1 : 0);
+                statistics.lookup();
+                std::map<std::array<int, 3>, bool>::const_iterator neighbor = nodes.find({{ node[0], nx, ny }});
+                if (neighbor != nodes.end() && !neighbor->second) _leaf_vertices.push_back(vertex((cx[f] + cx[(f + 1) % 4]) / 2, (cy[f] + cy[(f + 1) % 4]) / 2));
+            }
+            const unsigned int begin = _leaf_offsets.back(), end = (unsigned int)_leaf_vertices.size();
+            for (unsigned int v = begin; v < end; v++) _leaf_edges.push_back(edge(_leaf_vertices[v], _leaf_vertices[(v + 1 == end) ? begin : (v + 1)], leaf));
+        }
+    }
+    _leaf_offsets.push_back((unsigned int)_leaf_vertices.size());
+    statistics.memory((vertex_indexes.size() + edge_indexes.size() + nodes.size()) * (4 * sizeof(void*) + 4 * sizeof(int))
+        + _vertices.capacity() * sizeof(Vertex) + _edges.capacity() * sizeof(Edge) + _leaves.capacity() * sizeof(Leaf)
+        + (_leaf_offsets.capacity() + _leaf_vertices.capacity() + _leaf_edges.capacity()) * sizeof(unsigned int));
+    statistics.end();
+
+    //STAGE 4: reach vertices, edges of active vertices are probed in parallel
+    statistics.begin("flood fill");
+    const std::map<std::pair<int, int>, unsigned int>::const_iterator find_origin = vertex_indexes.find({ 0, 0 });
+    const unsigned int origin = (find_origin == vertex_indexes.end()) ? no_index : find_origin->second;
+    vertex_indexes.clear();
+    edge_indexes.clear();
+    nodes.clear();
+    if (origin == no_index)
+    {
+        statistics.end();
+        return;
+    }
+    std::vector<unsigned int> vertex_offsets(_vertices.size() + 1, 0), vertex_edges(2 * _edges.size());
+    for (typename std::vector<Edge>::const_iterator e = _edges.begin(); e != _edges.end(); e++) { vertex_offsets[e->vertices[0] + 1]++; vertex_offsets[e->vertices[1] + 1]++; }
+    for (unsigned int v = 0; v < _vertices.size(); v++) vertex_offsets[v + 1] += vertex_offsets[v];
+    {
+        std::vector<unsigned int> counters(vertex_offsets.begin(), vertex_offsets.end() - 1);
+        for (unsigned int e = 0; e < _edges.size(); e++) { vertex_edges[counters[_edges[e].vertices[0]]++] = e; vertex_edges[counters[_edges[e].vertices[1]]++] = e; }
+    }
+    std::vector<unsigned int> active(1, origin), new_active;
+    std::vector<std::pair<unsigned int, unsigned int>> probes;  //Edge and vertex it is probed from
+    _vertices[origin].reached = true;
+    while (!active.empty())
+    {
+        statistics.wave();
+        probes.clear();
+        for (std::vector<unsigned int>::const_iterator v = active.begin(); v != active.end(); v++)
+        {
+            for (unsigned int i = vertex_offsets[*v]; i < vertex_offsets[*v + 1]; i++)
+            {
+                Edge &e = _edges[vertex_edges[i]];
+                const unsigned int other = (e.vertices[0] == *v) ? e.vertices[1] : e.vertices[0];
+                if (e.probed || _vertices[other].reached) continue;
+                e.probed = true;
+                probes.push_back({ vertex_edges[i], *v });
+            }
+        }
+        parallel_for(pool, (unsigned int)probes.size(), [&](unsigned int i)
+        {
+            Edge &e = _edges[probes[i].first];
+            const unsigned int from = probes[i].second, to = (e.vertices[0] == from) ? e.vertices[1] : e.vertices[0];
+            e.intersection = index.intersection(_vertices[from].coord, _vertices[to].coord, e.boundary, statistics);
+        });
+        new_active.clear();
+        for (std::vector<std::pair<unsigned int, unsigned int>>::const_iterator probe = probes.begin(); probe != probes.end(); probe++)
+        {
+            const Edge &e = _edges[probe->first];
+            const unsigned int to = (e.vertices[0] == probe->second) ? e.vertices[1] : e.vertices[0];
+            if (e.intersection.valid || _vertices[to].reached) continue;
+            _vertices[to].reached = true;
+            new_active.push_back(to);
+        }
+        active.swap(new_active);
+    }
+    statistics.end();
+}
+
+template <class B> const std::vector<typename gg::Quadtree<B>::Vertex> &gg::Quadtree<B>::vertices() const
+{
+    return _vertices;
+}
+
+template <class B> const std::vector<typename gg::Quadtree<B>::Edge> &gg::Quadtree<B>::edges() const
+{
+    return _edges;
+}
+
+template <class B> const std::vector<typename gg::Quadtree<B>::Leaf> &gg::Quadtree<B>::leaves() const
+{
+    return _leaves;
+}
+
+template <class B> const std::vector<unsigned int> &gg::Quadtree<B>::leaf_offsets() const
+{
+    return _leaf_offsets;
+}
+
+template <class B> const std::vector<unsigned int> &gg::Quadtree<B>::leaf_vertices() const
+{
+    return _leaf_vertices;
+}
+
+template <class B> const std::vector<unsigned int> &gg::Quadtree<B>::leaf_edges() const
+{
+    return _leaf_edges;
+}
+
+template <class B> double gg::Quadtree<B>::area(unsigned int leaf) const
+{
+    const double side = 1.0 / (double)(1 << _leaves[leaf].level);
+    return side * side * _parameters.size.x * _parameters.size.y;
+}
+
+template <class B> gg::Vector gg::Quadtree<B>::center(unsigned int leaf) const
+{
+    const int span = 1 << (_levels - _leaves[leaf].level);
+    return _coord((_leaves[leaf].x + 0.5) * span, (_leaves[leaf].y + 0.5) * span);
+}
@@ -0,0 +1,61 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "common_internal.h"
+#include "boundary_index.h"
+#include <vector>
+
+namespace gg
+{
+    ///Intersects lattice rows (elements or element points with equal Y index) with boundaries
+    template <class B>
+    class Scanline
+    {
+    protected:
+        Lattice _lattice;
+        const BoundaryIndex<B> &_index;
+        Box _bounds;
+    public:
+        ///Creates scanline, all boundary figures must have finite bounds
+        ///@param parameters Grid parameters
+        ///@param index Index of grid boundaries
+        Scanline(const Parameters &parameters, const BoundaryIndex<B> &index);
+        ///Gets range of Y indexes of the row that may lie inside of the domain
+        ///@param zero Coordinate of element (or element point) with zero Y index
+        ///@param one Coordinate of element (or element point) with Y index one
+        ///@param ymin Minimal Y index
+        ///@param ymax Maximal Y index
+        ///@return Whether the range is not empty
+        bool rows(Vector zero, Vector one, int &ymin, int &ymax) const;
+        ///Gets range of X indexes of the row that may lie inside of the domain
+        ///@param zero Coordinate of element (or element point) with zero X index
+        ///@param one Coordinate of element (or element point) with X index one
+        ///@param xmin Minimal X index
+        ///@param xmax Maximal X index
+        ///@return Whether the range is not empty
+        bool columns(Vector zero, Vector one, int &xmin, int &xmax) const;
+        ///Gets range of X indexes of the row that may lie inside of the domain and crossings of the row with boundaries
+        ///@param zero Coordinate of element (or element point) with zero X index
+        ///@param one Coordinate of element (or element point) with X index one
+        ///@param xmin Minimal X index
+        ///@param xmax Maximal X index
+        ///@param crossings Crossings, sorted by X index
+        ///@return Whether the row may lie inside of the domain
+        bool columns(Vector zero, Vector one, int &xmin, int &xmax, std::vector<Crossing> &crossings) const;
+        ///Checks if element with given X index is inside of the domain
+        ///@param crossings Crossings of the row
+        ///@param x X index
+        static bool inside(const std::vector<Crossing> &crossings, double x);
+        ///Checks if row has crossings between given X indexes
+        ///@param crossings Crossings of the row
+        ///@param xmin Minimal X index
+        ///@param xmax Maximal X index
+        static bool crossed(const std::vector<Crossing> &crossings, double xmin, double xmax);
+    };
+}
\ No newline at end of file
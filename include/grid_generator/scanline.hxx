@@ -0,0 +1,110 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "scanline.h"
+#include <algorithm>
+#include <stdexcept>
+#include <math.h>
+
+/*
+    A row is a line of elements (or element points) with equal Y index, its elements differ only by X index
+    The row is intersected with every boundary once, crossings are sorted along the row
+    Boundary normals point inside of the domain, so if the row goes along the normal, it enters the domain, otherwise it leaves it
+    The row starts outside of the domain, so element is inside if the last crossing before it is entering
+*/
+
+template <class B> gg::Scanline<B>::Scanline(const Parameters &parameters, const BoundaryIndex<B> &index) :
+    _lattice(parameters), _index(index)
+{
+    if (!index.finite()) throw std::runtime_error("gg::Scanline::Scanline(): Boundary figure has infinite bounds");
+    const Box bounds = index.bounds();
+    if (bounds.empty()) return;
+
+    //Bounds in the frame of the grid
+    const Vector corners[4] = { bounds.min, Vector(bounds.max.x, bounds.min.y), bounds.max, Vector(bounds.min.x, bounds.max.y) };
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        const Vector corner = _lattice.lattice_coord(corners[i]);
+        _bounds.extend(Box(corner, corner));
+    }
+}
+
+template <class B> bool gg::Scanline<B>::rows(Vector zero, Vector one, int &ymin, int &ymax) const
+{
+    if (_bounds.empty()) return false;
+    const double y0 = _lattice.lattice_coord(zero).y;
+    const double dy = _lattice.lattice_coord(one).y - y0;
+    const double begin = (_bounds.min.y - y0) / dy;
+    const double end = (_bounds.max.y - y0) / dy;
+    ymin = (int)floor(fmin(begin, end)) - 1;
+    ymax = (int)ceil(fmax(begin, end)) + 1;
+    return true;
+}
+
+template <class B> bool gg::Scanline<B>::columns(Vector zero, Vector one, int &xmin, int &xmax) const
+{
+    if (_bounds.empty()) return false;
+    const double x0 = _lattice.lattice_coord(zero).x;
+    const double dx = _lattice.lattice_coord(one).x - x0;
+    const double begin = (_bounds.min.x - x0) / dx;
+    const double end = (_bounds.max.x - x0) / dx;
+    xmin = (int)floor(fmin(begin, end)) - 1;
+    xmax = (int)ceil(fmax(begin, end)) + 1;
+    return true;
+}
+
+template <class B> bool gg::Scanline<B>::columns(Vector zero, Vector one, int &xmin, int &xmax, std::vector<Crossing> &crossings) const
+{
+    crossings.clear();
+    if (_bounds.empty()) return false;
+    const double y = _lattice.lattice_coord(zero).y;
+    if (y < _bounds.min.y || y > _bounds.max.y) return false;
+    columns(zero, one, xmin, xmax);
+
+    //Intersect the whole row with every boundary
+    const Vector step = one - zero;
+    const Vector a = zero + step * xmin;
+    const Vector b = zero + step * xmax;
+    const double squared_length = (b - a).squared_norm();
+    std::vector<Intersection> intersections;
+    std::vector<unsigned int> candidates;
+    _index.candidates(a, b, candidates);
+    for (std::vector<unsigned int>::const_iterator candidate = candidates.begin(); candidate != candidates.end(); candidate++)
+    {
+        intersections.clear();
+        BoundaryTraits<B>::intersections(_index.boundary(*candidate), a, b, intersections);
+        for (std::vector<Intersection>::const_iterator intersection = intersections.begin(); intersection != intersections.end(); intersection++)
+        {
+            const double direction = intersection->normal.dot(step);
+            if (direction == 0.0) continue; //Row touches the boundary, but does not cross it
+            Crossing crossing;
+            crossing.x = xmin + (intersection->coord - a).dot(b - a) / squared_length * (xmax - xmin);
+            crossing.entering = direction > 0.0;
+            crossings.push_back(crossing);
+        }
+    }
+    std::sort(crossings.begin(), crossings.end());
+    return true;
+}
+
+template <class B> bool gg::Scanline<B>::inside(const std::vector<Crossing> &crossings, double x)
+{
+    Crossing crossing;
+    crossing.x = x;
+    const std::vector<Crossing>::const_iterator next = std::upper_bound(crossings.begin(), crossings.end(), crossing);
+    return next != crossings.begin() && (next - 1)->entering;
+}
+
+template <class B> bool gg::Scanline<B>::crossed(const std::vector<Crossing> &crossings, double xmin, double xmax)
+{
+    Crossing crossing;
+    crossing.x = xmin;
+    const std::vector<Crossing>::const_iterator next = std::lower_bound(crossings.begin(), crossings.end(), crossing);
+    return next != crossings.end() && next->x <= xmax;
+}
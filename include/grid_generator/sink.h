@@ -0,0 +1,47 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "indexed_grid.h"
+#include <array>
+
+namespace gg
+{
+    ///Sink that appends streamed points, faces and cells to IndexedCellGrid
+    ///Custom sinks passed to CellGrid::stream() must provide the same point(), face() and cell() functions
+    class IndexedCellSink
+    {
+    protected:
+        IndexedCellGrid _grid;
+    public:
+        ///Receives point, points are passed in order of their indexes
+        ///@param index Index of the point
+        ///@param coord Coordinate of the point
+        ///@param normal Normal of the point, zero if point does not lie on a boundary
+        ///@param boundary Index of the boundary the point lies on, or no_index
+        void point(unsigned int index, Vector coord, Vector normal, unsigned int boundary);
+        ///Receives face, faces are passed in order of their indexes and after their points
+        ///@param index Index of the face
+        ///@param points Points of the face
+        ///@param center Center of the face
+        ///@param normal Normal of the face, length of normal is length of face
+        ///@param length Length of the face
+        ///@param boundary Index of the boundary the face touches, or no_index
+        void face(unsigned int index, std::array<unsigned int, 2> points, Vector center, Vector normal, double length, unsigned int boundary);
+        ///Receives cell, cells are passed in order of their indexes and after their points and faces, neighbor cells may be passed later
+        ///@param index Index of the cell
+        ///@param center Center of the cell
+        ///@param area Area of the cell
+        ///@param boundary Index of the boundary the cell touches, or no_index
+        ///@param sides Sides of the cell, valid only during the call
+        ///@param count Number of sides
+        void cell(unsigned int index, Vector center, double area, unsigned int boundary, const IndexedSide *sides, unsigned int count);
+        ///Gets received grid
+        IndexedCellGrid &grid();
+    };
+}
@@ -0,0 +1,102 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gg
+{
+    ///Statistics policy that records nothing, calls are empty and are optimized away
+    ///Custom policies passed to grid constructors must provide the same functions
+    ///If Parameters::threads is not 1, probe(), test(), lookup() and allocation() are called concurrently from worker threads and must be thread-safe,
+    ///begin(), end(), wave() and memory() are called only from the thread that constructs the grid
+    struct NoStatistics
+    {
+        ///Begins generation stage
+        void begin(const char *) {}
+        ///Ends generation stage
+        void end() {}
+        ///Counts flood fill wave
+        void wave() {}
+        ///Counts probe of the segment between two elements
+        void probe(bool) {}
+        ///Counts figures tested by probe
+        void test(unsigned int) {}
+        ///Counts lookups in temporary containers
+        void lookup(unsigned int = 1) {}
+        ///Counts allocations of temporary elements
+        void allocation(unsigned int = 1) {}
+        ///Reports current size of temporary containers
+        void memory(std::size_t) {}
+    };
+
+    ///Statistics policy that records time of generation stages and counts operations, counters may be incremented by multiple threads
+    class GridStatistics
+    {
+    public:
+        ///Generation stage
+        struct Stage
+        {
+            std::string name;   ///< Name of the stage
+            double seconds;     ///< Wall time of the stage
+        };
+    protected:
+        std::vector<Stage> _stages;
+        std::chrono::steady_clock::time_point _begin;
+        unsigned long long _waves = 0;
+        std::atomic<unsigned long long> _probes;
+        std::atomic<unsigned long long> _hits;
+        std::atomic<unsigned long long> _tests;
+        std::atomic<unsigned long long> _lookups;
+        std::atomic<unsigned long long> _allocations;
+        std::size_t _peak_memory = 0;
+    public:
+        ///Creates empty statistics
+        GridStatistics();
+        GridStatistics(const GridStatistics &other) = delete;
+        GridStatistics &operator=(const GridStatistics &other) = delete;
+        ///Begins generation stage
+        void begin(const char *stage);
+        ///Ends generation stage
+        void end();
+        ///Counts flood fill wave
+        void wave();
+        ///Counts probe of the segment between two elements
+        void probe(bool hit);
+        ///Counts figures tested by probe
+        void test(unsigned int figures);
+        ///Counts lookups in temporary containers
+        void lookup(unsigned int count = 1);
+        ///Counts allocations of temporary elements
+        void allocation(unsigned int count = 1);
+        ///Reports current size of temporary containers
+        void memory(std::size_t bytes);
+        ///Resets statistics
+        void clear();
+        ///Gets generation stages in order of execution
+        const std::vector<Stage> &stages() const;
+        ///Gets number of flood fill waves
+        unsigned long long waves() const;
+        ///Gets number of probes, every probe searches for the nearest boundary between two elements
+        unsigned long long probes() const;
+        ///Gets number of probes that found a boundary
+        unsigned long long hits() const;
+        ///Gets number of figures tested by probes (equivalent of Figure::intersection() calls)
+        unsigned long long tests() const;
+        ///Gets number of lookups in temporary maps and lattices
+        unsigned long long lookups() const;
+        ///Gets number of heap allocations of temporary elements (map nodes)
+        unsigned long long allocations() const;
+        ///Gets peak estimated size of temporary containers in bytes
+        std::size_t peak_memory() const;
+    };
+}
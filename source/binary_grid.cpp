@@ -0,0 +1,289 @@
+#include "../include/grid_generator/binary_grid.h"
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/*
+    File layout:
+        Header (magic, version, kind of grid, byte order mark, number of arrays)
+        Table of arrays (offset from the beginning of the file, number of elements, size of element)
+        Arrays, every array begins at multiple of 64 bytes, padding is filled with zeros
+    Arrays are written exactly as they are in memory, so the reader only checks the header and the table and points views into mapped pages
+*/
+
+namespace
+{
+    const char binary_grid_magic[8] = { 'G', 'G', 'B', 'I', 'N', 'A', 'R', 'Y' };
+    const unsigned int binary_grid_byte_order = 0x01020304;
+    const std::size_t binary_grid_alignment = 64;
+
+    struct BinaryHeader
+    {
+        char magic[8];
+        unsigned int version;
+        unsigned int cellular;
+        unsigned int byte_order;
+        unsigned int arrays;
+    };
+
+    struct BinaryArray
+    {
+        unsigned long long offset;
+        unsigned long long count;
+        unsigned long long element_size;
+    };
+
+    struct Array
+    {
+        const void *data;
+        std::size_t count;
+        std::size_t element_size;
+        void (*copy)(unsigned char *destination, const void *source, std::size_t count);  //Copies elements with zero padding bytes, nullptr if elements have no padding
+    };
+
+    template <class T> Array make_array(const std::vector<T> &vector)
+    {
+        return { vector.data(), vector.size(), sizeof(T), nullptr };
+    }
+
+    //Copies sides to zeroed memory member by member, so padding bytes are zero and equal grids give equal files
+    void copy_sides(unsigned char *destination, const void *source, std::size_t count)
+    {
+        const gg::IndexedSide *sides = (const gg::IndexedSide*)source;
+        for (std::size_t s = 0; s < count; s++)
+        {
+            unsigned char *side = destination + s * sizeof(gg::IndexedSide);
+            std::memset(side, 0, sizeof(gg::IndexedSide));
+            std::memcpy(side + offsetof(gg::IndexedSide, point), &sides[s].point, sizeof(unsigned int));
+            std::memcpy(side + offsetof(gg::IndexedSide, face), &sides[s].face, sizeof(unsigned int));
+            std::memcpy(side + offsetof(gg::IndexedSide, cell), &sides[s].cell, sizeof(unsigned int));
+            std::memcpy(side + offsetof(gg::IndexedSide, inwards), &sides[s].inwards, sizeof(bool));
+        }
+    }
+
+    std::size_t align(std::size_t offset)
+    {
+        return (offset + binary_grid_alignment - 1) / binary_grid_alignment * binary_grid_alignment;
+    }
+
+    void write_arrays(const std::string &path, bool cellular, const std::vector<Array> &arrays)
+    {
+        BinaryHeader header;
+        std::memcpy(header.magic, binary_grid_magic, sizeof(header.magic));
+        header.version = gg::binary_grid_version;
+        header.cellular = cellular ? 1 : 0;
+        header.byte_order = binary_grid_byte_order;
+        header.arrays = (unsigned int)arrays.size();
+
+        std::vector<BinaryArray> table(arrays.size());
+        std::size_t offset = align(sizeof(BinaryHeader) + table.size() * sizeof(BinaryArray));
+        for (unsigned int i = 0; i < arrays.size(); i++)
+        {
+            table[i].offset = offset;
+            table[i].count = arrays[i].count;
+            table[i].element_size = arrays[i].element_size;
+            offset = align(offset + arrays[i].count * arrays[i].element_size);
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("gg::write_grid(): Could not open file");
+        const char zeros[binary_grid_alignment] = {};
+        std::size_t position = 0;
+        const auto write = [&](const void *data, std::size_t size)
+        {
+            file.write((const char*)data, size);
+            position += size;
+        };
+        write(&header, sizeof(BinaryHeader));
+        write(table.data(), table.size() * sizeof(BinaryArray));
+        std::vector<unsigned char> chunk;   //Arrays with padding are copied through this buffer in chunks
+        const std::size_t chunk_size = 1 << 16;
+        for (unsigned int i = 0; i < arrays.size(); i++)
+        {
+            write(zeros, table[i].offset - position);
+            if (arrays[i].copy == nullptr)
+            {
+                write(arrays[i].data, arrays[i].count * arrays[i].element_size);
+                continue;
+            }
+            const std::size_t chunk_count = std::max<std::size_t>(1, chunk_size / arrays[i].element_size);
+            chunk.resize(chunk_count * arrays[i].element_size);
+            for (std::size_t begin = 0; begin < arrays[i].count; begin += chunk_count)
+            {
+                const std::size_t count = std::min(chunk_count, arrays[i].count - begin);
+                arrays[i].copy(chunk.data(), (const unsigned char*)arrays[i].data + begin * arrays[i].element_size, count);
+                write(chunk.data(), count * arrays[i].element_size);
+            }
+        }
+        write(zeros, align(position) - position);
+        if (!file.good()) throw std::runtime_error("gg::write_grid(): Could not write file");
+    }
+
+    template <class T> gg::ArrayView<T> make_view(const unsigned char *data, const BinaryArray &array)
+    {
+        return gg::ArrayView<T>((const T*)(data + array.offset), (std::size_t)array.count);
+    }
+}
+
+void gg::write_grid(const std::string &path, const IndexedPointGrid &grid)
+{
+    write_arrays(path, false, {
+        make_array(grid.coords), make_array(grid.normals), make_array(grid.boundaries),
+        make_array(grid.neighbor_offsets), make_array(grid.neighbors) });
+}
+
+void gg::write_grid(const std::string &path, const IndexedCellGrid &grid)
+{
+    write_arrays(path, true, {
+        make_array(grid.point_coords), make_array(grid.point_normals), make_array(grid.point_boundaries),
+        make_array(grid.face_points), make_array(grid.face_centers), make_array(grid.face_normals), make_array(grid.face_lengths), make_array(grid.face_boundaries),
+        make_array(grid.cell_centers), make_array(grid.cell_areas), make_array(grid.cell_boundaries), make_array(grid.side_offsets),
+        { grid.sides.data(), grid.sides.size(), sizeof(IndexedSide), &copy_sides } });
+}
+
+gg::MappedGrid::MappedGrid(const std::string &path)
+{
+    //Map file
+    #ifdef _WIN32
+        const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("gg::MappedGrid::MappedGrid(): Could not open file");
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) { CloseHandle(file); throw std::runtime_error("gg::MappedGrid::MappedGrid(): Could not get size of file"); }
+        _size = (std::size_t)size.QuadPart;
+        if (_size != 0)
+        {
+            _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_mapping != nullptr) _data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        CloseHandle(file);
+        if (_size != 0 && _data == nullptr) { _unmap(); throw std::runtime_error("gg::MappedGrid::MappedGrid(): Could not map file"); }
+    #else
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file < 0) throw std::runtime_error("gg::MappedGrid::MappedGrid(): Could not open file");
+        struct stat status;
+        if (fstat(file, &status) != 0) { close(file); throw std::runtime_error("gg::MappedGrid::MappedGrid(): Could not get size of file"); }
+        _size = (std::size_t)status.st_size;
+        if (_size != 0)
+        {
+            _data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, file, 0);
+            if (_data == MAP_FAILED) _data = nullptr;
+        }
+        close(file);
+        if (_size != 0 && _data == nullptr) throw std::runtime_error("gg::MappedGrid::MappedGrid(): Could not map file");
+    #endif
+
+    //Check header
+    const unsigned char *data = (const unsigned char*)_data;
+    BinaryHeader header;
+    if (_size < sizeof(BinaryHeader)) { _unmap(); throw std::runtime_error("gg::MappedGrid::MappedGrid(): File is not a binary grid"); }
+    std::memcpy(&header, data, sizeof(BinaryHeader));
+    if (std::memcmp(header.magic, binary_grid_magic, sizeof(header.magic)) != 0) { _unmap(); throw std::runtime_error("gg::MappedGrid::MappedGrid(): File is not a binary grid"); }
+    if (header.byte_order != binary_grid_byte_order) { _unmap(); throw std::runtime_error("gg::MappedGrid::MappedGrid(): File has different byte order"); }
+    if (header.version != binary_grid_version) { _unmap(); throw std::runtime_error("gg::MappedGrid::MappedGrid(): Unsupported version of binary grid"); }
+    _cellular = header.cellular != 0;
+
+    //Check table of arrays
+    const std::vector<std::size_t> element_sizes = _cellular
+        ? std::vector<std::size_t>{ sizeof(Vector), sizeof(Vector), sizeof(unsigned int),
+            sizeof(std::array<unsigned int, 2>), sizeof(Vector), sizeof(Vector), sizeof(double), sizeof(unsigned int),
+            sizeof(Vector), sizeof(double), sizeof(unsigned int), sizeof(unsigned int), sizeof(IndexedSide) }
+        : std::vector<std::size_t>{ sizeof(Vector), sizeof(Vector), sizeof(unsigned int), sizeof(unsigned int), sizeof(unsigned int) };
+    if (header.arrays != element_sizes.size() || _size < sizeof(BinaryHeader) + element_sizes.size() * sizeof(BinaryArray))
+    {
+        _unmap();
+        throw std::runtime_error("gg::MappedGrid::MappedGrid(): Invalid table of arrays");
+    }
+    std::vector<BinaryArray> table(element_sizes.size());
+    std::memcpy(table.data(), data + sizeof(BinaryHeader), table.size() * sizeof(BinaryArray));
+    for (unsigned int i = 0; i < table.size(); i++)
+    {
+        if (table[i].element_size != element_sizes[i] || table[i].offset % binary_grid_alignment != 0
+        || table[i].offset > _size || table[i].count > (_size - table[i].offset) / element_sizes[i])
+        {
+            _unmap();
+            throw std::runtime_error("gg::MappedGrid::MappedGrid(): Invalid table of arrays");
+        }
+    }
+
+    //Create views
+    if (_cellular)
+    {
+        _cell_grid.point_coords = make_view<Vector>(data, table[0]);
+        _cell_grid.point_normals = make_view<Vector>(data, table[1]);
+        _cell_grid.point_boundaries = make_view<unsigned int>(data, table[2]);
+        _cell_grid.face_points = make_view<std::array<unsigned int, 2>>(data, table[3]);
+        _cell_grid.face_centers = make_view<Vector>(data, table[4]);
+        _cell_grid.face_normals = make_view<Vector>(data, table[5]);
+        _cell_grid.face_lengths = make_view<double>(data, table[6]);
+        _cell_grid.face_boundaries = make_view<unsigned int>(data, table[7]);
+        _cell_grid.cell_centers = make_view<Vector>(data, table[8]);
+        _cell_grid.cell_areas = make_view<double>(data, table[9]);
+        _cell_grid.cell_boundaries = make_view<unsigned int>(data, table[10]);
+        _cell_grid.side_offsets = make_view<unsigned int>(data, table[11]);
+        _cell_grid.sides = make_view<IndexedSide>(data, table[12]);
+    }
+    else
+    {
+        _point_grid.coords = make_view<Vector>(data, table[0]);
+        _point_grid.normals = make_view<Vector>(data, table[1]);
+        _point_grid.boundaries = make_view<unsigned int>(data, table[2]);
+        _point_grid.neighbor_offsets = make_view<unsigned int>(data, table[3]);
+        _point_grid.neighbors = make_view<unsigned int>(data, table[4]);
+    }
+}
+
+gg::MappedGrid::MappedGrid(MappedGrid &&other) : _data(other._data), _size(other._size), _mapping(other._mapping), _cellular(other._cellular),
+    _point_grid(other._point_grid), _cell_grid(other._cell_grid)
+{
+    other._data = nullptr;
+    other._size = 0;
+    other._mapping = nullptr;
+    other._point_grid = MappedPointGrid();
+    other._cell_grid = MappedCellGrid();
+}
+
+void gg::MappedGrid::_unmap()
+{
+    #ifdef _WIN32
+        if (_data != nullptr) UnmapViewOfFile(_data);
+        if (_mapping != nullptr) CloseHandle(_mapping);
+    #else
+        if (_data != nullptr) munmap(_data, _size);
+    #endif
+    _data = nullptr;
+    _mapping = nullptr;
+    _size = 0;
+}
+
+gg::MappedGrid::~MappedGrid()
+{
+    _unmap();
+}
+
+bool gg::MappedGrid::cellular() const
+{
+    return _cellular;
+}
+
+const gg::MappedPointGrid &gg::MappedGrid::point_grid() const
+{
+    if (_cellular) throw std::runtime_error("gg::MappedGrid::point_grid(): File contains cellular grid");
+    return _point_grid;
+}
+
+const gg::MappedCellGrid &gg::MappedGrid::cell_grid() const
+{
+    if (!_cellular) throw std::runtime_error("gg::MappedGrid::cell_grid(): File contains point grid");
+    return _cell_grid;
+}
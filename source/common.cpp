@@ -1,51 +1,64 @@
 #include "../include/grid_generator/common.h"
 #include "../include/grid_generator/common_internal.h"
+#include "../include/grid_generator/figure_batch.h"
+#include <new>
 #include <stdexcept>
+#include <limits>
 #include <math.h>
 
-bool angle_in_arc(double arc_azimuth, double arc_angle, double angle)
-{
-    if (arc_azimuth + arc_angle > M_PI) return angle >= (arc_azimuth - M_PI) && angle <= (arc_azimuth + arc_angle - M_PI);
-    else return angle >= (arc_azimuth) && angle <= (arc_azimuth + arc_angle);
-}
-
-gg::Vector::Vector() {}
-
-gg::Vector::Vector(double x, double y) : x(x), y(y) {}
-
-gg::Vector gg::Vector::operator*(double b) const
-{
-    return Vector(x * b, y * b);
-}
+gg::Box::Box() :
+    min(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()),
+    max(-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()) {}
 
-gg::Vector gg::Vector::operator/(double b) const
-{
-    return Vector(x / b, y / b);
-}
+gg::Box::Box(Vector min, Vector max) : min(min), max(max) {}
 
-gg::Vector gg::Vector::operator+(const Vector &b) const
+bool gg::Box::empty() const
 {
-    return Vector(x + b.x, y + b.y);
+    return min.x > max.x || min.y > max.y;
 }
 
-gg::Vector gg::Vector::operator-(const Vector &b) const
+bool gg::Box::finite() const
 {
-    return Vector(x - b.x, y - b.y);
+    return std::isfinite(min.x) && std::isfinite(min.y) && std::isfinite(max.x) && std::isfinite(max.y);
 }
 
-double gg::Vector::dot(const Vector &b) const
+void gg::Box::extend(const Box &b)
 {
-    return x * b.x + y * b.y;
+    if (b.min.x < min.x) min.x = b.min.x;
+    if (b.min.y < min.y) min.y = b.min.y;
+    if (b.max.x > max.x) max.x = b.max.x;
+    if (b.max.y > max.y) max.y = b.max.y;
 }
 
-double gg::Vector::norm() const
+void gg::Figure::intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const
 {
-    return sqrt(x * x + y * y);
+    //Search from the last found intersection (plus small step) until nothing is found
+    //The step is relative to the segment, but never smaller than the precision of coordinates, so the search always moves forward
+    const Vector direction = b - a;
+    const double squared_length = direction.squared_norm();
+    if (squared_length == 0.0) return;
+    const double magnitude = fmax(fmax(fabs(a.x), fabs(a.y)), fmax(fabs(b.x), fabs(b.y)));
+    const double step = 1e-9 + 4 * std::numeric_limits<double>::epsilon() * magnitude / sqrt(squared_length);
+    double last = -std::numeric_limits<double>::infinity();
+    Vector begin = a;
+    while (true)
+    {
+        const Intersection intersection = this->intersection(begin, b);
+        if (!intersection.valid) break;
+        const double t = (intersection.coord - a).dot(direction) / squared_length;
+        if (t <= last) break;
+        intersections.push_back(intersection);
+        last = t;
+        const double next = t + step;
+        if (next >= 1.0) break;
+        begin = a + direction * next;
+    }
 }
 
-double gg::Vector::squared_norm() const
+gg::Box gg::Figure::bounds() const
 {
-    return x * x + y * y;
+    return Box(Vector(-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()),
+        Vector(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()));
 }
 
 gg::Figure::~Figure() {}
@@ -58,92 +71,114 @@ gg::Circle::Circle(Vector center, double radius, bool normal_inwards) : _center(
 
 gg::Intersection gg::Circle::intersection(Vector a, Vector b) const
 {
-    double A = 1;
-    double B = -2 * (_center - a).dot(b-a) / (b-a).norm();
-    double C = (_center - a).squared_norm() - _radius*_radius;
-    double determinant = B*B - 4 * A * C;
-    if (determinant == 0)
-    {
-        double L = (-B) / (2 * A);
-        if (L >= 0 && L <= (b-a).norm()) //Valid length
-        {
-            Vector I = a + (b-a) * L / (b-a).norm();
-            return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center));
-        }
-    }
-    else if (determinant > 0)
+    double length, distances[2];
+    if (circle_intersections(_center, _radius, a, b, length, distances) == 0) return Intersection();
+    Vector I = a + (b - a) * distances[0] / length;
+    return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center));
+}
+
+void gg::Circle::intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const
+{
+    double length, distances[2];
+    const unsigned int count = circle_intersections(_center, _radius, a, b, length, distances);
+    for (unsigned int i = 0; i < count; i++)
     {
-        double L1 = (-B - sqrt(determinant)) / (2 * A);
-        if (L1 >= 0 && L1 <= (b-a).norm()) //Valid length
-        {
-            Vector I = a + (b-a) * L1 / (b-a).norm();
-            return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center));
-        }
-        double L2 = (-B + sqrt(determinant)) / (2 * A);
-        if (L2 >= 0 && L2 <= (b-a).norm()) //Valid length
-        {
-            Vector I = a + (b-a) * L2 / (b-a).norm();
-            return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center));
-        }
+        Vector I = a + (b - a) * distances[i] / length;
+        intersections.push_back(Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center)));
     }
-    return Intersection();
+}
+
+gg::Box gg::Circle::bounds() const
+{
+    return Box(_center - Vector(_radius, _radius), _center + Vector(_radius, _radius));
+}
+
+gg::Vector gg::Circle::center() const
+{
+    return _center;
+}
+
+double gg::Circle::radius() const
+{
+    return _radius;
 }
 
 gg::Arc::Arc(Vector center, double radius, bool normal_inwards, double azimuth, double angle) : _center(center), _radius(radius), _normal_inwards(normal_inwards), _azimuth(azimuth), _angle(angle) {}
 
 gg::Intersection gg::Arc::intersection(Vector a, Vector b) const
 {
-    const double A = 1;
-    const double B = -2 * (_center - a).dot(b - a) / (b - a).norm();
-    const double C = (_center - a).squared_norm() - _radius*_radius;
-    const double determinant = B*B - 4 * A * C;
-    if (determinant == 0)
+    double length, distances[2];
+    const unsigned int count = circle_intersections(_center, _radius, a, b, length, distances);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        Vector I = a + (b - a) * distances[i] / length;
+        const double angle = atan2((I - _center).y, (I - _center).x);
+        if (angle_in_arc(_azimuth, _angle, angle)) return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center)); //Valid azimuth
+    }
+    return Intersection();
+}
+
+void gg::Arc::intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const
+{
+    double length, distances[2];
+    const unsigned int count = circle_intersections(_center, _radius, a, b, length, distances);
+    for (unsigned int i = 0; i < count; i++)
     {
-        const double L = (-B) / (2 * A);
-        if (L >= 0 && L <= (b-a).norm()) //Valid length
-        {
-            Vector I = a + (b-a) * L / (b-a).norm();
-            double angle = atan2((I - _center).y, (I - _center).x);
-            if (angle >= _azimuth && angle <= (_azimuth + angle)) return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center)); //Valid azimuth
-        }
+        Vector I = a + (b - a) * distances[i] / length;
+        const double angle = atan2((I - _center).y, (I - _center).x);
+        if (angle_in_arc(_azimuth, _angle, angle)) intersections.push_back(Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center))); //Valid azimuth
     }
-    else if (determinant > 0)
+}
+
+gg::Box gg::Arc::bounds() const
+{
+    //Box of the endpoints and of the axis extremes that lie on the arc
+    Box box;
+    const double angles[6] = { _azimuth, _azimuth + _angle, 0.0, M_PI / 2, M_PI, -M_PI / 2 };
+    for (unsigned int i = 0; i < 6; i++)
     {
-        const double L1 = (-B - sqrt(determinant)) / (2 * A);
-        if (L1 >= 0 && L1 <= (b-a).norm()) //Valid length
-        {
-            Vector I = a + (b-a) * L1 / (b-a).norm();
-            const double angle = atan2((I - _center).y, (I - _center).x);
-            if (angle_in_arc(_azimuth, _angle, angle)) return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center)); //Valid azimuth
-        }
-        double L2 = (-B + sqrt(determinant)) / (2 * A);
-        if (L2 >= 0 && L2 <= (b-a).norm()) //Valid length
-        {
-            Vector I = a + (b-a) * L2 / (b-a).norm();
-            const double angle = atan2((I - _center).y, (I - _center).x);
-            if (angle_in_arc(_azimuth, _angle, angle)) return Intersection(I, rotate_ccw(I - _center), _normal_inwards ? (_center - I) : (I - _center)); //Valid azimuth
-        }
+        if (i >= 2 && !angle_in_arc(_azimuth, _angle, angles[i])) continue;
+        const Vector point = _center + Vector(cos(angles[i]), sin(angles[i])) * _radius;
+        box.extend(Box(point, point));
     }
-    return Intersection();
+    return box;
+}
+
+gg::Vector gg::Arc::center() const
+{
+    return _center;
+}
+
+double gg::Arc::radius() const
+{
+    return _radius;
+}
+
+double gg::Arc::azimuth() const
+{
+    return _azimuth;
+}
+
+double gg::Arc::angle() const
+{
+    return _angle;
 }
 
 gg::Line::Line(Vector a, Vector b, bool normal_cw) : _a(a), _b(b), _normal_cw(normal_cw) {}
 
-gg::Intersection gg::Line::intersection(Vector a, Vector b) const
+gg::Box gg::Line::bounds() const
+{
+    return Box(Vector(fmin(_a.x, _b.x), fmin(_a.y, _b.y)), Vector(fmax(_a.x, _b.x), fmax(_a.y, _b.y)));
+}
+
+gg::Vector gg::Line::a() const
+{
+    return _a;
+}
+
+gg::Vector gg::Line::b() const
 {
-    //Equation "a + (b - a) * t = _a + (_b - _a) * s" transformed into "A * [t s] = b" and solved
-    const double A00 = b.x - a.x;
-    const double A01 = -_b.x + _a.x;
-    const double A10 = b.y - a.y;
-    const double A11 = -_b.y + _a.y;
-    const double b0 = -a.x + _a.x;
-    const double b1 = -a.y + _a.y;
-    const double determinant = abs(A00 * A11 - A01 * A10);
-    const double t = (A11 * b0 - A01 * b1) / determinant;
-    if (t < 0.0 || t > 1.0) return Intersection();
-    const double s = (-A10 * b0 + A00 * b1) / determinant;
-    if (s < 0.0 || s > 1.0) return Intersection();
-    return Intersection(a + (b - a) * t, _b - _a, _normal_cw ? rotate_cw(_b-_a) : rotate_ccw(_b-_a));
+    return _b;
 }
 
 gg::Boundary::Boundary(const Figure *fig) : _figure(fig)
@@ -157,12 +192,111 @@ gg::Boundary::Boundary(Boundary &&other)
     other._figure = nullptr;
 }
 
+gg::Boundary &gg::Boundary::operator=(Boundary &&other)
+{
+    if (this == &other) return *this;
+    if (_figure != nullptr) delete _figure;
+    _figure = other._figure;
+    other._figure = nullptr;
+    return *this;
+}
+
 const gg::Figure *gg::Boundary::figure() const
 {
     return _figure;
 }
 
+gg::Box gg::Boundary::bounds() const
+{
+    return _figure->bounds();
+}
+
+gg::Intersection gg::Boundary::intersection(Vector a, Vector b) const
+{
+    return _figure->intersection(a, b);
+}
+
+void gg::Boundary::intersections(Vector a, Vector b, std::vector<Intersection> &intersections) const
+{
+    _figure->intersections(a, b, intersections);
+}
+
+void gg::Boundary::batch(FigureBatch &batch, unsigned int index) const
+{
+    batch.push_back(_figure, index);
+}
+
 gg::Boundary::~Boundary()
 {
     if (_figure != nullptr) delete _figure;
-}
\ No newline at end of file
+}
+
+void gg::StaticBoundary::_construct(const StaticBoundary &other)
+{
+    _type = other._type;
+    switch (_type)
+    {
+    case Type::line: new (&_line) Line(other._line); break;
+    case Type::circle: new (&_circle) Circle(other._circle); break;
+    default: new (&_arc) Arc(other._arc); break;
+    }
+}
+
+void gg::StaticBoundary::_destroy()
+{
+    switch (_type)
+    {
+    case Type::line: _line.~Line(); break;
+    case Type::circle: _circle.~Circle(); break;
+    default: _arc.~Arc(); break;
+    }
+}
+
+gg::StaticBoundary::StaticBoundary(const Line &line) : _type(Type::line), _line(line) {}
+
+gg::StaticBoundary::StaticBoundary(const Circle &circle) : _type(Type::circle), _circle(circle) {}
+
+gg::StaticBoundary::StaticBoundary(const Arc &arc) : _type(Type::arc), _arc(arc) {}
+
+gg::StaticBoundary::StaticBoundary(const StaticBoundary &other)
+{
+    _construct(other);
+}
+
+gg::StaticBoundary &gg::StaticBoundary::operator=(const StaticBoundary &other)
+{
+    if (this == &other) return *this;
+    _destroy();
+    _construct(other);
+    return *this;
+}
+
+gg::StaticBoundary::Type gg::StaticBoundary::type() const
+{
+    return _type;
+}
+
+const gg::Figure *gg::StaticBoundary::figure() const
+{
+    switch (_type)
+    {
+    case Type::line: return &_line;
+    case Type::circle: return &_circle;
+    default: return &_arc;
+    }
+}
+
+void gg::StaticBoundary::batch(FigureBatch &batch, unsigned int index) const
+{
+    switch (_type)
+    {
+    case Type::line: batch.push_back(_line, index); break;
+    case Type::circle: batch.push_back(_circle, index); break;
+    default: batch.push_back(_arc, index); break;
+    }
+}
+
+gg::StaticBoundary::~StaticBoundary()
+{
+    _destroy();
+}
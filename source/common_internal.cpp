@@ -1,4 +1,5 @@
 #include "../include/grid_generator/common_internal.h"
+#include "../include/grid_generator/lattice_traits.h"
 #include <math.h>
 
 bool gg::Position::operator<(const Position &b) const
@@ -8,209 +9,271 @@ bool gg::Position::operator<(const Position &b) const
     else return (!upside_down && b.upside_down);
 }
 
-unsigned int gg::get_shape(const Parameters &parameters)
+bool gg::Position::operator==(const Position &b) const
 {
-    switch (parameters.typ)
-    {
-        case GridType::triangular: return 3;
-        case GridType::hexagonal: return 6;
-        default: return 4;
-    }
+    return xi == b.xi && yi == b.yi && upside_down == b.upside_down;
 }
 
-double gg::get_area(const Parameters &parameters)
+std::size_t gg::PositionHash::operator()(Position position) const
 {
-    switch (parameters.typ)
-    {
-        case GridType::triangular: return parameters.size.x * parameters.size.y * sqrt(3) / 4.0;
-        case GridType::hexagonal: return 6.0 * parameters.size.x * parameters.size.y * sqrt(3) / 4.0;;
-        default: return parameters.size.x * parameters.size.y;
-    }
+    //Spatial hash, multiplication by large primes spreads neighbor positions over the buckets
+    return ((std::size_t)(unsigned int)position.xi * 73856093u) ^ ((std::size_t)(unsigned int)position.yi * 19349663u) ^ (position.upside_down ? 83492791u : 0u);
 }
 
-gg::Vector gg::get_center(const Parameters &parameters, Position position)
+bool gg::Crossing::operator<(const Crossing &b) const
+{
+    return x < b.x;
+}
+
+constexpr gg::GridType gg::LatticeTraits<gg::GridType::triangular>::typ;
+constexpr unsigned int gg::LatticeTraits<gg::GridType::triangular>::shape;
+constexpr gg::GridType gg::LatticeTraits<gg::GridType::square>::typ;
+constexpr unsigned int gg::LatticeTraits<gg::GridType::square>::shape;
+constexpr gg::GridType gg::LatticeTraits<gg::GridType::hexagonal>::typ;
+constexpr unsigned int gg::LatticeTraits<gg::GridType::hexagonal>::shape;
+
+gg::Lattice::Lattice(const Parameters &parameters) :
+    _origin(parameters.origin), _size(parameters.size),
+    _cos(cos(parameters.inclination)), _sin(sin(parameters.inclination)),
+    _inverse_cos(cos(-parameters.inclination)), _inverse_sin(sin(-parameters.inclination)),
+    _typ(parameters.typ), _shape(get_shape(parameters)), _area(get_area(parameters))
 {
-    Vector coord;
     switch (parameters.typ)
     {
         case GridType::triangular:
-            coord = Vector(0.5 * position.yi + position.xi, 0.5 * sqrt(3) * position.yi);
-            if (position.upside_down) coord = coord + Vector(1.0 / 4.0, sqrt(3) / 12);
-            else coord = coord - Vector(1.0 / 4.0, sqrt(3) / 12);
+            _basis[0] = Vector(1.0, 0.0);
+            _basis[1] = Vector(0.5, 0.5 * sqrt(3));
+            _center_offsets[0] = Vector(-1.0 / 4.0, -(sqrt(3) / 12));
+            _point_offsets[0][0] = Vector(-3.0 / 4.0, -sqrt(3) / 4);
+            _point_offsets[0][1] = Vector(1.0 / 4.0, -sqrt(3) / 4);
+            _point_offsets[0][2] = Vector(-1.0 / 4.0, sqrt(3) / 4);
             break;
         case GridType::hexagonal:
-            coord = Vector(position.yi + 2.0 * position.xi, sqrt(3) * position.yi);
+            _basis[0] = Vector(2.0, 0.0);
+            _basis[1] = Vector(1.0, sqrt(3));
+            _center_offsets[0] = Vector(0.0, 0.0);
+            _point_offsets[0][0] = Vector(0, -2.0 / sqrt(3));
+            _point_offsets[0][1] = Vector(1.0, -1.0 / sqrt(3));
+            _point_offsets[0][2] = Vector(1.0, 1.0 / sqrt(3));
+            _point_offsets[0][3] = Vector(0, 2.0 / sqrt(3));
+            _point_offsets[0][4] = Vector(-1.0, 1.0 / sqrt(3));
+            _point_offsets[0][5] = Vector(-1.0, -1.0 / sqrt(3));
             break;
         default: //case GridType::square:
-            coord = Vector(position.xi, position.yi);
+            _basis[0] = Vector(1.0, 0.0);
+            _basis[1] = Vector(0.0, 1.0);
+            _center_offsets[0] = Vector(0.0, 0.0);
+            _point_offsets[0][0] = Vector(-0.5, -0.5);
+            _point_offsets[0][1] = Vector(0.5, -0.5);
+            _point_offsets[0][2] = Vector(0.5, 0.5);
+            _point_offsets[0][3] = Vector(-0.5, 0.5);
             break;
     }
-    return parameters.origin + rotate(Vector(parameters.size.x * coord.x, parameters.size.y * coord.y), parameters.inclination);
+
+    //Upside down elements (only triangular) are point reflections of normal elements
+    _center_offsets[1] = Vector(-_center_offsets[0].x, -_center_offsets[0].y);
+    for (unsigned int i = 0; i < _shape; i++) _point_offsets[1][i] = Vector(-_point_offsets[0][i].x, -_point_offsets[0][i].y);
 }
 
-std::array<gg::Vector, 6> gg::get_points(const Parameters &parameters, Position point)
+gg::Vector gg::Lattice::_base(Position position) const
 {
-    std::array<gg::Vector, 6> coords;
-    unsigned int coords_size;
-    switch (parameters.typ)
+    return Vector(position.xi * _basis[0].x + position.yi * _basis[1].x, position.xi * _basis[0].y + position.yi * _basis[1].y);
+}
+
+unsigned int gg::Lattice::shape() const
+{
+    return _shape;
+}
+
+double gg::Lattice::area() const
+{
+    return _area;
+}
+
+gg::Vector gg::Lattice::transform(Vector lattice_coord) const
+{
+    const double x = _size.x * lattice_coord.x, y = _size.y * lattice_coord.y;
+    return Vector(_origin.x + (_cos * x - _sin * y), _origin.y + (_sin * x + _cos * y));
+}
+
+gg::Vector gg::Lattice::lattice_coord(Vector coord) const
+{
+    const double x = coord.x - _origin.x, y = coord.y - _origin.y;
+    return Vector((_inverse_cos * x - _inverse_sin * y) / _size.x, (_inverse_sin * x + _inverse_cos * y) / _size.y);
+}
+
+gg::Vector gg::Lattice::center(Position position) const
+{
+    const Vector base = _base(position);
+    const Vector offset = _center_offsets[position.upside_down ? 1 : 0];
+    return transform(Vector(base.x + offset.x, base.y + offset.y));
+}
+
+std::array<gg::Vector, 6> gg::Lattice::points(Position position) const
+{
+    std::array<Vector, 6> coords;
+    points(position, 1, coords.data());
+    return coords;
+}
+
+void gg::Lattice::centers(Position first, unsigned int count, Vector *centers) const
+{
+    const Vector offset = _center_offsets[first.upside_down ? 1 : 0];
+    const double row_x = first.yi * _basis[1].x, row_y = first.yi * _basis[1].y;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const int xi = first.xi + (int)i;
+        centers[i] = transform(Vector((xi * _basis[0].x + row_x) + offset.x, (xi * _basis[0].y + row_y) + offset.y));
+    }
+}
+
+void gg::Lattice::points(Position first, unsigned int count, Vector *points) const
+{
+    const std::array<Vector, 6> &offsets = _point_offsets[first.upside_down ? 1 : 0];
+    const double row_x = first.yi * _basis[1].x, row_y = first.yi * _basis[1].y;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const int xi = first.xi + (int)i;
+        const double x = xi * _basis[0].x + row_x, y = xi * _basis[0].y + row_y;
+        for (unsigned int p = 0; p < _shape; p++) points[i * _shape + p] = transform(Vector(x + offsets[p].x, y + offsets[p].y));
+    }
+}
+
+gg::Position gg::Lattice::position(Vector coord) const
+{
+    const Vector lattice = lattice_coord(coord);
+    Position position;
+    switch (_typ)
     {
         case GridType::triangular:
         {
-            Vector center(0.5 * point.yi + point.xi, 0.5 * sqrt(3) * point.yi);
-            std::array<gg::Vector, 3> offsets;
-            offsets[0] = Vector(-3.0 / 4.0, -sqrt(3) / 4);
-            offsets[1] = Vector(1.0 / 4.0, -sqrt(3) / 4);
-            offsets[2] = Vector(-1.0 / 4.0, sqrt(3) / 4);
-            for (unsigned int i = 0; i < 3; i++) coords[i] = point.upside_down ? (center - offsets[i]) : (center + offsets[i]);
-            coords_size = 3;
+            //Rows are horizontal bands, normal and upside down triangles alternate in the row and their sides are slanted
+            const double height = _basis[1].y;
+            position.yi = (int)floor(lattice.y / height + 0.5);
+            const double t = (lattice.y - height * position.yi) / height + 0.5;   //0 at the bottom of the row, 1 at the top
+            const double u = lattice.x - 0.5 * position.yi + 0.75 - 0.5 * t;    //Normal triangle xi spans [xi, xi + 1 - t], upside down spans [xi + 1 - t, xi + 1]
+            position.xi = (int)floor(u);
+            position.upside_down = (u - position.xi) > (1.0 - t);
             break;
         }
         case GridType::hexagonal:
         {
-            Vector center(point.yi + 2.0 * point.xi, sqrt(3) * point.yi);
-            coords[0] = center + Vector(0, -1);
-            coords[1] = center + Vector(sqrt(3) / 4, -1.0 / 2.0);
-            coords[2] = center + Vector(sqrt(3) / 4, 1.0 / 2.0);
-            coords[3] = center + Vector(0, 1);
-            coords[4] = center + Vector(-sqrt(3) / 4, 1.0 / 2.0);
-            coords[5] = center + Vector(-sqrt(3) / 4, -1.0 / 2.0);
-            coords_size = 6;
+            //Nearest center around the approximate position
+            const int yi = (int)floor(lattice.y / _basis[1].y + 0.5);
+            const int xi = (int)floor(0.5 * (lattice.x - yi) + 0.5);
+            double nearest = INFINITY;
+            for (int y = yi - 1; y <= yi + 1; y++)
+            {
+                for (int x = xi - 1; x <= xi + 1; x++)
+                {
+                    const double dx = lattice.x - (x * _basis[0].x + y * _basis[1].x), dy = lattice.y - y * _basis[1].y;
+                    const double distance = dx * dx + dy * dy;
+                    if (distance < nearest) { nearest = distance; position.xi = x; position.yi = y; }
+                }
+            }
             break;
         }
         default: //case GridType::square:
-        {
-            Vector center(point.xi, point.yi);
-            coords[0] = center + Vector(-0.5, -0.5);
-            coords[1] = center + Vector(0.5, -0.5);
-            coords[2] = center + Vector(0.5, 0.5);
-            coords[3] = center + Vector(-0.5, 0.5);
-            coords_size = 4;
+            position.xi = (int)floor(lattice.x + 0.5);
+            position.yi = (int)floor(lattice.y + 0.5);
             break;
-        }
     }
-    for (unsigned int i = 0; i < coords_size; i++)
+    return position;
+}
+
+unsigned int gg::get_shape(const Parameters &parameters)
+{
+    switch (parameters.typ)
     {
-        coords[i] = parameters.origin + rotate(Vector(parameters.size.x * coords[i].x, parameters.size.y * coords[i].y), parameters.inclination);
+        case GridType::triangular: return 3;
+        case GridType::hexagonal: return 6;
+        default: return 4;
     }
-    return coords;
+}
+
+double gg::get_area(const Parameters &parameters)
+{
+    switch (parameters.typ)
+    {
+        case GridType::triangular: return parameters.size.x * parameters.size.y * sqrt(3) / 4.0;
+        case GridType::hexagonal: return 2.0 * parameters.size.x * parameters.size.y * sqrt(3);
+        default: return parameters.size.x * parameters.size.y;
+    }
+}
+
+gg::Vector gg::get_center(const Parameters &parameters, Position position)
+{
+    return Lattice(parameters).center(position);
+}
+
+std::array<gg::Vector, 6> gg::get_points(const Parameters &parameters, Position point)
+{
+    return Lattice(parameters).points(point);
 }
 
 gg::FacePosition gg::get_face_neighbor(const Parameters &parameters, FacePosition face)
 {
-    int one;
     switch (parameters.typ)
     {
-    case GridType::triangular:
-        one = (face.position.upside_down ? -1 : 1);
-        switch (face.face)
-        {
-            case 0: face.position.yi -= one; break;
-            case 2: face.position.xi -= one; break;
-        }
-        face.position.upside_down = !face.position.upside_down;
-        break;
-    case GridType::hexagonal:
-        switch (face.face)
-        {
-            case 0: face.position.yi--; face.position.xi++; break;
-            case 1: face.position.xi++; break;
-            case 2: face.position.yi++; break;
-            case 3: face.position.xi--; face.position.yi++; break;
-            case 4: face.position.xi--; break;
-            default: face.position.yi--; break;
-        }
-        face.face = (face.face + 3) % 6;
-        break;
-    default: //case GridType::square:
-        switch (face.face)
-        {
-            case 0: face.position.yi--; break;
-            case 1: face.position.xi++; break;
-            case 2: face.position.yi++; break;
-            default: face.position.xi--; break;
-        }
-        face.face = (face.face + 2) % 4;
-        break;
+        case GridType::triangular: return LatticeTraits<GridType::triangular>::face_neighbor(face);
+        case GridType::hexagonal: return LatticeTraits<GridType::hexagonal>::face_neighbor(face);
+        default: return LatticeTraits<GridType::square>::face_neighbor(face);
     }
-    return face;
 }
 
 std::array<gg::PointPosition, 6> gg::get_point_neighbors(const Parameters &parameters, PointPosition point)
 {
-    std::array<gg::PointPosition, 6> result;
-    int one;
     switch (parameters.typ)
     {
-    case GridType::triangular:
-        for (unsigned int i = 0; i < 6; i++) { result[i].position = point.position; result[i].point = (unsigned int)-1; }
-        one = (point.position.upside_down ? -1 : 1);
-        switch (point.point)
-        {
-        case 0:
-            result[0].point = 2; result[0].position.xi -= one; result[0].position.upside_down = !point.position.upside_down;
-            result[1].point = 1; result[1].position.xi -= one;
-            result[2].point = 0; result[2].position.xi -= one; result[2].position.yi -= one; result[2].position.upside_down = !point.position.upside_down;
-            result[3].point = 2; result[3].position.yi -= one;
-            result[4].point = 1; result[4].position.yi -= one; result[4].position.upside_down = !point.position.upside_down;
-            break;
-        case 1:
-            result[0].point = 0; result[0].position.yi -= one; result[0].position.upside_down = !point.position.upside_down;
-            result[1].point = 2; result[1].position.xi += one; result[1].position.yi -= one;
-            result[2].point = 1; result[2].position.xi += one; result[2].position.yi -= one; result[2].position.upside_down = !point.position.upside_down;
-            result[3].point = 0; result[3].position.xi += one;
-            result[4].point = 2; result[4].position.upside_down = !point.position.upside_down;
-            break;
-        default:
-            result[0].point = 1; result[0].position.upside_down = !point.position.upside_down;
-            result[1].point = 0; result[1].position.yi += one;
-            result[2].point = 2; result[2].position.xi -= one; result[2].position.yi += one; result[2].position.upside_down = !point.position.upside_down;
-            result[3].point = 1; result[3].position.xi -= one; result[3].position.yi += one;
-            result[4].point = 0; result[4].position.xi += one; result[4].position.upside_down = !point.position.upside_down;
-            break;
-        }
-        break;
-    case GridType::hexagonal:
-        for (unsigned int i = 0; i < 6; i++) { result[i].position = point.position; result[i].point = (unsigned int)-1; }
-        switch (point.point)
-        {
-            case 0: result[0].position.yi--; result[1].position.xi++; result[1].position.yi--; break;
-            case 1: result[0].position.xi++; result[0].position.yi--; result[1].position.xi++; break;
-            case 2: result[0].position.xi++; result[1].position.yi++; break;
-            case 3: result[0].position.yi++; result[1].position.xi--; result[1].position.yi++; break;
-            case 4: result[0].position.xi--; result[0].position.yi++; result[1].position.xi--; break;
-            default: result[0].position.xi--; result[1].position.yi--; break;
-        }
-        result[0].point = (point.point + 2) % 6;
-        result[1].point = (point.point + 4) % 6;
-        break;
-    default: //case GridType::square:
-        for (unsigned int i = 0; i < 6; i++) { result[i].position = point.position; result[i].point = (unsigned int)-1; }
-        switch (point.point)
-        {
-            case 0: result[0].position.xi--; result[1].position.xi--; result[1].position.yi--; result[2].position.yi--; break;
-            case 1: result[0].position.yi--; result[1].position.xi++; result[1].position.yi--; result[2].position.xi++; break;
-            case 2: result[0].position.xi++; result[1].position.xi++; result[1].position.yi++; result[2].position.yi++; break;
-            default: result[0].position.yi++; result[1].position.xi--; result[1].position.yi++; result[2].position.xi--; break;
-        }
-        result[0].point = (point.point + 1) % 4;
-        result[1].point = (point.point + 2) % 4;
-        result[2].point = (point.point + 3) % 4;
-        break;
+        case GridType::triangular: return LatticeTraits<GridType::triangular>::point_neighbors(point);
+        case GridType::hexagonal: return LatticeTraits<GridType::hexagonal>::point_neighbors(point);
+        default: return LatticeTraits<GridType::square>::point_neighbors(point);
     }
-    return result;
 }
 
-gg::Vector gg::rotate_ccw(Vector v)
+gg::PointPosition gg::get_canonical_point(const Parameters &parameters, PointPosition point)
 {
-    return Vector(v.y, -v.x);
+    switch (parameters.typ)
+    {
+        case GridType::triangular: return LatticeTraits<GridType::triangular>::canonical_point(point);
+        case GridType::hexagonal: return LatticeTraits<GridType::hexagonal>::canonical_point(point);
+        default: return LatticeTraits<GridType::square>::canonical_point(point);
+    }
+}
+
+gg::Vector gg::get_lattice_coord(const Parameters &parameters, Vector coord)
+{
+    return Lattice(parameters).lattice_coord(coord);
 }
 
-gg::Vector gg::rotate_cw(Vector v)
+gg::Position gg::get_position(const Parameters &parameters, Vector coord)
 {
-    return Vector(-v.y, v.x);
+    return Lattice(parameters).position(coord);
 }
 
 gg::Vector gg::rotate(Vector v, double angle)
 {
     return Vector(cos(angle) * v.x - sin(angle) * v.y, sin(angle) * v.x + cos(angle) * v.y);
-}
\ No newline at end of file
+}
+
+bool gg::angle_in_arc(double arc_azimuth, double arc_angle, double angle)
+{
+    if (arc_azimuth + arc_angle > M_PI) return angle >= arc_azimuth || angle <= (arc_azimuth + arc_angle - 2 * M_PI);
+    else return angle >= (arc_azimuth) && angle <= (arc_azimuth + arc_angle);
+}
+
+unsigned int gg::circle_intersections(Vector center, double radius, Vector a, Vector b, double &length, double distances[2])
+{
+    length = (b - a).norm();
+    const double B = -2 * (center - a).dot(b - a) / length;
+    const double C = (center - a).squared_norm() - radius*radius;
+    const double determinant = B*B - 4 * C;
+    if (determinant < 0) return 0;
+    const double L[2] = { (-B - sqrt(determinant)) / 2, (-B + sqrt(determinant)) / 2 };
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < (determinant == 0 ? 1 : 2); i++)
+    {
+        if (L[i] >= 0 && L[i] <= length) distances[count++] = L[i]; //Valid length
+    }
+    return count;
+}
@@ -0,0 +1,18 @@
+#include "../include/grid_generator/csr_patch.h"
+
+void gg::replace_offsets(std::vector<unsigned int> &offsets, unsigned int count, const std::vector<unsigned int> &rows, const std::vector<unsigned int> &row_offsets)
+{
+    //Offsets before the first replaced row do not change, other rows are shifted by the change of length of replaced rows before them
+    const unsigned int end = offsets.back();
+    offsets.resize(count + 1, end);
+    if (rows.empty()) return;
+    unsigned int i = 0;
+    unsigned int old_begin = offsets[rows[0]];
+    for (unsigned int row = rows[0]; row < count; row++)
+    {
+        const unsigned int old_end = offsets[row + 1];
+        if (i < rows.size() && rows[i] == row) { offsets[row + 1] = offsets[row] + (row_offsets[i + 1] - row_offsets[i]); i++; }
+        else offsets[row + 1] = offsets[row] + (old_end - old_begin);
+        old_begin = old_end;
+    }
+}
@@ -0,0 +1,334 @@
+#include "../include/grid_generator/export.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+/*
+    Exporters write arrays of indexed grids in large blocks
+    Arrays that are stored in the same layout as the file needs (offsets, fields) are written directly,
+    other arrays (3D coordinates, connectivity, element types) are converted in chunks of fixed size
+*/
+
+namespace
+{
+    const std::size_t export_buffer_size = 1 << 20;
+    const std::size_t export_chunk_size = 4096;
+
+    class BufferedFile
+    {
+    protected:
+        const char *_function;
+        std::ofstream _file;
+        std::vector<char> _buffer;
+        std::size_t _size = 0;
+    public:
+        BufferedFile(const std::string &path, const char *function) : _function(function), _file(path, std::ios::binary | std::ios::trunc), _buffer(export_buffer_size)
+        {
+            if (!_file.is_open()) throw std::runtime_error(std::string(_function) + ": Could not open file");
+        }
+        void flush()
+        {
+            _file.write(_buffer.data(), _size);
+            _size = 0;
+        }
+        void write(const void *data, std::size_t size)
+        {
+            if (_size + size > _buffer.size()) flush();
+            if (size >= _buffer.size()) _file.write((const char*)data, size);
+            else { std::memcpy(&_buffer[_size], data, size); _size += size; }
+        }
+        void text(const std::string &string)
+        {
+            write(string.data(), string.size());
+        }
+        template <class T> void value(T value)
+        {
+            write(&value, sizeof(T));
+        }
+        void close()
+        {
+            flush();
+            _file.close();
+            if (!_file.good()) throw std::runtime_error(std::string(_function) + ": Could not write file");
+        }
+    };
+
+    //Writes array in chunks, element i is produced by convert(i, pointer)
+    template <class T, class G> void write_converted(BufferedFile &file, std::size_t count, unsigned int components, G convert)
+    {
+        std::vector<T> chunk(export_chunk_size * components);
+        for (std::size_t begin = 0; begin < count; begin += export_chunk_size)
+        {
+            const std::size_t end = std::min(count, begin + export_chunk_size);
+            for (std::size_t i = begin; i < end; i++) convert(i, &chunk[(i - begin) * components]);
+            file.write(chunk.data(), (end - begin) * components * sizeof(T));
+        }
+    }
+
+    void check_fields(const std::vector<gg::ExportField> &fields, std::size_t count, const char *function)
+    {
+        for (std::vector<gg::ExportField>::const_iterator field = fields.begin(); field != fields.end(); field++)
+        {
+            if (field->values.size() != count) throw std::runtime_error(std::string(function) + ": Field size does not match the grid");
+        }
+    }
+
+    const char *byte_order()
+    {
+        const unsigned int one = 1;
+        return (*(const unsigned char*)&one == 1) ? "LittleEndian" : "BigEndian";
+    }
+
+    //Creates header of VTU file, sizes are sizes of appended blocks in order of writing
+    std::string vtu_header(std::size_t points, std::size_t cells, const std::vector<std::size_t> &sizes, const std::vector<gg::ExportField> &fields, bool cell_fields)
+    {
+        std::vector<unsigned long long> offsets(sizes.size());
+        unsigned long long offset = 0;
+        for (unsigned int i = 0; i < sizes.size(); i++) { offsets[i] = offset; offset += sizeof(unsigned long long) + sizes[i]; }
+        std::ostringstream header;
+        header << "<?xml version=\"1.0\"?>\n";
+        header << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << byte_order() << "\" header_type=\"UInt64\">\n";
+        header << "  <UnstructuredGrid>\n";
+        header << "    <Piece NumberOfPoints=\"" << points << "\" NumberOfCells=\"" << cells << "\">\n";
+        header << "      <Points>\n";
+        header << "        <DataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" << offsets[0] << "\"/>\n";
+        header << "      </Points>\n";
+        header << "      <Cells>\n";
+        header << "        <DataArray type=\"UInt32\" Name=\"connectivity\" format=\"appended\" offset=\"" << offsets[1] << "\"/>\n";
+        header << "        <DataArray type=\"UInt32\" Name=\"offsets\" format=\"appended\" offset=\"" << offsets[2] << "\"/>\n";
+        header << "        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"" << offsets[3] << "\"/>\n";
+        header << "      </Cells>\n";
+        header << (cell_fields ? "      <CellData>\n" : "      <PointData>\n");
+        for (unsigned int i = 0; i < fields.size(); i++)
+            header << "        <DataArray type=\"Float64\" Name=\"" << fields[i].name << "\" format=\"appended\" offset=\"" << offsets[4 + i] << "\"/>\n";
+        header << (cell_fields ? "      </CellData>\n" : "      </PointData>\n");
+        header << "    </Piece>\n";
+        header << "  </UnstructuredGrid>\n";
+        header << "  <AppendedData encoding=\"raw\">\n";
+        header << "   _";
+        return header.str();
+    }
+
+    const std::string vtu_footer = "\n  </AppendedData>\n</VTKFile>\n";
+
+    void vtu_fields(BufferedFile &file, const std::vector<gg::ExportField> &fields)
+    {
+        for (std::vector<gg::ExportField>::const_iterator field = fields.begin(); field != fields.end(); field++)
+        {
+            file.value<unsigned long long>(field->values.size() * sizeof(double));
+            file.write(field->values.data(), field->values.size() * sizeof(double));
+        }
+    }
+
+    void vtu_points(BufferedFile &file, const std::vector<gg::Vector> &coords)
+    {
+        file.value<unsigned long long>(coords.size() * 3 * sizeof(double));
+        write_converted<double>(file, coords.size(), 3, [&](std::size_t i, double *output)
+        {
+            output[0] = coords[i].x; output[1] = coords[i].y; output[2] = 0.0;
+        });
+    }
+
+    void msh_format(BufferedFile &file)
+    {
+        file.text("$MeshFormat\n4.1 1 8\n");
+        file.value<int>(1);
+        file.text("\n$EndMeshFormat\n");
+    }
+
+    void msh_nodes(BufferedFile &file, const std::vector<gg::Vector> &coords)
+    {
+        file.text("$Nodes\n");
+        file.value<std::size_t>(1);
+        file.value<std::size_t>(coords.size());
+        file.value<std::size_t>(coords.empty() ? 0 : 1);
+        file.value<std::size_t>(coords.size());
+        file.value<int>(2);
+        file.value<int>(1);
+        file.value<int>(0);
+        file.value<std::size_t>(coords.size());
+        write_converted<std::size_t>(file, coords.size(), 1, [](std::size_t i, std::size_t *output) { *output = i + 1; });
+        write_converted<double>(file, coords.size(), 3, [&](std::size_t i, double *output)
+        {
+            output[0] = coords[i].x; output[1] = coords[i].y; output[2] = 0.0;
+        });
+        file.text("\n$EndNodes\n");
+    }
+
+    //Writes header of data section, values are written by the caller as pairs of int tag and double value
+    void msh_data_header(BufferedFile &file, const char *section, const std::string &name, std::size_t count)
+    {
+        std::ostringstream header;
+        header << "$" << section << "\n1\n\"" << name << "\"\n1\n0.0\n3\n0\n1\n" << count << "\n";
+        file.text(header.str());
+    }
+}
+
+gg::ExportField gg::area_field(const IndexedCellGrid &grid)
+{
+    return { "area", grid.cell_areas };
+}
+
+gg::ExportField gg::boundary_field(const IndexedCellGrid &grid)
+{
+    ExportField field;
+    field.name = "boundary";
+    field.values.resize(grid.cell_boundaries.size());
+    for (unsigned int cell = 0; cell < grid.cell_boundaries.size(); cell++) field.values[cell] = (grid.cell_boundaries[cell] == no_index) ? 0.0 : 1.0;
+    return field;
+}
+
+void gg::write_vtu(const std::string &path, const IndexedCellGrid &grid, const std::vector<ExportField> &fields)
+{
+    const std::size_t points = grid.point_coords.size(), cells = grid.cell_centers.size(), sides = grid.sides.size();
+    check_fields(fields, cells, "gg::write_vtu()");
+    std::vector<std::size_t> sizes = { points * 3 * sizeof(double), sides * sizeof(unsigned int), cells * sizeof(unsigned int), cells * sizeof(unsigned char) };
+    for (unsigned int i = 0; i < fields.size(); i++) sizes.push_back(cells * sizeof(double));
+
+    BufferedFile file(path, "gg::write_vtu()");
+    file.text(vtu_header(points, cells, sizes, fields, true));
+    vtu_points(file, grid.point_coords);
+    file.value<unsigned long long>(sizes[1]);
+    write_converted<unsigned int>(file, sides, 1, [&](std::size_t s, unsigned int *output) { *output = grid.sides[s].point; });
+    file.value<unsigned long long>(sizes[2]);
+    if (cells != 0) file.write(&grid.side_offsets[1], cells * sizeof(unsigned int));
+    file.value<unsigned long long>(sizes[3]);
+    write_converted<unsigned char>(file, cells, 1, [](std::size_t, unsigned char *output) { *output = 7; }); //VTK_POLYGON
+    vtu_fields(file, fields);
+    file.text(vtu_footer);
+    file.close();
+}
+
+void gg::write_vtu(const std::string &path, const IndexedPointGrid &grid, const std::vector<ExportField> &fields)
+{
+    const std::size_t points = grid.coords.size();
+    check_fields(fields, points, "gg::write_vtu()");
+    std::vector<std::size_t> sizes = { points * 3 * sizeof(double), points * sizeof(unsigned int), points * sizeof(unsigned int), points * sizeof(unsigned char) };
+    for (unsigned int i = 0; i < fields.size(); i++) sizes.push_back(points * sizeof(double));
+
+    BufferedFile file(path, "gg::write_vtu()");
+    file.text(vtu_header(points, points, sizes, fields, false));
+    vtu_points(file, grid.coords);
+    file.value<unsigned long long>(sizes[1]);
+    write_converted<unsigned int>(file, points, 1, [](std::size_t i, unsigned int *output) { *output = (unsigned int)i; });
+    file.value<unsigned long long>(sizes[2]);
+    write_converted<unsigned int>(file, points, 1, [](std::size_t i, unsigned int *output) { *output = (unsigned int)(i + 1); });
+    file.value<unsigned long long>(sizes[3]);
+    write_converted<unsigned char>(file, points, 1, [](std::size_t, unsigned char *output) { *output = 1; });  //VTK_VERTEX
+    vtu_fields(file, fields);
+    file.text(vtu_footer);
+    file.close();
+}
+
+void gg::write_msh(const std::string &path, const IndexedCellGrid &grid, const std::vector<ExportField> &fields)
+{
+    const std::size_t cells = grid.cell_centers.size();
+    check_fields(fields, cells, "gg::write_msh()");
+    const auto side_count = [&](std::size_t cell) -> unsigned int { return grid.side_offsets[cell + 1] - grid.side_offsets[cell]; };
+    std::size_t triangles = 0, quadrangles = 0;
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        if (side_count(cell) == 4) quadrangles++;
+        else triangles += side_count(cell) - 2;
+    }
+
+    //Calls function for every element in order of their tags
+    const auto elements = [&](bool quadrangle, std::function<void(std::size_t cell, unsigned int first_side)> function)
+    {
+        for (std::size_t cell = 0; cell < cells; cell++)
+        {
+            const unsigned int count = side_count(cell);
+            if ((count == 4) != quadrangle) continue;
+            if (quadrangle) function(cell, 0);
+            else for (unsigned int s = 1; s + 1 < count; s++) function(cell, s);
+        }
+    };
+
+    BufferedFile file(path, "gg::write_msh()");
+    msh_format(file);
+    msh_nodes(file, grid.point_coords);
+
+    file.text("$Elements\n");
+    file.value<std::size_t>((triangles != 0 ? 1 : 0) + (quadrangles != 0 ? 1 : 0));
+    file.value<std::size_t>(triangles + quadrangles);
+    file.value<std::size_t>((triangles + quadrangles) != 0 ? 1 : 0);
+    file.value<std::size_t>(triangles + quadrangles);
+    std::size_t tag = 1;
+    if (triangles != 0)
+    {
+        file.value<int>(2); file.value<int>(1); file.value<int>(2);
+        file.value<std::size_t>(triangles);
+        elements(false, [&](std::size_t cell, unsigned int s)
+        {
+            //Triangle fan from the first point of the cell
+            const IndexedSide *sides = &grid.sides[grid.side_offsets[cell]];
+            const std::size_t element[4] = { tag++, (std::size_t)sides[0].point + 1, (std::size_t)sides[s].point + 1, (std::size_t)sides[s + 1].point + 1 };
+            file.write(element, sizeof(element));
+        });
+    }
+    if (quadrangles != 0)
+    {
+        file.value<int>(2); file.value<int>(1); file.value<int>(3);
+        file.value<std::size_t>(quadrangles);
+        elements(true, [&](std::size_t cell, unsigned int)
+        {
+            const IndexedSide *sides = &grid.sides[grid.side_offsets[cell]];
+            const std::size_t element[5] = { tag++, (std::size_t)sides[0].point + 1, (std::size_t)sides[1].point + 1, (std::size_t)sides[2].point + 1, (std::size_t)sides[3].point + 1 };
+            file.write(element, sizeof(element));
+        });
+    }
+    file.text("\n$EndElements\n");
+
+    for (std::vector<ExportField>::const_iterator field = fields.begin(); field != fields.end(); field++)
+    {
+        msh_data_header(file, "ElementData", field->name, triangles + quadrangles);
+        int data_tag = 1;
+        const auto value = [&](std::size_t cell, unsigned int)
+        {
+            file.value<int>(data_tag++);
+            file.value<double>(field->values[cell]);
+        };
+        elements(false, value);
+        elements(true, value);
+        file.text("\n$EndElementData\n");
+    }
+    file.close();
+}
+
+void gg::write_msh(const std::string &path, const IndexedPointGrid &grid, const std::vector<ExportField> &fields)
+{
+    const std::size_t points = grid.coords.size();
+    check_fields(fields, points, "gg::write_msh()");
+
+    BufferedFile file(path, "gg::write_msh()");
+    msh_format(file);
+    msh_nodes(file, grid.coords);
+
+    file.text("$Elements\n");
+    file.value<std::size_t>(points != 0 ? 1 : 0);
+    file.value<std::size_t>(points);
+    file.value<std::size_t>(points != 0 ? 1 : 0);
+    file.value<std::size_t>(points);
+    if (points != 0)
+    {
+        file.value<int>(0); file.value<int>(1); file.value<int>(15);
+        file.value<std::size_t>(points);
+        write_converted<std::size_t>(file, points, 2, [](std::size_t i, std::size_t *output) { output[0] = output[1] = i + 1; });
+    }
+    file.text("\n$EndElements\n");
+
+    for (std::vector<ExportField>::const_iterator field = fields.begin(); field != fields.end(); field++)
+    {
+        msh_data_header(file, "NodeData", field->name, points);
+        for (std::size_t point = 0; point < points; point++)
+        {
+            file.value<int>((int)(point + 1));
+            file.value<double>(field->values[point]);
+        }
+        file.text("\n$EndNodeData\n");
+    }
+    file.close();
+}
@@ -0,0 +1,243 @@
+#include "../include/grid_generator/figure_batch.h"
+#include "figure_batch_kernel.h"
+#include <atomic>
+#include <limits>
+#include <typeinfo>
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+namespace gg
+{
+    namespace batch
+    {
+        namespace
+        {
+            #ifdef __SSE2__
+                ///SSE2 vector of width two
+                struct Sse2Ops
+                {
+                    typedef __m128d Real;
+                    typedef __m128d Mask;
+                    static const unsigned int width = 2;
+                    static Real load(const double *p) { return _mm_loadu_pd(p); }
+                    static Real load(const unsigned int *p)
+                    {
+                        //Unsigned integers are shifted to the signed range before conversion and shifted back exactly
+                        const __m128i shifted = _mm_xor_si128(_mm_loadl_epi64((const __m128i*)p), _mm_set1_epi32((int)0x80000000u));
+                        return _mm_add_pd(_mm_cvtepi32_pd(shifted), _mm_set1_pd(2147483648.0));
+                    }
+                    static Real set(double v) { return _mm_set1_pd(v); }
+                    static Real iota(unsigned int v) { return _mm_setr_pd(v, v + 1.0); }
+                    static void store(double *p, Real v) { _mm_storeu_pd(p, v); }
+                    static Real add(Real a, Real b) { return _mm_add_pd(a, b); }
+                    static Real sub(Real a, Real b) { return _mm_sub_pd(a, b); }
+                    static Real mul(Real a, Real b) { return _mm_mul_pd(a, b); }
+                    static Real div(Real a, Real b) { return _mm_div_pd(a, b); }
+                    static Real sqrt(Real a) { return _mm_sqrt_pd(a); }
+                    static Mask lt(Real a, Real b) { return _mm_cmplt_pd(a, b); }
+                    static Mask le(Real a, Real b) { return _mm_cmple_pd(a, b); }
+                    static Mask gt(Real a, Real b) { return _mm_cmpgt_pd(a, b); }
+                    static Mask ge(Real a, Real b) { return _mm_cmpge_pd(a, b); }
+                    static Mask eq(Real a, Real b) { return _mm_cmpeq_pd(a, b); }
+                    static Mask ne(Real a, Real b) { return _mm_cmpneq_pd(a, b); }
+                    static Mask and_(Mask a, Mask b) { return _mm_and_pd(a, b); }
+                    static Mask or_(Mask a, Mask b) { return _mm_or_pd(a, b); }
+                    static bool any(Mask a) { return _mm_movemask_pd(a) != 0; }
+                    static Real select(Mask m, Real a, Real b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+                };
+            #endif
+
+            ///Kernels of one instruction set
+            struct Kernels
+            {
+                InstructionSet instruction_set;
+                LineKernel lines;
+                CircleKernel circles;
+                CircleKernel arcs;
+            };
+
+            bool supported(InstructionSet instruction_set)
+            {
+                switch (instruction_set)
+                {
+                case InstructionSet::scalar:
+                    return true;
+                case InstructionSet::sse2:
+                    #ifdef __SSE2__
+                        return true;
+                    #else
+                        return false;
+                    #endif
+                case InstructionSet::avx2:
+                    #ifdef GG_AVX2
+                        __builtin_cpu_init();
+                        return __builtin_cpu_supports("avx2");
+                    #else
+                        return false;
+                    #endif
+                }
+                return false;
+            }
+
+            Kernels get_kernels(InstructionSet instruction_set)
+            {
+                Kernels kernels;
+                kernels.instruction_set = instruction_set;
+                kernels.lines = &lines<ScalarOps>;
+                kernels.circles = &circles<ScalarOps>;
+                kernels.arcs = &arcs<ScalarOps>;
+                #ifdef __SSE2__
+                    if (instruction_set == InstructionSet::sse2)
+                    {
+                        kernels.lines = &lines<Sse2Ops>;
+                        kernels.circles = &circles<Sse2Ops>;
+                        kernels.arcs = &arcs<Sse2Ops>;
+                    }
+                #endif
+                #ifdef GG_AVX2
+                    if (instruction_set == InstructionSet::avx2)
+                    {
+                        kernels.lines = &lines_avx2;
+                        kernels.circles = &circles_avx2;
+                        kernels.arcs = &arcs_avx2;
+                    }
+                #endif
+                return kernels;
+            }
+
+            ///Kernel tables are constant, only the pointer to the current table changes, so batches may be used while it is switched
+            const Kernels *kernels_of(InstructionSet instruction_set)
+            {
+                static const Kernels kernels[3] = { get_kernels(InstructionSet::scalar), get_kernels(InstructionSet::sse2), get_kernels(InstructionSet::avx2) };
+                return &kernels[(unsigned int)instruction_set];
+            }
+
+            std::atomic<const Kernels*> &current_kernels()
+            {
+                static std::atomic<const Kernels*> kernels(kernels_of(
+                    supported(InstructionSet::avx2) ? InstructionSet::avx2 :
+                    (supported(InstructionSet::sse2) ? InstructionSet::sse2 : InstructionSet::scalar)));
+                return kernels;
+            }
+        }
+    }
+}
+
+gg::BatchHit::BatchHit() : t(std::numeric_limits<double>::infinity()), index((unsigned int)-1), figure(nullptr) {}
+
+void gg::FigureBatch::push_back(const Figure *figure, unsigned int index)
+{
+    //Exact types only, subclasses may override intersection()
+    if (typeid(*figure) == typeid(Line)) push_back(*static_cast<const Line*>(figure), index);
+    else if (typeid(*figure) == typeid(Circle)) push_back(*static_cast<const Circle*>(figure), index);
+    else if (typeid(*figure) == typeid(Arc)) push_back(*static_cast<const Arc*>(figure), index);
+    else
+    {
+        _other_index.push_back(index);
+        _other_figure.push_back(figure);
+    }
+}
+
+void gg::FigureBatch::push_back(const Line &line, unsigned int index)
+{
+    _line_ax.push_back(line.a().x);
+    _line_ay.push_back(line.a().y);
+    _line_dx.push_back(line.a().x - line.b().x);
+    _line_dy.push_back(line.a().y - line.b().y);
+    _line_index.push_back(index);
+    _line_figure.push_back(&line);
+}
+
+void gg::FigureBatch::push_back(const Circle &circle, unsigned int index)
+{
+    _circle_cx.push_back(circle.center().x);
+    _circle_cy.push_back(circle.center().y);
+    _circle_r2.push_back(circle.radius() * circle.radius());
+    _circle_index.push_back(index);
+    _circle_figure.push_back(&circle);
+}
+
+void gg::FigureBatch::push_back(const Arc &arc, unsigned int index)
+{
+    _arc_cx.push_back(arc.center().x);
+    _arc_cy.push_back(arc.center().y);
+    _arc_r2.push_back(arc.radius() * arc.radius());
+    _arc_azimuth.push_back(arc.azimuth());
+    _arc_angle.push_back(arc.angle());
+    _arc_index.push_back(index);
+    _arc_figure.push_back(&arc);
+}
+
+gg::FigureBatch::Offset gg::FigureBatch::end() const
+{
+    Offset offset;
+    offset.lines = (unsigned int)_line_index.size();
+    offset.circles = (unsigned int)_circle_index.size();
+    offset.arcs = (unsigned int)_arc_index.size();
+    offset.others = (unsigned int)_other_index.size();
+    return offset;
+}
+
+void gg::FigureBatch::nearest(Vector a, Vector b, const Offset &begin, const Offset &end, BatchHit &hit) const
+{
+    const batch::Kernels &kernels = *batch::current_kernels().load(std::memory_order_acquire);
+    batch::KernelHit kernel_hit;
+    kernel_hit.t = hit.t;
+    kernel_hit.index = hit.index;
+    if (begin.lines != end.lines)
+    {
+        batch::LineData data;
+        data.ax = _line_ax.data(); data.ay = _line_ay.data(); data.dx = _line_dx.data(); data.dy = _line_dy.data();
+        data.index = _line_index.data();
+        kernel_hit.position = (unsigned int)-1;
+        kernels.lines(data, begin.lines, end.lines, a, b, kernel_hit);
+        if (kernel_hit.position != (unsigned int)-1) { hit.t = kernel_hit.t; hit.index = kernel_hit.index; hit.figure = _line_figure[kernel_hit.position]; }
+    }
+    if (begin.circles != end.circles)
+    {
+        batch::CircleData data;
+        data.cx = _circle_cx.data(); data.cy = _circle_cy.data(); data.r2 = _circle_r2.data(); data.azimuth = nullptr; data.angle = nullptr;
+        data.index = _circle_index.data();
+        kernel_hit.position = (unsigned int)-1;
+        kernels.circles(data, begin.circles, end.circles, a, b, kernel_hit);
+        if (kernel_hit.position != (unsigned int)-1) { hit.t = kernel_hit.t; hit.index = kernel_hit.index; hit.figure = _circle_figure[kernel_hit.position]; }
+    }
+    if (begin.arcs != end.arcs)
+    {
+        batch::CircleData data;
+        data.cx = _arc_cx.data(); data.cy = _arc_cy.data(); data.r2 = _arc_r2.data(); data.azimuth = _arc_azimuth.data(); data.angle = _arc_angle.data();
+        data.index = _arc_index.data();
+        kernel_hit.position = (unsigned int)-1;
+        kernels.arcs(data, begin.arcs, end.arcs, a, b, kernel_hit);
+        if (kernel_hit.position != (unsigned int)-1) { hit.t = kernel_hit.t; hit.index = kernel_hit.index; hit.figure = _arc_figure[kernel_hit.position]; }
+    }
+    if (begin.others != end.others)
+    {
+        const double squared_length = (b - a).squared_norm();
+        for (unsigned int i = begin.others; i < end.others; i++)
+        {
+            const Intersection intersection = _other_figure[i]->intersection(a, b);
+            if (!intersection.valid) continue;
+            const double t = (intersection.coord - a).dot(b - a) / squared_length;
+            if (t < hit.t || (t == hit.t && _other_index[i] < hit.index)) { hit.t = t; hit.index = _other_index[i]; hit.figure = _other_figure[i]; }
+        }
+    }
+}
+
+void gg::FigureBatch::nearest(Vector a, Vector b, BatchHit &hit) const
+{
+    nearest(a, b, Offset(), end(), hit);
+}
+
+gg::InstructionSet gg::FigureBatch::instruction_set()
+{
+    return batch::current_kernels().load(std::memory_order_acquire)->instruction_set;
+}
+
+bool gg::FigureBatch::instruction_set(InstructionSet instruction_set)
+{
+    if (!batch::supported(instruction_set)) return false;
+    batch::current_kernels().store(batch::kernels_of(instruction_set), std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,61 @@
+#include "figure_batch_kernel.h"
+#include <immintrin.h>
+
+//The file is compiled with AVX2 enabled, the functions are called only if the processor supports AVX2
+
+namespace gg
+{
+    namespace batch
+    {
+        namespace
+        {
+            ///AVX2 vector of width four
+            struct Avx2Ops
+            {
+                typedef __m256d Real;
+                typedef __m256d Mask;
+                static const unsigned int width = 4;
+                static Real load(const double *p) { return _mm256_loadu_pd(p); }
+                static Real load(const unsigned int *p)
+                {
+                    //Unsigned integers are shifted to the signed range before conversion and shifted back exactly
+                    const __m128i shifted = _mm_xor_si128(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi32((int)0x80000000u));
+                    return _mm256_add_pd(_mm256_cvtepi32_pd(shifted), _mm256_set1_pd(2147483648.0));
+                }
+                static Real set(double v) { return _mm256_set1_pd(v); }
+                static Real iota(unsigned int v) { return _mm256_setr_pd(v, v + 1.0, v + 2.0, v + 3.0); }
+                static void store(double *p, Real v) { _mm256_storeu_pd(p, v); }
+                static Real add(Real a, Real b) { return _mm256_add_pd(a, b); }
+                static Real sub(Real a, Real b) { return _mm256_sub_pd(a, b); }
+                static Real mul(Real a, Real b) { return _mm256_mul_pd(a, b); }
+                static Real div(Real a, Real b) { return _mm256_div_pd(a, b); }
+                static Real sqrt(Real a) { return _mm256_sqrt_pd(a); }
+                static Mask lt(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+                static Mask le(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+                static Mask gt(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+                static Mask ge(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+                static Mask eq(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+                static Mask ne(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+                static Mask and_(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+                static Mask or_(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+                static bool any(Mask a) { return _mm256_movemask_pd(a) != 0; }
+                static Real select(Mask m, Real a, Real b) { return _mm256_blendv_pd(b, a, m); }
+            };
+        }
+    }
+}
+
+void gg::batch::lines_avx2(const LineData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit)
+{
+    lines<Avx2Ops>(data, begin, end, a, b, hit);
+}
+
+void gg::batch::circles_avx2(const CircleData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit)
+{
+    circles<Avx2Ops>(data, begin, end, a, b, hit);
+}
+
+void gg::batch::arcs_avx2(const CircleData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit)
+{
+    arcs<Avx2Ops>(data, begin, end, a, b, hit);
+}
@@ -0,0 +1,245 @@
+/*
+    Part of the GridGenerator Project. Distributed under MIT License, which means:
+        - Do whatever you want
+        - Keep this notice and include the license file to your project
+        - I provide no warranty
+    Created by Kyrylo Sovailo, github.com/kyrylo-sovailo, k.sovailo@gmail.com
+*/
+
+#pragma once
+#include "../include/grid_generator/common.h"
+#include "../include/grid_generator/common_internal.h"
+#include <math.h>
+
+/*
+    Kernels are written once for an abstract vector of doubles V (scalar, SSE2 or AVX2) and do exactly the same
+    floating point operations as Line::intersection(), Circle::intersection() and Arc::intersection(), so results are equal
+    Every lane keeps its own nearest hit, lanes are reduced at the end, ties are won by lower figure index
+    The header is included by several translation units compiled with different instruction sets,
+    so everything is put in an anonymous namespace to prevent the linker from mixing instantiations
+*/
+
+namespace gg
+{
+    namespace batch
+    {
+        ///Nearest hit found by kernel
+        struct KernelHit
+        {
+            double t;
+            unsigned int index;
+            unsigned int position;
+        };
+
+        ///Line arrays
+        struct LineData
+        {
+            const double *ax, *ay, *dx, *dy;
+            const unsigned int *index;
+        };
+
+        ///Circle or arc arrays
+        struct CircleData
+        {
+            const double *cx, *cy, *r2, *azimuth, *angle;
+            const unsigned int *index;
+        };
+
+        typedef void (*LineKernel)(const LineData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit);
+        typedef void (*CircleKernel)(const CircleData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit);
+
+        #ifdef GG_AVX2
+            void lines_avx2(const LineData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit);
+            void circles_avx2(const CircleData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit);
+            void arcs_avx2(const CircleData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit);
+        #endif
+
+        namespace
+        {
+            //Not std::numeric_limits, inline functions of the standard library must not be instantiated here
+            const double infinity = HUGE_VAL;
+
+            ///Scalar vector of width one
+            struct ScalarOps
+            {
+                typedef double Real;
+                typedef bool Mask;
+                static const unsigned int width = 1;
+                static Real load(const double *p) { return *p; }
+                static Real load(const unsigned int *p) { return (double)*p; }
+                static Real set(double v) { return v; }
+                static Real iota(unsigned int v) { return (double)v; }
+                static void store(double *p, Real v) { *p = v; }
+                static Real add(Real a, Real b) { return a + b; }
+                static Real sub(Real a, Real b) { return a - b; }
+                static Real mul(Real a, Real b) { return a * b; }
+                static Real div(Real a, Real b) { return a / b; }
+                static Real sqrt(Real a) { return ::sqrt(a); }
+                static Mask lt(Real a, Real b) { return a < b; }
+                static Mask le(Real a, Real b) { return a <= b; }
+                static Mask gt(Real a, Real b) { return a > b; }
+                static Mask ge(Real a, Real b) { return a >= b; }
+                static Mask eq(Real a, Real b) { return a == b; }
+                static Mask ne(Real a, Real b) { return a != b; }
+                static Mask and_(Mask a, Mask b) { return a && b; }
+                static Mask or_(Mask a, Mask b) { return a || b; }
+                static bool any(Mask a) { return a; }
+                static Real select(Mask m, Real a, Real b) { return m ? a : b; }
+            };
+
+            ///Nearest hits of every lane
+            template <class V> struct LaneHit
+            {
+                typename V::Real t, index, position;
+                LaneHit() : t(V::set(infinity)), index(V::set(0.0)), position(V::set(0.0)) {}
+                void update(typename V::Real new_t, typename V::Real new_index, typename V::Real new_position)
+                {
+                    const typename V::Mask better = V::or_(V::lt(new_t, t), V::and_(V::eq(new_t, t), V::lt(new_index, index)));
+                    t = V::select(better, new_t, t);
+                    index = V::select(better, new_index, index);
+                    position = V::select(better, new_position, position);
+                }
+                void reduce(KernelHit &hit) const
+                {
+                    double lane_t[V::width], lane_index[V::width], lane_position[V::width];
+                    V::store(lane_t, t);
+                    V::store(lane_index, index);
+                    V::store(lane_position, position);
+                    for (unsigned int lane = 0; lane < V::width; lane++)
+                    {
+                        if (lane_t[lane] == infinity) continue;
+                        if (lane_t[lane] < hit.t || (lane_t[lane] == hit.t && lane_index[lane] < hit.index))
+                        {
+                            hit.t = lane_t[lane];
+                            hit.index = (unsigned int)lane_index[lane];
+                            hit.position = (unsigned int)lane_position[lane];
+                        }
+                    }
+                }
+            };
+
+            ///Intersects segment with V::width lines, see Line::intersection()
+            template <class V> void line_block(const LineData &data, unsigned int i, Vector a, Vector b, LaneHit<V> &lanes)
+            {
+                typedef typename V::Real Real;
+                const Real A00 = V::set(b.x - a.x);
+                const Real A10 = V::set(b.y - a.y);
+                const Real negative_A10 = V::set(-(b.y - a.y));
+                const Real A01 = V::load(data.dx + i);
+                const Real A11 = V::load(data.dy + i);
+                const Real b0 = V::sub(V::load(data.ax + i), V::set(a.x));
+                const Real b1 = V::sub(V::load(data.ay + i), V::set(a.y));
+                const Real zero = V::set(0.0), one = V::set(1.0);
+                const Real determinant = V::sub(V::mul(A00, A11), V::mul(A01, A10));
+                const Real t = V::div(V::sub(V::mul(A11, b0), V::mul(A01, b1)), determinant);
+                const Real s = V::div(V::add(V::mul(negative_A10, b0), V::mul(A00, b1)), determinant);
+                const typename V::Mask valid = V::and_(V::and_(V::ne(determinant, zero), V::and_(V::ge(t, zero), V::le(t, one))), V::and_(V::ge(s, zero), V::le(s, one)));
+                lanes.update(V::select(valid, t, V::set(infinity)), V::load(data.index + i), V::iota(i));
+            }
+
+            ///Solves quadratic equation for V::width circles, see Circle::intersection()
+            template <class V> void circle_roots(const CircleData &data, unsigned int i, Vector a, Vector b, double length,
+                typename V::Real &L1, typename V::Real &L2, typename V::Mask &valid1, typename V::Mask &valid2)
+            {
+                typedef typename V::Real Real;
+                const Real cax = V::sub(V::load(data.cx + i), V::set(a.x));
+                const Real cay = V::sub(V::load(data.cy + i), V::set(a.y));
+                const Real zero = V::set(0.0), two = V::set(2.0), L = V::set(length);
+                const Real dot = V::add(V::mul(cax, V::set(b.x - a.x)), V::mul(cay, V::set(b.y - a.y)));
+                const Real B = V::div(V::mul(V::set(-2.0), dot), L);
+                const Real C = V::sub(V::add(V::mul(cax, cax), V::mul(cay, cay)), V::load(data.r2 + i));
+                const Real determinant = V::sub(V::mul(B, B), V::mul(V::set(4.0), C));
+                const Real root = V::sqrt(V::select(V::ge(determinant, zero), determinant, zero));
+                const Real negative_B = V::sub(V::set(-0.0), B);
+                L1 = V::div(V::sub(negative_B, root), two);
+                L2 = V::div(V::add(negative_B, root), two);
+                valid1 = V::and_(V::ge(determinant, zero), V::and_(V::ge(L1, zero), V::le(L1, L)));
+                valid2 = V::and_(V::gt(determinant, zero), V::and_(V::ge(L2, zero), V::le(L2, L)));
+            }
+
+            ///Intersects segment with V::width circles, see Circle::intersection()
+            template <class V> void circle_block(const CircleData &data, unsigned int i, Vector a, Vector b, double length, LaneHit<V> &lanes)
+            {
+                typename V::Real L1, L2;
+                typename V::Mask valid1, valid2;
+                circle_roots<V>(data, i, a, b, length, L1, L2, valid1, valid2);
+                const typename V::Real L = V::select(valid1, L1, V::select(valid2, L2, V::set(infinity)));
+                lanes.update(V::div(L, V::set(length)), V::load(data.index + i), V::iota(i));
+            }
+
+            ///Intersects segment with V::width arcs, see Arc::intersection(), azimuth is checked only for roots of valid length
+            template <class V> void arc_block(const CircleData &data, unsigned int i, Vector a, Vector b, double length, LaneHit<V> &lanes)
+            {
+                typename V::Real L1, L2;
+                typename V::Mask valid1, valid2;
+                circle_roots<V>(data, i, a, b, length, L1, L2, valid1, valid2);
+                if (!V::any(V::or_(valid1, valid2))) return;
+                double lane_L[2][V::width], lane_valid[2][V::width], lane_t[V::width];
+                V::store(lane_L[0], L1);
+                V::store(lane_L[1], L2);
+                V::store(lane_valid[0], V::select(valid1, V::set(1.0), V::set(0.0)));
+                V::store(lane_valid[1], V::select(valid2, V::set(1.0), V::set(0.0)));
+                for (unsigned int lane = 0; lane < V::width; lane++)
+                {
+                    lane_t[lane] = infinity;
+                    const Vector center(data.cx[i + lane], data.cy[i + lane]);
+                    for (unsigned int root = 0; root < 2; root++)
+                    {
+                        if (lane_valid[root][lane] == 0.0) continue;
+                        const Vector I = a + (b - a) * lane_L[root][lane] / length;
+                        const double angle = atan2((I - center).y, (I - center).x);
+                        if (angle_in_arc(data.azimuth[i + lane], data.angle[i + lane], angle)) { lane_t[lane] = lane_L[root][lane] / length; break; }
+                    }
+                }
+                lanes.update(V::load(lane_t), V::load(data.index + i), V::iota(i));
+            }
+
+            ///Searches for nearest intersection with lines, full blocks are processed with V, the rest is processed with ScalarOps
+            template <class V> void lines(const LineData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit)
+            {
+                unsigned int i = begin;
+                if (i + V::width <= end)
+                {
+                    LaneHit<V> lanes;
+                    for (; i + V::width <= end; i += V::width) line_block<V>(data, i, a, b, lanes);
+                    lanes.reduce(hit);
+                }
+                LaneHit<ScalarOps> rest;
+                for (; i < end; i++) line_block<ScalarOps>(data, i, a, b, rest);
+                rest.reduce(hit);
+            }
+
+            ///Searches for nearest intersection with circles, full blocks are processed with V, the rest is processed with ScalarOps
+            template <class V> void circles(const CircleData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit)
+            {
+                const double length = (b - a).norm();
+                unsigned int i = begin;
+                if (i + V::width <= end)
+                {
+                    LaneHit<V> lanes;
+                    for (; i + V::width <= end; i += V::width) circle_block<V>(data, i, a, b, length, lanes);
+                    lanes.reduce(hit);
+                }
+                LaneHit<ScalarOps> rest;
+                for (; i < end; i++) circle_block<ScalarOps>(data, i, a, b, length, rest);
+                rest.reduce(hit);
+            }
+
+            ///Searches for nearest intersection with arcs, full blocks are processed with V, the rest is processed with ScalarOps
+            template <class V> void arcs(const CircleData &data, unsigned int begin, unsigned int end, Vector a, Vector b, KernelHit &hit)
+            {
+                const double length = (b - a).norm();
+                unsigned int i = begin;
+                if (i + V::width <= end)
+                {
+                    LaneHit<V> lanes;
+                    for (; i + V::width <= end; i += V::width) arc_block<V>(data, i, a, b, length, lanes);
+                    lanes.reduce(hit);
+                }
+                LaneHit<ScalarOps> rest;
+                for (; i < end; i++) arc_block<ScalarOps>(data, i, a, b, length, rest);
+                rest.reduce(hit);
+            }
+        }
+    }
+}
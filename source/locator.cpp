@@ -0,0 +1,60 @@
+#include "../include/grid_generator/locator.h"
+#include "../include/grid_generator/dense_lattice.hxx"
+#include "../include/grid_generator/parallel.hxx"
+#include "../include/grid_generator/csr_patch.hxx"
+
+gg::CellLocator::CellLocator() : _lattice(Parameters()), _cells(Parameters(), no_index) {}
+
+gg::CellLocator::CellLocator(const Parameters &parameters) : _lattice(parameters), _cells(parameters, no_index) {}
+
+void gg::CellLocator::insert(Position position, unsigned int cell, const std::vector<Vector> &polygon)
+{
+    _cells.at(position) = cell;
+    if (_polygon_offsets.empty()) _polygon_offsets.push_back(0);
+    _polygon_offsets.resize(cell + 1, _polygon_offsets.back());
+    _polygon_points.insert(_polygon_points.end(), polygon.begin(), polygon.end());
+    _polygon_offsets.push_back((unsigned int)_polygon_points.size());
+}
+
+void gg::CellLocator::set(Position position, unsigned int cell)
+{
+    _cells.at(position) = cell;
+}
+
+void gg::CellLocator::replace(unsigned int count, const std::vector<unsigned int> &cells, const std::vector<unsigned int> &offsets, const std::vector<Vector> &points)
+{
+    if (_polygon_offsets.empty()) _polygon_offsets.push_back(0);
+    replace_rows(_polygon_offsets, _polygon_points, count, cells, offsets, points);
+    replace_offsets(_polygon_offsets, count, cells, offsets);
+}
+
+unsigned int gg::CellLocator::locate(Vector coord) const
+{
+    const unsigned int cell = _cells.get(_lattice.position(coord));
+    if (cell == no_index) return no_index;
+    const unsigned int begin = _polygon_offsets[cell], end = _polygon_offsets[cell + 1];
+    if (begin == end) return cell;
+
+    //Crossing number test
+    bool inside = false;
+    for (unsigned int i = begin, j = end - 1; i < end; j = i++)
+    {
+        const Vector a = _polygon_points[i], b = _polygon_points[j];
+        if ((a.y > coord.y) != (b.y > coord.y) && coord.x < a.x + (coord.y - a.y) * (b.x - a.x) / (b.y - a.y)) inside = !inside;
+    }
+    return inside ? cell : no_index;
+}
+
+void gg::CellLocator::locate(const std::vector<Vector> &coords, std::vector<unsigned int> &cells, ThreadPool &pool) const
+{
+    cells.resize(coords.size());
+    parallel_for(pool, (unsigned int)coords.size(), [&](unsigned int i)
+    {
+        cells[i] = locate(coords[i]);
+    });
+}
+
+bool gg::CellLocator::empty() const
+{
+    return _polygon_offsets.empty();
+}
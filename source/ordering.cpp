@@ -0,0 +1,200 @@
+#include "../include/grid_generator/ordering.hxx"
+#include "../include/grid_generator/common_internal.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+    std::uint64_t morton_key(std::uint32_t x, std::uint32_t y)
+    {
+        std::uint64_t key = 0;
+        for (unsigned int bit = 0; bit < 32; bit++)
+        {
+            key |= (std::uint64_t)((x >> bit) & 1) << (2 * bit);
+            key |= (std::uint64_t)((y >> bit) & 1) << (2 * bit + 1);
+        }
+        return key;
+    }
+
+    std::uint64_t hilbert_key(std::uint32_t x, std::uint32_t y, std::uint32_t n)
+    {
+        std::uint64_t key = 0;
+        for (std::uint32_t s = n / 2; s > 0; s /= 2)
+        {
+            const std::uint32_t rx = ((x & s) != 0) ? 1 : 0, ry = ((y & s) != 0) ? 1 : 0;
+            key += (std::uint64_t)s * s * ((3 * rx) ^ ry);
+            if (ry == 0)
+            {
+                if (rx == 1) { x = n - 1 - x; y = n - 1 - y; }
+                std::swap(x, y);
+            }
+        }
+        return key;
+    }
+}
+
+std::vector<unsigned int> gg::get_cell_order(const IndexedCellGrid &grid, const Parameters &parameters, Ordering ordering)
+{
+    const unsigned int cells = (unsigned int)grid.cell_centers.size();
+    std::vector<unsigned int> order(cells);
+    for (unsigned int cell = 0; cell < cells; cell++) order[cell] = cell;
+    if (ordering == Ordering::lattice || cells == 0) return order;
+
+    if (ordering == Ordering::cuthill_mckee)
+    {
+        //Breadth-first search from cells with fewest neighbors, neighbors are visited in order of ascending degree, the result is reversed
+        std::vector<unsigned int> degrees(cells, 0);
+        for (unsigned int cell = 0; cell < cells; cell++)
+        {
+            for (unsigned int s = grid.side_offsets[cell]; s < grid.side_offsets[cell + 1]; s++)
+            {
+                if (grid.sides[s].cell != no_index) degrees[cell]++;
+            }
+        }
+        const auto by_degree = [&](unsigned int a, unsigned int b) -> bool { return degrees[a] < degrees[b]; };
+        std::vector<unsigned int> starts = order;
+        std::stable_sort(starts.begin(), starts.end(), by_degree);
+        std::vector<bool> visited(cells, false);
+        std::vector<unsigned int> neighbors;
+        order.clear();
+        for (std::vector<unsigned int>::const_iterator start = starts.begin(); start != starts.end(); start++)
+        {
+            if (visited[*start]) continue;
+            visited[*start] = true;
+            std::size_t head = order.size();
+            order.push_back(*start);
+            while (head < order.size())
+            {
+                const unsigned int cell = order[head++];
+                neighbors.clear();
+                for (unsigned int s = grid.side_offsets[cell]; s < grid.side_offsets[cell + 1]; s++)
+                {
+                    const unsigned int neighbor = grid.sides[s].cell;
+                    if (neighbor == no_index || visited[neighbor]) continue;
+                    visited[neighbor] = true;
+                    neighbors.push_back(neighbor);
+                }
+                std::stable_sort(neighbors.begin(), neighbors.end(), by_degree);
+                order.insert(order.end(), neighbors.begin(), neighbors.end());
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    //Space-filling curves over lattice positions, upside down elements follow normal ones
+    const Lattice lattice(parameters);
+    std::vector<Position> positions(cells);
+    int xmin = INT_MAX, ymin = INT_MAX, xmax = INT_MIN, ymax = INT_MIN;
+    for (unsigned int cell = 0; cell < cells; cell++)
+    {
+        positions[cell] = lattice.position(grid.cell_centers[cell]);
+        xmin = std::min(xmin, positions[cell].xi); xmax = std::max(xmax, positions[cell].xi);
+        ymin = std::min(ymin, positions[cell].yi); ymax = std::max(ymax, positions[cell].yi);
+    }
+    const std::uint32_t extent = std::max((std::uint32_t)((std::int64_t)xmax - xmin), (std::uint32_t)((std::int64_t)ymax - ymin)) + 1;
+    std::uint32_t n = 1;
+    while (n < extent && n < 0x80000000u) n *= 2;
+    std::vector<std::uint64_t> keys(cells);
+    for (unsigned int cell = 0; cell < cells; cell++)
+    {
+        const std::uint32_t x = (std::uint32_t)((std::int64_t)positions[cell].xi - xmin), y = (std::uint32_t)((std::int64_t)positions[cell].yi - ymin);
+        keys[cell] = (ordering == Ordering::hilbert) ? hilbert_key(x, y, n) : morton_key(x, y);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) -> bool
+    {
+        if (keys[a] != keys[b]) return keys[a] < keys[b];
+        return positions[a].upside_down < positions[b].upside_down;
+    });
+    return order;
+}
+
+gg::GridReordering gg::reorder(IndexedCellGrid &grid, const std::vector<unsigned int> &order)
+{
+    const unsigned int cells = (unsigned int)grid.cell_centers.size(), faces = (unsigned int)grid.face_points.size(), points = (unsigned int)grid.point_coords.size();
+    if (order.size() != cells) throw std::runtime_error("gg::reorder(): Invalid order");
+    GridReordering reordering;
+    reordering.cell_map.assign(cells, no_index);
+    for (unsigned int cell = 0; cell < cells; cell++)
+    {
+        if (order[cell] >= cells || reordering.cell_map[order[cell]] != no_index) throw std::runtime_error("gg::reorder(): Invalid order");
+        reordering.cell_map[order[cell]] = cell;
+    }
+
+    //Points and faces are numbered in order of the first cell that has them, then the ones that no cell has
+    reordering.point_map.assign(points, no_index);
+    reordering.face_map.assign(faces, no_index);
+    unsigned int point_count = 0, face_count = 0;
+    for (unsigned int cell = 0; cell < cells; cell++)
+    {
+        for (unsigned int s = grid.side_offsets[order[cell]]; s < grid.side_offsets[order[cell] + 1]; s++)
+        {
+            const IndexedSide &side = grid.sides[s];
+            if (reordering.point_map[side.point] == no_index) reordering.point_map[side.point] = point_count++;
+            if (reordering.face_map[side.face] == no_index) reordering.face_map[side.face] = face_count++;
+        }
+    }
+    for (unsigned int point = 0; point < points; point++)
+    {
+        if (reordering.point_map[point] == no_index) reordering.point_map[point] = point_count++;
+    }
+    for (unsigned int face = 0; face < faces; face++)
+    {
+        if (reordering.face_map[face] == no_index) reordering.face_map[face] = face_count++;
+    }
+
+    //Moving elements
+    permute(grid.point_coords, reordering.point_map);
+    permute(grid.point_normals, reordering.point_map);
+    permute(grid.point_boundaries, reordering.point_map);
+    for (unsigned int face = 0; face < faces; face++)
+    {
+        grid.face_points[face][0] = reordering.point_map[grid.face_points[face][0]];
+        grid.face_points[face][1] = reordering.point_map[grid.face_points[face][1]];
+    }
+    permute(grid.face_points, reordering.face_map);
+    permute(grid.face_centers, reordering.face_map);
+    permute(grid.face_normals, reordering.face_map);
+    permute(grid.face_lengths, reordering.face_map);
+    permute(grid.face_boundaries, reordering.face_map);
+    permute(grid.cell_centers, reordering.cell_map);
+    permute(grid.cell_areas, reordering.cell_map);
+    permute(grid.cell_boundaries, reordering.cell_map);
+    std::vector<unsigned int> side_offsets;
+    std::vector<IndexedSide> sides;
+    side_offsets.reserve(grid.side_offsets.size());
+    sides.reserve(grid.sides.size());
+    for (unsigned int cell = 0; cell < cells; cell++)
+    {
+        side_offsets.push_back((unsigned int)sides.size());
+        for (unsigned int s = grid.side_offsets[order[cell]]; s < grid.side_offsets[order[cell] + 1]; s++)
+        {
+            IndexedSide side = grid.sides[s];
+            side.point = reordering.point_map[side.point];
+            side.face = reordering.face_map[side.face];
+            if (side.cell != no_index) side.cell = reordering.cell_map[side.cell];
+            sides.push_back(side);
+        }
+    }
+    side_offsets.push_back((unsigned int)sides.size());
+    grid.side_offsets.swap(side_offsets);
+    grid.sides.swap(sides);
+    return reordering;
+}
+
+unsigned int gg::get_bandwidth(const IndexedCellGrid &grid)
+{
+    unsigned int bandwidth = 0;
+    for (unsigned int cell = 0; cell + 1 < grid.side_offsets.size(); cell++)
+    {
+        for (unsigned int s = grid.side_offsets[cell]; s < grid.side_offsets[cell + 1]; s++)
+        {
+            const unsigned int neighbor = grid.sides[s].cell;
+            if (neighbor == no_index) continue;
+            bandwidth = std::max(bandwidth, (neighbor > cell) ? (neighbor - cell) : (cell - neighbor));
+        }
+    }
+    return bandwidth;
+}
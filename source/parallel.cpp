@@ -0,0 +1,75 @@
+#include "../include/grid_generator/parallel.h"
+#include <thread>
+
+unsigned int gg::get_threads(const Parameters &parameters)
+{
+    if (parameters.threads != 0) return parameters.threads;
+    const unsigned int threads = std::thread::hardware_concurrency();
+    return (threads != 0) ? threads : 1;
+}
+
+gg::ThreadPool::ThreadPool(unsigned int threads) : _busy(false)
+{
+    for (unsigned int t = 1; t < threads; t++) _workers.push_back(std::thread(&ThreadPool::_work, this));
+}
+
+void gg::ThreadPool::_work()
+{
+    unsigned int job_number = 0;
+    while (true)
+    {
+        const std::function<void()> *job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _start.wait(lock, [&]() -> bool { return _stop || _job_number != job_number; });
+            if (_stop) return;
+            job_number = _job_number;
+            job = _job;
+        }
+        (*job)();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running--;
+            if (_running == 0) _finish.notify_one();
+        }
+    }
+}
+
+unsigned int gg::ThreadPool::threads() const
+{
+    return (unsigned int)_workers.size() + 1;
+}
+
+void gg::ThreadPool::run(const std::function<void()> &job)
+{
+    //Workers are busy with the outer job, the nested one runs only here
+    if (_workers.empty() || _busy.exchange(true))
+    {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _job_number++;
+        _running = (unsigned int)_workers.size();
+    }
+    _start.notify_all();
+    job();
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finish.wait(lock, [&]() -> bool { return _running == 0; });
+        _job = nullptr;
+    }
+    _busy = false;
+}
+
+gg::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _start.notify_all();
+    for (std::vector<std::thread>::iterator worker = _workers.begin(); worker != _workers.end(); worker++) worker->join();
+}
@@ -0,0 +1,41 @@
+#include "../include/grid_generator/partition.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+    void bisect(const std::vector<gg::Vector> &centers, std::vector<unsigned int>::iterator begin, std::vector<unsigned int>::iterator end, unsigned int first_part, unsigned int parts, std::vector<unsigned int> &cell_parts)
+    {
+        if (parts == 1 || begin == end)
+        {
+            for (std::vector<unsigned int>::iterator cell = begin; cell != end; cell++) cell_parts[*cell] = first_part;
+            return;
+        }
+
+        //Cells are split in proportion to the number of parts on both sides, ties are broken by index
+        gg::Box box;
+        for (std::vector<unsigned int>::iterator cell = begin; cell != end; cell++) box.extend(gg::Box(centers[*cell], centers[*cell]));
+        const bool vertical = (box.max.y - box.min.y) > (box.max.x - box.min.x);
+        const unsigned int lower_parts = parts / 2;
+        const std::vector<unsigned int>::iterator middle = begin + (std::ptrdiff_t)((std::uint64_t)(end - begin) * lower_parts / parts);
+        std::nth_element(begin, middle, end, [&](unsigned int a, unsigned int b) -> bool
+        {
+            const double a_coord = vertical ? centers[a].y : centers[a].x, b_coord = vertical ? centers[b].y : centers[b].x;
+            if (a_coord != b_coord) return a_coord < b_coord;
+            return a < b;
+        });
+        bisect(centers, begin, middle, first_part, lower_parts, cell_parts);
+        bisect(centers, middle, end, first_part + lower_parts, parts - lower_parts, cell_parts);
+    }
+}
+
+std::vector<unsigned int> gg::get_cell_parts(const std::vector<Vector> &centers, unsigned int parts)
+{
+    if (parts == 0) throw std::runtime_error("gg::get_cell_parts(): Invalid number of parts");
+    std::vector<unsigned int> cells(centers.size());
+    for (unsigned int cell = 0; cell < cells.size(); cell++) cells[cell] = cell;
+    std::vector<unsigned int> cell_parts(centers.size(), 0);
+    bisect(centers, cells.begin(), cells.end(), 0, parts, cell_parts);
+    return cell_parts;
+}
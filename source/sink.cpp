@@ -0,0 +1,36 @@
+#include "../include/grid_generator/sink.h"
+#include <stdexcept>
+
+void gg::IndexedCellSink::point(unsigned int index, Vector coord, Vector normal, unsigned int boundary)
+{
+    if (index != _grid.point_coords.size()) throw std::runtime_error("gg::IndexedCellSink::point(): Points are not passed in order of their indexes");
+    _grid.point_coords.push_back(coord);
+    _grid.point_normals.push_back(normal);
+    _grid.point_boundaries.push_back(boundary);
+}
+
+void gg::IndexedCellSink::face(unsigned int index, std::array<unsigned int, 2> points, Vector center, Vector normal, double length, unsigned int boundary)
+{
+    if (index != _grid.face_points.size()) throw std::runtime_error("gg::IndexedCellSink::face(): Faces are not passed in order of their indexes");
+    _grid.face_points.push_back(points);
+    _grid.face_centers.push_back(center);
+    _grid.face_normals.push_back(normal);
+    _grid.face_lengths.push_back(length);
+    _grid.face_boundaries.push_back(boundary);
+}
+
+void gg::IndexedCellSink::cell(unsigned int index, Vector center, double area, unsigned int boundary, const IndexedSide *sides, unsigned int count)
+{
+    if (index != _grid.cell_centers.size()) throw std::runtime_error("gg::IndexedCellSink::cell(): Cells are not passed in order of their indexes");
+    _grid.cell_centers.push_back(center);
+    _grid.cell_areas.push_back(area);
+    _grid.cell_boundaries.push_back(boundary);
+    if (_grid.side_offsets.empty()) _grid.side_offsets.push_back(0);
+    _grid.sides.insert(_grid.sides.end(), sides, sides + count);
+    _grid.side_offsets.push_back((unsigned int)_grid.sides.size());
+}
+
+gg::IndexedCellGrid &gg::IndexedCellSink::grid()
+{
+    return _grid;
+}
@@ -0,0 +1,100 @@
+#include "../include/grid_generator/statistics.h"
+
+gg::GridStatistics::GridStatistics() : _probes(0), _hits(0), _tests(0), _lookups(0), _allocations(0) {}
+
+void gg::GridStatistics::begin(const char *stage)
+{
+    Stage new_stage;
+    new_stage.name = stage;
+    new_stage.seconds = 0.0;
+    _stages.push_back(new_stage);
+    _begin = std::chrono::steady_clock::now();
+}
+
+void gg::GridStatistics::end()
+{
+    if (!_stages.empty()) _stages.back().seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _begin).count();
+}
+
+void gg::GridStatistics::wave()
+{
+    _waves++;
+}
+
+void gg::GridStatistics::probe(bool hit)
+{
+    _probes.fetch_add(1, std::memory_order_relaxed);
+    if (hit) _hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+void gg::GridStatistics::test(unsigned int figures)
+{
+    _tests.fetch_add(figures, std::memory_order_relaxed);
+}
+
+void gg::GridStatistics::lookup(unsigned int count)
+{
+    _lookups.fetch_add(count, std::memory_order_relaxed);
+}
+
+void gg::GridStatistics::allocation(unsigned int count)
+{
+    _allocations.fetch_add(count, std::memory_order_relaxed);
+}
+
+void gg::GridStatistics::memory(std::size_t bytes)
+{
+    if (bytes > _peak_memory) _peak_memory = bytes;
+}
+
+void gg::GridStatistics::clear()
+{
+    _stages.clear();
+    _waves = 0;
+    _probes = 0;
+    _hits = 0;
+    _tests = 0;
+    _lookups = 0;
+    _allocations = 0;
+    _peak_memory = 0;
+}
+
+const std::vector<gg::GridStatistics::Stage> &gg::GridStatistics::stages() const
+{
+    return _stages;
+}
+
+unsigned long long gg::GridStatistics::waves() const
+{
+    return _waves;
+}
+
+unsigned long long gg::GridStatistics::probes() const
+{
+    return _probes;
+}
+
+unsigned long long gg::GridStatistics::hits() const
+{
+    return _hits;
+}
+
+unsigned long long gg::GridStatistics::tests() const
+{
+    return _tests;
+}
+
+unsigned long long gg::GridStatistics::lookups() const
+{
+    return _lookups;
+}
+
+unsigned long long gg::GridStatistics::allocations() const
+{
+    return _allocations;
+}
+
+std::size_t gg::GridStatistics::peak_memory() const
+{
+    return _peak_memory;
+}